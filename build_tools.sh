@@ -0,0 +1,17 @@
+#!/bin/bash
+start=$(date +%s.%3N)
+mkdir -p ./bin
+clang -Wall -Wfatal-errors -Wno-gnu -Wno-microsoft -O3 -std=gnu11 -fms-extensions \
+-I"./libs" -I"./src/include" -I"./src" ./tools/generator_bench.c -lpthread -lm -o ./bin/generator_bench
+clang -Wall -Wfatal-errors -Wno-gnu -Wno-microsoft -O3 -std=gnu11 -fms-extensions \
+-I"./libs" -I"./src/include" -I"./src" ./tools/animation_bench.c -lpthread -lm -o ./bin/animation_bench
+clang -Wall -Wfatal-errors -Wno-gnu -Wno-microsoft -O3 -std=gnu11 -fms-extensions \
+-I"./libs" -I"./src/include" -I"./src" ./tools/math_bench.c -lm -o ./bin/math_bench
+clang -Wall -Wfatal-errors -Wno-gnu -Wno-microsoft -O3 -std=gnu11 -fms-extensions \
+-I"./libs" -I"./src/include" -I"./src" ./tools/animation_report.c -lpthread -lm -o ./bin/animation_report
+clang -Wall -Wfatal-errors -Wno-gnu -Wno-microsoft -O3 -std=gnu11 -fms-extensions \
+-I"./libs" -I"./src/include" -I"./src" ./tools/gltf_load_report.c -lpthread -lm -o ./bin/gltf_load_report
+clang -Wall -Wfatal-errors -Wno-gnu -Wno-microsoft -O3 -std=gnu11 -fms-extensions \
+-I"./libs" -I"./src/include" -I"./src" ./tools/model_cooker.c -lpthread -lm -o ./bin/model_cooker
+stop=$(date +%s.%3N)
+echo "the build took $(bc <<< $stop-$start) seconds"
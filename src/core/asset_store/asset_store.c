@@ -5,21 +5,259 @@
 
 #include <logger.h>
 #include <string_utils.h>
+#include <animation.h>
+#include <skeleton.h>
+#include <jobs.h>
 
 #define STB_DS_IMPLEMENTATION
 #include <stb/stb_ds.h>
 
 #include <assert.h>
+#include <pthread.h>
+#include <limits.h>
+#include <stdlib.h>
 #include "json_loader.c"
+#include "cooked_model.c"
+#include "skeleton.c"
 #include "skinned_model.c"
 
-void asset_store_init(asset_store_t *asset_store, bulk_data_texture_t *textures, bulk_data_skinned_model_t *skinned_models)
+#define ASSET_MAX_LOADS             64
+#define ASSET_DEFAULT_UPLOAD_BUDGET MEGABYTES(32)
+
+struct asset_loader_t;
+
+typedef struct
+{
+    struct asset_loader_t *loader;
+    asset_type_e           type;
+    //! @brief asset_load_state_e, main thread only
+    uint32_t               state;
+    //! @brief bumped every time the load is reused so old handles see ASSET_LOAD_NONE
+    uint32_t               generation;
+    //! @brief finished loads are reused oldest first
+    uint64_t               finished;
+
+    const char            *asset_id;
+    const char            *file_path;
+    const char            *skeleton_id;
+
+    //! @brief written by the job, read on the main thread once the load is in the completed queue
+    bool                   loaded;
+    stbi_uc               *pixels;
+    int                    width, height;
+    cooked_model_t         cooked;
+    skinned_model_source_t source;
+    uint32_t               upload_size;
+
+    //! @brief slot of the created asset while it uploads
+    uint32_t               slot;
+}asset_load_t;
+
+typedef struct asset_loader_t
+{
+    asset_load_t    loads[ASSET_MAX_LOADS];
+    //! @brief indices of loads the jobs are done with, in the order they finished
+    pthread_mutex_t mutex;
+    uint32_t        completed[ASSET_MAX_LOADS];
+    uint32_t        completed_head;
+    uint32_t        completed_count;
+    //! @brief loads in the upload batch that is in flight
+    uint32_t        uploading[ASSET_MAX_LOADS];
+    uint32_t        uploading_count;
+    uint64_t        finished_count;
+    job_counter_t   jobs;
+}asset_loader_t;
+
+void asset_store_init(asset_store_t *asset_store, bulk_data_texture_t *textures, bulk_data_skinned_model_t *skinned_models, bulk_data_skeleton_t *skeletons)
 {
     asset_store->texture_map = NULL;
     asset_store->skinned_model_map = NULL;
+    asset_store->skeleton_map = NULL;
+    asset_store->shared_textures = NULL;
+    asset_store->shared_renderbuffers = NULL;
+    asset_store->residents = NULL;
+    asset_store->retired = NULL;
 
     asset_store->textures       = textures;
     asset_store->skinned_models = skinned_models;
+    asset_store->skeletons      = skeletons;
+
+    //off until the game asks for it
+    memset(&asset_store->animation_compression, 0, sizeof(asset_store->animation_compression));
+    asset_store->animation_bake_rate = 0.0f;
+
+    asset_store->loader = memory_alloc(sizeof(asset_loader_t), MEM_TAG_HEAP);
+    memset(asset_store->loader, 0, sizeof(asset_loader_t));
+    pthread_mutex_init(&asset_store->loader->mutex, NULL);
+    asset_store->upload_budget = ASSET_DEFAULT_UPLOAD_BUDGET;
+
+    //unlimited until the game sets a budget
+    memset(&asset_store->memory_budget, 0, sizeof(asset_store->memory_budget));
+    memset(&asset_store->memory_used, 0, sizeof(asset_store->memory_used));
+    asset_store->frame = 0;
+}
+
+asset_key_t asset_store_file_key(const char *file_path)
+{
+    //paths that reach the same file through ./, ../ or links share the texture
+    char canonical[PATH_MAX];
+    const char *path = realpath(file_path, canonical) ? canonical : file_path;
+    asset_key_t key = asset_store_content_key(path, strlen(path), 0);
+    key.hash = string_hash(path);
+    return key;
+}
+
+static inline uint64_t asset_store_rotate(uint64_t x, uint32_t r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+asset_key_t asset_store_content_key(const void *data, size_t size, uint64_t seed)
+{
+    //the check lane mixes with its own constants and rotations, a collision of one lane says nothing about the other
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint64_t hash  = seed ^ (size * 0x9E3779B97F4A7C15ULL);
+    uint64_t check = ~seed + size * 0xC2B2AE3D27D4EB4FULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 0xBF58476D1CE4E5B9ULL;
+        hash ^= hash >> 29;
+        check = asset_store_rotate(check + word * 0xC2B2AE3D27D4EB4FULL, 31) * 0x9E3779B185EBCA87ULL;
+    }
+    for (; i < size; i++) {
+        hash  = (hash ^ bytes[i]) * 0x94D049BB133111EBULL;
+        check = asset_store_rotate(check ^ (bytes[i] * 0x27D4EB2F165667C5ULL), 11) * 0x9E3779B185EBCA87ULL;
+    }
+    hash ^= hash >> 31;
+    hash *= 0xBF58476D1CE4E5B9ULL;
+    check ^= check >> 33;
+    check *= 0xFF51AFD7ED558CCDULL;
+    return (asset_key_t){hash ^ (hash >> 32), check ^ (check >> 29)};
+}
+
+uint32_t asset_store_acquire_shared(shared_hash_entry_t **shared, asset_key_t key)
+{
+    shared_hash_entry_t *entry = hmgetp_null(*shared, key.hash);
+    if (!entry || entry->value.check != key.check) return UINT32_MAX;
+    entry->value.ref_count++;
+    return entry->value.slot;
+}
+
+void asset_store_add_shared(shared_hash_entry_t **shared, asset_key_t key, uint32_t slot, uint32_t size)
+{
+    shared_hash_entry_t *entry = hmgetp_null(*shared, key.hash);
+    assert((!entry || entry->value.check != key.check) && "shared slot added twice");
+    if (entry) {
+        LOGE("Hash %016llx is taken by other data, slot %u is not shared", (unsigned long long)key.hash, slot);
+        return;
+    }
+    asset_shared_t value = {slot, 1, size, key.check};
+    hmput(*shared, key.hash, value);
+}
+
+bool asset_store_release_shared(shared_hash_entry_t **shared, uint32_t slot)
+{
+    //few enough textures and buffers per store that the reverse lookup is a scan
+    for (ptrdiff_t i = 0; i < hmlen(*shared); i++) {
+        shared_hash_entry_t *entry = &(*shared)[i];
+        if (entry->value.slot != slot) continue;
+
+        if (--entry->value.ref_count > 0) return false;
+        (void)hmdel(*shared, entry->key);
+        return true;
+    }
+    //not shared, the caller held the only reference
+    return true;
+}
+
+static inline uint64_t asset_store_resident_key(const char *asset_id, asset_type_e type)
+{
+    //a texture id and a model id may be the same string
+    return string_hash(asset_id) ^ ((uint64_t)type << 56);
+}
+
+//! @brief: adds a created asset to its map, nothing references it yet
+static void asset_store_publish(asset_store_t *asset_store, asset_type_e type, const char *asset_id, uint32_t slot)
+{
+    switch (type)
+    {
+        case ASSET_TYPE_TEXTURE:
+            shput(asset_store->texture_map, asset_id, slot);
+            break;
+        case ASSET_TYPE_SKINNED_MODEL:
+            shput(asset_store->skinned_model_map, asset_id, slot);
+            break;
+        case ASSET_TYPE_SKELETON:
+            shput(asset_store->skeleton_map, asset_id, slot);
+            break;
+        default:
+            assert(false && "This should not happen");
+            return;
+    }
+    asset_resident_t resident = {asset_id, type, slot, 0, asset_store->frame};
+    hmput(asset_store->residents, asset_store_resident_key(asset_id, type), resident);
+}
+
+void asset_store_retire(asset_store_t *asset_store, renderer_t *renderer, asset_type_e type, uint32_t slot,
+                        render_data_type_e render_data_type, void *render_data)
+{
+    if (slot == UINT32_MAX && !render_data) return;
+
+    //frames submitted until now may still read it
+    asset_retired_t retired = {type, slot, render_data, render_data_type, renderer->frame_count + renderer->max_frames_in_flight};
+    arrput(asset_store->retired, retired);
+}
+
+//! @brief: drops a reference to a shared texture or renderbuffer, the last one retires it
+static void asset_store_release_resource(asset_store_t *asset_store, renderer_t *renderer, asset_type_e type, uint32_t slot)
+{
+    shared_hash_entry_t **shared = type == ASSET_TYPE_TEXTURE ? &asset_store->shared_textures : &asset_store->shared_renderbuffers;
+    if (slot == UINT32_MAX || !asset_store_release_shared(shared, slot)) return;
+    asset_store_retire(asset_store, renderer, type, slot, RENDER_DATA_SKINNED_MODEL, NULL);
+}
+
+//! @brief: drops the textures and buffers a skinned model holds, also those of one that failed to be created
+static void asset_store_release_model_resources(asset_store_t *asset_store, renderer_t *renderer, skinned_model_t *model)
+{
+    for (uint32_t i = 0; i < model->texture_count; i++) {
+        asset_store_release_resource(asset_store, renderer, ASSET_TYPE_TEXTURE, model->textures[i]);
+    }
+    asset_store_release_resource(asset_store, renderer, ASSET_TYPE_RENDERBUFFER, model->vertex_buffer);
+    asset_store_release_resource(asset_store, renderer, ASSET_TYPE_RENDERBUFFER, model->index_buffer);
+    model->texture_count = 0;
+    model->vertex_buffer = UINT32_MAX;
+    model->index_buffer  = UINT32_MAX;
+}
+
+//! @brief: texture slot of a file, or of decoded RGBA8 pixels when there are any, UINT32_MAX when it can't be created.
+//          A texture of the same file is shared.
+static uint32_t asset_store_create_texture(asset_store_t *store,
+                                           renderer_t    *renderer,
+                                           const char    *file_path,
+                                           const void    *pixels,
+                                           uint32_t       width,
+                                           uint32_t       height)
+{
+    asset_key_t key = asset_store_file_key(file_path);
+    uint32_t slot   = asset_store_acquire_shared(&store->shared_textures, key);
+    if (slot != UINT32_MAX) return slot;
+
+    slot = bulk_data_allocate_slot_texture_t(store->textures);
+    texture_t *texture = bulk_data_getp_null_texture_t(store->textures, slot);
+    if (!texture) return UINT32_MAX;
+
+    bool created = pixels ? renderer_create_texture_from_pixels(renderer, texture, pixels, width, height) :
+                            renderer_create_texture(renderer, texture, file_path);
+    if (!created) {
+        LOGE("Unable to load texture from file: %s", file_path);
+        //remove from bulk data
+        bulk_data_delete_item_texture_t(store->textures, slot);
+        return UINT32_MAX;
+    }
+    asset_store_add_shared(&store->shared_textures, key, slot, texture->size);
+    return slot;
 }
 
 void asset_store_add_texture(asset_store_t *store,
@@ -28,46 +266,630 @@ void asset_store_add_texture(asset_store_t *store,
                              const char    *file_path)
 {
     if ((shgetp_null(store->texture_map, asset_id)) == NULL) {
-        uint32_t slot = bulk_data_allocate_slot_texture_t(store->textures);
-        texture_t *texture = bulk_data_getp_null_texture_t(store->textures, slot);
-        if (texture) {
-            if (!renderer_create_texture(renderer, texture, file_path)) {
-                LOGE("Unable to load texture from file: %s", file_path);
-                //remove from bulk data
-                bulk_data_delete_item_texture_t(store->textures, slot);
-                return;
+        uint32_t slot = asset_store_create_texture(store, renderer, file_path, NULL, 0, 0);
+        if (slot != UINT32_MAX) {
+            asset_store_publish(store, ASSET_TYPE_TEXTURE, asset_id, slot);
+        }
+    }
+}
+
+/**
+ * @brief: Skinned model slot of a cooked model, which is closed, UINT32_MAX when it can't be created. A skeleton it
+ *         creates for skeleton_id is added to the store right away, the model is left to the caller to add.
+ */
+static uint32_t asset_store_create_cooked_model(asset_store_t  *asset_store,
+                                                renderer_t     *renderer,
+                                                cooked_model_t *cooked,
+                                                const char     *file_path,
+                                                const char     *skeleton_id)
+{
+    uint32_t node_remap[MAX_NODES_PER_MODEL];
+    bool new_skeleton = false;
+    uint32_t skeleton_slot = asset_store_get_asset_index(asset_store, skeleton_id, ASSET_TYPE_SKELETON);
+    skeleton_t *skeleton = NULL;
+    if (skeleton_slot == UINT32_MAX) {
+        skeleton_slot = bulk_data_allocate_slot_skeleton_t(asset_store->skeletons);
+        skeleton = bulk_data_getp_null_skeleton_t(asset_store->skeletons, skeleton_slot);
+        if (!skeleton_create_cooked(skeleton, cooked)) {
+            LOGE("Unable to load skeleton from file: %s", file_path);
+            bulk_data_delete_item_skeleton_t(asset_store->skeletons, skeleton_slot);
+            cooked_model_close(cooked);
+            return UINT32_MAX;
+        }
+        for (uint32_t i = 0; i < skeleton->node_count; i++) {
+            node_remap[i] = i;
+        }
+        new_skeleton = true;
+    } else {
+        skeleton = bulk_data_getp_null_skeleton_t(asset_store->skeletons, skeleton_slot);
+        if (!skeleton_bind_cooked_nodes(skeleton, cooked, node_remap)) {
+            LOGE("Unable to bind the nodes of %s to skeleton %s", file_path, skeleton_id);
+            cooked_model_close(cooked);
+            return UINT32_MAX;
+        }
+    }
+
+    uint32_t slot = bulk_data_allocate_slot_skinned_model_t(asset_store->skinned_models);
+    skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, slot);
+    bool created = skinned_model_create_cooked(model, cooked, skeleton, skeleton_slot, node_remap, asset_store, renderer);
+    //the buffers and textures are in staging memory and the clips copied, nothing reads the file anymore
+    cooked_model_close(cooked);
+    if (!created) {
+        LOGE("Unable to load skinned model from file: %s", file_path);
+        asset_store_release_model_resources(asset_store, renderer, model);
+        bulk_data_delete_item_skinned_model_t(asset_store->skinned_models, slot);
+        if (new_skeleton) {
+            skeleton_destroy(skeleton);
+            bulk_data_delete_item_skeleton_t(asset_store->skeletons, skeleton_slot);
+        }
+        return UINT32_MAX;
+    }
+    if (asset_store->animation_bake_rate > 0.0f && !skinned_model_bake_animations(model, skeleton, asset_store->animation_bake_rate)) {
+        LOGE("Unable to bake the animations of %s", file_path);
+    }
+
+    if (new_skeleton) {
+        asset_store_publish(asset_store, ASSET_TYPE_SKELETON, skeleton_id, skeleton_slot);
+    }
+    //the model keeps its skeleton resident
+    asset_store_acquire(asset_store, skeleton_id, ASSET_TYPE_SKELETON);
+    return slot;
+}
+
+//! @brief: asset_store_create_cooked_model for a read glTF file, which is released
+static uint32_t asset_store_create_gltf_model(asset_store_t          *asset_store,
+                                              renderer_t             *renderer,
+                                              skinned_model_source_t *source,
+                                              const char             *file_path,
+                                              const char             *skeleton_id)
+{
+    gltf_model_t *gltf_model = source->gltf_model;
+    uint32_t *node_remap = memory_alloc(MAX(gltf_model->node_count, 1) * sizeof(uint32_t), MEM_TAG_TEMP);
+
+    //first model of a rig brings the skeleton, the others bind to it
+    bool new_skeleton = false;
+    uint32_t skeleton_slot = asset_store_get_asset_index(asset_store, skeleton_id, ASSET_TYPE_SKELETON);
+    skeleton_t *skeleton = NULL;
+    if (skeleton_slot == UINT32_MAX) {
+        skeleton_slot = bulk_data_allocate_slot_skeleton_t(asset_store->skeletons);
+        skeleton = bulk_data_getp_null_skeleton_t(asset_store->skeletons, skeleton_slot);
+        if (!skeleton_create(skeleton, gltf_model, &asset_store->animation_compression, node_remap)) {
+            LOGE("Unable to load skeleton from file: %s", file_path);
+            bulk_data_delete_item_skeleton_t(asset_store->skeletons, skeleton_slot);
+            skinned_model_release_source(source);
+            return UINT32_MAX;
+        }
+        new_skeleton = true;
+    } else {
+        skeleton = bulk_data_getp_null_skeleton_t(asset_store->skeletons, skeleton_slot);
+        if (!skeleton_bind_gltf_nodes(skeleton, gltf_model, node_remap)) {
+            LOGE("Unable to bind the nodes of %s to skeleton %s", file_path, skeleton_id);
+            skinned_model_release_source(source);
+            return UINT32_MAX;
+        }
+    }
+
+    uint32_t slot = bulk_data_allocate_slot_skinned_model_t(asset_store->skinned_models);
+    skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, slot);
+    if (!skinned_model_create(model, source, skeleton, skeleton_slot, node_remap, asset_store, renderer)) {
+        LOGE("Unable to load skinned model from file: %s", file_path);
+        asset_store_release_model_resources(asset_store, renderer, model);
+        bulk_data_delete_item_skinned_model_t(asset_store->skinned_models, slot);
+        if (new_skeleton) {
+            skeleton_destroy(skeleton);
+            bulk_data_delete_item_skeleton_t(asset_store->skeletons, skeleton_slot);
+        }
+        skinned_model_release_source(source);
+        return UINT32_MAX;
+    }
+    //vertices and clips are converted, nothing reads the file anymore
+    skinned_model_release_source(source);
+    if (asset_store->animation_bake_rate > 0.0f && !skinned_model_bake_animations(model, skeleton, asset_store->animation_bake_rate)) {
+        LOGE("Unable to bake the animations of %s", file_path);
+    }
+
+    if (new_skeleton) {
+        asset_store_publish(asset_store, ASSET_TYPE_SKELETON, skeleton_id, skeleton_slot);
+    }
+    //the model keeps its skeleton resident
+    asset_store_acquire(asset_store, skeleton_id, ASSET_TYPE_SKELETON);
+    return slot;
+}
+
+static bool asset_store_is_cooked_model(const char *file_path)
+{
+    const char *extension = string_find_last_of(file_path, ".");
+    return extension && strcmp(extension, COOKED_MODEL_EXTENSION) == 0;
+}
+
+void asset_store_add_skinned_model(asset_store_t *asset_store, 
+                                   renderer_t    *renderer, 
+                                   const char    *asset_id, 
+                                   const char    *file_path, 
+                                   const char    *skeleton_id,
+                                   struct bulk_data_renderbuffer_t *renderbuffers)
+{
+    if ((shgetp_null(asset_store->skinned_model_map, asset_id)) != NULL) return;
+    if (!skeleton_id) skeleton_id = asset_id;
+
+    cooked_model_t cooked;
+    skinned_model_source_t source;
+    bool is_cooked = asset_store_is_cooked_model(file_path);
+    //nothing is parsed or converted
+    if (is_cooked && !cooked_model_open(&cooked, file_path)) {
+        LOGE("Unable to load cooked model: %s", file_path);
+        return;
+    }
+    //images another model shares are skipped, the create decodes the others in parallel
+    if (!is_cooked && !skinned_model_read_gltf(&source, file_path, asset_id, false)) {
+        return;
+    }
+
+    //textures and buffers go in one submission, unless the batch of asynchronous loads hasn't finished
+    bool batching = asset_store->loader->uploading_count == 0 && renderer_begin_uploads(renderer);
+    uint32_t slot = is_cooked ? asset_store_create_cooked_model(asset_store, renderer, &cooked, file_path, skeleton_id) :
+                                asset_store_create_gltf_model(asset_store, renderer, &source, file_path, skeleton_id);
+    if (batching) {
+        renderer_end_uploads(renderer);
+        renderer_uploads_finished(renderer, true);
+    }
+
+    if (slot != UINT32_MAX) {
+        asset_store_publish(asset_store, ASSET_TYPE_SKINNED_MODEL, asset_id, slot);
+    }
+}
+
+//! @brief: reads every page of a file so the main thread finds it in the page cache
+static bool asset_load_prefetch(const char *file_path, uint32_t *size)
+{
+    mapped_file_t file;
+    if (!map_whole_file(file_path, &file)) return false;
+
+    volatile uint8_t sum = 0;
+    for (size_t i = 0; i < file.size; i += 4096) {
+        sum += file.data[i];
+    }
+    *size = (uint32_t)MIN(file.size, UINT32_MAX);
+    unmap_whole_file(&file);
+    return true;
+}
+
+static void asset_load_job(void *data)
+{
+    asset_load_t *load = (asset_load_t *)data;
+    const char *extension = string_find_last_of(load->file_path, ".");
+
+    load->loaded = false;
+    if (load->type == ASSET_TYPE_TEXTURE && extension &&
+        (strncmp(extension, "png", 3) == 0 || strncmp(extension, "jpg", 3) == 0)) {
+        int channels;
+        load->pixels = stbi_load(load->file_path, &load->width, &load->height, &channels, 4);
+        load->loaded = load->pixels != NULL;
+        load->upload_size = (uint32_t)load->width * (uint32_t)load->height * 4;
+    } else if (load->type == ASSET_TYPE_SKINNED_MODEL && asset_store_is_cooked_model(load->file_path)) {
+        load->loaded = cooked_model_open(&load->cooked, load->file_path);
+        if (load->loaded) {
+            volatile uint8_t sum = 0;
+            for (size_t i = 0; i < load->cooked.file.size; i += 4096) {
+                sum += load->cooked.file.data[i];
+            }
+            load->upload_size = (uint32_t)MIN(load->cooked.file.size, UINT32_MAX);
+        }
+    } else if (load->type == ASSET_TYPE_SKINNED_MODEL) {
+        //parsed, converted and decoded here, the main thread only binds the skeleton and creates the buffers
+        load->loaded = skinned_model_read_gltf(&load->source, load->file_path, load->asset_id, true);
+        if (load->loaded) {
+            const skinned_geometry_t *geometry = &load->source.geometry;
+            uint64_t size = (uint64_t)geometry->vertex_count * sizeof(skinned_vertex_t) + (uint64_t)geometry->index_count * sizeof(uint32_t);
+            for (uint32_t i = 0; i < MAX_TEXTURES_PER_MODEL; i++) {
+                size += (uint64_t)load->source.images[i].width * (uint64_t)load->source.images[i].height * 4;
             }
-            shput(store->texture_map, asset_id, slot);
+            load->upload_size = (uint32_t)MIN(size, UINT32_MAX);
         }
+    } else {
+        //ktx is decoded by the main thread, read it ahead
+        load->loaded = asset_load_prefetch(load->file_path, &load->upload_size);
     }
+
+    asset_loader_t *loader = load->loader;
+    pthread_mutex_lock(&loader->mutex);
+    uint32_t tail = (loader->completed_head + loader->completed_count) % ASSET_MAX_LOADS;
+    loader->completed[tail] = (uint32_t)(load - loader->loads);
+    loader->completed_count++;
+    pthread_mutex_unlock(&loader->mutex);
+}
+
+//! @brief: frees what the job read for a load that isn't created
+static void asset_load_release(asset_load_t *load)
+{
+    if (!load->loaded) return;
+    if (load->pixels) {
+        stbi_image_free(load->pixels);
+        load->pixels = NULL;
+    } else if (load->type == ASSET_TYPE_SKINNED_MODEL && asset_store_is_cooked_model(load->file_path)) {
+        cooked_model_close(&load->cooked);
+    } else if (load->type == ASSET_TYPE_SKINNED_MODEL) {
+        skinned_model_release_source(&load->source);
+    }
+}
+
+static inline asset_load_handle_t asset_load_handle(asset_loader_t *loader, asset_load_t *load)
+{
+    return (load->generation << 8) | (uint32_t)(load - loader->loads);
 }
 
-void asset_store_add_skinned_model(asset_store_t *asset_store, renderer_t *renderer, const char *asset_id, const char *file_path, struct bulk_data_renderbuffer_t *renderbuffers)
+static inline asset_load_t *asset_load_from_handle(asset_loader_t *loader, asset_load_handle_t handle)
 {
-    if ((shgetp_null(asset_store->skinned_model_map, asset_id)) == NULL) {
-        uint32_t slot = bulk_data_allocate_slot_skinned_model_t(asset_store->skinned_models);
-        skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, slot);
-        if (model) {
-            if (!skinned_model_create(model, file_path, asset_id, renderer, asset_store)) {
-                LOGE("Unable to load skinned model from file: %s", file_path);
-                bulk_data_delete_item_skinned_model_t(asset_store->skinned_models, slot);
-                return;
+    if (handle == ASSET_LOAD_HANDLE_INVALID) return NULL;
+    asset_load_t *load = &loader->loads[(handle & 0xff) % ASSET_MAX_LOADS];
+    return load->generation == (handle >> 8) ? load : NULL;
+}
+
+static void asset_load_finish(asset_loader_t *loader, asset_load_t *load, asset_load_state_e state)
+{
+    load->state    = state;
+    load->finished = ++loader->finished_count;
+}
+
+static asset_load_handle_t asset_store_load_async(asset_store_t *asset_store,
+                                                  asset_type_e   type,
+                                                  const char    *asset_id,
+                                                  const char    *file_path,
+                                                  const char    *skeleton_id)
+{
+    asset_loader_t *loader = asset_store->loader;
+    asset_load_t *free_load = NULL;
+    for (uint32_t i = 0; i < ASSET_MAX_LOADS; i++) {
+        asset_load_t *load = &loader->loads[i];
+        if (load->state == ASSET_LOAD_PENDING || load->state == ASSET_LOAD_UPLOADING) {
+            if (load->type == type && strcmp(load->asset_id, asset_id) == 0) {
+                return asset_load_handle(loader, load);
             }
-            shput(asset_store->skinned_model_map, asset_id, slot);
+        } else if (!free_load || load->finished < free_load->finished) {
+            free_load = load;
         }
     }
+    if (!free_load) {
+        LOGE("%u assets are loading already, can't load %s", ASSET_MAX_LOADS, file_path);
+        return ASSET_LOAD_HANDLE_INVALID;
+    }
+
+    asset_load_t *load = free_load;
+    load->loader      = loader;
+    load->type        = type;
+    load->generation  = (load->generation + 1) & 0xffffff;
+    load->asset_id    = asset_id;
+    load->file_path   = file_path;
+    load->skeleton_id = skeleton_id ? skeleton_id : asset_id;
+    load->pixels      = NULL;
+    load->upload_size = 0;
+    load->slot        = UINT32_MAX;
+
+    //already in the store, nothing to do
+    if (asset_store_get_asset_index(asset_store, asset_id, type) != UINT32_MAX) {
+        asset_load_finish(loader, load, ASSET_LOAD_COMPLETE);
+        return asset_load_handle(loader, load);
+    }
+    //another id loaded the same file, nothing to read
+    if (type == ASSET_TYPE_TEXTURE) {
+        uint32_t slot = asset_store_acquire_shared(&asset_store->shared_textures, asset_store_file_key(file_path));
+        if (slot != UINT32_MAX) {
+            asset_store_publish(asset_store, ASSET_TYPE_TEXTURE, asset_id, slot);
+            asset_load_finish(loader, load, ASSET_LOAD_COMPLETE);
+            return asset_load_handle(loader, load);
+        }
+    }
+
+    load->state = ASSET_LOAD_PENDING;
+    jobs_submit(asset_load_job, load, &loader->jobs);
+    return asset_load_handle(loader, load);
+}
+
+asset_load_handle_t asset_store_load_texture_async(asset_store_t *asset_store, const char *asset_id, const char *file_path)
+{
+    return asset_store_load_async(asset_store, ASSET_TYPE_TEXTURE, asset_id, file_path, NULL);
+}
+
+asset_load_handle_t asset_store_load_skinned_model_async(asset_store_t *asset_store,
+                                                         const char    *asset_id,
+                                                         const char    *file_path,
+                                                         const char    *skeleton_id)
+{
+    return asset_store_load_async(asset_store, ASSET_TYPE_SKINNED_MODEL, asset_id, file_path, skeleton_id);
+}
+
+//! @brief: creates the asset of a load the job is done with, its copies go into the open upload batch
+static bool asset_store_create_load(asset_store_t *asset_store, renderer_t *renderer, asset_load_t *load)
+{
+    if (!load->loaded) {
+        LOGE("Unable to read %s", load->file_path);
+        return false;
+    }
+    //an earlier load or a synchronous add got there first
+    if (asset_store_get_asset_index(asset_store, load->asset_id, load->type) != UINT32_MAX) {
+        asset_load_release(load);
+        return true;
+    }
+
+    if (load->type == ASSET_TYPE_TEXTURE) {
+        load->slot = asset_store_create_texture(asset_store, renderer, load->file_path, load->pixels, (uint32_t)load->width, (uint32_t)load->height);
+        if (load->pixels) stbi_image_free(load->pixels);
+        load->pixels = NULL;
+    } else if (asset_store_is_cooked_model(load->file_path)) {
+        load->slot = asset_store_create_cooked_model(asset_store, renderer, &load->cooked, load->file_path, load->skeleton_id);
+    } else {
+        load->slot = asset_store_create_gltf_model(asset_store, renderer, &load->source, load->file_path, load->skeleton_id);
+    }
+    return load->slot != UINT32_MAX;
 }
 
-void asset_store_remove_skinned_model(asset_store_t *asset_store, uint32_t index) {
-    skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, index);
-    //!TODO: call destructor here
-    if (model) {
-        for (uint32_t i = 0; i < model->animation_count;i++) {
-            memory_dealloc(model->animations[i].samplers);
-            memory_dealloc(model->animations[i].channels);
+void asset_store_update_loads(asset_store_t *asset_store, renderer_t *renderer)
+{
+    asset_loader_t *loader = asset_store->loader;
+
+    //the last batch has to execute before its assets can be drawn and before the next one is recorded
+    if (loader->uploading_count > 0) {
+        if (!renderer_uploads_finished(renderer, false)) return;
+
+        for (uint32_t i = 0; i < loader->uploading_count; i++) {
+            asset_load_t *load = &loader->loads[loader->uploading[i]];
+            asset_store_publish(asset_store, load->type, load->asset_id, load->slot);
+            asset_load_finish(loader, load, ASSET_LOAD_COMPLETE);
         }
+        loader->uploading_count = 0;
+    }
+
+    bool batching   = false;
+    uint32_t budget = 0;
+    while (budget < asset_store->upload_budget) {
+        pthread_mutex_lock(&loader->mutex);
+        uint32_t index = UINT32_MAX;
+        if (loader->completed_count > 0) {
+            index = loader->completed[loader->completed_head];
+            loader->completed_head = (loader->completed_head + 1) % ASSET_MAX_LOADS;
+            loader->completed_count--;
+        }
+        pthread_mutex_unlock(&loader->mutex);
+        if (index == UINT32_MAX) break;
+
+        if (!batching) {
+            batching = renderer_begin_uploads(renderer);
+        }
+        asset_load_t *load = &loader->loads[index];
+        budget += MAX(load->upload_size, 1);
+        if (!asset_store_create_load(asset_store, renderer, load)) {
+            asset_load_finish(loader, load, ASSET_LOAD_FAILED);
+        } else if (load->slot == UINT32_MAX) {
+            asset_load_finish(loader, load, ASSET_LOAD_COMPLETE);
+        } else {
+            load->state = ASSET_LOAD_UPLOADING;
+            loader->uploading[loader->uploading_count++] = index;
+        }
+    }
+
+    if (batching) {
+        renderer_end_uploads(renderer);
+    }
+}
+
+asset_load_state_e asset_store_load_state(asset_store_t *asset_store, asset_load_handle_t handle)
+{
+    asset_load_t *load = asset_load_from_handle(asset_store->loader, handle);
+    return load ? (asset_load_state_e)load->state : ASSET_LOAD_NONE;
+}
+
+void asset_store_wait_loads(asset_store_t *asset_store, renderer_t *renderer)
+{
+    asset_loader_t *loader = asset_store->loader;
+    jobs_wait(&loader->jobs);
+    //the jobs are done, the completed queue only shrinks from here
+    do {
+        renderer_uploads_finished(renderer, true);
+        asset_store_update_loads(asset_store, renderer);
+    } while (loader->completed_count > 0 || loader->uploading_count > 0);
+}
+
+void asset_store_shutdown(asset_store_t *asset_store)
+{
+    asset_loader_t *loader = asset_store->loader;
+    if (!loader) return;
+
+    //jobs write into the loads, let them finish first
+    jobs_wait(&loader->jobs);
+    for (uint32_t i = 0; i < loader->completed_count; i++) {
+        asset_load_release(&loader->loads[loader->completed[(loader->completed_head + i) % ASSET_MAX_LOADS]]);
+    }
+    pthread_mutex_destroy(&loader->mutex);
+    memory_dealloc(loader);
+    asset_store->loader = NULL;
+}
+
+bool asset_store_add_animations(asset_store_t *asset_store, const char *skeleton_id, const char *file_path)
+{
+    skeleton_t *skeleton = asset_store_get_asset_ptr_null(asset_store, skeleton_id, ASSET_TYPE_SKELETON);
+    if (!skeleton) {
+        LOGE("No skeleton %s to add the animations of %s to", skeleton_id, file_path);
+        return false;
+    }
+
+    gltf_model_t *gltf_model = model_load_from_gltf(file_path, skeleton_id);
+    if (!gltf_model){
+        LOGE("Unable to load gltf file: %s", file_path);
+        return false;
+    }
+    bool added = skeleton_add_animations(skeleton, gltf_model, &asset_store->animation_compression);
+    model_release_gltf(gltf_model);
+    if (!added) {
+        return false;
+    }
+
+    //models that baked the rig's clips bake the new ones too
+    uint32_t skeleton_index = asset_store_get_asset_index(asset_store, skeleton_id, ASSET_TYPE_SKELETON);
+    for (uint32_t i = 0; i < asset_store->skinned_models->count; i++) {
+        skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, i);
+        if (model && model->skeleton == skeleton_index && model->baked_clip_count > 0) {
+            skinned_model_bake_animations(model, skeleton, model->baked_clips[0].sample_rate);
+        }
+    }
+    return true;
+}
+
+uint32_t asset_store_acquire(asset_store_t *asset_store, const char *asset_id, asset_type_e type)
+{
+    resident_hash_entry_t *entry = hmgetp_null(asset_store->residents, asset_store_resident_key(asset_id, type));
+    if (!entry) return UINT32_MAX;
+    entry->value.ref_count++;
+    entry->value.last_used = asset_store->frame;
+    return entry->value.slot;
+}
+
+void asset_store_release(asset_store_t *asset_store, const char *asset_id, asset_type_e type)
+{
+    resident_hash_entry_t *entry = hmgetp_null(asset_store->residents, asset_store_resident_key(asset_id, type));
+    assert(entry && entry->value.ref_count > 0 && "asset released more often than acquired");
+    if (!entry || entry->value.ref_count == 0) return;
+    entry->value.ref_count--;
+    entry->value.last_used = asset_store->frame;
+}
+
+//! @brief: removes an asset nothing references from its map, its CPU memory is freed right away
+static void asset_store_evict(asset_store_t *asset_store, renderer_t *renderer, const asset_resident_t *resident)
+{
+    uint32_t slot = resident->slot;
+    switch (resident->type)
+    {
+        case ASSET_TYPE_TEXTURE:
+            (void)shdel(asset_store->texture_map, resident->asset_id);
+            asset_store_release_resource(asset_store, renderer, ASSET_TYPE_TEXTURE, slot);
+            break;
+        case ASSET_TYPE_SKINNED_MODEL: {
+            (void)shdel(asset_store->skinned_model_map, resident->asset_id);
+            skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, slot);
+            if (!model) break;
+            asset_store_release_model_resources(asset_store, renderer, model);
+
+            //clips belong to the skeleton, which outlives the models bound to it, the baked ones to the model
+            for (ptrdiff_t i = 0; i < hmlen(asset_store->residents); i++) {
+                asset_resident_t *skeleton = &asset_store->residents[i].value;
+                if (skeleton->type == ASSET_TYPE_SKELETON && skeleton->slot == model->skeleton) {
+                    asset_store_release(asset_store, skeleton->asset_id, ASSET_TYPE_SKELETON);
+                    break;
+                }
+            }
+            skinned_model_destroy(model);
+            bulk_data_delete_item_skinned_model_t(asset_store->skinned_models, slot);
+            break;
+        }
+        case ASSET_TYPE_SKELETON: {
+            (void)shdel(asset_store->skeleton_map, resident->asset_id);
+            skeleton_t *skeleton = bulk_data_getp_null_skeleton_t(asset_store->skeletons, slot);
+            if (skeleton) {
+                skeleton_destroy(skeleton);
+            }
+            bulk_data_delete_item_skeleton_t(asset_store->skeletons, slot);
+            break;
+        }
+        default:
+            assert(false && "This should not happen");
+    }
+}
+
+static uint64_t asset_store_cpu_size(asset_store_t *asset_store, const asset_resident_t *resident)
+{
+    uint64_t size = 0;
+    if (resident->type == ASSET_TYPE_SKELETON) {
+        skeleton_t *skeleton = bulk_data_getp_null_skeleton_t(asset_store->skeletons, resident->slot);
+        if (!skeleton) return 0;
+        size = sizeof(skeleton_t);
+        for (uint32_t i = 0; i < skeleton->animation_count; i++) {
+            size += skeleton->animations[i].data_size;
+        }
+    } else if (resident->type == ASSET_TYPE_SKINNED_MODEL) {
+        skinned_model_t *model = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, resident->slot);
+        if (!model) return 0;
+        for (uint32_t i = 0; i < model->baked_clip_count; i++) {
+            const animation_baked_clip_t *clip = &model->baked_clips[i];
+            size += (uint64_t)clip->frame_count * (clip->joint_count + 1) * sizeof(affine3x4_t);
+        }
+    }
+    return size;
+}
+
+static void asset_store_measure(asset_store_t *asset_store)
+{
+    asset_memory_t *used = &asset_store->memory_used;
+    used->cpu = 0;
+    used->gpu = 0;
+    for (ptrdiff_t i = 0; i < hmlen(asset_store->residents); i++) {
+        used->cpu += asset_store_cpu_size(asset_store, &asset_store->residents[i].value);
+    }
+    //shared once however many assets use them
+    for (ptrdiff_t i = 0; i < hmlen(asset_store->shared_textures); i++) {
+        used->gpu += asset_store->shared_textures[i].value.size;
+    }
+    for (ptrdiff_t i = 0; i < hmlen(asset_store->shared_renderbuffers); i++) {
+        used->gpu += asset_store->shared_renderbuffers[i].value.size;
+    }
+}
+
+static inline bool asset_store_over_budget(const asset_store_t *asset_store)
+{
+    const asset_memory_t *budget = &asset_store->memory_budget;
+    const asset_memory_t *used   = &asset_store->memory_used;
+    return (budget->cpu > 0 && used->cpu > budget->cpu) || (budget->gpu > 0 && used->gpu > budget->gpu);
+}
+
+void asset_store_update_residency(asset_store_t *asset_store, renderer_t *renderer)
+{
+    asset_store->frame = renderer->frame_count;
+
+    //the frames that could read them have finished
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < arrlenu(asset_store->retired); i++) {
+        asset_retired_t retired = asset_store->retired[i];
+        if (renderer->frame_count < retired.frame) {
+            asset_store->retired[kept++] = retired;
+            continue;
+        }
+        if (retired.render_data) {
+            renderer_destroy_render_data(renderer, (render_data_type_e)retired.render_data_type, retired.render_data);
+        }
+        if (retired.slot == UINT32_MAX) continue;
+        if (retired.type == ASSET_TYPE_TEXTURE) {
+            texture_t *texture = bulk_data_getp_null_texture_t(asset_store->textures, retired.slot);
+            if (texture) renderer_destroy_texture(renderer, texture);
+            bulk_data_delete_item_texture_t(asset_store->textures, retired.slot);
+        } else {
+            renderbuffer_t *renderbuffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, retired.slot);
+            if (renderbuffer) renderer_destroy_renderbuffer(renderer, renderbuffer);
+            bulk_data_delete_item_renderbuffer_t(renderer->renderbuffers, retired.slot);
+        }
+    }
+    arrsetlen(asset_store->retired, kept);
+
+    asset_memory_t previous = asset_store->memory_used;
+    asset_store_measure(asset_store);
+    while (asset_store_over_budget(asset_store)) {
+        //a skeleton goes once the models bound to it have
+        resident_hash_entry_t *lru = NULL;
+        for (ptrdiff_t i = 0; i < hmlen(asset_store->residents); i++) {
+            resident_hash_entry_t *entry = &asset_store->residents[i];
+            if (entry->value.ref_count > 0) continue;
+            if (!lru || entry->value.last_used < lru->value.last_used) lru = entry;
+        }
+        if (!lru) {
+            //once per change rather than every frame
+            if (previous.cpu == asset_store->memory_used.cpu && previous.gpu == asset_store->memory_used.gpu) break;
+            LOGE("Assets in use take %llu bytes of cpu and %llu bytes of gpu memory, over the budget",
+                 (unsigned long long)asset_store->memory_used.cpu, (unsigned long long)asset_store->memory_used.gpu);
+            break;
+        }
+
+        asset_resident_t resident = lru->value;
+        (void)hmdel(asset_store->residents, lru->key);
+        asset_store_evict(asset_store, renderer, &resident);
+        asset_store_measure(asset_store);
     }
-    bulk_data_delete_item_skinned_model_t(asset_store->skinned_models,index);
 }
 
 uint32_t asset_store_get_asset_index(asset_store_t *asset_store, const char *asset_id, asset_type_e type)
@@ -83,6 +905,9 @@ uint32_t asset_store_get_asset_index(asset_store_t *asset_store, const char *ass
         case ASSET_TYPE_SKINNED_MODEL:
             map = asset_store->skinned_model_map;
             break;
+        case ASSET_TYPE_SKELETON:
+            map = asset_store->skeleton_map;
+            break;
         default:
             LOGE("Unknown asset type");
             return result;
@@ -107,6 +932,9 @@ void *asset_store_get_asset_ptr_null(asset_store_t *asset_store, const char *ass
             case ASSET_TYPE_SKINNED_MODEL:
                 result = bulk_data_getp_null_skinned_model_t(asset_store->skinned_models, index);
                 break;
+            case ASSET_TYPE_SKELETON:
+                result = bulk_data_getp_null_skeleton_t(asset_store->skeletons, index);
+                break;
             default:
                 assert(false && "This should not happen");
         }
@@ -0,0 +1,365 @@
+#include <cooked_model.h>
+#include <json_loader.h>
+#include <skeleton.h>
+#include <memory.h>
+#include <logger.h>
+#include <string_utils.h>
+
+#include <stb/stb_image.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+//! @brief: pads the file to COOKED_MODEL_ALIGNMENT and appends size bytes, offset is where they start
+static bool cooked_model_write_section(FILE *file, const void *data, size_t size, uint64_t *offset)
+{
+    long position = ftell(file);
+    long aligned  = (position + COOKED_MODEL_ALIGNMENT - 1) & ~(long)(COOKED_MODEL_ALIGNMENT - 1);
+    for (; position < aligned; position++) {
+        if (fputc(0, file) == EOF) return false;
+    }
+    *offset = (uint64_t)aligned;
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+static bool cooked_model_write_images(FILE *file, gltf_model_t *gltf_model, cooked_image_t *images)
+{
+    for (uint32_t i = 0; i < gltf_model->image_count; i++) {
+        cooked_image_t *image = &images[i];
+        const char *path      = gltf_model->image_paths[i];
+        const char *extension = path ? string_find_last_of(path, ".") : NULL;
+        if (!extension) {
+            LOGE("Image %u of %s has no file to cook", i, gltf_model->path);
+            return false;
+        }
+
+        memset(image, 0, sizeof(*image));
+        if (strncmp(extension, "png", 3) == 0 || strncmp(extension, "jpg", 3) == 0) {
+            int w, h, channels;
+            stbi_uc *pixels = stbi_load(path, &w, &h, &channels, 4);
+            if (!pixels) {
+                LOGE("Unable to decode %s", path);
+                return false;
+            }
+            image->format = COOKED_IMAGE_RGBA8;
+            image->width  = (uint32_t)w;
+            image->height = (uint32_t)h;
+            image->size   = (uint32_t)w * (uint32_t)h * 4;
+            bool written  = cooked_model_write_section(file, pixels, image->size, &image->offset);
+            stbi_image_free(pixels);
+            if (!written) return false;
+        } else {
+            image->format = COOKED_IMAGE_FILE;
+            image->size   = (uint32_t)strlen(path) + 1;
+            if (!cooked_model_write_section(file, path, image->size, &image->offset)) return false;
+        }
+    }
+    return true;
+}
+
+static bool cooked_model_write_animations(FILE *file, const skeleton_t *skeleton, cooked_animation_t *animations)
+{
+    for (uint32_t i = 0; i < skeleton->animation_count; i++) {
+        const animation_t *animation = &skeleton->animations[i];
+        const uint8_t *base = (const uint8_t *)animation->data;
+
+        uint8_t *data = memory_alloc(animation->data_size, MEM_TAG_TEMP);
+        memcpy(data, base, animation->data_size);
+
+        //pointers into the block become offsets from its start
+        animation_sampler_t *samplers = (animation_sampler_t *)data;
+        for (uint32_t j = 0; j < animation->sampler_count; j++) {
+            samplers[j].inputs  = (const float *)(uintptr_t)((const uint8_t *)animation->samplers[j].inputs - base);
+            samplers[j].outputs = (const void *)(uintptr_t)((const uint8_t *)animation->samplers[j].outputs - base);
+        }
+
+        cooked_animation_t *cooked  = &animations[i];
+        memset(cooked, 0, sizeof(*cooked));
+        cooked->size          = animation->data_size;
+        cooked->sampler_count = animation->sampler_count;
+        cooked->channel_count = animation->channel_count;
+        cooked->start_time    = animation->start_time;
+        cooked->end_time      = animation->end_time;
+        if (!cooked_model_write_section(file, data, animation->data_size, &cooked->offset)) return false;
+    }
+    return true;
+}
+
+bool cooked_model_write(gltf_model_t *gltf_model, const animation_compression_config_t *compression, const char *path)
+{
+    cooked_model_header_t header = {0};
+    header.magic   = COOKED_MODEL_MAGIC;
+    header.version = COOKED_MODEL_VERSION;
+
+    //the same conversions asset_store_add_skinned_model runs on every load
+    uint32_t *remap = memory_alloc(MAX(gltf_model->node_count, 1) * sizeof(uint32_t), MEM_TAG_TEMP);
+    skeleton_t *skeleton = memory_alloc(sizeof(skeleton_t), MEM_TAG_TEMP);
+    if (!skeleton_create(skeleton, gltf_model, compression, remap)) {
+        LOGE("Unable to create the skeleton of %s", gltf_model->path);
+        return false;
+    }
+
+    header.mesh_node = UINT32_MAX;
+    for (uint32_t i = 0; i < gltf_model->node_count; i++) {
+        if (gltf_model->nodes[i].mesh != UINT32_MAX) {
+            header.mesh_node = remap[i];
+            break;
+        }
+    }
+
+    uint32_t joint_table[MAX_BONES_PER_SKIN] = {0};
+    uint32_t images[MAX_TEXTURES_PER_MODEL];
+    material_t materials[MAX_MATERIALS_PER_MODEL];
+    skinned_geometry_t geometry = {0};
+    //written with their padding, the same model cooks to the same bytes
+    memset(materials, 0, sizeof(materials));
+    bool ok = header.mesh_node != UINT32_MAX && gltf_model->image_count <= MAX_TEXTURES_PER_MODEL &&
+              skeleton_build_joint_table(skeleton, gltf_model, remap, joint_table);
+    if (ok) {
+        //texture indices of the cooked materials are image indices
+        for (uint32_t i = 0; i < gltf_model->image_count; i++) {
+            images[i] = i;
+        }
+        header.material_count = model_load_materials(gltf_model, images, materials);
+        model_load_skinned_geometry(gltf_model, joint_table, &header.mesh, &geometry);
+    } else {
+        LOGE("%s has no mesh node, too many images or joints outside its skeleton", gltf_model->path);
+    }
+
+    FILE *file = ok ? fopen(path, "wb") : NULL;
+    if (ok && !file) {
+        LOGE("Unable to open %s for writing", path);
+        ok = false;
+    }
+
+    cooked_image_t     *cooked_images     = memory_alloc(MAX(gltf_model->image_count, 1) * sizeof(cooked_image_t), MEM_TAG_TEMP);
+    cooked_animation_t *cooked_animations = memory_alloc(MAX(skeleton->animation_count, 1) * sizeof(cooked_animation_t), MEM_TAG_TEMP);
+
+    header.node_count      = skeleton->node_count;
+    header.image_count     = gltf_model->image_count;
+    header.animation_count = skeleton->animation_count;
+    header.vertex_count    = geometry.vertex_count;
+    header.index_count     = geometry.index_count;
+
+    //header goes first and is written again once the offsets are known
+    ok = ok && fwrite(&header, sizeof(header), 1, file) == 1 &&
+         cooked_model_write_section(file, skeleton->nodes, header.node_count * sizeof(model_node_t), &header.nodes) &&
+         cooked_model_write_section(file, skeleton->node_names, header.node_count * sizeof(uint64_t), &header.node_names) &&
+         cooked_model_write_section(file, skeleton->leaf_nodes, header.node_count * sizeof(bool), &header.leaf_nodes) &&
+         cooked_model_write_section(file, &skeleton->skin, sizeof(skin_t), &header.skin) &&
+         cooked_model_write_section(file, materials, header.material_count * sizeof(material_t), &header.materials) &&
+         cooked_model_write_images(file, gltf_model, cooked_images) &&
+         cooked_model_write_section(file, cooked_images, header.image_count * sizeof(cooked_image_t), &header.images) &&
+         cooked_model_write_animations(file, skeleton, cooked_animations) &&
+         cooked_model_write_section(file, cooked_animations, header.animation_count * sizeof(cooked_animation_t), &header.animations) &&
+         cooked_model_write_section(file, geometry.vertices, header.vertex_count * sizeof(skinned_vertex_t), &header.vertices) &&
+         cooked_model_write_section(file, geometry.indices, header.index_count * sizeof(uint32_t), &header.indices);
+
+    if (ok) {
+        header.size = (uint64_t)ftell(file);
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    if (file && fclose(file) != 0) ok = false;
+    if (file && !ok) {
+        LOGE("Unable to write %s", path);
+        remove(path);
+    }
+
+    skeleton_destroy(skeleton);
+    return ok;
+}
+
+//! @brief: points section at count elements of stride bytes at offset, false when they are not inside the file
+static bool cooked_model_section(const cooked_model_t *cooked, uint64_t offset, uint64_t count, uint64_t stride, const void **section)
+{
+    uint64_t size = count * stride;
+    if (offset % COOKED_MODEL_ALIGNMENT != 0 || offset > cooked->file.size || size > cooked->file.size - offset) {
+        return false;
+    }
+    *section = cooked->file.data + offset;
+    return true;
+}
+
+//! @brief: true when the nodes are parent before child and the skin only names nodes of the file
+static bool cooked_model_check_nodes(const cooked_model_t *cooked)
+{
+    uint32_t node_count = cooked->header->node_count;
+    for (uint32_t i = 0; i < node_count; i++) {
+        uint32_t parent = cooked->nodes[i].parent;
+        if (parent != UINT32_MAX && parent >= i) return false;
+    }
+    const skin_t *skin = cooked->skin;
+    for (uint32_t i = 0; i < skin->joint_count; i++) {
+        if (skin->joints[i] >= node_count) return false;
+    }
+    return skin->skeleton_root < node_count;
+}
+
+//! @brief: true when every index the mesh and its materials store points at something the file has
+static bool cooked_model_check_mesh(const cooked_model_t *cooked)
+{
+    const cooked_model_header_t *header = cooked->header;
+    for (uint32_t i = 0; i < MAX_PRIMITIVES_PER_MESH; i++) {
+        const mesh_primitive_t *primitive = &header->mesh.primitives[i];
+        if ((uint64_t)primitive->first_index + primitive->index_count > header->index_count) return false;
+        if (primitive->index_count > 0 && primitive->material != UINT32_MAX && primitive->material >= header->material_count) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->material_count; i++) {
+        const material_t *material = &cooked->materials[i];
+        uint32_t textures[] = {material->base_color_texture, material->metallic_roughness_texture, material->normal_texture,
+                               material->occlusion_texture, material->emissive_texture, material->specular_texture,
+                               material->specular_color_texture};
+        for (uint32_t j = 0; j < sizeof(textures) / sizeof(textures[0]); j++) {
+            if (textures[j] != UINT32_MAX && textures[j] >= header->image_count) return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->index_count; i++) {
+        if (cooked->indices[i] >= header->vertex_count) return false;
+    }
+    //joint indices are floats, a NaN fails the comparison as well
+    float joint_count = (float)MAX(cooked->skin->joint_count, 1);
+    for (uint32_t i = 0; i < header->vertex_count; i++) {
+        const float *joints = &cooked->vertices[i].joint_indices.x;
+        for (uint32_t j = 0; j < 4; j++) {
+            if (!(joints[j] >= 0.0f && joints[j] < joint_count)) return false;
+        }
+    }
+    return true;
+}
+
+bool cooked_model_open(cooked_model_t *cooked, const char *path)
+{
+    memset(cooked, 0, sizeof(*cooked));
+    if (!map_whole_file(path, &cooked->file)) {
+        return false;
+    }
+
+    const cooked_model_header_t *header = (const cooked_model_header_t *)cooked->file.data;
+    if (cooked->file.size < sizeof(*header) || header->magic != COOKED_MODEL_MAGIC) {
+        LOGE("%s is not a cooked model", path);
+        cooked_model_close(cooked);
+        return false;
+    }
+    if (header->version != COOKED_MODEL_VERSION) {
+        LOGE("%s was cooked as version %u, version %u is loaded, cook it again", path, header->version, COOKED_MODEL_VERSION);
+        cooked_model_close(cooked);
+        return false;
+    }
+    cooked->header = header;
+
+    bool ok = header->size == cooked->file.size &&
+              header->node_count <= MAX_NODES_PER_MODEL && header->mesh_node < header->node_count &&
+              header->material_count <= MAX_MATERIALS_PER_MODEL && header->image_count <= MAX_TEXTURES_PER_MODEL &&
+              header->animation_count <= MAX_ANIMATIONS_PER_MODEL &&
+              cooked_model_section(cooked, header->nodes, header->node_count, sizeof(model_node_t), (const void **)&cooked->nodes) &&
+              cooked_model_section(cooked, header->node_names, header->node_count, sizeof(uint64_t), (const void **)&cooked->node_names) &&
+              cooked_model_section(cooked, header->leaf_nodes, header->node_count, sizeof(bool), (const void **)&cooked->leaf_nodes) &&
+              cooked_model_section(cooked, header->skin, 1, sizeof(skin_t), (const void **)&cooked->skin) &&
+              cooked_model_section(cooked, header->materials, header->material_count, sizeof(material_t), (const void **)&cooked->materials) &&
+              cooked_model_section(cooked, header->images, header->image_count, sizeof(cooked_image_t), (const void **)&cooked->images) &&
+              cooked_model_section(cooked, header->animations, header->animation_count, sizeof(cooked_animation_t), (const void **)&cooked->animations) &&
+              cooked_model_section(cooked, header->vertices, header->vertex_count, sizeof(skinned_vertex_t), (const void **)&cooked->vertices) &&
+              cooked_model_section(cooked, header->indices, header->index_count, sizeof(uint32_t), (const void **)&cooked->indices) &&
+              cooked->skin->joint_count <= MAX_BONES_PER_SKIN &&
+              cooked_model_check_nodes(cooked) && cooked_model_check_mesh(cooked);
+
+    for (uint32_t i = 0; ok && i < header->image_count; i++) {
+        const cooked_image_t *image = &cooked->images[i];
+        const void *data;
+        ok = cooked_model_section(cooked, image->offset, image->size, 1, &data) &&
+             (image->format == COOKED_IMAGE_RGBA8 ? (uint64_t)image->width * image->height * 4 == image->size :
+              image->format == COOKED_IMAGE_FILE && image->size > 0 && ((const char *)data)[image->size - 1] == '\0');
+    }
+    for (uint32_t i = 0; ok && i < header->animation_count; i++) {
+        const cooked_animation_t *animation = &cooked->animations[i];
+        const void *data;
+        ok = cooked_model_section(cooked, animation->offset, animation->size, 1, &data) &&
+             animation->channel_count <= MAX_ANIMATION_CHANNEL_COUNT &&
+             animation->size >= animation->sampler_count * sizeof(animation_sampler_t) + animation->channel_count * sizeof(animation_channel_t);
+    }
+
+    if (!ok) {
+        LOGE("%s is truncated or corrupt", path);
+        cooked_model_close(cooked);
+        return false;
+    }
+    return true;
+}
+
+void cooked_model_close(cooked_model_t *cooked)
+{
+    unmap_whole_file(&cooked->file);
+    memset(cooked, 0, sizeof(*cooked));
+}
+
+//! @brief: true when the input and output keys of a sampler, stored as offsets, lie inside a clip of size bytes
+static bool cooked_model_check_sampler(const animation_sampler_t *sampler, uint64_t size)
+{
+    uint64_t key_size, alignment;
+    switch (sampler->format)
+    {
+        case ANIMATION_KEY_FORMAT_FLOAT:   key_size = sampler->components * sizeof(float);    alignment = sizeof(float);    break;
+        case ANIMATION_KEY_FORMAT_QUAT48:  key_size = 3 * sizeof(uint16_t);                   alignment = sizeof(uint16_t); break;
+        case ANIMATION_KEY_FORMAT_RANGE16: key_size = sampler->components * sizeof(uint16_t); alignment = sizeof(uint16_t); break;
+        default: return false;
+    }
+    uint64_t inputs  = (uintptr_t)sampler->inputs;
+    uint64_t outputs = (uintptr_t)sampler->outputs;
+    uint64_t keys    = (uint64_t)sampler->input_count * (sampler->interpolation == CUBIC_SPLINE_INTERPOLATION ? 3 : 1);
+    return sampler->components >= 1 && sampler->components <= 4 && sampler->interpolation <= CUBIC_SPLINE_INTERPOLATION &&
+           sampler->output_count >= keys &&
+           inputs % sizeof(float) == 0 && inputs <= size && (uint64_t)sampler->input_count * sizeof(float) <= size - inputs &&
+           outputs % alignment == 0 && outputs <= size && (uint64_t)sampler->output_count * key_size <= size - outputs;
+}
+
+bool cooked_model_load_animation(const cooked_model_t *cooked, uint32_t index, animation_t *animation)
+{
+    assert(index < cooked->header->animation_count);
+    const cooked_animation_t *source = &cooked->animations[index];
+
+    uint8_t *data = memory_alloc(source->size, MEM_TAG_HEAP);
+    if (!data) {
+        LOGE("Unable to allocate %llu bytes for animation", (unsigned long long)source->size);
+        return false;
+    }
+    memcpy(data, cooked->file.data + source->offset, source->size);
+
+    memset(animation, 0, sizeof(*animation));
+    animation->data          = data;
+    animation->data_size     = source->size;
+    animation->samplers      = (animation_sampler_t *)data;
+    animation->sampler_count = source->sampler_count;
+    animation->channels      = (animation_channel_t *)(data + source->sampler_count * sizeof(animation_sampler_t));
+    animation->channel_count = source->channel_count;
+    animation->start_time    = source->start_time;
+    animation->end_time      = source->end_time;
+
+    for (uint32_t i = 0; i < animation->sampler_count; i++) {
+        animation_sampler_t *sampler = &animation->samplers[i];
+        if (!cooked_model_check_sampler(sampler, source->size)) {
+            LOGE("Sampler %u of cooked animation %u points outside of it", i, index);
+            animation_destroy(animation);
+            return false;
+        }
+        sampler->inputs  = (const float *)(data + (uintptr_t)sampler->inputs);
+        sampler->outputs = data + (uintptr_t)sampler->outputs;
+    }
+    for (uint32_t i = 0; i < animation->channel_count; i++) {
+        const animation_channel_t *channel = &animation->channels[i];
+        if (channel->sampler >= animation->sampler_count || channel->node >= cooked->header->node_count || channel->path > WEIGHTS) {
+            LOGE("Channel %u of cooked animation %u names a sampler or node it doesn't have", i, index);
+            animation_destroy(animation);
+            return false;
+        }
+    }
+    return true;
+}
+
+const void *cooked_model_image_data(const cooked_model_t *cooked, uint32_t index)
+{
+    assert(index < cooked->header->image_count);
+    return cooked->file.data + cooked->images[index].offset;
+}
@@ -9,6 +9,10 @@
 #include "cJSON.c"
 
 #include <assert.h>
+#include <pthread.h>
+#if defined (__linux__)
+#include <sys/mman.h>
+#endif
 
 entity_state_t get_animation_state_from_string(const char *state_string)
 {
@@ -35,7 +39,7 @@ static uint32_t interpolation_from_string(const char *interpolation)
     if (strcmp(interpolation, "STEP") == 0) return STEP_INTERPOLATION;
     else if (strcmp(interpolation, "LINEAR") == 0) return LINEAR_INTERPOLATION;
     else if (strcmp(interpolation, "SPHERICAL_LINEAR") == 0) return SPHERICAL_LINEAR_INTERPOLATION;
-    else if (strcmp(interpolation, "CUBIC_SPLINE") == 0) return CUBIC_SPLINE_INTERPOLATION;
+    else if (strcmp(interpolation, "CUBICSPLINE") == 0) return CUBIC_SPLINE_INTERPOLATION;
     return NIL;
 }
 
@@ -135,505 +139,1167 @@ typedef struct
 }model_t;
 #endif
 
-static inline float json_get_float_default(cJSON *node, const char *str, float def)
+//! @brief: a .glb is a 12 byte header and chunks of an 8 byte header each, JSON first and an optional BIN after
+#define GLB_MAGIC       0x46546C67 //"glTF"
+#define GLB_CHUNK_JSON  0x4E4F534A //"JSON"
+#define GLB_CHUNK_BIN   0x004E4942 //"BIN\0"
+
+typedef struct
 {
-    float result = def;
+    uint32_t magic;
+    uint32_t version;
+    uint32_t length;
+} glb_header_t;
 
-    cJSON *child = cJSON_GetObjectItem(node, str);
-    if (child) {
-        double num = cJSON_GetNumberValue(child);
-        if (num == NAN) {
-            result = def;
-        } else {
-            result = (float)num;
-        }
+typedef struct
+{
+    uint32_t length;
+    uint32_t type;
+} glb_chunk_t;
+
+//! @brief: a load's DOM, model and converted geometry go in its own arena, any thread can load while another does.
+//          Only address space is reserved, pages are committed as loads touch them. Released arenas are kept for the
+//          next loads with their pages, a fresh one faults in every page again
+#define JSON_ARENA_SIZE        MEGABYTES(256)
+#define JSON_ARENA_ALIGNMENT   16
+#define JSON_ARENA_CACHE_COUNT 4
+
+static json_arena_t    json_arena_cache[JSON_ARENA_CACHE_COUNT];
+static uint32_t        json_arena_cache_count;
+static pthread_mutex_t json_arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void json_arena_init(json_arena_t *arena)
+{
+    memset(arena, 0, sizeof(*arena));
+    pthread_mutex_lock(&json_arena_mutex);
+    if (json_arena_cache_count > 0) {
+        *arena = json_arena_cache[--json_arena_cache_count];
     }
+    pthread_mutex_unlock(&json_arena_mutex);
+    if (arena->base) return;
+#if defined (__linux__)
+    void *base = mmap(NULL, JSON_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        //everything overflows then
+        LOGE("Unable to reserve %u bytes for a glTF load", (uint32_t)JSON_ARENA_SIZE);
+        return;
+    }
+    arena->base     = base;
+    arena->capacity = JSON_ARENA_SIZE;
+#endif
+}
+
+//! @brief: not cleared, what cJSON allocates it fills in itself
+static void *json_arena_push(json_arena_t *arena, size_t size)
+{
+    size = (size + JSON_ARENA_ALIGNMENT - 1) & ~(size_t)(JSON_ARENA_ALIGNMENT - 1);
+    if (arena->used + size > arena->capacity) {
+        //the link takes a whole alignment unit so the block stays aligned
+        void **block = malloc(size + JSON_ARENA_ALIGNMENT);
+        if (!block) return NULL;
+        block[0] = arena->overflow;
+        arena->overflow = block;
+        return (uint8_t *)block + JSON_ARENA_ALIGNMENT;
+    }
+    void *result = arena->base + arena->used;
+    arena->used += size;
     return result;
 }
 
-static inline uint32_t json_get_uint32_default(cJSON *node, const char *str, uint32_t def)
+//! @brief: cleared like memory_alloc
+static void *json_arena_alloc(json_arena_t *arena, size_t size)
 {
-    uint32_t result = def;
+    void *result = json_arena_push(arena, size);
+    if (result) memset(result, 0, size);
+    return result;
+}
 
-    cJSON *child = cJSON_GetObjectItem(node, str);
-    if (child) {
-        double num = cJSON_GetNumberValue(child);
-        if (num == NAN) {
-            result = def;
-        } else {
-            result = (uint32_t)num;
-        }
+static void json_arena_release(json_arena_t *arena)
+{
+    void *block = arena->overflow;
+    while (block) {
+        void *next = *(void **)block;
+        free(block);
+        block = next;
     }
+    arena->overflow = NULL;
+    arena->used     = 0;
+
+    if (arena->base) {
+        pthread_mutex_lock(&json_arena_mutex);
+        bool cached = json_arena_cache_count < JSON_ARENA_CACHE_COUNT;
+        if (cached) json_arena_cache[json_arena_cache_count++] = *arena;
+        pthread_mutex_unlock(&json_arena_mutex);
+#if defined (__linux__)
+        if (!cached) munmap(arena->base, arena->capacity);
+#endif
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+static const char *json_arena_string(json_arena_t *arena, const char *string)
+{
+    size_t length = strlen(string);
+    char *result = json_arena_alloc(arena, length + 1);
+    if (result) memcpy(result, string, length + 1);
     return result;
 }
 
-gltf_model_t *model_load_from_gltf(const char * path, const char *asset_id)
+//! @brief: uri resolved against the directory of the file at path
+static const char *json_arena_path(json_arena_t *arena, const char *path, const char *uri)
 {
-    long buf_size;
-    uint8_t *buf = read_whole_file(path, &buf_size, MEM_TAG_TEMP);
-    if (!buf) {
-        LOGE("Can't read gltf file %s", path);
-        return NULL;
+    //past the last slash, the directory keeps it
+    const char *file = string_find_last_of(path, "/\\");
+    size_t directory = file ? (size_t)(file - path) : 0;
+    size_t length    = strlen(uri);
+
+    char *result = json_arena_alloc(arena, directory + length + 1);
+    if (!result) return NULL;
+    memcpy(result, path, directory);
+    memcpy(result + directory, uri, length + 1);
+    return result;
+}
+
+//! @brief: cJSON only has global hooks, they stay installed and allocate from the arena of the parse running on the
+//          calling thread. cJSON used anywhere else gets malloc and free
+static _Thread_local json_arena_t *json_hook_arena;
+static pthread_once_t json_hooks_once = PTHREAD_ONCE_INIT;
+
+static void *json_hook_alloc(size_t size)
+{
+    return json_hook_arena ? json_arena_push(json_hook_arena, size) : malloc(size);
+}
+
+static void json_hook_free(void *ptr)
+{
+    //arena memory goes with the arena
+    if (!json_hook_arena) free(ptr);
+}
+
+static void json_install_hooks(void)
+{
+    cJSON_Hooks hooks = {json_hook_alloc, json_hook_free};
+    cJSON_InitHooks(&hooks);
+}
+
+//! @brief: the DOM lives as long as arena, nothing has to be freed node by node
+static cJSON *json_parse(json_arena_t *arena, const char *data, size_t size)
+{
+    pthread_once(&json_hooks_once, json_install_hooks);
+    json_hook_arena = arena;
+    cJSON *root = cJSON_ParseWithLength(data, size);
+    json_hook_arena = NULL;
+    return root;
+}
+
+//! @brief: members[k] is the member of object named keys[k], NULL when it has none. One pass over the members,
+//          keys are matched case sensitively as glTF spells them
+static void json_get_members(const cJSON *object, const char *const *keys, uint32_t key_count, cJSON **members)
+{
+    memset(members, 0, key_count * sizeof(cJSON *));
+
+    cJSON *member;
+    cJSON_ArrayForEach(member, object) {
+        for (uint32_t k = 0; k < key_count; k++) {
+            if (member->string && strcmp(member->string, keys[k]) == 0) {
+                members[k] = member;
+                break;
+            }
+        }
     }
+}
+#define JSON_GET_MEMBERS(object, keys, members) json_get_members((object), (keys), sizeof(keys) / sizeof((keys)[0]), (members))
 
-    cJSON* root = cJSON_Parse((const char*)buf);
-    if (!root) {
-        LOGE("Unable to parse json file %s", path);
-        return NULL;
+static inline float json_float(const cJSON *item, float def)
+{
+    return cJSON_IsNumber(item) ? (float)item->valuedouble : def;
+}
+
+static inline uint32_t json_uint32(const cJSON *item, uint32_t def)
+{
+    return cJSON_IsNumber(item) ? (uint32_t)item->valuedouble : def;
+}
+
+static inline const char *json_string(const cJSON *item)
+{
+    return cJSON_IsString(item) ? item->valuestring : NULL;
+}
+
+//! @brief: the first count numbers of an array, out keeps its values past the end of the array
+static void json_floats(const cJSON *array, float *out, uint32_t count)
+{
+    const cJSON *item = array ? array->child : NULL;
+    for (uint32_t i = 0; i < count && item; i++, item = item->next) {
+        out[i] = json_float(item, out[i]);
     }
+}
+
+static inline uint32_t json_array_size(const cJSON *array)
+{
+    return cJSON_IsArray(array) ? (uint32_t)cJSON_GetArraySize(array) : 0;
+}
 
-    gltf_model_t *gltf_model = memory_alloc(sizeof(gltf_model_t), MEM_TAG_TEMP);
+//! NOTE: member tables, the enums index the key arrays
+enum { GLTF_SCENES, GLTF_NODES, GLTF_BUFFERS, GLTF_ACCESSORS, GLTF_BUFFER_VIEWS, GLTF_MESHES, GLTF_ANIMATIONS,
+       GLTF_SKINS, GLTF_MATERIALS, GLTF_TEXTURES, GLTF_IMAGES, GLTF_SAMPLERS };
+static const char *const gltf_keys[] = {
+    [GLTF_SCENES] = "scenes", [GLTF_NODES] = "nodes", [GLTF_BUFFERS] = "buffers", [GLTF_ACCESSORS] = "accessors",
+    [GLTF_BUFFER_VIEWS] = "bufferViews", [GLTF_MESHES] = "meshes", [GLTF_ANIMATIONS] = "animations",
+    [GLTF_SKINS] = "skins", [GLTF_MATERIALS] = "materials", [GLTF_TEXTURES] = "textures", [GLTF_IMAGES] = "images",
+    [GLTF_SAMPLERS] = "samplers"};
+
+enum { NODE_CHILDREN, NODE_NAME, NODE_MATRIX, NODE_TRANSLATION, NODE_ROTATION, NODE_SCALE, NODE_SKIN, NODE_MESH };
+static const char *const node_keys[] = {
+    [NODE_CHILDREN] = "children", [NODE_NAME] = "name", [NODE_MATRIX] = "matrix", [NODE_TRANSLATION] = "translation",
+    [NODE_ROTATION] = "rotation", [NODE_SCALE] = "scale", [NODE_SKIN] = "skin", [NODE_MESH] = "mesh"};
+
+enum { BUFFER_URI, BUFFER_BYTE_LENGTH };
+static const char *const buffer_keys[] = {[BUFFER_URI] = "uri", [BUFFER_BYTE_LENGTH] = "byteLength"};
+
+enum { ACCESSOR_BUFFER_VIEW, ACCESSOR_BYTE_OFFSET, ACCESSOR_COMPONENT_TYPE, ACCESSOR_TYPE, ACCESSOR_COUNT };
+static const char *const accessor_keys[] = {
+    [ACCESSOR_BUFFER_VIEW] = "bufferView", [ACCESSOR_BYTE_OFFSET] = "byteOffset",
+    [ACCESSOR_COMPONENT_TYPE] = "componentType", [ACCESSOR_TYPE] = "type", [ACCESSOR_COUNT] = "count"};
+
+enum { BUFFER_VIEW_BUFFER, BUFFER_VIEW_BYTE_OFFSET, BUFFER_VIEW_BYTE_LENGTH, BUFFER_VIEW_BYTE_STRIDE, BUFFER_VIEW_TARGET };
+static const char *const buffer_view_keys[] = {
+    [BUFFER_VIEW_BUFFER] = "buffer", [BUFFER_VIEW_BYTE_OFFSET] = "byteOffset", [BUFFER_VIEW_BYTE_LENGTH] = "byteLength",
+    [BUFFER_VIEW_BYTE_STRIDE] = "byteStride", [BUFFER_VIEW_TARGET] = "target"};
+
+enum { MESH_NAME, MESH_PRIMITIVES };
+static const char *const mesh_keys[] = {[MESH_NAME] = "name", [MESH_PRIMITIVES] = "primitives"};
+
+enum { PRIMITIVE_ATTRIBUTES, PRIMITIVE_INDICES, PRIMITIVE_MODE, PRIMITIVE_MATERIAL };
+static const char *const primitive_keys[] = {
+    [PRIMITIVE_ATTRIBUTES] = "attributes", [PRIMITIVE_INDICES] = "indices", [PRIMITIVE_MODE] = "mode",
+    [PRIMITIVE_MATERIAL] = "material"};
+
+enum { ATTRIBUTE_JOINTS, ATTRIBUTE_NORMAL, ATTRIBUTE_TEX_COORD, ATTRIBUTE_POSITION, ATTRIBUTE_WEIGHTS };
+static const char *const attribute_keys[] = {
+    [ATTRIBUTE_JOINTS] = "JOINTS_0", [ATTRIBUTE_NORMAL] = "NORMAL", [ATTRIBUTE_TEX_COORD] = "TEXCOORD_0",
+    [ATTRIBUTE_POSITION] = "POSITION", [ATTRIBUTE_WEIGHTS] = "WEIGHTS_0"};
+
+enum { ANIMATION_CHANNELS, ANIMATION_SAMPLERS };
+static const char *const animation_keys[] = {[ANIMATION_CHANNELS] = "channels", [ANIMATION_SAMPLERS] = "samplers"};
+
+enum { CHANNEL_SAMPLER, CHANNEL_TARGET };
+static const char *const channel_keys[] = {[CHANNEL_SAMPLER] = "sampler", [CHANNEL_TARGET] = "target"};
+
+enum { TARGET_NODE, TARGET_PATH };
+static const char *const target_keys[] = {[TARGET_NODE] = "node", [TARGET_PATH] = "path"};
+
+enum { ANIMATION_SAMPLER_INPUT, ANIMATION_SAMPLER_OUTPUT, ANIMATION_SAMPLER_INTERPOLATION };
+static const char *const animation_sampler_keys[] = {
+    [ANIMATION_SAMPLER_INPUT] = "input", [ANIMATION_SAMPLER_OUTPUT] = "output",
+    [ANIMATION_SAMPLER_INTERPOLATION] = "interpolation"};
+
+enum { SKIN_INVERSE_BIND_MATRICES, SKIN_SKELETON, SKIN_JOINTS, SKIN_NAME };
+static const char *const skin_keys[] = {
+    [SKIN_INVERSE_BIND_MATRICES] = "inverseBindMatrices", [SKIN_SKELETON] = "skeleton", [SKIN_JOINTS] = "joints",
+    [SKIN_NAME] = "name"};
+
+enum { MATERIAL_NAME, MATERIAL_EXTENSIONS, MATERIAL_PBR, MATERIAL_NORMAL_TEXTURE, MATERIAL_EMISSIVE_FACTOR,
+       MATERIAL_EMISSIVE_TEXTURE, MATERIAL_OCCLUSION_TEXTURE, MATERIAL_ALPHA_MODE, MATERIAL_DOUBLE_SIDED };
+static const char *const material_keys[] = {
+    [MATERIAL_NAME] = "name", [MATERIAL_EXTENSIONS] = "extensions", [MATERIAL_PBR] = "pbrMetallicRoughness",
+    [MATERIAL_NORMAL_TEXTURE] = "normalTexture", [MATERIAL_EMISSIVE_FACTOR] = "emissiveFactor",
+    [MATERIAL_EMISSIVE_TEXTURE] = "emissiveTexture", [MATERIAL_OCCLUSION_TEXTURE] = "occlusionTexture",
+    [MATERIAL_ALPHA_MODE] = "alphaMode", [MATERIAL_DOUBLE_SIDED] = "doubleSided"};
+
+enum { SPECULAR_FACTOR, SPECULAR_TEXTURE, SPECULAR_COLOR_FACTOR, SPECULAR_COLOR_TEXTURE };
+static const char *const specular_keys[] = {
+    [SPECULAR_FACTOR] = "specularFactor", [SPECULAR_TEXTURE] = "specularTexture",
+    [SPECULAR_COLOR_FACTOR] = "specularColorFactor", [SPECULAR_COLOR_TEXTURE] = "specularColorTexture"};
+
+enum { PBR_BASE_COLOR_TEXTURE, PBR_BASE_COLOR_FACTOR, PBR_METALLIC_ROUGHNESS_TEXTURE, PBR_METALLIC_FACTOR,
+       PBR_ROUGHNESS_FACTOR };
+static const char *const pbr_keys[] = {
+    [PBR_BASE_COLOR_TEXTURE] = "baseColorTexture", [PBR_BASE_COLOR_FACTOR] = "baseColorFactor",
+    [PBR_METALLIC_ROUGHNESS_TEXTURE] = "metallicRoughnessTexture", [PBR_METALLIC_FACTOR] = "metallicFactor",
+    [PBR_ROUGHNESS_FACTOR] = "roughnessFactor"};
+
+//! @brief: textureInfo and its normal and occlusion variants
+enum { TEXTURE_INFO_INDEX, TEXTURE_INFO_TEX_COORD, TEXTURE_INFO_SCALE, TEXTURE_INFO_STRENGTH };
+static const char *const texture_info_keys[] = {
+    [TEXTURE_INFO_INDEX] = "index", [TEXTURE_INFO_TEX_COORD] = "texCoord", [TEXTURE_INFO_SCALE] = "scale",
+    [TEXTURE_INFO_STRENGTH] = "strength"};
+
+enum { TEXTURE_SAMPLER, TEXTURE_SOURCE };
+static const char *const texture_keys[] = {[TEXTURE_SAMPLER] = "sampler", [TEXTURE_SOURCE] = "source"};
+
+enum { SAMPLER_MAG_FILTER, SAMPLER_MIN_FILTER, SAMPLER_WRAP_S, SAMPLER_WRAP_T };
+static const char *const sampler_keys[] = {
+    [SAMPLER_MAG_FILTER] = "magFilter", [SAMPLER_MIN_FILTER] = "minFilter", [SAMPLER_WRAP_S] = "wrapS",
+    [SAMPLER_WRAP_T] = "wrapT"};
+
+static void json_get_texture_info(const cJSON *texture_info_node, gltf_texture_info_t *texture_info)
+{
+    cJSON *members[4];
+    JSON_GET_MEMBERS(texture_info_node, texture_info_keys, members);
+    texture_info->index     = json_uint32(members[TEXTURE_INFO_INDEX], UINT32_MAX);
+    texture_info->tex_coord = json_uint32(members[TEXTURE_INFO_TEX_COORD], 0);
+}
+
+//! @brief: the external buffers mapped so far
+static void model_unmap_buffers(gltf_model_t *gltf_model)
+{
+    for (uint32_t i = 0; i < gltf_model->buffer_count; i++) {
+        unmap_whole_file(&gltf_model->buffers[i].file);
+    }
+}
+
+/**
+ * @brief: Everything but the buffer data comes from the JSON. A buffer without a uri is the BIN chunk of a .glb,
+ *         bin, which the buffer points into. Arrays are walked through their child lists and every object's members
+ *         are matched in one pass with json_get_members. Returns NULL when the model can't be used.
+ */
+static gltf_model_t *model_load_from_json(json_arena_t *arena, const cJSON *root, const char *path, const char *asset_id, const uint8_t *bin, uint32_t bin_size)
+{
+    gltf_model_t *gltf_model = json_arena_alloc(arena, sizeof(gltf_model_t));
     if (!gltf_model) {
         LOGE("Failed to allocate model memory");
         return NULL;
     }
-    
-    gltf_model->path = string_duplicate(path, MEM_TAG_TEMP);
-    gltf_model->asset_id = string_duplicate(asset_id, MEM_TAG_TEMP);
-    const char *asset_directory = string_get_file_directory(gltf_model->path, MEM_TAG_TEMP);
+
+    gltf_model->path = json_arena_string(arena, path);
+    gltf_model->asset_id = json_arena_string(arena, asset_id);
+
+    cJSON *sections[12];
+    JSON_GET_MEMBERS(root, gltf_keys, sections);
 
     //do scenes
-    cJSON *scenes_node = cJSON_GetObjectItem(root, "scenes");
-    gltf_model->scene_count = cJSON_GetArraySize(scenes_node);
-    gltf_model->scenes = memory_alloc(sizeof(gltf_scene_t) * gltf_model->scene_count, MEM_TAG_TEMP);
+    cJSON *scenes_node = sections[GLTF_SCENES];
+    gltf_model->scene_count = json_array_size(scenes_node);
+    gltf_model->scenes = json_arena_alloc(arena, sizeof(gltf_scene_t) * gltf_model->scene_count);
 
-    for  (uint32_t i = 0; i < gltf_model->scene_count; i++) {
-        cJSON *scene_node = cJSON_GetArrayItem(scenes_node, i);
-        cJSON *nodes_node = cJSON_GetObjectItem(scene_node, "nodes");
-        int node_count = cJSON_GetArraySize(nodes_node);
+    cJSON *scene_node = scenes_node ? scenes_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->scene_count; i++, scene_node = scene_node->next) {
+        cJSON *nodes_node = cJSON_GetObjectItemCaseSensitive(scene_node, "nodes");
 
         gltf_scene_t *scene = &gltf_model->scenes[i];
-        scene->node_count = node_count;
-        scene->nodes = memory_alloc(sizeof(uint32_t) * scene->node_count, MEM_TAG_TEMP);
+        scene->node_count = json_array_size(nodes_node);
+        scene->nodes = json_arena_alloc(arena, sizeof(uint32_t) * scene->node_count);
 
-        for (uint32_t j = 0; j < scene->node_count; j++) {
-            scene->nodes[j] = cJSON_GetNumberValue(cJSON_GetArrayItem(nodes_node, j));
+        cJSON *item = scene->node_count ? nodes_node->child : NULL;
+        for (uint32_t j = 0; j < scene->node_count; j++, item = item->next) {
+            scene->nodes[j] = json_uint32(item, 0);
         }
     }
 
-    //do nodes 
-    cJSON *nodes = cJSON_GetObjectItem(root, "nodes");
-    if (!nodes) {
+    //do nodes
+    cJSON *nodes = sections[GLTF_NODES];
+    if (!cJSON_IsArray(nodes)) {
         LOGE("Unable to find \"nodes\" node. Aborting");
-        goto exit;
+        return NULL;
     }
 
-    gltf_model->node_count = cJSON_GetArraySize(nodes);
-    gltf_model->nodes = memory_alloc(gltf_model->node_count * sizeof(gltf_node_t), MEM_TAG_TEMP);
+    gltf_model->node_count = json_array_size(nodes);
+    gltf_model->nodes = json_arena_alloc(arena, gltf_model->node_count * sizeof(gltf_node_t));
 
-    for (uint32_t i = 0; i < gltf_model->node_count; i++) {
-        cJSON* node = cJSON_GetArrayItem(nodes, i);
+    cJSON *node = nodes->child;
+    for (uint32_t i = 0; i < gltf_model->node_count; i++, node = node->next) {
         gltf_node_t *model_node = &gltf_model->nodes[i];
-        
+        cJSON *members[8];
+        JSON_GET_MEMBERS(node, node_keys, members);
+
         //children
-        cJSON *children = cJSON_GetObjectItem(node, "children");
-        model_node->child_count = cJSON_GetArraySize(children);
+        cJSON *children = members[NODE_CHILDREN];
+        model_node->child_count = json_array_size(children);
         assert(model_node->child_count <= MODEL_NODE_CHILDREN_COUNT);
 
-        for (int j = 0; j < model_node->child_count; j++) {
-            model_node->children[j] = (uint8_t)cJSON_GetNumberValue(cJSON_GetArrayItem(children, j));
+        cJSON *child = model_node->child_count ? children->child : NULL;
+        for (int j = 0; j < model_node->child_count; j++, child = child->next) {
+            model_node->children[j] = (uint8_t)json_uint32(child, 0);
         }
 
         //name
-        const char *name = cJSON_GetStringValue(cJSON_GetObjectItem(node, "name"));
-        model_node->name = string_duplicate(name, MEM_TAG_TEMP);
+        const char *name = json_string(members[NODE_NAME]);
+        model_node->name = name ? json_arena_string(arena, name) : NULL;
 
         //default t,r,s and local transform
         model_node->translation = (vec3f_t){0.0f, 0.0f, 0.0f};
         model_node->scale       = (vec3f_t){1.0f, 1.0f, 1.0f};
-        model_node->rotation    = (quat_t){0.0f, 0.0f, 0.0f, 0.0f};
+        model_node->rotation    = (quat_t){.w = 1.0f};
         model_node->local_transform = mat4_identity();
 
         //matrix
-        cJSON *matrix = cJSON_GetObjectItem(node, "matrix");
-        if (matrix) {
-            int j = 0;
+        if (members[NODE_MATRIX]) {
             //copy the matrix directly (column major order)
-            for (uint32_t row = 0; row < 4; row++) {
-                for (uint32_t col = 0; col < 4; col++) {
-                    model_node->local_transform.m[row][col] = (float)cJSON_GetNumberValue(cJSON_GetArrayItem(matrix, j++));
-                }
-            }
+            json_floats(members[NODE_MATRIX], &model_node->local_transform.m[0][0], 16);
         } else {
             //construct the matrix from TRS
-            cJSON *trans = cJSON_GetObjectItem(node, "translation");
-            if (trans) {
-                model_node->translation.x = cJSON_GetNumberValue(cJSON_GetArrayItem(trans, 0));
-                model_node->translation.y = cJSON_GetNumberValue(cJSON_GetArrayItem(trans, 1));
-                model_node->translation.z = cJSON_GetNumberValue(cJSON_GetArrayItem(trans, 2));
-            }
-
-            cJSON *rot = cJSON_GetObjectItem(node, "rotation");
-            if (rot) {
-                model_node->rotation.x = cJSON_GetNumberValue(cJSON_GetArrayItem(rot, 0));
-                model_node->rotation.y = cJSON_GetNumberValue(cJSON_GetArrayItem(rot, 1));
-                model_node->rotation.z = cJSON_GetNumberValue(cJSON_GetArrayItem(rot, 2));
-                model_node->rotation.w = cJSON_GetNumberValue(cJSON_GetArrayItem(rot, 3));
-            } 
-
-            cJSON *scale = cJSON_GetObjectItem(node, "scale");
-            if (scale) {
-                model_node->scale.x = cJSON_GetNumberValue(cJSON_GetArrayItem(scale, 0));
-                model_node->scale.y = cJSON_GetNumberValue(cJSON_GetArrayItem(scale, 1));
-                model_node->scale.z = cJSON_GetNumberValue(cJSON_GetArrayItem(scale, 2));
-            }
+            json_floats(members[NODE_TRANSLATION], &model_node->translation.x, 3);
+            //quat_t keeps w first, glTF last
+            float rotation[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+            json_floats(members[NODE_ROTATION], rotation, 4);
+            model_node->rotation = (quat_t){.x = rotation[0], .y = rotation[1], .z = rotation[2], .w = rotation[3]};
+            json_floats(members[NODE_SCALE], &model_node->scale.x, 3);
         }
 
         //skin
-        model_node->skin = json_get_uint32_default(node, "skin", UINT32_MAX);
+        model_node->skin = json_uint32(members[NODE_SKIN], UINT32_MAX);
         if (model_node->skin != UINT32_MAX) {
             LOGI("Mode node %s has skin", model_node->name);
         }
         //mesh
-        model_node->mesh = json_get_uint32_default(node, "mesh", UINT32_MAX);
+        model_node->mesh = json_uint32(members[NODE_MESH], UINT32_MAX);
     }
     //we need to load the actual data here
 
     //cache buffers
-    cJSON *buffers_node       = cJSON_GetObjectItem(root, "buffers");
-    gltf_model->buffer_count  = (uint32_t)cJSON_GetArraySize(buffers_node);
-    gltf_model->buffers       = memory_alloc(gltf_model->buffer_count * sizeof(gltf_buffer_t), MEM_TAG_TEMP);
+    cJSON *buffers_node       = sections[GLTF_BUFFERS];
+    gltf_model->buffer_count  = json_array_size(buffers_node);
+    gltf_model->buffers       = json_arena_alloc(arena, gltf_model->buffer_count * sizeof(gltf_buffer_t));
 
-    for (uint32_t i = 0; i < gltf_model->buffer_count; i++) {
-        cJSON* buffer_node      = cJSON_GetArrayItem(buffers_node, i);
+    cJSON *buffer_node = gltf_model->buffer_count ? buffers_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->buffer_count; i++, buffer_node = buffer_node->next) {
         gltf_buffer_t *buffer   = &gltf_model->buffers[i];
-        const char *uri = cJSON_GetStringValue(cJSON_GetObjectItem(buffer_node, "uri"));
-        const char *binary_path = string_concatenate(asset_directory, uri, MEM_TAG_TEMP);
-        buffer->size = json_get_uint32_default(buffer_node, "byteLength", 0);
-        long size;
-        buffer->data = read_whole_file(binary_path, &size, MEM_TAG_TEMP);
+        cJSON *members[2];
+        JSON_GET_MEMBERS(buffer_node, buffer_keys, members);
+        const char *uri = json_string(members[BUFFER_URI]);
+        buffer->size = json_uint32(members[BUFFER_BYTE_LENGTH], 0);
+
+        if (!uri) {
+            //only the first buffer of a .glb may leave out its uri, the BIN chunk is padded past byteLength
+            if (i != 0 || !bin || buffer->size > bin_size) {
+                LOGE("Buffer %u of %s has no uri and no BIN chunk to use", i, path);
+                model_unmap_buffers(gltf_model);
+                return NULL;
+            }
+            buffer->data = bin;
+            continue;
+        }
+        const char *binary_path = json_arena_path(arena, path, uri);
+        if (!binary_path || !map_whole_file(binary_path, &buffer->file) || buffer->file.size < buffer->size) {
+            LOGE("Unable to read buffer %s of %s", uri, path);
+            model_unmap_buffers(gltf_model);
+            return NULL;
+        }
+        buffer->data = buffer->file.data;
     }
 
     //cache accessors
-    cJSON* accessors_node      = cJSON_GetObjectItem(root, "accessors");
-    gltf_model->accessor_count = cJSON_GetArraySize(accessors_node);
-    gltf_model->accessors      = memory_alloc(gltf_model->accessor_count * sizeof(gltf_accessor_t), MEM_TAG_TEMP);
-    
-    for (uint32_t i = 0; i < gltf_model->accessor_count; i++) {
-        cJSON *accessor_node = cJSON_GetArrayItem(accessors_node, i);
+    cJSON* accessors_node      = sections[GLTF_ACCESSORS];
+    gltf_model->accessor_count = json_array_size(accessors_node);
+    gltf_model->accessors      = json_arena_alloc(arena, gltf_model->accessor_count * sizeof(gltf_accessor_t));
+
+    cJSON *accessor_node = gltf_model->accessor_count ? accessors_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->accessor_count; i++, accessor_node = accessor_node->next) {
+        cJSON *members[5];
+        JSON_GET_MEMBERS(accessor_node, accessor_keys, members);
 
         gltf_accessor_t *accessor = &gltf_model->accessors[i];
-        accessor->buffer_view = json_get_uint32_default(accessor_node, "bufferView", UINT32_MAX);
-        accessor->byte_offset = json_get_uint32_default(accessor_node, "byteOffset", 0);
-        accessor->component_type = json_get_uint32_default(accessor_node, "componentType", UINT32_MAX);
-        accessor->type = value_type_from_string(cJSON_GetStringValue(cJSON_GetObjectItem(accessor_node, "type")));
-        accessor->count = json_get_uint32_default(accessor_node, "count", 0);
+        accessor->buffer_view = json_uint32(members[ACCESSOR_BUFFER_VIEW], UINT32_MAX);
+        accessor->byte_offset = json_uint32(members[ACCESSOR_BYTE_OFFSET], 0);
+        accessor->component_type = json_uint32(members[ACCESSOR_COMPONENT_TYPE], UINT32_MAX);
+        const char *type = json_string(members[ACCESSOR_TYPE]);
+        accessor->type = type ? value_type_from_string(type) : 0xFF;
+        accessor->count = json_uint32(members[ACCESSOR_COUNT], 0);
     }
 
-    //cache bufferviews 
-    cJSON* buffer_views_node      = cJSON_GetObjectItem(root, "bufferViews");
-    gltf_model->buffer_view_count = cJSON_GetArraySize(buffer_views_node);
-    gltf_model->buffer_views      = memory_alloc(gltf_model->buffer_view_count * sizeof(gltf_buffer_view_t), MEM_TAG_TEMP);
+    //cache bufferviews
+    cJSON* buffer_views_node      = sections[GLTF_BUFFER_VIEWS];
+    gltf_model->buffer_view_count = json_array_size(buffer_views_node);
+    gltf_model->buffer_views      = json_arena_alloc(arena, gltf_model->buffer_view_count * sizeof(gltf_buffer_view_t));
 
-    for (uint32_t i = 0; i < gltf_model->buffer_view_count; i++) {
-        cJSON *buffer_view_node = cJSON_GetArrayItem(buffer_views_node, i);
+    cJSON *buffer_view_node = gltf_model->buffer_view_count ? buffer_views_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->buffer_view_count; i++, buffer_view_node = buffer_view_node->next) {
+        cJSON *members[5];
+        JSON_GET_MEMBERS(buffer_view_node, buffer_view_keys, members);
 
         gltf_buffer_view_t *buffer_view = &gltf_model->buffer_views[i];
-        buffer_view->buffer      = json_get_uint32_default(buffer_view_node, "buffer", UINT32_MAX);
-        buffer_view->byte_offset = json_get_uint32_default(buffer_view_node, "byteOffset", 0);
-        buffer_view->byte_length = json_get_uint32_default(buffer_view_node, "byteLength", UINT32_MAX);
-        buffer_view->byte_stride = json_get_uint32_default(buffer_view_node, "byteStride", UINT32_MAX);
-        buffer_view->target      = json_get_uint32_default(buffer_view_node, "target", UINT32_MAX);
+        buffer_view->buffer      = json_uint32(members[BUFFER_VIEW_BUFFER], UINT32_MAX);
+        buffer_view->byte_offset = json_uint32(members[BUFFER_VIEW_BYTE_OFFSET], 0);
+        buffer_view->byte_length = json_uint32(members[BUFFER_VIEW_BYTE_LENGTH], UINT32_MAX);
+        buffer_view->byte_stride = json_uint32(members[BUFFER_VIEW_BYTE_STRIDE], UINT32_MAX);
+        buffer_view->target      = json_uint32(members[BUFFER_VIEW_TARGET], UINT32_MAX);
     }
-    
+
     //load meshes
-    cJSON *meshes_node = cJSON_GetObjectItem(root, "meshes");
-    gltf_model->mesh_count = cJSON_GetArraySize(meshes_node);
-    gltf_model->meshes = memory_alloc(sizeof(gltf_mesh_t) * gltf_model->mesh_count, MEM_TAG_TEMP);
+    cJSON *meshes_node = sections[GLTF_MESHES];
+    gltf_model->mesh_count = json_array_size(meshes_node);
+    gltf_model->meshes = json_arena_alloc(arena, sizeof(gltf_mesh_t) * gltf_model->mesh_count);
 
-    for (int i = 0; i < gltf_model->mesh_count; i++) {
-        cJSON *mesh_node = cJSON_GetArrayItem(meshes_node, i);
+    cJSON *mesh_node = gltf_model->mesh_count ? meshes_node->child : NULL;
+    for (int i = 0; i < gltf_model->mesh_count; i++, mesh_node = mesh_node->next) {
         gltf_mesh_t *mesh = &gltf_model->meshes[i];
+        cJSON *members[2];
+        JSON_GET_MEMBERS(mesh_node, mesh_keys, members);
 
-        const char *mesh_name = cJSON_GetStringValue(cJSON_GetObjectItem(mesh_node, "name"));
-        mesh->name = string_duplicate(mesh_name, MEM_TAG_TEMP);
+        const char *mesh_name = json_string(members[MESH_NAME]);
+        mesh->name = mesh_name ? json_arena_string(arena, mesh_name) : NULL;
 
-        cJSON *primitives_node = cJSON_GetObjectItem(mesh_node, "primitives");
-        mesh->primitive_count = cJSON_GetArraySize(primitives_node);
+        cJSON *primitives_node = members[MESH_PRIMITIVES];
+        mesh->primitive_count = json_array_size(primitives_node);
         assert(mesh->primitive_count <= 4);
 
-        for (int j = 0; j < mesh->primitive_count; j++) {
-            cJSON *primitive_node = cJSON_GetArrayItem(primitives_node, j);
+        cJSON *primitive_node = mesh->primitive_count ? primitives_node->child : NULL;
+        for (int j = 0; j < mesh->primitive_count; j++, primitive_node = primitive_node->next) {
+            cJSON *primitive_members[4];
+            cJSON *attributes[5];
+            JSON_GET_MEMBERS(primitive_node, primitive_keys, primitive_members);
+            JSON_GET_MEMBERS(primitive_members[PRIMITIVE_ATTRIBUTES], attribute_keys, attributes);
 
-            cJSON *attributes_node        = cJSON_GetObjectItem(primitive_node, "attributes");
-            mesh->primitives[j].joints    = json_get_uint32_default(attributes_node, "JOINTS_0",UINT32_MAX);
-            mesh->primitives[j].normal    = json_get_uint32_default(attributes_node, "NORMAL", UINT32_MAX);
-            mesh->primitives[j].tex_coord = json_get_uint32_default(attributes_node, "TEXCOORD_0", UINT32_MAX);
-            mesh->primitives[j].position  = json_get_uint32_default(attributes_node, "POSITION", UINT32_MAX);
-            mesh->primitives[j].weights   = json_get_uint32_default(attributes_node, "WEIGHTS_0", UINT32_MAX);
+            mesh->primitives[j].joints    = json_uint32(attributes[ATTRIBUTE_JOINTS], UINT32_MAX);
+            mesh->primitives[j].normal    = json_uint32(attributes[ATTRIBUTE_NORMAL], UINT32_MAX);
+            mesh->primitives[j].tex_coord = json_uint32(attributes[ATTRIBUTE_TEX_COORD], UINT32_MAX);
+            mesh->primitives[j].position  = json_uint32(attributes[ATTRIBUTE_POSITION], UINT32_MAX);
+            mesh->primitives[j].weights   = json_uint32(attributes[ATTRIBUTE_WEIGHTS], UINT32_MAX);
 
             //if this is undefined it means this is an unindexed geometry
-            mesh->primitives[j].indices  = json_get_uint32_default(primitive_node, "indices",UINT32_MAX);
+            mesh->primitives[j].indices  = json_uint32(primitive_members[PRIMITIVE_INDICES], UINT32_MAX);
             //triangles default
-            mesh->primitives[j].mode     = json_get_uint32_default(primitive_node, "mode", 4);
+            mesh->primitives[j].mode     = json_uint32(primitive_members[PRIMITIVE_MODE], 4);
 
-            mesh->primitives[j].material = json_get_uint32_default(primitive_node, "material", UINT32_MAX); 
+            mesh->primitives[j].material = json_uint32(primitive_members[PRIMITIVE_MATERIAL], UINT32_MAX);
         }
     }
 
-    gltf_model->index_counts  = memory_alloc(sizeof(uint32_t) * gltf_model->mesh_count, MEM_TAG_TEMP);
-    gltf_model->vertex_counts = memory_alloc(sizeof(uint32_t) * gltf_model->mesh_count, MEM_TAG_TEMP);
+    gltf_model->index_counts  = json_arena_alloc(arena, sizeof(uint32_t) * gltf_model->mesh_count);
+    gltf_model->vertex_counts = json_arena_alloc(arena, sizeof(uint32_t) * gltf_model->mesh_count);
 
     for (uint32_t i = 0; i < gltf_model->mesh_count; i++) {
         for (uint32_t j = 0; j < gltf_model->meshes[i].primitive_count; j++) {
             uint32_t accessor_index = gltf_model->meshes[i].primitives[j].position;
             gltf_model->vertex_counts[i] += gltf_model->accessors[accessor_index].count;
-            
+
             //indices
             accessor_index = gltf_model->meshes[i].primitives[j].indices;
             gltf_model->index_counts[i] += gltf_model->accessors[accessor_index].count;
         }
     }
-    
-    //load animations
-    cJSON *animations_node = cJSON_GetObjectItem(root, "animations");
-    if (animations_node) {
-        gltf_model->animation_count = cJSON_GetArraySize(animations_node);
-
-        gltf_model->animations = memory_alloc(sizeof(gltf_animation_t) * gltf_model->animation_count, MEM_TAG_TEMP);
-        for (int32_t i = 0; i < gltf_model->animation_count; i++) {
-            gltf_animation_t *animation = &gltf_model->animations[i];
 
-            cJSON *animation_node = cJSON_GetArrayItem(animations_node, i);
-            cJSON *channels_node = cJSON_GetObjectItem(animation_node, "channels");
-            animation->channel_count = (uint32_t)cJSON_GetArraySize(channels_node);
-            animation->channels = memory_alloc(sizeof(gltf_channel_t) * animation->channel_count, MEM_TAG_TEMP);
-
-            for (uint32_t j = 0; j < animation->channel_count; j++) {
-                cJSON *channel_node = cJSON_GetArrayItem(channels_node, j);
-                //this must exist
-                cJSON *target_node  = cJSON_GetObjectItem(channel_node, "target");
-
-                gltf_channel_t *channel = &animation->channels[j];
-
-                //this must exist
-                channel->sampler = json_get_uint32_default(channel_node, "sampler", UINT32_MAX);
-
-                //this is required
-                const char *path = cJSON_GetStringValue(cJSON_GetObjectItem(target_node, "path"));
-                channel->path    = path_from_string(path);
-
-                channel->node    = json_get_uint32_default(target_node, "node", UINT32_MAX);
-            }
+    //load animations
+    cJSON *animations_node = sections[GLTF_ANIMATIONS];
+    gltf_model->animation_count = json_array_size(animations_node);
+    gltf_model->animations = json_arena_alloc(arena, sizeof(gltf_animation_t) * gltf_model->animation_count);
+
+    cJSON *animation_node = gltf_model->animation_count ? animations_node->child : NULL;
+    for (int32_t i = 0; i < gltf_model->animation_count; i++, animation_node = animation_node->next) {
+        gltf_animation_t *animation = &gltf_model->animations[i];
+        cJSON *members[2];
+        JSON_GET_MEMBERS(animation_node, animation_keys, members);
+
+        cJSON *channels_node = members[ANIMATION_CHANNELS];
+        animation->channel_count = json_array_size(channels_node);
+        animation->channels = json_arena_alloc(arena, sizeof(gltf_channel_t) * animation->channel_count);
+
+        cJSON *channel_node = animation->channel_count ? channels_node->child : NULL;
+        for (uint32_t j = 0; j < animation->channel_count; j++, channel_node = channel_node->next) {
+            cJSON *channel_members[2];
+            cJSON *target_members[2];
+            JSON_GET_MEMBERS(channel_node, channel_keys, channel_members);
+            //this must exist
+            JSON_GET_MEMBERS(channel_members[CHANNEL_TARGET], target_keys, target_members);
+
+            gltf_channel_t *channel = &animation->channels[j];
+
+            //this must exist
+            channel->sampler = json_uint32(channel_members[CHANNEL_SAMPLER], UINT32_MAX);
+
+            //this is required
+            const char *target_path = json_string(target_members[TARGET_PATH]);
+            channel->path    = target_path ? path_from_string(target_path) : NIL;
+
+            channel->node    = json_uint32(target_members[TARGET_NODE], UINT32_MAX);
+        }
 
-            cJSON *samplers_node = cJSON_GetObjectItem(animation_node, "samplers");
-            if (samplers_node) {
-                animation->sampler_count = (uint32_t)cJSON_GetArraySize(samplers_node);
-                animation->samplers = memory_alloc(sizeof(gltf_animation_sampler_t) * animation->sampler_count, MEM_TAG_TEMP);
+        cJSON *samplers_node = members[ANIMATION_SAMPLERS];
+        animation->sampler_count = json_array_size(samplers_node);
+        animation->samplers = json_arena_alloc(arena, sizeof(gltf_animation_sampler_t) * animation->sampler_count);
 
-                for (uint32_t j = 0; j < animation->sampler_count; j++) {
-                    cJSON *sampler_node = cJSON_GetArrayItem(samplers_node, j);
-                    gltf_animation_sampler_t *sampler = &animation->samplers[j];
+        cJSON *sampler_node = animation->sampler_count ? samplers_node->child : NULL;
+        for (uint32_t j = 0; j < animation->sampler_count; j++, sampler_node = sampler_node->next) {
+            gltf_animation_sampler_t *sampler = &animation->samplers[j];
+            cJSON *sampler_members[3];
+            JSON_GET_MEMBERS(sampler_node, animation_sampler_keys, sampler_members);
 
-                    sampler->input = json_get_uint32_default(sampler_node, "input", UINT32_MAX);
-                    sampler->output = json_get_uint32_default(sampler_node, "output", UINT32_MAX);
-                    cJSON *interpolation_node = cJSON_GetObjectItem(sampler_node, "interpolation");
-                    const char *interpolation = interpolation_node ? (cJSON_GetStringValue(interpolation_node)) : "LINEAR";
-                    sampler->interpolation = interpolation_from_string(interpolation);
-                }
-            }
+            sampler->input = json_uint32(sampler_members[ANIMATION_SAMPLER_INPUT], UINT32_MAX);
+            sampler->output = json_uint32(sampler_members[ANIMATION_SAMPLER_OUTPUT], UINT32_MAX);
+            const char *interpolation = json_string(sampler_members[ANIMATION_SAMPLER_INTERPOLATION]);
+            sampler->interpolation = interpolation_from_string(interpolation ? interpolation : "LINEAR");
         }
     }
 
     //skins
-    cJSON* skins_node         = cJSON_GetObjectItem(root, "skins");
-    gltf_model->skin_count    = cJSON_GetArraySize(skins_node);
-    gltf_model->skins         = memory_alloc(sizeof(gltf_skin_t) * gltf_model->skin_count, MEM_TAG_TEMP);
+    cJSON* skins_node         = sections[GLTF_SKINS];
+    gltf_model->skin_count    = json_array_size(skins_node);
+    gltf_model->skins         = json_arena_alloc(arena, sizeof(gltf_skin_t) * gltf_model->skin_count);
 
-    for (uint32_t i = 0; i < gltf_model->skin_count; i++) {
-        cJSON *skin_node       = cJSON_GetArrayItem(skins_node, i);
+    cJSON *skin_node = gltf_model->skin_count ? skins_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->skin_count; i++, skin_node = skin_node->next) {
+        cJSON *members[4];
+        JSON_GET_MEMBERS(skin_node, skin_keys, members);
 
         gltf_skin_t *gltf_skin = &gltf_model->skins[i];
-        gltf_skin->inverse_bind_matrices = json_get_uint32_default(skin_node, "inverseBindMatrices", UINT32_MAX);
-        gltf_skin->skeleton = json_get_uint32_default(skin_node, "skeleton", UINT32_MAX);
+        gltf_skin->inverse_bind_matrices = json_uint32(members[SKIN_INVERSE_BIND_MATRICES], UINT32_MAX);
+        gltf_skin->skeleton = json_uint32(members[SKIN_SKELETON], UINT32_MAX);
 
-        cJSON *joints_node = cJSON_GetObjectItem(skin_node, "joints");
-        gltf_skin->joint_count = cJSON_GetArraySize(joints_node);
-        gltf_skin->joints = memory_alloc(gltf_skin->joint_count * sizeof(uint8_t), MEM_TAG_TEMP);
+        cJSON *joints_node = members[SKIN_JOINTS];
+        gltf_skin->joint_count = json_array_size(joints_node);
+        gltf_skin->joints = json_arena_alloc(arena, gltf_skin->joint_count * sizeof(uint8_t));
 
-        for (uint32_t j = 0; j < gltf_skin->joint_count; j++) {
-            gltf_skin->joints[j] = (uint32_t)cJSON_GetNumberValue(cJSON_GetArrayItem(joints_node, j));
+        cJSON *joint = gltf_skin->joint_count ? joints_node->child : NULL;
+        for (uint32_t j = 0; j < gltf_skin->joint_count; j++, joint = joint->next) {
+            gltf_skin->joints[j] = json_uint32(joint, 0);
         }
-        const char *name = cJSON_GetStringValue(cJSON_GetObjectItem(skin_node, "name"));
-        gltf_skin->name = string_duplicate(name, MEM_TAG_TEMP);
+        const char *name = json_string(members[SKIN_NAME]);
+        gltf_skin->name = name ? json_arena_string(arena, name) : NULL;
     }
-    
+
     //materials
-    cJSON *materials_node = cJSON_GetObjectItem(root, "materials");
-    gltf_model->material_count = cJSON_GetArraySize(materials_node);
-    gltf_model->materials = memory_alloc(sizeof(gltf_material_t) * gltf_model->material_count, MEM_TAG_TEMP);
+    cJSON *materials_node = sections[GLTF_MATERIALS];
+    gltf_model->material_count = json_array_size(materials_node);
+    gltf_model->materials = json_arena_alloc(arena, sizeof(gltf_material_t) * gltf_model->material_count);
 
-    for (uint32_t i = 0; i < gltf_model->material_count; i++) {
-        cJSON* material_node = cJSON_GetArrayItem(materials_node, i);
+    cJSON *material_node = gltf_model->material_count ? materials_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->material_count; i++, material_node = material_node->next) {
         gltf_material_t *material = &gltf_model->materials[i];
+        cJSON *members[9];
+        JSON_GET_MEMBERS(material_node, material_keys, members);
 
         //name
-        const char *name = cJSON_GetStringValue(cJSON_GetObjectItem(material_node, "name"));
-        material->name = string_duplicate(name, MEM_TAG_TEMP);
+        const char *name = json_string(members[MATERIAL_NAME]);
+        material->name = name ? json_arena_string(arena, name) : NULL;
 
         //extension
         //do extensions
-        cJSON *extensions_node = cJSON_GetObjectItem(material_node, "extensions");
+        cJSON *extensions_node = members[MATERIAL_EXTENSIONS];
         if (extensions_node) {
             //! NOTE: https://github.com/KhronosGroup/glTF/blob/main/extensions/2.0/Khronos/KHR_materials_specular/README.md
-            cJSON *specular_node = cJSON_GetObjectItem(extensions_node, "KHR_materials_specular");
+            cJSON *specular_node = cJSON_GetObjectItemCaseSensitive(extensions_node, "KHR_materials_specular");
             if (specular_node) {
-                material->specular = memory_alloc(sizeof(gltf_specular_t), MEM_TAG_TEMP);
+                cJSON *specular_members[4];
+                JSON_GET_MEMBERS(specular_node, specular_keys, specular_members);
+                material->specular = json_arena_alloc(arena, sizeof(gltf_specular_t));
                 //specular factor
-                material->specular->specular_factor = json_get_uint32_default(specular_node, "specularFactor", 1.0f);
+                material->specular->specular_factor = json_float(specular_members[SPECULAR_FACTOR], 1.0f);
                 //specular texture
-                cJSON *specular_texture_node = cJSON_GetObjectItem(specular_node, "specularTexture");
-                if (specular_texture_node) {
-                    material->specular->specular_texture.index = json_get_uint32_default(specular_texture_node, "index", UINT32_MAX);
-                    material->specular->specular_texture.tex_coord = json_get_uint32_default(specular_texture_node, "texCoord", 0);
+                material->specular->specular_texture.index = UINT32_MAX;
+                if (specular_members[SPECULAR_TEXTURE]) {
+                    json_get_texture_info(specular_members[SPECULAR_TEXTURE], &material->specular->specular_texture);
                 }
                 //specular color factor
-                cJSON *specular_color_factor_node = cJSON_GetObjectItem(specular_node, "specularColorFactor");
-                if (specular_color_factor_node) {
-                    material->specular->specular_color_factor.x = cJSON_GetNumberValue(cJSON_GetArrayItem(specular_color_factor_node, 0));
-                    material->specular->specular_color_factor.y = cJSON_GetNumberValue(cJSON_GetArrayItem(specular_color_factor_node, 1));
-                    material->specular->specular_color_factor.z = cJSON_GetNumberValue(cJSON_GetArrayItem(specular_color_factor_node, 2));
-                } else {
-                    material->specular->specular_color_factor = (vec3f_t){1.0f,1.0f,1.0f};
-                }
+                material->specular->specular_color_factor = (vec3f_t){1.0f,1.0f,1.0f};
+                json_floats(specular_members[SPECULAR_COLOR_FACTOR], &material->specular->specular_color_factor.x, 3);
                 //specular color texture
-                cJSON *specular_color_texture_node = cJSON_GetObjectItem(specular_node, "specularColorTexture");
-                if (specular_color_texture_node) {
-                    material->specular->specular_color_texture.index = json_get_uint32_default(specular_color_texture_node, "index", UINT32_MAX);
-                    material->specular->specular_color_texture.tex_coord = json_get_uint32_default(specular_color_texture_node, "texCoord", 0);
-                } 
+                material->specular->specular_color_texture.index = UINT32_MAX;
+                if (specular_members[SPECULAR_COLOR_TEXTURE]) {
+                    json_get_texture_info(specular_members[SPECULAR_COLOR_TEXTURE], &material->specular->specular_color_texture);
+                }
             }
         }
 
-        //extras
-        //do extras
-        cJSON *extras_node = cJSON_GetObjectItem(material_node, "extras");
-        if (extras_node) {
-        }
-
-        cJSON *pbr_mr_node = cJSON_GetObjectItem(material_node, "pbrMetallicRoughness");
+        cJSON *pbr_mr_node = members[MATERIAL_PBR];
         if (pbr_mr_node) {
-            material->pbr_metallic_roughness = memory_alloc(sizeof(gltf_pbr_metallic_roughness_t), MEM_TAG_TEMP);
+            material->pbr_metallic_roughness = json_arena_alloc(arena, sizeof(gltf_pbr_metallic_roughness_t));
+            gltf_pbr_metallic_roughness_t *pbr = material->pbr_metallic_roughness;
+            cJSON *pbr_members[5];
+            JSON_GET_MEMBERS(pbr_mr_node, pbr_keys, pbr_members);
 
             //base color texture
-            cJSON *base_color_texture_node = cJSON_GetObjectItem(pbr_mr_node, "baseColorTexture");
-            if (base_color_texture_node) {
-                material->pbr_metallic_roughness->base_color_texture.index = json_get_uint32_default(base_color_texture_node, "index", UINT32_MAX);
-                material->pbr_metallic_roughness->base_color_texture.tex_coord = json_get_uint32_default(base_color_texture_node, "texCoord", 0);
+            if (pbr_members[PBR_BASE_COLOR_TEXTURE]) {
+                json_get_texture_info(pbr_members[PBR_BASE_COLOR_TEXTURE], &pbr->base_color_texture);
             } else {
-                material->pbr_metallic_roughness->base_color_texture.index = UINT32_MAX;
-                material->pbr_metallic_roughness->base_color_texture.tex_coord = UINT32_MAX;
+                pbr->base_color_texture.index = UINT32_MAX;
+                pbr->base_color_texture.tex_coord = UINT32_MAX;
             }
 
             //base color factor
-            cJSON *base_color_factor_node = cJSON_GetObjectItem(pbr_mr_node, "baseColorFactor");
-            if (base_color_factor_node) {
-                material->pbr_metallic_roughness->base_color_factor.x = cJSON_GetNumberValue(cJSON_GetArrayItem(base_color_factor_node, 0));
-                material->pbr_metallic_roughness->base_color_factor.y = cJSON_GetNumberValue(cJSON_GetArrayItem(base_color_factor_node, 1));
-                material->pbr_metallic_roughness->base_color_factor.z = cJSON_GetNumberValue(cJSON_GetArrayItem(base_color_factor_node, 2));
-                material->pbr_metallic_roughness->base_color_factor.w = cJSON_GetNumberValue(cJSON_GetArrayItem(base_color_factor_node, 3));
-            } else {
-                material->pbr_metallic_roughness->base_color_factor.x = 1;
-                material->pbr_metallic_roughness->base_color_factor.y = 1;
-                material->pbr_metallic_roughness->base_color_factor.z = 1;
-                material->pbr_metallic_roughness->base_color_factor.w = 1;
-            }
+            pbr->base_color_factor = (vec4f_t){1.0f, 1.0f, 1.0f, 1.0f};
+            json_floats(pbr_members[PBR_BASE_COLOR_FACTOR], &pbr->base_color_factor.x, 4);
 
             //metallic roughness texture
-            cJSON *metallic_roughness_texture_node = cJSON_GetObjectItem(pbr_mr_node, "metallicRoughnesstexture");
-            if (metallic_roughness_texture_node) {
-                material->pbr_metallic_roughness->metallic_roughness_texture.index = json_get_uint32_default(metallic_roughness_texture_node, "index", UINT32_MAX);
-                material->pbr_metallic_roughness->metallic_roughness_texture.tex_coord = json_get_uint32_default(metallic_roughness_texture_node, "texCoord", 0);
+            if (pbr_members[PBR_METALLIC_ROUGHNESS_TEXTURE]) {
+                json_get_texture_info(pbr_members[PBR_METALLIC_ROUGHNESS_TEXTURE], &pbr->metallic_roughness_texture);
             } else {
-                material->pbr_metallic_roughness->metallic_roughness_texture.index = UINT32_MAX;
-                material->pbr_metallic_roughness->metallic_roughness_texture.tex_coord = UINT32_MAX;
+                pbr->metallic_roughness_texture.index = UINT32_MAX;
+                pbr->metallic_roughness_texture.tex_coord = UINT32_MAX;
             }
 
-            material->pbr_metallic_roughness->metallic_factor = json_get_float_default(pbr_mr_node, "metallicFactor", 1.0f);
-            material->pbr_metallic_roughness->roughness_factor = json_get_float_default(pbr_mr_node, "roughnessFactor", 1.0f);
+            pbr->metallic_factor = json_float(pbr_members[PBR_METALLIC_FACTOR], 1.0f);
+            pbr->roughness_factor = json_float(pbr_members[PBR_ROUGHNESS_FACTOR], 1.0f);
         } else {
             LOGE("No pbr metallic roughness workflow!!");
         }
 
-        cJSON *normal_texture_node = cJSON_GetObjectItem(material_node, "normalTexture");
+        cJSON *normal_texture_node = members[MATERIAL_NORMAL_TEXTURE];
         if (normal_texture_node) {
-            material->normal_texture = memory_alloc(sizeof(gltf_normal_texture_info_t), MEM_TAG_TEMP);
+            cJSON *texture_members[4];
+            JSON_GET_MEMBERS(normal_texture_node, texture_info_keys, texture_members);
+            material->normal_texture = json_arena_alloc(arena, sizeof(gltf_normal_texture_info_t));
 
-            material->normal_texture->index = json_get_uint32_default(normal_texture_node, "index", UINT32_MAX);
-            material->normal_texture->tex_coord = json_get_uint32_default(normal_texture_node, "texCoord", 0);
-            material->normal_texture->scale = json_get_uint32_default(normal_texture_node, "scale", 1.0f);
+            material->normal_texture->index = json_uint32(texture_members[TEXTURE_INFO_INDEX], UINT32_MAX);
+            material->normal_texture->tex_coord = json_uint32(texture_members[TEXTURE_INFO_TEX_COORD], 0);
+            material->normal_texture->scale = json_float(texture_members[TEXTURE_INFO_SCALE], 1.0f);
         }
 
         //emissive factor
-        cJSON *emissive_node = cJSON_GetObjectItem(material_node, "emissiveFactor");
-        if (emissive_node) {
-            material->emissive_factor.x = cJSON_GetNumberValue(cJSON_GetArrayItem(emissive_node, 0));
-            material->emissive_factor.y = cJSON_GetNumberValue(cJSON_GetArrayItem(emissive_node, 1));
-            material->emissive_factor.z = cJSON_GetNumberValue(cJSON_GetArrayItem(emissive_node, 2));
-        }
+        json_floats(members[MATERIAL_EMISSIVE_FACTOR], &material->emissive_factor.x, 3);
 
         //emissive texture
-        cJSON *emissive_texture_node = cJSON_GetObjectItem(material_node, "emissiveTexture");
-        if (emissive_texture_node) {
-            material->emissive_texture = memory_alloc(sizeof(gltf_texture_info_t), MEM_TAG_TEMP);
-            material->emissive_texture->index = json_get_uint32_default(emissive_texture_node, "index", UINT32_MAX);
-            material->emissive_texture->tex_coord = json_get_uint32_default(emissive_texture_node, "texCoord", 0);
+        if (members[MATERIAL_EMISSIVE_TEXTURE]) {
+            material->emissive_texture = json_arena_alloc(arena, sizeof(gltf_texture_info_t));
+            json_get_texture_info(members[MATERIAL_EMISSIVE_TEXTURE], material->emissive_texture);
         }
 
         //occlusion texture
-        cJSON *occlusion_texture_node = cJSON_GetObjectItem(material_node, "occlusionTexture");
+        cJSON *occlusion_texture_node = members[MATERIAL_OCCLUSION_TEXTURE];
         if (occlusion_texture_node) {
-            material->occlusion_texture = memory_alloc(sizeof(gltf_occlusion_texture_info_t), MEM_TAG_TEMP);
-            material->occlusion_texture->index = json_get_uint32_default(occlusion_texture_node, "index", UINT32_MAX);
-            material->occlusion_texture->tex_coord = json_get_uint32_default(occlusion_texture_node, "texCoord", 0);
-            material->occlusion_texture->strength = json_get_uint32_default(occlusion_texture_node, "strength", 1.0f);
+            cJSON *texture_members[4];
+            JSON_GET_MEMBERS(occlusion_texture_node, texture_info_keys, texture_members);
+            material->occlusion_texture = json_arena_alloc(arena, sizeof(gltf_occlusion_texture_info_t));
+            material->occlusion_texture->index = json_uint32(texture_members[TEXTURE_INFO_INDEX], UINT32_MAX);
+            material->occlusion_texture->tex_coord = json_uint32(texture_members[TEXTURE_INFO_TEX_COORD], 0);
+            material->occlusion_texture->strength = json_float(texture_members[TEXTURE_INFO_STRENGTH], 1.0f);
         }
 
-        material->alpha_mode = alpha_mode_from_string(cJSON_GetStringValue(cJSON_GetObjectItem(material_node, "alphaMode")));
+        material->alpha_mode = alpha_mode_from_string(json_string(members[MATERIAL_ALPHA_MODE]));
 
-        material->double_sided = json_get_uint32_default(material_node, "doubleSided", 0);
+        material->double_sided = cJSON_IsTrue(members[MATERIAL_DOUBLE_SIDED]);
     }
 
     //textures
-    cJSON *textures_node = cJSON_GetObjectItem(root, "textures");
-    gltf_model->texture_count = cJSON_GetArraySize(textures_node);
-    gltf_model->textures = memory_alloc(sizeof(gltf_texture_t) * gltf_model->texture_count, MEM_TAG_TEMP);
-    
-    for (uint32_t i = 0; i < gltf_model->texture_count; i++) {
-        cJSON *texture_node = cJSON_GetArrayItem(textures_node, i);
+    cJSON *textures_node = sections[GLTF_TEXTURES];
+    gltf_model->texture_count = json_array_size(textures_node);
+    gltf_model->textures = json_arena_alloc(arena, sizeof(gltf_texture_t) * gltf_model->texture_count);
+
+    cJSON *texture_node = gltf_model->texture_count ? textures_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->texture_count; i++, texture_node = texture_node->next) {
+        cJSON *members[2];
+        JSON_GET_MEMBERS(texture_node, texture_keys, members);
         gltf_texture_t *texture = &gltf_model->textures[i];
-        texture->sampler = json_get_uint32_default(texture_node, "sampler", UINT32_MAX);
-        texture->source  = json_get_uint32_default(texture_node, "source", UINT32_MAX);
+        texture->sampler = json_uint32(members[TEXTURE_SAMPLER], UINT32_MAX);
+        texture->source  = json_uint32(members[TEXTURE_SOURCE], UINT32_MAX);
     }
 
     //images
-    cJSON *images_node = cJSON_GetObjectItem(root, "images");
-    gltf_model->image_count = cJSON_GetArraySize(images_node);
-    gltf_model->image_paths = memory_alloc(sizeof(const char *) * gltf_model->image_count, MEM_TAG_TEMP);
-
-    for (uint32_t i = 0; i < gltf_model->image_count; i++) {
-        cJSON *image_node = cJSON_GetArrayItem(images_node, i);
-        const char *image_path = cJSON_GetStringValue(cJSON_GetObjectItem(image_node, "uri"));
-        gltf_model->image_paths[i] = string_concatenate(asset_directory, image_path, MEM_TAG_TEMP);
+    cJSON *images_node = sections[GLTF_IMAGES];
+    gltf_model->image_count = json_array_size(images_node);
+    gltf_model->image_paths = json_arena_alloc(arena, sizeof(const char *) * gltf_model->image_count);
+
+    cJSON *image_node = gltf_model->image_count ? images_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->image_count; i++, image_node = image_node->next) {
+        const char *image_path = json_string(cJSON_GetObjectItemCaseSensitive(image_node, "uri"));
+        if (!image_path) {
+            //textures are created from files, images inside a buffer view are not supported
+            LOGE("Image %u of %s is not an external file", i, path);
+            gltf_model->image_paths[i] = NULL;
+            continue;
+        }
+        gltf_model->image_paths[i] = json_arena_path(arena, path, image_path);
     }
 
     //samplers
-    cJSON *samplers_node = cJSON_GetObjectItem(root, "samplers");
-    gltf_model->sampler_count = cJSON_GetArraySize(samplers_node);
-    gltf_model->samplers = memory_alloc(sizeof(gltf_sampler_t) * gltf_model->sampler_count, MEM_TAG_TEMP);
-    
-    for (uint32_t i = 0; i < gltf_model->sampler_count; i++) {
-        cJSON *sampler_node = cJSON_GetArrayItem(samplers_node, i);
+    cJSON *samplers_node = sections[GLTF_SAMPLERS];
+    gltf_model->sampler_count = json_array_size(samplers_node);
+    gltf_model->samplers = json_arena_alloc(arena, sizeof(gltf_sampler_t) * gltf_model->sampler_count);
+
+    cJSON *sampler_node = gltf_model->sampler_count ? samplers_node->child : NULL;
+    for (uint32_t i = 0; i < gltf_model->sampler_count; i++, sampler_node = sampler_node->next) {
+        cJSON *members[4];
+        JSON_GET_MEMBERS(sampler_node, sampler_keys, members);
         gltf_sampler_t *sampler = &gltf_model->samplers[i];
-        sampler->mag_filter = json_get_uint32_default(sampler_node, "magFilter", UINT32_MAX);
-        sampler->min_filter = json_get_uint32_default(sampler_node, "minFilter", UINT32_MAX);
-        sampler->wrap_s     = json_get_uint32_default(sampler_node, "wrapS", UINT32_MAX);
-        sampler->wrap_t     = json_get_uint32_default(sampler_node, "wrapT", UINT32_MAX);
+        sampler->mag_filter = json_uint32(members[SAMPLER_MAG_FILTER], UINT32_MAX);
+        sampler->min_filter = json_uint32(members[SAMPLER_MIN_FILTER], UINT32_MAX);
+        sampler->wrap_s     = json_uint32(members[SAMPLER_WRAP_S], UINT32_MAX);
+        sampler->wrap_t     = json_uint32(members[SAMPLER_WRAP_T], UINT32_MAX);
     }
 
     LOGI("Success");
-exit:
-    cJSON_Delete(root);
     return gltf_model;
 }
 
+static gltf_model_t *model_load_from_glb(json_arena_t *arena, const char *path, const char *asset_id)
+{
+    mapped_file_t file;
+    if (!map_whole_file(path, &file)) {
+        LOGE("Can't map glb file %s", path);
+        return NULL;
+    }
+
+    const glb_header_t *header = (const glb_header_t *)file.data;
+    const glb_chunk_t  *json   = (const glb_chunk_t *)(file.data + sizeof(glb_header_t));
+    if (file.size < sizeof(glb_header_t) + sizeof(glb_chunk_t) || header->magic != GLB_MAGIC || header->version != 2 ||
+        header->length > file.size || json->type != GLB_CHUNK_JSON ||
+        json->length > header->length - sizeof(glb_header_t) - sizeof(glb_chunk_t)) {
+        LOGE("%s is not a glTF 2.0 binary", path);
+        unmap_whole_file(&file);
+        return NULL;
+    }
+    const char *json_data = (const char *)(json + 1);
+
+    //the BIN chunk is optional, chunks are 4 byte aligned
+    const uint8_t *bin = NULL;
+    uint32_t bin_size  = 0;
+    size_t bin_offset = sizeof(glb_header_t) + sizeof(glb_chunk_t) + json->length;
+    if (bin_offset + sizeof(glb_chunk_t) <= header->length) {
+        const glb_chunk_t *chunk = (const glb_chunk_t *)(file.data + bin_offset);
+        if (chunk->type == GLB_CHUNK_BIN && chunk->length <= header->length - bin_offset - sizeof(glb_chunk_t)) {
+            bin      = (const uint8_t *)(chunk + 1);
+            bin_size = chunk->length;
+        }
+    }
+
+    //the JSON chunk is not null terminated
+    cJSON *root = json_parse(arena, json_data, json->length);
+    if (!root) {
+        LOGE("Unable to parse the json chunk of %s", path);
+        unmap_whole_file(&file);
+        return NULL;
+    }
+
+    gltf_model_t *gltf_model = model_load_from_json(arena, root, path, asset_id, bin, bin_size);
+    if (!gltf_model) {
+        unmap_whole_file(&file);
+        return NULL;
+    }
+    gltf_model->file = file;
+    return gltf_model;
+}
+
+static gltf_model_t *model_load_from_text(json_arena_t *arena, const char *path, const char *asset_id)
+{
+    mapped_file_t file;
+    if (!map_whole_file(path, &file)) {
+        LOGE("Can't read gltf file %s", path);
+        return NULL;
+    }
+
+    //the DOM copies the strings, the text isn't read past the parse
+    cJSON *root = json_parse(arena, (const char *)file.data, file.size);
+    unmap_whole_file(&file);
+    if (!root) {
+        LOGE("Unable to parse json file %s", path);
+        return NULL;
+    }
+    return model_load_from_json(arena, root, path, asset_id, NULL, 0);
+}
+
+gltf_model_t *model_load_from_gltf(const char *path, const char *asset_id)
+{
+    json_arena_t arena;
+    json_arena_init(&arena);
+
+    const char *extension = string_find_last_of(path, ".");
+    gltf_model_t *gltf_model = extension && strcmp(extension, "glb") == 0 ? model_load_from_glb(&arena, path, asset_id) :
+                                                                            model_load_from_text(&arena, path, asset_id);
+    if (!gltf_model) {
+        json_arena_release(&arena);
+        return NULL;
+    }
+    //the model lives in the arena it keeps
+    gltf_model->arena = arena;
+    return gltf_model;
+}
+
+static void model_init_material(material_t *material) 
+{
+    material->alpha_mode = OPAQUE;
+
+    material->base_color_texture = UINT32_MAX;
+    material->metallic_roughness_texture = UINT32_MAX;
+    material->normal_texture = UINT32_MAX;
+    material->occlusion_texture = UINT32_MAX;
+    material->emissive_texture = UINT32_MAX;
+
+    material->base_color_factor = (vec4f_t){1.0f, 1.0f, 1.0f, 1.0f};
+    material->emissive_factor = (vec3f_t){1.0f, 1.0f, 1.0f};
+
+    material->metallic_factor = 1.0f;
+    material->roughness_factor = 1.0f;
+    material->normal_scale = 1.0f;
+    material->occlusion_strength = 1.0f;
+    material->alpha_cut_off = 0.5f;
+    
+    material->specular_texture = UINT32_MAX;
+    material->specular_color_texture = UINT32_MAX;
+    material->specular_factor = 1.0f;
+    material->specular_color_factor = (vec3f_t){1.0f, 1.0f, 1.0f};
+
+    material->double_sided = false;
+}
+
+uint32_t model_load_materials(gltf_model_t *gltf_model, const uint32_t *textures, material_t *materials)
+{
+    assert(gltf_model->material_count <= MAX_MATERIALS_PER_MODEL);
+
+    for (uint32_t i = 0; i < gltf_model->material_count; i++) {
+        material_t *material = &materials[i];
+        gltf_material_t *gltf_material = &gltf_model->materials[i];
+
+        model_init_material(material);
+
+        material->alpha_mode = (alpha_mode_e)gltf_material->alpha_mode;
+
+        //do pbr metallic roughness
+        gltf_pbr_metallic_roughness_t *pbr_metallic_roughness = gltf_material->pbr_metallic_roughness;
+        if (pbr_metallic_roughness) {
+            gltf_texture_info_t *base_color_texture = &gltf_material->pbr_metallic_roughness->base_color_texture;
+            gltf_texture_info_t *metallic_roughness_texture = &gltf_material->pbr_metallic_roughness->metallic_roughness_texture;
+
+            if (metallic_roughness_texture->index != UINT32_MAX) {
+                material->metallic_roughness_texture = textures[gltf_model->textures[metallic_roughness_texture->index].source];
+            }
+            
+            if (base_color_texture->index != UINT32_MAX) {
+                material->base_color_texture = textures[gltf_model->textures[base_color_texture->index].source];
+            }
+
+            material->base_color_factor = pbr_metallic_roughness->base_color_factor;
+            material->metallic_factor = pbr_metallic_roughness->metallic_factor;
+            material->roughness_factor = pbr_metallic_roughness->roughness_factor;
+        }
+
+        //do normal_texture
+        gltf_normal_texture_info_t *normal_texture = gltf_material->normal_texture;
+        if (normal_texture) {
+            material->normal_texture = textures[gltf_model->textures[normal_texture->index].source];
+            material->normal_scale = normal_texture->scale;
+        }
+
+        gltf_occlusion_texture_info_t *occlusion_texture = gltf_material->occlusion_texture;
+        if (occlusion_texture) {
+            material->occlusion_texture = textures[gltf_model->textures[occlusion_texture->index].source];
+            material->occlusion_strength = occlusion_texture->strength;
+        }
+
+        gltf_specular_t *specular = gltf_material->specular;
+        if (specular) {
+            if (specular->specular_texture.index != UINT32_MAX) {
+                material->specular_texture = textures[gltf_model->textures[specular->specular_texture.index].source];
+            }
+            if (specular->specular_color_texture.index != UINT32_MAX) {
+                material->specular_color_texture = textures[gltf_model->textures[specular->specular_color_texture.index].source];
+            }
+            material->specular_color_factor = gltf_material->specular->specular_color_factor;
+            material->specular_factor = gltf_material->specular->specular_factor;
+        }
+
+        gltf_texture_info_t *emissive_texture = gltf_material->emissive_texture;
+        if (emissive_texture) {
+            material->emissive_texture = textures[gltf_model->textures[emissive_texture->index].source];
+        }
+
+        material->emissive_factor = gltf_material->emissive_factor;
+        material->double_sided = gltf_material->double_sided;
+    }
+    return gltf_model->material_count;
+}
+
+//! @brief: a joint of the glTF skin as a skeleton joint, itself without a table. Joints the skin doesn't have are 0
+static inline float model_joint(const uint32_t *joint_table, uint32_t joint_count, uint32_t joint)
+{
+    if (joint >= joint_count) return 0.0f;
+    return (float)(joint_table ? joint_table[joint] : joint);
+}
+
+void model_load_skinned_geometry(gltf_model_t *gltf_model, const uint32_t *joint_table, mesh_t *mesh_out, skinned_geometry_t *geometry)
+{
+    //allocate vertex and index buffers
+    //calculate total buffer size and number of indices
+    size_t index_count          = 0;
+    size_t vertex_count         = 0;
+
+    for (uint32_t i = 0; i < gltf_model->mesh_count; i++) {
+        index_count += gltf_model->index_counts[i];
+        vertex_count += gltf_model->vertex_counts[i];
+    }
+
+    uint32_t joint_count = gltf_model->skin_count > 0 ? MIN(gltf_model->skins[0].joint_count, MAX_BONES_PER_SKIN) : 0;
+
+    //vertex and index buffers for ALL meshes in the entire models
+    skinned_vertex_t *vertex_buffer_data = (skinned_vertex_t*)json_arena_alloc(&gltf_model->arena, vertex_count * sizeof(skinned_vertex_t));
+    uint32_t *index_buffer_data  = (uint32_t*)json_arena_alloc(&gltf_model->arena, index_count * sizeof(uint32_t));//we will just use 32 bit indices
+    
+    index_count  = 0;
+    vertex_count = 0;
+    assert(gltf_model->mesh_count == 1 && "Model has more than one mesh");
+
+    for (uint32_t i = 0; i < gltf_model->mesh_count; i++) {
+        
+        gltf_mesh_t *gltf_mesh = &gltf_model->meshes[i];
+        assert(gltf_mesh->primitive_count <= MAX_PRIMITIVES_PER_MESH && "Mesh has more than 4 primitives");
+
+        mesh_t *mesh = mesh_out;
+
+        for (uint32_t j = 0; j < gltf_mesh->primitive_count; j++) {
+            gltf_mesh_primitive_t *gltf_primitive = &gltf_mesh->primitives[j];
+            mesh_primitive_t *primitive = &mesh->primitives[j];
+
+            uint32_t first_index      = index_count;
+            uint32_t vertex_start     = vertex_count;
+            uint32_t prim_index_count = 0;
+            bool has_skin = false;
+            {
+                const float *position_buffer         = NULL;
+                const float *normals_buffer          = NULL;
+                const float *tex_coords_buffer       = NULL;
+                const void *joint_indices_buffer     = NULL;
+                const float *joint_weights_buffer    = NULL;
+                uint32_t prim_vertex_count           = 0; 
+                uint32_t joint_indices_type = UNSIGNED_BYTE;
+
+                if (gltf_primitive->position != UINT32_MAX) {
+                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->position];
+                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+                    position_buffer = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
+                    prim_vertex_count = accessor->count;
+                }
+
+                if (gltf_primitive->normal != UINT32_MAX) {
+                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->normal];
+                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+                    normals_buffer = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
+                }
+
+                if (gltf_primitive->tex_coord != UINT32_MAX) {
+                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->tex_coord];
+                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+                    tex_coords_buffer = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
+                }
+
+                if (gltf_primitive->joints != UINT32_MAX) {
+                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->joints];
+                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+                    joint_indices_buffer      = (&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
+                    joint_indices_type        = accessor->component_type;
+                }
+
+                if (gltf_primitive->weights != UINT32_MAX) {
+                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->weights];
+                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+                    joint_weights_buffer      = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
+                }
+
+                has_skin = (joint_indices_buffer && joint_weights_buffer);
+
+                for (uint32_t v = 0; v < prim_vertex_count; v++) {
+                    skinned_vertex_t *vert = &vertex_buffer_data[vertex_count++];
+                    //positions
+                    vert->pos    = (vec3f_t){position_buffer[v * 3], position_buffer[v * 3 + 1], position_buffer[v * 3 + 2]};
+                    //normals
+                    vec3f_t normal = {0};
+                    if (normals_buffer) {
+                        normal = vec3_normalize((vec3f_t){normals_buffer[v * 3], normals_buffer[v * 3 + 1], normals_buffer[v * 3 + 2]});
+                    }
+                    vert->normal =  normal;
+                    //tex coords
+                    vec2f_t tex_coords = {0};
+                    if (tex_coords_buffer) {
+                        tex_coords = (vec2f_t){tex_coords_buffer[v * 2], tex_coords_buffer[v * 2 + 1]};
+                    }
+                    vert->uv = tex_coords;
+
+                    if (has_skin){
+                        vec4f_t joint_indices = {0};
+                        switch(joint_indices_type) 
+                        {
+                            case UNSIGNED_SHORT:
+                            {
+                                const uint16_t *buf = (const uint16_t *)joint_indices_buffer;
+                                joint_indices =  (vec4f_t){model_joint(joint_table, joint_count, buf[v * 4]), model_joint(joint_table, joint_count, buf[v * 4 + 1]), 
+                                                           model_joint(joint_table, joint_count, buf[v * 4 + 2]), model_joint(joint_table, joint_count, buf[v * 4 + 3])};
+                                break;
+                            }
+                                
+                            case UNSIGNED_BYTE:
+                            {
+                                const uint8_t *buf = (const uint8_t *)joint_indices_buffer;
+                                joint_indices = (vec4f_t){model_joint(joint_table, joint_count, buf[v * 4]), model_joint(joint_table, joint_count, buf[v * 4 + 1]), 
+                                                          model_joint(joint_table, joint_count, buf[v * 4 + 2]), model_joint(joint_table, joint_count, buf[v * 4 + 3])};
+                                break;
+                            }
+                        }
+                        vert->joint_indices = joint_indices;
+                    }
+
+                    //joint weights
+                    vec4f_t joint_weights = {0};
+                    if (has_skin){
+                        joint_weights = (vec4f_t){joint_weights_buffer[v * 4], joint_weights_buffer[v * 4 + 1], joint_weights_buffer[v * 4 + 2], joint_weights_buffer[v * 4 + 3]};
+                    }
+                    vert->joint_weights = joint_weights;
+                }
+            }
+
+            //indices
+            {
+                gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->indices];
+                gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+                gltf_buffer_t *buffer     = &gltf_model->buffers[bv->buffer];
+                
+                prim_index_count = accessor->count;
+
+                switch (accessor->component_type)
+                {
+                    case UNSIGNED_BYTE:
+                    {
+                        const uint8_t *buf = (const uint8_t *)(&buffer->data[accessor->byte_offset + bv->byte_offset]);
+                        for (uint32_t index = 0; index < accessor->count; index++) {
+                            index_buffer_data[index_count++] = buf[index] + vertex_start;
+                        }
+                        break;
+                    }
+
+                    case UNSIGNED_SHORT:
+                    {
+                        const uint16_t *buf = (const uint16_t *)(&buffer->data[accessor->byte_offset + bv->byte_offset]);
+                        for (uint32_t index = 0; index < accessor->count; index++){
+                            index_buffer_data[index_count++] = buf[index] + vertex_start;
+                        }
+                        break;
+                    }
+
+                    case UNSIGNED_INT:
+                    {
+                        const uint32_t *buf = (const uint32_t *)(&buffer->data[accessor->byte_offset + bv->byte_offset]);
+                        for (uint32_t index = 0; index < accessor->count; index++){
+                            index_buffer_data[index_count++] = buf[index] + vertex_start;
+                        }
+                        break;
+                    }
+                    default:
+                        assert(false);
+                        break;
+                }
+            }
+
+            primitive->first_index = first_index;
+            primitive->index_count = prim_index_count;
+            primitive->material    = gltf_primitive->material;
+        }
+    }
+
+    geometry->vertices     = vertex_buffer_data;
+    geometry->vertex_count = (uint32_t)vertex_count;
+    geometry->indices      = index_buffer_data;
+    geometry->index_count  = (uint32_t)index_count;
+}
+
+void model_remap_skinned_joints(skinned_geometry_t *geometry, const uint32_t *joint_table, uint32_t joint_count)
+{
+    bool identity = true;
+    for (uint32_t i = 0; i < joint_count && identity; i++) {
+        identity = joint_table[i] == i;
+    }
+    if (identity) return;
+
+    for (uint32_t i = 0; i < geometry->vertex_count; i++) {
+        //the conversion left every joint inside the skin
+        float *joints = &geometry->vertices[i].joint_indices.x;
+        for (uint32_t j = 0; j < 4; j++) {
+            joints[j] = (float)joint_table[(uint32_t)joints[j]];
+        }
+    }
+}
+
+void model_release_gltf(gltf_model_t *gltf_model)
+{
+    model_unmap_buffers(gltf_model);
+    unmap_whole_file(&gltf_model->file);
+    //the model goes with its arena
+    json_arena_t arena = gltf_model->arena;
+    json_arena_release(&arena);
+}
+
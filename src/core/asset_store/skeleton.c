@@ -0,0 +1,292 @@
+#include <asset_types.h>
+#include <skeleton.h>
+#include <animation.h>
+#include <animation_compression.h>
+#include <string_utils.h>
+#include <cooked_model.h>
+
+//! @brief: parent of every gltf node, and the nodes in the parent before child order the skeleton stores them in
+static void skeleton_order_gltf_nodes(const gltf_model_t *gltf_model, uint32_t *parents, uint32_t *order)
+{
+    uint32_t count = gltf_model->node_count;
+    assert(count <= MAX_NODES_PER_MODEL);
+
+    for (uint32_t i = 0; i < count; i++) {
+        parents[i] = UINT32_MAX;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        gltf_node_t *gltf_node = &gltf_model->nodes[i];
+        for (uint32_t j = 0; j < gltf_node->child_count; j++) {
+            parents[gltf_node->children[j]] = i;
+        }
+    }
+
+    //breadth first from every root, the queue ends up in parent before child order
+    uint32_t order_count = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (parents[i] == UINT32_MAX) order[order_count++] = i;
+    }
+    for (uint32_t head = 0; head < order_count; head++) {
+        gltf_node_t *gltf_node = &gltf_model->nodes[order[head]];
+        for (uint32_t j = 0; j < gltf_node->child_count && order_count < count; j++) {
+            order[order_count++] = gltf_node->children[j];
+        }
+    }
+    assert(order_count == count && "gltf node hierarchy is not a forest");
+}
+
+//! @brief: nodes are stored parent before child so global transforms are one pass in index order.
+//          remap takes a gltf node index to its index in the skeleton.
+static void skeleton_load_nodes(gltf_model_t *gltf_model, skeleton_t *skeleton, uint32_t *remap)
+{
+    uint32_t count = gltf_model->node_count;
+    skeleton->node_count = count;
+
+    uint32_t parents[MAX_NODES_PER_MODEL];
+    uint32_t order[MAX_NODES_PER_MODEL];
+    skeleton_order_gltf_nodes(gltf_model, parents, order);
+    for (uint32_t i = 0; i < count; i++) {
+        remap[order[i]] = i;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        model_node_t *node = &skeleton->nodes[i];
+        uint32_t gltf_index = order[i];
+        gltf_node_t *gltf_node = &gltf_model->nodes[gltf_index];
+
+        affine_from_mat4(&gltf_node->local_transform, &node->local_transform);
+        node->index = i;
+        node->parent = parents[gltf_index] == UINT32_MAX ? UINT32_MAX : remap[parents[gltf_index]];
+        node->skin = gltf_node->skin;
+        node->mesh = gltf_node->mesh;
+        node->translation  = gltf_node->translation;
+        node->scale = gltf_node->scale;
+        node->rotation = gltf_node->rotation;
+        skeleton->node_names[i] = string_hash(gltf_node->name);
+        skeleton->leaf_nodes[i] = true;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (skeleton->nodes[i].parent != UINT32_MAX) skeleton->leaf_nodes[skeleton->nodes[i].parent] = false;
+    }
+}
+
+static void skeleton_load_skin(gltf_model_t *gltf_model, skeleton_t *skeleton, const uint32_t *remap)
+{
+    assert((gltf_model->skin_count <= 1) && "gltf model has multiple skins");
+
+    skin_t *skin = &skeleton->skin;
+    memset(skin, 0, sizeof(*skin));
+    if (gltf_model->skin_count == 0) return;
+
+    gltf_skin_t *gltf_skin = &gltf_model->skins[0];
+
+    skin->joint_count = gltf_skin->joint_count;
+    assert(skin->joint_count <= MAX_BONES_PER_SKIN);
+    for (uint32_t i = 0; i < skin->joint_count; i++) {
+        skin->joints[i] = (uint8_t)remap[gltf_skin->joints[i]];
+    }
+    if (gltf_skin->skeleton < skeleton->node_count) {
+        skin->skeleton_root = (uint8_t)remap[gltf_skin->skeleton];
+    }
+
+    //inverse bind matrices
+    if (gltf_skin->inverse_bind_matrices != UINT32_MAX) {
+        gltf_accessor_t *accessor = &gltf_model->accessors[gltf_skin->inverse_bind_matrices];
+        gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+        gltf_buffer_t      *buf   = &gltf_model->buffers[bv->buffer];
+
+        const uint8_t *data = &buf->data[accessor->byte_offset + bv->byte_offset];
+        for (uint32_t i = 0; i < accessor->count && i < MAX_BONES_PER_SKIN; i++) {
+            mat4f_t inverse_bind;
+            memcpy(&inverse_bind, data + i * sizeof(mat4f_t), sizeof(mat4f_t));
+            affine_from_mat4(&inverse_bind, &skin->inverse_bind_matrices[i]);
+        }
+    }
+}
+
+static bool skeleton_load_animations(skeleton_t *skeleton, 
+                                     gltf_model_t *gltf_model, 
+                                     const uint32_t *remap, 
+                                     const animation_compression_config_t *compression)
+{
+    for (uint32_t i = 0; i < gltf_model->animation_count; i++) {
+        if (skeleton->animation_count >= MAX_ANIMATIONS_PER_MODEL) {
+            LOGE("Skeleton has too many animations, dropping %u from %s", gltf_model->animation_count - i, gltf_model->path);
+            break;
+        }
+
+        animation_t *animation = &skeleton->animations[skeleton->animation_count];
+        if (!animation_create_from_gltf(animation, gltf_model, i, remap)) {
+            return false;
+        }
+
+        if (compression->enabled) {
+            animation_t compressed = {0};
+            if (animation_compress(animation, compression, &compressed)) {
+                animation_destroy(animation);
+                *animation = compressed;
+            } else {
+                LOGE("Unable to compress animation %u, keeping it uncompressed", i);
+            }
+        }
+        skeleton->animation_count++;
+    }
+    return true;
+}
+
+bool skeleton_create(skeleton_t *skeleton, gltf_model_t *gltf_model, const animation_compression_config_t *compression, uint32_t *remap)
+{
+    memset(skeleton, 0, sizeof(*skeleton));
+
+    skeleton_load_nodes(gltf_model, skeleton, remap);
+    skeleton_load_skin(gltf_model, skeleton, remap);
+    if (!skeleton_load_animations(skeleton, gltf_model, remap, compression)) {
+        LOGE("Unable to load animations of %s", gltf_model->path);
+        skeleton_destroy(skeleton);
+        return false;
+    }
+    return true;
+}
+
+bool skeleton_create_cooked(skeleton_t *skeleton, const cooked_model_t *cooked)
+{
+    memset(skeleton, 0, sizeof(*skeleton));
+
+    const cooked_model_header_t *header = cooked->header;
+    skeleton->node_count = header->node_count;
+    memcpy(skeleton->nodes, cooked->nodes, header->node_count * sizeof(model_node_t));
+    memcpy(skeleton->node_names, cooked->node_names, header->node_count * sizeof(uint64_t));
+    memcpy(skeleton->leaf_nodes, cooked->leaf_nodes, header->node_count * sizeof(bool));
+    skeleton->skin = *cooked->skin;
+
+    for (uint32_t i = 0; i < header->animation_count; i++) {
+        if (!cooked_model_load_animation(cooked, i, &skeleton->animations[i])) {
+            skeleton_destroy(skeleton);
+            return false;
+        }
+        skeleton->animation_count++;
+    }
+    return true;
+}
+
+void skeleton_destroy(skeleton_t *skeleton)
+{
+    for (uint32_t i = 0; i < skeleton->animation_count; i++) {
+        animation_destroy(&skeleton->animations[i]);
+    }
+    skeleton->animation_count = 0;
+}
+
+/**
+ * @brief: binds nodes stored parent before child, named by their string_hash, 0 for no name. A name that is missing
+ *         or that more than one node carries can't be bound, the nodes are then bound by index if both hierarchies
+ *         are the same and the bind fails otherwise.
+ */
+static bool skeleton_bind_nodes(const skeleton_t *skeleton, const uint64_t *names, const uint32_t *parents, uint32_t count, uint32_t *remap)
+{
+    bool same_hierarchy = count == skeleton->node_count;
+    for (uint32_t i = 0; i < count && same_hierarchy; i++) {
+        same_hierarchy = parents[i] == skeleton->nodes[i].parent;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        remap[i] = UINT32_MAX;
+        const char *error = names[i] == 0 ? "has no name" : NULL;
+        for (uint32_t j = 0; j < i && !error; j++) {
+            if (names[j] == names[i]) error = "has the name of another node";
+        }
+        for (uint32_t j = 0; j < skeleton->node_count && !error; j++) {
+            if (skeleton->node_names[j] != names[i]) continue;
+            if (remap[i] != UINT32_MAX) error = "matches more than one skeleton node";
+            remap[i] = j;
+        }
+        if (!error) continue;
+
+        if (same_hierarchy) {
+            for (uint32_t j = 0; j < count; j++) {
+                remap[j] = j;
+            }
+            return true;
+        }
+        LOGE("Unable to bind nodes to the skeleton, node %u %s", i, error);
+        return false;
+    }
+    return true;
+}
+
+bool skeleton_bind_gltf_nodes(const skeleton_t *skeleton, const gltf_model_t *gltf_model, uint32_t *remap)
+{
+    //put the file's nodes in the order a skeleton created from it would have
+    uint32_t count = gltf_model->node_count;
+    uint32_t parents[MAX_NODES_PER_MODEL];
+    uint32_t order[MAX_NODES_PER_MODEL];
+    uint32_t position[MAX_NODES_PER_MODEL];
+    skeleton_order_gltf_nodes(gltf_model, parents, order);
+    for (uint32_t i = 0; i < count; i++) {
+        position[order[i]] = i;
+    }
+
+    uint64_t names[MAX_NODES_PER_MODEL] = {0};
+    uint32_t ordered_parents[MAX_NODES_PER_MODEL] = {0};
+    uint32_t bound[MAX_NODES_PER_MODEL];
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t parent    = parents[order[i]];
+        names[i]           = string_hash(gltf_model->nodes[order[i]].name);
+        ordered_parents[i] = parent == UINT32_MAX ? UINT32_MAX : position[parent];
+    }
+    if (!skeleton_bind_nodes(skeleton, names, ordered_parents, count, bound)) return false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        remap[i] = bound[position[i]];
+    }
+    return true;
+}
+
+bool skeleton_bind_cooked_nodes(const skeleton_t *skeleton, const cooked_model_t *cooked, uint32_t *remap)
+{
+    uint32_t count = cooked->header->node_count;
+    uint32_t parents[MAX_NODES_PER_MODEL];
+    for (uint32_t i = 0; i < count; i++) {
+        parents[i] = cooked->nodes[i].parent;
+    }
+    return skeleton_bind_nodes(skeleton, cooked->node_names, parents, count, remap);
+}
+
+bool skeleton_add_animations(skeleton_t *skeleton, gltf_model_t *gltf_model, const animation_compression_config_t *compression)
+{
+    uint32_t *remap = memory_alloc(MAX(gltf_model->node_count, 1) * sizeof(uint32_t), MEM_TAG_TEMP);
+    if (!skeleton_bind_gltf_nodes(skeleton, gltf_model, remap)) {
+        LOGE("Unable to bind the nodes of %s to the skeleton", gltf_model->path);
+        return false;
+    }
+    return skeleton_load_animations(skeleton, gltf_model, remap, compression);
+}
+
+uint32_t skeleton_find_joint(const skeleton_t *skeleton, uint32_t node)
+{
+    for (uint32_t i = 0; i < skeleton->skin.joint_count; i++) {
+        if (skeleton->skin.joints[i] == node) return i;
+    }
+    return UINT32_MAX;
+}
+
+bool skeleton_build_joint_table(const skeleton_t *skeleton, const gltf_model_t *gltf_model, const uint32_t *node_remap, uint32_t *joint_table)
+{
+    if (gltf_model->skin_count == 0) return true;
+
+    const gltf_skin_t *gltf_skin = &gltf_model->skins[0];
+    if (gltf_skin->joint_count > MAX_BONES_PER_SKIN) {
+        LOGE("Skin of %s has %u joints, at most %u are supported", gltf_model->path, gltf_skin->joint_count, MAX_BONES_PER_SKIN);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < gltf_skin->joint_count; i++) {
+        uint32_t node = node_remap[gltf_skin->joints[i]];
+        joint_table[i] = node == UINT32_MAX ? UINT32_MAX : skeleton_find_joint(skeleton, node);
+        if (joint_table[i] == UINT32_MAX) {
+            LOGE("Joint %s of %s is not a joint of its skeleton", gltf_model->nodes[gltf_skin->joints[i]].name, gltf_model->path);
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,655 +1,420 @@
 #include <asset_types.h>
 #include <renderer_types.h>
 #include <skinned_model.h>
+#include <animation.h>
+#include <skeleton.h>
+#include <cooked_model.h>
+#include <asset_store.h>
+#include <jobs.h>
 
-static void skinned_model_init_material(material_t *material) 
+#include <stb/stb_image.h>
+#include <time.h>
+
+static double skinned_model_now(void)
 {
-    material->alpha_mode = OPAQUE;
-
-    material->base_color_texture = UINT32_MAX;
-    material->metallic_roughness_texture = UINT32_MAX;
-    material->normal_texture = UINT32_MAX;
-    material->occlusion_texture = UINT32_MAX;
-    material->emissive_texture = UINT32_MAX;
-
-    material->base_color_factor = (vec4f_t){1.0f, 1.0f, 1.0f, 1.0f};
-    material->emissive_factor = (vec3f_t){1.0f, 1.0f, 1.0f};
-
-    material->metallic_factor = 1.0f;
-    material->roughness_factor = 1.0f;
-    material->normal_scale = 1.0f;
-    material->occlusion_strength = 1.0f;
-    material->alpha_cut_off = 0.5f;
-    
-    material->specular_texture = UINT32_MAX;
-    material->specular_color_texture = UINT32_MAX;
-    material->specular_factor = 1.0f;
-    material->specular_color_factor = (vec3f_t){1.0f, 1.0f, 1.0f};
-
-    material->double_sided = false;
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
 }
 
-static void skinned_model_load_materials(gltf_model_t *gltf_model, skinned_model_t *model, uint32_t *textures, uint32_t texture_count)
+static void skinned_model_decode_image(void *data)
 {
-    assert(gltf_model->material_count <= MAX_MATERIALS_PER_MODEL);
-    model->material_count = gltf_model->material_count;
-
-    for (uint32_t i = 0; i < model->material_count; i++) {
-        material_t *material = &model->materials[i];
-        gltf_material_t *gltf_material = &gltf_model->materials[i];
-
-        skinned_model_init_material(material);
-
-        material->alpha_mode = (alpha_mode_e)gltf_material->alpha_mode;
-
-        //do pbr metallic roughness
-        gltf_pbr_metallic_roughness_t *pbr_metallic_roughness = gltf_material->pbr_metallic_roughness;
-        if (pbr_metallic_roughness) {
-            gltf_texture_info_t *base_color_texture = &gltf_material->pbr_metallic_roughness->base_color_texture;
-            gltf_texture_info_t *metallic_roughness_texture = &gltf_material->pbr_metallic_roughness->metallic_roughness_texture;
-
-            if (metallic_roughness_texture->index != UINT32_MAX) {
-                material->metallic_roughness_texture = textures[gltf_model->textures[metallic_roughness_texture->index].source];
-            }
-            
-            if (base_color_texture->index != UINT32_MAX) {
-                material->base_color_texture = textures[gltf_model->textures[base_color_texture->index].source];
-            }
-
-            material->base_color_factor = pbr_metallic_roughness->base_color_factor;
-            material->metallic_factor = pbr_metallic_roughness->metallic_factor;
-            material->roughness_factor = pbr_metallic_roughness->roughness_factor;
-        }
-
-        //do normal_texture
-        gltf_normal_texture_info_t *normal_texture = gltf_material->normal_texture;
-        if (normal_texture) {
-            material->normal_texture = textures[gltf_model->textures[normal_texture->index].source];
-            material->normal_scale = normal_texture->scale;
-        }
-
-        gltf_occlusion_texture_info_t *occlusion_texture = gltf_material->occlusion_texture;
-        if (occlusion_texture) {
-            material->occlusion_texture = textures[gltf_model->textures[occlusion_texture->index].source];
-            material->occlusion_strength = occlusion_texture->strength;
-        }
-
-        gltf_specular_t *specular = gltf_material->specular;
-        if (specular) {
-            material->specular_texture = textures[gltf_model->textures[specular->specular_texture.index].source];
-            material->specular_color_texture = textures[gltf_model->textures[specular->specular_color_texture.index].source];
-            material->specular_color_factor = gltf_material->specular->specular_color_factor;
-            material->specular_factor = gltf_material->specular->specular_factor;
-        }
+    skinned_model_image_t *image = (skinned_model_image_t *)data;
+    double start = skinned_model_now();
+    int channels;
+    image->pixels  = stbi_load(image->path, &image->width, &image->height, &channels, 4);
+    image->time    = skinned_model_now() - start;
+    image->decoded = true;
+}
 
-        gltf_texture_info_t *emissive_texture = gltf_material->emissive_texture;
-        if (emissive_texture) {
-            material->emissive_texture = textures[gltf_model->textures[emissive_texture->index].source];
+//! @brief: decodes the images that are marked for it and weren't yet, in parallel
+static void skinned_model_decode_images(skinned_model_image_t *images, uint32_t count)
+{
+    job_counter_t decoding = {0};
+    for (uint32_t i = 0; i < count; i++) {
+        if (images[i].decode && !images[i].decoded) {
+            jobs_submit(skinned_model_decode_image, &images[i], &decoding);
         }
-
-        material->emissive_factor = gltf_material->emissive_factor;
-        material->double_sided = gltf_material->double_sided;
     }
+    jobs_wait(&decoding);
+}
+
+//! @brief: records a texture reference of the model, released with it
+static void skinned_model_add_texture(skinned_model_t *model, uint32_t texture)
+{
+    assert(model->texture_count < MAX_TEXTURES_PER_MODEL);
+    model->textures[model->texture_count++] = texture;
 }
 
-static void skinned_model_load_textures(gltf_model_t *gltf_model, 
+static void skinned_model_load_textures(skinned_model_source_t *source, 
                                         skinned_model_t *model, 
+                                        asset_store_t *asset_store,
                                         renderer_t *renderer, 
                                         uint32_t **texture_indices,
                                         uint32_t *texture_index_count)
 {
-    uint32_t count  = gltf_model->image_count;
+    uint32_t count  = source->gltf_model->image_count;
     assert(count <= MAX_TEXTURES_PER_MODEL);
 
     uint32_t *textures = memory_alloc(count * sizeof(uint32_t), MEM_TAG_TEMP);
 
+    //images another model loaded already are shared, the others decoded in parallel if they are png or jpg and
+    //weren't decoded with the read, and left to the renderer otherwise
+    skinned_model_image_t *images = source->images;
+    for (uint32_t i = 0; i < count; i++) {
+        textures[i] = UINT32_MAX;
+        if (!images[i].path) continue;
+        textures[i] = asset_store_acquire_shared(&asset_store->shared_textures, images[i].key);
+        if (textures[i] != UINT32_MAX) images[i].decode = false;
+    }
+    skinned_model_decode_images(images, count);
+
+    model->texture_count = 0;
     for (uint32_t i = 0; i < count; i++) {
+        skinned_model_image_t *image = &images[i];
+        if (!image->path) continue;
+        if (textures[i] == UINT32_MAX) {
+            //the model may list a file twice
+            textures[i] = asset_store_acquire_shared(&asset_store->shared_textures, image->key);
+        }
+        if (textures[i] != UINT32_MAX) {
+            if (image->pixels) stbi_image_free(image->pixels);
+            image->pixels = NULL;
+            skinned_model_add_texture(model, textures[i]);
+            continue;
+        }
+
         textures[i] = bulk_data_allocate_slot_texture_t(renderer->textures);
         texture_t *texture = bulk_data_getp_null_texture_t(renderer->textures, textures[i]);
-        renderer_create_texture(renderer, texture, gltf_model->image_paths[i]);
+        bool created = false;
+        if (image->pixels) {
+            LOGI("Decoded %s, %dx%d in %.2f ms", image->path, image->width, image->height, image->time * 1e3);
+            created = renderer_create_texture_from_pixels(renderer, texture, image->pixels, (uint32_t)image->width, (uint32_t)image->height);
+            stbi_image_free(image->pixels);
+            image->pixels = NULL;
+        } else if (!image->decode) {
+            created = renderer_create_texture(renderer, texture, image->path);
+        }
+        if (!created) {
+            LOGE("Unable to load texture from file: %s", image->path);
+            //materials that use the image fall back to their factors
+            bulk_data_delete_item_texture_t(renderer->textures, textures[i]);
+            textures[i] = UINT32_MAX;
+            continue;
+        }
+        asset_store_add_shared(&asset_store->shared_textures, image->key, textures[i], texture->size);
+        skinned_model_add_texture(model, textures[i]);
     }
 
     *texture_indices = textures;
     *texture_index_count = count;
 }
 
-static void skinned_model_assign_parent_to_node(model_node_t *model_node, 
-                                                skinned_model_t *model, 
-                                                gltf_node_t *gltf_nodes, 
-                                                uint32_t parent, 
-                                                uint32_t node_index)
+//! @brief: renderbuffer of data, shared with every model that uploaded the same bytes, UINT32_MAX when it can't be created
+static uint32_t skinned_model_upload_buffer(asset_store_t *asset_store, renderer_t *renderer, renderbuffer_type_e type, const void *data, uint32_t size)
 {
-    model_node->parent = parent;
-
-    gltf_node_t *gltf_node = &gltf_nodes[node_index];
-    for (uint32_t i = 0; i < gltf_node->child_count; i++) {
-        uint32_t child_index = gltf_node->children[i];
-        skinned_model_assign_parent_to_node(&model->nodes[child_index], model, gltf_nodes, node_index, child_index);
+    asset_key_t key = asset_store_content_key(data, size, type);
+    uint32_t slot   = asset_store_acquire_shared(&asset_store->shared_renderbuffers, key);
+    if (slot != UINT32_MAX) return slot;
+
+    slot = bulk_data_allocate_slot_renderbuffer_t(renderer->renderbuffers);
+    renderbuffer_t *buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, slot);
+    if (!renderer_create_renderbuffer(renderer, buffer, type, (uint8_t *)data, size)) {
+        LOGE("Unable to create renderbuffer of %u bytes", size);
+        bulk_data_delete_item_renderbuffer_t(renderer->renderbuffers, slot);
+        return UINT32_MAX;
     }
+    asset_store_add_shared(&asset_store->shared_renderbuffers, key, slot, buffer->size * MAX(buffer->buffer_count, 1));
+    return slot;
 }
 
-static void skinned_model_load_nodes(gltf_model_t *gltf_model, skinned_model_t *model)
+//! @brief: false when a buffer can't be created, the caller releases the one that was
+static bool skinned_model_upload_geometry(skinned_model_t *model, const skinned_geometry_t *geometry, asset_store_t *asset_store, renderer_t *renderer)
 {
-    model->node_count = gltf_model->node_count;
-    assert(model->node_count <= MAX_NODES_PER_MODEL);
-
-    for (uint32_t i = 0; i < gltf_model->node_count; i++) {
-        model_node_t *node = &model->nodes[i];
-        gltf_node_t *gltf_node = &gltf_model->nodes[i];
-
-        node->local_transform = gltf_node->local_transform;
-        node->index = i;
-        node->skin = gltf_node->skin;
-        node->mesh = gltf_node->mesh;
-        node->translation  = gltf_node->translation;
-        node->scale = gltf_node->scale;
-        node->rotation = gltf_node->rotation;
-    }
-
-    //! we only allow 1 scene.
-    uint32_t root_index = gltf_model->scenes[0].nodes[0];
-    model_node_t *root = &model->nodes[root_index];
-    skinned_model_assign_parent_to_node(root, model, gltf_model->nodes, UINT32_MAX, root_index);
+    model->vertex_buffer = skinned_model_upload_buffer(asset_store, renderer, RENDERBUFFER_TYPE_VERTEX_BUFFER, geometry->vertices, geometry->vertex_count * sizeof(skinned_vertex_t));
+    model->index_buffer  = skinned_model_upload_buffer(asset_store, renderer, RENDERBUFFER_TYPE_INDEX_BUFFER, geometry->indices, geometry->index_count * sizeof(uint32_t));
+    return model->vertex_buffer != UINT32_MAX && model->index_buffer != UINT32_MAX;
 }
 
-static void skinned_model_load_skins(gltf_model_t *gltf_model, skinned_model_t *model, renderer_t *renderer)
+bool skinned_model_create_instance(const skinned_model_t *model, 
+                                   const skeleton_t *skeleton, 
+                                   animated_instance_t *instance, 
+                                   renderer_t *renderer)
 {
-    assert((gltf_model->skin_count == 1) && "gltf model has multiple skins");
+    assert(!instance->rendering_data && "instance already has render data");
 
-    gltf_skin_t *gltf_skin = &gltf_model->skins[0];
-    skin_t *skin = &model->skin;
-    memset(skin, 0, sizeof(*skin));
-
-    skin->joint_count = gltf_skin->joint_count;
-    assert(skin->joint_count <= MAX_BONES_PER_SKIN);
-    memmove(skin->joints, gltf_skin->joints, skin->joint_count);
-    skin->skeleton_root = gltf_skin->skeleton;
+    //the skinning shader samples a base color, a model whose texture failed to load has none
+    if (model->material_count == 0 || model->materials[0].base_color_texture == UINT32_MAX) {
+        LOGE("Skinned model has no base color texture to draw with");
+        return false;
+    }
 
-    //inverse bind matrices
-    if (gltf_skin->inverse_bind_matrices != UINT32_MAX) {
-        gltf_accessor_t *accessor = &gltf_model->accessors[gltf_skin->inverse_bind_matrices];
-        gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-        gltf_buffer_t      *buf   = &gltf_model->buffers[bv->buffer];
+    //the compiled skinning shader reads a mat4 array, animation_write_palette expands the affine joints into it
+    uint32_t ssbo_size = MAX(skeleton->skin.joint_count, 1) * sizeof(mat4f_t);
+    instance->ssbo = bulk_data_allocate_slot_renderbuffer_t(renderer->renderbuffers);
 
-        memmove(skin->inverse_bind_matrices, &buf->data[accessor->byte_offset + bv->byte_offset], accessor->count * sizeof(mat4f_t));
+    renderbuffer_t *ssbo = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, instance->ssbo);
+    if (!renderer_create_renderbuffer(renderer, ssbo, RENDERBUFFER_TYPE_STORAGE_BUFFER, NULL, ssbo_size)) {
+        LOGE("Unable to create joint palette for animated instance");
+        return false;
+    }
+    assert(ssbo->buffer_count <= MAX_PALETTE_BUFFERS && "animated instance tracks fewer palette buffers than frames in flight");
 
-        VkDeviceSize ssbo_size = skin->joint_count * sizeof(mat4f_t);
-        skin->ssbo = bulk_data_allocate_slot_renderbuffer_t(renderer->renderbuffers);
+    //! @TODO: Need to think about models with multiple meshes and materials.
+    render_data_config_t config = {0};
+    config.type = RENDER_DATA_SKINNED_MODEL;
+    config.buffer_count       = ssbo->buffer_count;
+    for (uint32_t i = 0; i < config.buffer_count; i++) {
+        config.buffer_indices[i] = ssbo->buffers[i];
+    }
+    config.texture_count      = 1;
+    config.texture_indices[0] = model->materials[0].base_color_texture;
 
-        renderbuffer_t *ssbo = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, skin->ssbo);
-        renderer_create_renderbuffer(renderer, ssbo, RENDERBUFFER_TYPE_STORAGE_BUFFER, NULL, ssbo_size);
+    instance->rendering_data = renderer_create_render_data(renderer, RENDER_DATA_SKINNED_MODEL, &config);
+    if (!instance->rendering_data) {
+        LOGE("Unable to create render data for animated instance");
+        return false;
     }
+
+    return true;
 }
 
-static void skinned_model_load_animations(gltf_model_t *gltf_model, skinned_model_t *model)
+void skinned_model_destroy_instance(bulk_data_animated_instance_t *instances, uint32_t index, asset_store_t *asset_store, renderer_t *renderer)
 {
-    model->animation_count = gltf_model->animation_count; 
-    assert(gltf_model->animation_count <= MAX_ANIMATIONS_PER_MODEL && "model has too many animations");
-
-    for (uint32_t i = 0; i < model->animation_count; i++) {
-        gltf_animation_t *gltf_animation = &gltf_model->animations[i];
-
-        animation_t *animation = &model->animations[i];
-
-        animation->sampler_count = gltf_animation->sampler_count;
-        animation->channel_count = gltf_animation->channel_count;
-        animation->samplers = memory_alloc(animation->sampler_count * sizeof(animation_sampler_t), MEM_TAG_HEAP);
-        animation->channels = memory_alloc(animation->channel_count * sizeof(animation_channel_t), MEM_TAG_HEAP);
-
-        animation->start_time = INFINITY;
-        animation->end_time = -INFINITY;
-
-        //samplers
-        for (uint32_t j = 0; j < animation->sampler_count; j++) {
-            gltf_animation_sampler_t *gltf_sampler = &gltf_animation->samplers[j];
-
-            animation_sampler_t *sampler = &animation->samplers[j];
-
-            sampler->interpolation = gltf_sampler->interpolation;
-
-            //sampler keyframe and input time values
-            {
-                gltf_accessor_t *accessor = &gltf_model->accessors[gltf_sampler->input];
-                gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                gltf_buffer_t *buffer     = &gltf_model->buffers[bv->buffer];
-                const void *data          = &buffer->data[accessor->byte_offset + bv->byte_offset];
-                const float *dst          = (const float*)data;
-
-                sampler->input_count = accessor->count;
-                assert(sampler->input_count <= MAX_ANIMATION_SAMPLER_INPUT_COUNT);
-                memcpy(sampler->inputs, dst, sampler->input_count * sizeof(float));
-
-                for (uint32_t k = 0; k < sampler->input_count; k++)
-                {
-                    float input = sampler->inputs[k];
-                    if (input < animation->start_time)
-                    {
-                        animation->start_time = input;
-                    }
-                    if (input > animation->end_time)
-                    {
-                        animation->end_time = input;
-                    }
-                }
-            }
-
-            //read sampler keyframe output translate/rotate/scale values
-            {
-                gltf_accessor_t *accessor = &gltf_model->accessors[gltf_sampler->output];
-                gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                gltf_buffer_t *buffer     = &gltf_model->buffers[bv->buffer];
-                const void *data          = &buffer->data[accessor->byte_offset + bv->byte_offset];
-
-                assert(accessor->count <= MAX_ANIMATION_SAMPLER_OUTPUT_COUNT);
-
-                switch(accessor->type) 
-                {
-                    case VEC3: 
-                    {
-                        const vec3f_t *buf = (const vec3f_t *)data;
-                        for (uint32_t index = 0; index < accessor->count; index++) {
-                            const vec3f_t *vec3 = &buf[index];
-                            vec4f_t *vec4 = &sampler->outputs[index];
-                            vec4->x = vec3->x;
-                            vec4->y = vec3->y;
-                            vec4->z = vec3->z;
-                            vec4->w = 0;
-                        }
-                        break;
-                    }
-                    case VEC4:
-                    {
-                        const vec4f_t *buf = (const vec4f_t*)data;
-                        memcpy(sampler->outputs, buf, accessor->count * sizeof(vec4f_t));
-                        break;
-                    }
-                }
-            }
-        }
-
-        //channels
-        for (uint32_t k = 0; k < animation->channel_count; k++) {
-            gltf_channel_t *gltf_channel = &gltf_animation->channels[k];
-            animation_channel_t *channel = &animation->channels[k];
-
-            channel->path    = gltf_channel->path;
-            channel->sampler = gltf_channel->sampler;
-            channel->node    = gltf_channel->node;
-        }
-    }
+    animated_instance_t *instance = bulk_data_getp_null_animated_instance_t(instances, index);
+    if (!instance) return;
+
+    //frames in flight may still read the palette through the descriptor sets
+    asset_store_retire(asset_store, renderer, ASSET_TYPE_RENDERBUFFER, instance->ssbo, RENDER_DATA_SKINNED_MODEL, instance->rendering_data);
+    instance->ssbo           = UINT32_MAX;
+    instance->rendering_data = NULL;
+    bulk_data_delete_item_animated_instance_t(instances, index);
 }
 
-static void skinned_model_get_node_matrix(skinned_model_t *model, model_node_t *model_node, mat4f_t *out)
+mat4f_t *skinned_model_map_palette(const animated_instance_t *instance, renderer_t *renderer)
 {
-    mat4f_t node_matrix = model_node->local_transform;
-    transform_from_TRS(&node_matrix, model_node->translation, model_node->rotation, model_node->scale);
-
-    uint32_t current_parent = model_node->parent;
-    while (current_parent != UINT32_MAX) {
-        model_node_t *parent_node = &model->nodes[current_parent];
-        mat4f_t parent_mat = parent_node->local_transform;
-        transform_from_TRS(&parent_mat, parent_node->translation, parent_node->rotation, parent_node->scale);
-
-        mat4f_t temp = node_matrix;
-        mat4_multiply(&temp, &parent_mat, &node_matrix);
-        current_parent = parent_node->parent;
-    }
-    *out = node_matrix;
+    renderbuffer_t *ssbo = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, instance->ssbo);
+    return (mat4f_t *)renderer_map_renderbuffer(renderer, ssbo);
 }
 
-static void skinned_model_update_joints(skinned_model_t *model, model_node_t *node, renderer_t *renderer)
+void skinned_model_draw(const skinned_model_t *model, 
+                        const animated_instance_t *instance,
+                        renderer_t *renderer, 
+                        shader_t *shader)
 {
-    if (node->skin != UINT32_MAX) {
-        mat4f_t local_transform = {0};
-        skinned_model_get_node_matrix(model, node, &local_transform);
-
-        mat4f_t inverse_transform = {0};
-        mat4_inverse(&local_transform, &inverse_transform);
+    renderbuffer_t *vertex_buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, model->vertex_buffer);
+    renderer_bind_vertex_buffers(renderer, vertex_buffer);
 
-        skin_t *skin = &model->skin;
-        uint32_t joint_count    = skin->joint_count;
+    renderbuffer_t *index_buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, model->index_buffer);
+    renderer_bind_index_buffers(renderer, index_buffer);
 
-        mat4f_t *joint_matrices = memory_alloc(joint_count * sizeof(mat4f_t), MEM_TAG_TEMP);
+    mat4f_t node_matrix;
+    affine_to_mat4(&instance->global_matrices[model->mesh_node], &node_matrix);
+    renderer_push_constants(renderer, shader, &node_matrix, sizeof(mat4f_t), 0, SHADER_STAGE_VERTEX);
+    renderer_shader_bind_resource(renderer, SHADER_TYPE_SKINNED_GEOMETRY, RENDER_DATA_SKINNED_MODEL, instance->rendering_data);
+    //! TODO: draw all primitives
+    renderer_draw_indexed(renderer, 0, model->mesh.primitives[0].first_index, model->mesh.primitives[0].index_count, 0, 1);
+}
 
-        for (uint32_t i = 0; i < joint_count; i++) {
-            model_node_t *joint = &model->nodes[skin->joints[i]];
+bool skinned_model_read_gltf(skinned_model_source_t *source, const char *file_path, const char *asset_id, bool decode_images)
+{
+    memset(source, 0, sizeof(*source));
+    gltf_model_t *gltf_model = model_load_from_gltf(file_path, asset_id);
+    if (!gltf_model) {
+        LOGE("Unable to load gltf file: %s", file_path);
+        return false;
+    }
+    source->gltf_model = gltf_model;
+    if (gltf_model->mesh_count != 1 || gltf_model->image_count > MAX_TEXTURES_PER_MODEL) {
+        LOGE("%s has %u meshes and %u images, one mesh and at most %u images are supported", file_path,
+             gltf_model->mesh_count, gltf_model->image_count, MAX_TEXTURES_PER_MODEL);
+        skinned_model_release_source(source);
+        return false;
+    }
 
-            mat4f_t joint_mat = {0};
-            skinned_model_get_node_matrix(model, joint, &joint_mat);
+    //the skeleton isn't known yet, the vertices keep the skin's joints
+    model_load_skinned_geometry(gltf_model, NULL, &source->mesh, &source->geometry);
 
-            mat4f_t temp = {0};
-            mat4_multiply(&skin->inverse_bind_matrices[i], &joint_mat, &temp);
-            mat4_multiply(&temp, &inverse_transform, &joint_matrices[i]);
-        }
+    for (uint32_t i = 0; i < gltf_model->image_count; i++) {
+        skinned_model_image_t *image = &source->images[i];
+        image->path = gltf_model->image_paths[i];
+        if (!image->path) continue;
 
-        renderbuffer_t *ssbo = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, skin->ssbo);
-        renderer_copy_to_renderbuffer(renderer, ssbo, joint_matrices, joint_count * sizeof(mat4f_t));
+        const char *extension = string_find_last_of(image->path, ".");
+        image->key    = asset_store_file_key(image->path);
+        image->decode = extension && (strncmp(extension, "png", 3) == 0 || strncmp(extension, "jpg", 3) == 0);
+    }
+    if (decode_images) {
+        skinned_model_decode_images(source->images, gltf_model->image_count);
     }
+    return true;
 }
 
-static void skinned_model_load_meshes(gltf_model_t             *gltf_model, 
-                                      skinned_model_t          *model,
-                                      renderer_t               *renderer)
+void skinned_model_release_source(skinned_model_source_t *source)
 {
-    //allocate vertex and index buffers
-    //calculate total buffer size and number of indices
-    size_t index_count          = 0;
-    size_t vertex_count         = 0;
-
-    for (uint32_t i = 0; i < gltf_model->mesh_count; i++) {
-        index_count += gltf_model->index_counts[i];
-        vertex_count += gltf_model->vertex_counts[i];
+    for (uint32_t i = 0; i < MAX_TEXTURES_PER_MODEL; i++) {
+        if (source->images[i].pixels) stbi_image_free(source->images[i].pixels);
+        source->images[i].pixels = NULL;
     }
+    //the geometry is in the model's arena
+    if (source->gltf_model) model_release_gltf(source->gltf_model);
+    source->gltf_model = NULL;
+}
 
-    //vertex and index buffers for ALL meshes in the entire models
-    skinned_vertex_t *vertex_buffer_data = (skinned_vertex_t*)memory_alloc(vertex_count * sizeof(skinned_vertex_t), MEM_TAG_TEMP);
-    uint32_t *index_buffer_data  = (uint32_t*)memory_alloc(index_count * sizeof(uint32_t), MEM_TAG_TEMP);//we will just use 32 bit indices
-    
-    index_count  = 0;
-    vertex_count = 0;
-    assert(gltf_model->mesh_count == 1 && "Model has more than one mesh");
-
-    for (uint32_t i = 0; i < gltf_model->mesh_count; i++) {
-        
-        gltf_mesh_t *gltf_mesh = &gltf_model->meshes[i];
-        assert(gltf_mesh->primitive_count <= MAX_PRIMITIVES_PER_MESH && "Mesh has more than 4 primitives");
-
-        mesh_t *mesh = &model->mesh;
-
-        for (uint32_t j = 0; j < gltf_mesh->primitive_count; j++) {
-            gltf_mesh_primitive_t *gltf_primitive = &gltf_mesh->primitives[j];
-            mesh_primitive_t *primitive = &mesh->primitives[j];
-
-            uint32_t first_index      = index_count;
-            uint32_t vertex_start     = vertex_count;
-            uint32_t prim_index_count = 0;
-            bool has_skin = false;
-            {
-                const float *position_buffer         = NULL;
-                const float *normals_buffer          = NULL;
-                const float *tex_coords_buffer       = NULL;
-                const void *joint_indices_buffer     = NULL;
-                const float *joint_weights_buffer    = NULL;
-                uint32_t prim_vertex_count           = 0; 
-                uint32_t joint_indices_type = UNSIGNED_BYTE;
-
-                if (gltf_primitive->position != UINT32_MAX) {
-                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->position];
-                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                    position_buffer = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
-                    prim_vertex_count = accessor->count;
-                }
-
-                if (gltf_primitive->normal != UINT32_MAX) {
-                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->normal];
-                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                    normals_buffer = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
-                }
-
-                if (gltf_primitive->tex_coord != UINT32_MAX) {
-                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->tex_coord];
-                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                    tex_coords_buffer = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
-                }
-
-                if (gltf_primitive->joints != UINT32_MAX) {
-                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->joints];
-                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                    joint_indices_buffer      = (&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
-                    joint_indices_type        = accessor->component_type;
-                }
-
-                if (gltf_primitive->weights != UINT32_MAX) {
-                    gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->weights];
-                    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                    joint_weights_buffer      = (const float *)(&gltf_model->buffers[bv->buffer].data[accessor->byte_offset + bv->byte_offset]);
-                }
-
-                has_skin = (joint_indices_buffer && joint_weights_buffer);
-
-                for (uint32_t v = 0; v < prim_vertex_count; v++) {
-                    skinned_vertex_t *vert = &vertex_buffer_data[vertex_count++];
-                    //positions
-                    vert->pos    = (vec3f_t){position_buffer[v * 3], position_buffer[v * 3 + 1], position_buffer[v * 3 + 2]};
-                    //normals
-                    vec3f_t normal = {0};
-                    if (normals_buffer) {
-                        normal = vec3_normalize((vec3f_t){normals_buffer[v * 3], normals_buffer[v * 3 + 1], normals_buffer[v * 3 + 2]});
-                    }
-                    vert->normal =  normal;
-                    //tex coords
-                    vec2f_t tex_coords = {0};
-                    if (tex_coords_buffer) {
-                        tex_coords = (vec2f_t){tex_coords_buffer[v * 2], tex_coords_buffer[v * 2 + 1]};
-                    }
-                    vert->uv = tex_coords;
-
-                    if (has_skin){
-                        vec4f_t joint_indices = {0};
-                        switch(joint_indices_type) 
-                        {
-                            case UNSIGNED_SHORT:
-                            {
-                                const uint16_t *buf = (const uint16_t *)joint_indices_buffer;
-                                joint_indices =  (vec4f_t){buf[v * 4], buf[v * 4 + 1], buf[v * 4 + 2], buf[v * 4 +3]};
-                                break;
-                            }
-                                
-                            case UNSIGNED_BYTE:
-                            {
-                                const uint8_t *buf = (const uint8_t *)joint_indices_buffer;
-                                joint_indices = (vec4f_t){buf[v * 4], buf[v * 4 + 1], buf[v * 4 + 2], buf[v * 4 +3]};
-                                break;
-                            }
-                        }
-                        vert->joint_indices = joint_indices;
-                    }
-
-                    //joint weights
-                    vec4f_t joint_weights = {0};
-                    if (has_skin){
-                        joint_weights = (vec4f_t){joint_weights_buffer[v * 4], joint_weights_buffer[v * 4 + 1], joint_weights_buffer[v * 4 + 2], joint_weights_buffer[v * 4 + 3]};
-                    }
-                    vert->joint_weights = joint_weights;
-                }
-            }
-
-            //indices
-            {
-                gltf_accessor_t *accessor = &gltf_model->accessors[gltf_primitive->indices];
-                gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
-                gltf_buffer_t *buffer     = &gltf_model->buffers[bv->buffer];
-                
-                prim_index_count = accessor->count;
-
-                switch (accessor->component_type)
-                {
-                    case UNSIGNED_BYTE:
-                    {
-                        const uint8_t *buf = (const uint8_t *)(&buffer->data[accessor->byte_offset + bv->byte_offset]);
-                        for (uint32_t index = 0; index < accessor->count; index++) {
-                            index_buffer_data[index_count++] = buf[index] + vertex_start;
-                        }
-                        break;
-                    }
-
-                    case UNSIGNED_SHORT:
-                    {
-                        const uint16_t *buf = (const uint16_t *)(&buffer->data[accessor->byte_offset + bv->byte_offset]);
-                        for (uint32_t index = 0; index < accessor->count; index++){
-                            index_buffer_data[index_count++] = buf[index] + vertex_start;
-                        }
-                        break;
-                    }
-
-                    case UNSIGNED_INT:
-                    {
-                        const uint32_t *buf = (const uint32_t *)(&buffer->data[accessor->byte_offset + bv->byte_offset]);
-                        for (uint32_t index = 0; index < accessor->count; index++){
-                            index_buffer_data[index_count++] = buf[index] + vertex_start;
-                        }
-                        break;
-                    }
-                    default:
-                        assert(false);
-                        break;
-                }
-            }
-
-            primitive->first_index = first_index;
-            primitive->index_count = prim_index_count;
-            primitive->material    = gltf_primitive->material;
+bool skinned_model_create(skinned_model_t        *skinned_model, 
+                          skinned_model_source_t *source, 
+                          const skeleton_t       *skeleton, 
+                          uint32_t               skeleton_index,
+                          const uint32_t         *node_remap,
+                          asset_store_t          *asset_store,
+                          renderer_t             *renderer)
+{
+    gltf_model_t *gltf_model     = source->gltf_model;
+    skinned_model->skeleton      = skeleton_index;
+    skinned_model->mesh_node     = UINT32_MAX;
+    skinned_model->texture_count = 0;
+    skinned_model->vertex_buffer = UINT32_MAX;
+    skinned_model->index_buffer  = UINT32_MAX;
+    for (uint32_t i = 0; i < gltf_model->node_count; i++) {
+        if (gltf_model->nodes[i].mesh != UINT32_MAX) {
+            skinned_model->mesh_node = node_remap[i];
+            break;
         }
     }
+    if (skinned_model->mesh_node == UINT32_MAX) {
+        LOGE("Mesh node of %s is not part of its skeleton", gltf_model->path);
+        return false;
+    }
 
-    model->vertex_buffer = bulk_data_allocate_slot_renderbuffer_t(renderer->renderbuffers);
-    renderbuffer_t *vertex_buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, model->vertex_buffer);
-    
-    model->index_buffer = bulk_data_allocate_slot_renderbuffer_t(renderer->renderbuffers);
-    renderbuffer_t *index_buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, model->index_buffer);
+    uint32_t joint_table[MAX_BONES_PER_SKIN] = {0};
+    if (!skeleton_build_joint_table(skeleton, gltf_model, node_remap, joint_table)) {
+        return false;
+    }
+    model_remap_skinned_joints(&source->geometry, joint_table, gltf_model->skin_count > 0 ? gltf_model->skins[0].joint_count : 0);
+
+    uint32_t *textures = NULL;
+    uint32_t texture_count = 0;
+
+    skinned_model_load_textures(source, skinned_model, asset_store, renderer, &textures, &texture_count);
+    skinned_model->material_count = model_load_materials(gltf_model, textures, skinned_model->materials);
 
-    renderer_create_renderbuffer(renderer, vertex_buffer, RENDERBUFFER_TYPE_VERTEX_BUFFER,(uint8_t *)vertex_buffer_data, vertex_count * sizeof(skinned_vertex_t));
-    renderer_create_renderbuffer(renderer, index_buffer, RENDERBUFFER_TYPE_INDEX_BUFFER, (uint8_t*)index_buffer_data, index_count * sizeof(uint32_t));
+    skinned_model->mesh = source->mesh;
+    return skinned_model_upload_geometry(skinned_model, &source->geometry, asset_store, renderer);
 }
 
-void skinned_model_update_animation(skinned_model_t *model, renderer_t *renderer, float dt)
+//! @brief: material texture indices are cooked as image indices
+static void skinned_model_load_cooked_textures(const cooked_model_t *cooked, skinned_model_t *model, asset_store_t *asset_store, renderer_t *renderer)
 {
-    if (model->active_animation > model->animation_count - 1) {
-        LOGE("No animation with index %u", model->active_animation);
-    }
-    animation_t *animation = &model->animations[model->active_animation];
-    animation->current_time += dt;
-    //!NOTE: looping
-    if (animation->current_time >= animation->end_time) {
-        animation->current_time -= animation->end_time;
-    }
+    uint32_t textures[MAX_TEXTURES_PER_MODEL];
+    model->texture_count = 0;
+    for (uint32_t i = 0; i < cooked->header->image_count; i++) {
+        const cooked_image_t *image = &cooked->images[i];
+        const void *data = cooked_model_image_data(cooked, i);
+
+        //decoded images are keyed by their pixels, the cooker doesn't keep their paths
+        bool pixels     = image->format == COOKED_IMAGE_RGBA8;
+        asset_key_t key = pixels ? asset_store_content_key(data, image->size, ((uint64_t)image->width << 32) | image->height) :
+                                   asset_store_file_key((const char *)data);
+        textures[i] = asset_store_acquire_shared(&asset_store->shared_textures, key);
+        if (textures[i] != UINT32_MAX) {
+            skinned_model_add_texture(model, textures[i]);
+            continue;
+        }
 
-    for (uint32_t i = 0 ; i < animation->channel_count; i++) {
-        animation_channel_t *channel = &animation->channels[i];
-        animation_sampler_t *sampler = &animation->samplers[channel->sampler];
-        model_node_t *node = &model->nodes[channel->node];
-        
-        for (uint32_t j = 0; j < sampler->input_count - 1; j++) {
-            if (sampler->interpolation == STEP_INTERPOLATION) {
-                if ((animation->current_time >= sampler->inputs[j]) && (animation->current_time <= sampler->inputs[j + 1])) {
-                    if (channel->path == TRANSLATION) {
-                        node->translation.x = sampler->outputs[j].x;
-                        node->translation.y = sampler->outputs[j].y;
-                        node->translation.z = sampler->outputs[j].z;
-                    } else if (channel->path == ROTATION) {
-                        node->rotation.x = sampler->outputs[j].x;
-                        node->rotation.y = sampler->outputs[j].y;
-                        node->rotation.z = sampler->outputs[j].z;
-                        node->rotation.w = sampler->outputs[j].w;
-                    } else if (channel->path == SCALE) {
-                        node->scale.x = sampler->outputs[j].x;
-                        node->scale.y = sampler->outputs[j].y;
-                        node->scale.z = sampler->outputs[j].z;
-                    }
-                } 
-            } else if (sampler->interpolation == LINEAR_INTERPOLATION) {
-                if ((animation->current_time >= sampler->inputs[j]) && (animation->current_time <= sampler->inputs[j + 1])) {
-                    float t = (animation->current_time - sampler->inputs[j]) / (sampler->inputs[j + 1] - sampler->inputs[j]);
-
-                    if (channel->path == TRANSLATION) {
-                        vec4f_t trans = vec4_lerp(sampler->outputs[j], sampler->outputs[j + 1], t);
-                        node->translation.x = trans.x;
-                        node->translation.y = trans.y;
-                        node->translation.z = trans.z;
-                    } else if(channel->path == ROTATION) {
-                        quat_t q1 = {};
-                        q1.x = sampler->outputs[j].x;
-                        q1.y = sampler->outputs[j].y;
-                        q1.z = sampler->outputs[j].z;
-                        q1.w = sampler->outputs[j].w;
-
-                        quat_t q2 = {};
-                        q2.x = sampler->outputs[j + 1].x;
-                        q2.y = sampler->outputs[j + 1].y;
-                        q2.z = sampler->outputs[j + 1].z;
-                        q2.w = sampler->outputs[j + 1].w;
-
-                        //!TODO: Check game engine architecture for quat slerp implementation
-                        node->rotation = quat_normalize(quat_slerp(q1, q2, t));
-                    } else if (channel->path == SCALE) {
-                        vec4f_t scale = vec4_lerp(sampler->outputs[j], sampler->outputs[j + 1], t);
-                        node->scale = (vec3f_t){scale.x, scale.y, scale.z};
-                    }
-                }
-            }
+        textures[i] = bulk_data_allocate_slot_texture_t(renderer->textures);
+        texture_t *texture = bulk_data_getp_null_texture_t(renderer->textures, textures[i]);
+        bool created = pixels ? renderer_create_texture_from_pixels(renderer, texture, data, image->width, image->height) :
+                                renderer_create_texture(renderer, texture, (const char *)data);
+        if (!created) {
+            LOGE("Unable to create texture of cooked image %u", i);
+            bulk_data_delete_item_texture_t(renderer->textures, textures[i]);
+            textures[i] = UINT32_MAX;
+            continue;
         }
+        asset_store_add_shared(&asset_store->shared_textures, key, textures[i], texture->size);
+        skinned_model_add_texture(model, textures[i]);
     }
-#if 0
-    for (uint32_t i = 0; i < model->node_count; i++) {
-        model_node_t *node = &model->nodes[i];
-        update_joints(model, node, renderer, bd);
-    }
-#endif
-}
 
-void skinned_model_draw(skinned_model_t *model, 
-                        renderer_t *renderer, 
-                        shader_t *shader)
-{
-    renderbuffer_t *vertex_buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, model->vertex_buffer);
-    renderer_bind_vertex_buffers(renderer, vertex_buffer);
-
-    renderbuffer_t *index_buffer = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, model->index_buffer);
-    renderer_bind_index_buffers(renderer, index_buffer);
+    model->material_count = cooked->header->material_count;
+    for (uint32_t i = 0; i < model->material_count; i++) {
+        material_t *material = &model->materials[i];
+        *material = cooked->materials[i];
 
-    for (uint32_t i = 0; i < model->node_count; i++) {
-        model_node_t *node = &model->nodes[i]; 
-        if (node->mesh != UINT32_MAX) {
-            mat4f_t node_matrix = {0};
-            skinned_model_get_node_matrix(model, node, &node_matrix);
-            skinned_model_update_joints(model, node, renderer);
-
-            renderer_push_constants(renderer, shader, &node_matrix, sizeof(mat4f_t), 0, SHADER_STAGE_VERTEX);
-            renderer_shader_bind_resource(renderer, SHADER_TYPE_SKINNED_GEOMETRY, RENDER_DATA_SKINNED_MODEL, model->rendering_data);
-            //! TODO: draw all primitives
-            renderer_draw_indexed(renderer, 0, model->mesh.primitives[0].first_index, model->mesh.primitives[0].index_count, 0, 1);
+        uint32_t *indices[] = {&material->base_color_texture, &material->metallic_roughness_texture, &material->normal_texture,
+                               &material->occlusion_texture, &material->emissive_texture, &material->specular_texture,
+                               &material->specular_color_texture};
+        for (uint32_t j = 0; j < sizeof(indices) / sizeof(indices[0]); j++) {
+            if (*indices[j] != UINT32_MAX) *indices[j] = textures[*indices[j]];
         }
     }
 }
 
-bool skinned_model_create(skinned_model_t *skinned_model, 
-                          const char *file_path, 
-                          const char *asset_id, 
-                          renderer_t *renderer, 
-                          asset_store_t *asset_store)
+bool skinned_model_create_cooked(skinned_model_t      *skinned_model,
+                                 const cooked_model_t *cooked,
+                                 const skeleton_t     *skeleton,
+                                 uint32_t             skeleton_index,
+                                 const uint32_t       *node_remap,
+                                 asset_store_t        *asset_store,
+                                 renderer_t           *renderer)
 {
-    gltf_model_t *gltf_model = model_load_from_gltf(file_path, asset_id);
-    if (!gltf_model){
-        LOGE("Unable to load gltf file: %s", file_path);
+    const cooked_model_header_t *header = cooked->header;
+    skinned_model->skeleton      = skeleton_index;
+    skinned_model->mesh_node     = node_remap[header->mesh_node];
+    skinned_model->texture_count = 0;
+    skinned_model->vertex_buffer = UINT32_MAX;
+    skinned_model->index_buffer  = UINT32_MAX;
+    if (skinned_model->mesh_node == UINT32_MAX) {
+        LOGE("Mesh node of cooked model is not part of its skeleton");
         return false;
     }
 
-    uint32_t *textures = NULL;
-    uint32_t texture_count = 0;
-
-    skinned_model_load_textures(gltf_model, skinned_model, renderer, &textures, &texture_count);
-    skinned_model_load_materials(gltf_model, skinned_model, textures, texture_count);
-    skinned_model_load_nodes(gltf_model, skinned_model);
-    skinned_model_load_skins(gltf_model, skinned_model, renderer);
-    skinned_model_load_animations(gltf_model, skinned_model);
-
-    for (uint32_t i = 0; i < skinned_model->node_count; i++) {
-        skinned_model_update_joints(skinned_model, &skinned_model->nodes[i], renderer);
+    //vertices are cooked against the file's own skin, another skeleton of the rig may order its joints differently
+    uint32_t joint_table[MAX_BONES_PER_SKIN];
+    bool same_joints = true;
+    for (uint32_t i = 0; i < cooked->skin->joint_count; i++) {
+        uint32_t node  = node_remap[cooked->skin->joints[i]];
+        joint_table[i] = node == UINT32_MAX ? UINT32_MAX : skeleton_find_joint(skeleton, node);
+        if (joint_table[i] == UINT32_MAX) {
+            LOGE("Joint %u of cooked model is not a joint of its skeleton", i);
+            return false;
+        }
+        same_joints &= joint_table[i] == i;
     }
-    skinned_model_load_meshes(gltf_model, skinned_model, renderer);
-    
-    //! @TODO: Need to think about models with multiple meshes and materials.
-    renderbuffer_t *ssbo = bulk_data_getp_null_renderbuffer_t(renderer->renderbuffers, skinned_model->skin.ssbo);
-    render_data_config_t config = {0};
-    config.type = RENDER_DATA_SKINNED_MODEL;
-    config.buffer_count       = ssbo->buffer_count;
-    for (uint32_t i = 0; i < config.buffer_count; i++) {
-        config.buffer_indices[i] = ssbo->buffers[i];
+
+    //the upload copies the vertices, they are handed over straight from the mapped file
+    skinned_geometry_t geometry = {(skinned_vertex_t *)cooked->vertices, header->vertex_count,
+                                   (uint32_t *)cooked->indices, header->index_count};
+    if (!same_joints) {
+        geometry.vertices = memory_alloc(header->vertex_count * sizeof(skinned_vertex_t), MEM_TAG_TEMP);
+        memcpy(geometry.vertices, cooked->vertices, header->vertex_count * sizeof(skinned_vertex_t));
+        for (uint32_t i = 0; i < header->vertex_count; i++) {
+            vec4f_t *joints = &geometry.vertices[i].joint_indices;
+            *joints = (vec4f_t){joint_table[(uint32_t)joints->x], joint_table[(uint32_t)joints->y],
+                                joint_table[(uint32_t)joints->z], joint_table[(uint32_t)joints->w]};
+        }
     }
-    config.texture_count      = 1;
-    config.texture_indices[0] = skinned_model->materials[0].base_color_texture;
 
-    skinned_model->rendering_data = renderer_create_render_data(renderer, RENDER_DATA_SKINNED_MODEL, skinned_model);
-    skinned_model->active_animation = 1;
+    skinned_model->mesh = header->mesh;
+    skinned_model_load_cooked_textures(cooked, skinned_model, asset_store, renderer);
+    return skinned_model_upload_geometry(skinned_model, &geometry, asset_store, renderer);
+}
+
+bool skinned_model_bake_animations(skinned_model_t *skinned_model, const skeleton_t *skeleton, float sample_rate)
+{
+    for (uint32_t i = skinned_model->baked_clip_count; i < skeleton->animation_count; i++) {
+        if (!animation_bake(&skinned_model->baked_clips[i], skeleton, skinned_model->mesh_node, i, sample_rate)) {
+            LOGE("Unable to bake animation %u", i);
+            return false;
+        }
+        skinned_model->baked_clip_count = i + 1;
+    }
     return true;
 }
+
+void skinned_model_destroy(skinned_model_t *skinned_model)
+{
+    for (uint32_t i = 0; i < skinned_model->baked_clip_count; i++) {
+        animation_baked_clip_destroy(&skinned_model->baked_clips[i]);
+    }
+    skinned_model->baked_clip_count = 0;
+}
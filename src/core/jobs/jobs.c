@@ -0,0 +1,166 @@
+#include <jobs.h>
+#include <logger.h>
+
+#include <assert.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define MAX_WORKER_THREADS 64
+#define JOB_QUEUE_CAP      4096
+
+typedef struct
+{
+    job_fn_t       fn;
+    void          *data;
+    job_counter_t *counter;
+}job_t;
+
+typedef struct
+{
+    pthread_t       threads[MAX_WORKER_THREADS];
+    uint32_t        thread_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t  not_empty;
+
+    //ring buffer
+    job_t           queue[JOB_QUEUE_CAP];
+    uint32_t        head;
+    uint32_t        count;
+
+    bool            running;
+}job_system_t;
+
+static job_system_t job_system;
+
+static bool jobs_pop(job_t *job)
+{
+    if (job_system.count == 0) return false;
+
+    *job = job_system.queue[job_system.head];
+    job_system.head = (job_system.head + 1) % JOB_QUEUE_CAP;
+    job_system.count--;
+    return true;
+}
+
+static void jobs_execute(job_t *job)
+{
+    job->fn(job->data);
+    if (job->counter) {
+        atomic_fetch_sub_explicit(&job->counter->pending, 1, memory_order_release);
+    }
+}
+
+static void *jobs_worker(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        job_t job;
+
+        pthread_mutex_lock(&job_system.mutex);
+        while (job_system.count == 0 && job_system.running) {
+            pthread_cond_wait(&job_system.not_empty, &job_system.mutex);
+        }
+
+        if (!jobs_pop(&job)) {
+            //not running and nothing left to do
+            pthread_mutex_unlock(&job_system.mutex);
+            break;
+        }
+        pthread_mutex_unlock(&job_system.mutex);
+
+        jobs_execute(&job);
+    }
+    return NULL;
+}
+
+void jobs_init(uint32_t worker_count)
+{
+    memset(&job_system, 0, sizeof(job_system));
+
+    if (worker_count == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        worker_count = cores > 1 ? (uint32_t)(cores - 1) : 1;
+    }
+    if (worker_count > MAX_WORKER_THREADS) worker_count = MAX_WORKER_THREADS;
+
+    pthread_mutex_init(&job_system.mutex, NULL);
+    pthread_cond_init(&job_system.not_empty, NULL);
+    job_system.running = true;
+
+    for (uint32_t i = 0; i < worker_count; i++) {
+        if (pthread_create(&job_system.threads[i], NULL, jobs_worker, NULL) != 0) {
+            LOGE("Unable to create worker thread %u", i);
+            break;
+        }
+        job_system.thread_count++;
+    }
+    LOGI("Started %u worker threads", job_system.thread_count);
+}
+
+void jobs_shutdown(void)
+{
+    pthread_mutex_lock(&job_system.mutex);
+    job_system.running = false;
+    pthread_cond_broadcast(&job_system.not_empty);
+    pthread_mutex_unlock(&job_system.mutex);
+
+    for (uint32_t i = 0; i < job_system.thread_count; i++) {
+        pthread_join(job_system.threads[i], NULL);
+    }
+    job_system.thread_count = 0;
+
+    pthread_cond_destroy(&job_system.not_empty);
+    pthread_mutex_destroy(&job_system.mutex);
+}
+
+uint32_t jobs_worker_count(void)
+{
+    return job_system.thread_count;
+}
+
+void jobs_submit(job_fn_t fn, void *data, job_counter_t *counter)
+{
+    job_t job = {fn, data, counter};
+    if (counter) {
+        atomic_fetch_add_explicit(&counter->pending, 1, memory_order_relaxed);
+    }
+
+    pthread_mutex_lock(&job_system.mutex);
+    if (job_system.count == JOB_QUEUE_CAP || job_system.thread_count == 0) {
+        pthread_mutex_unlock(&job_system.mutex);
+        jobs_execute(&job);
+        return;
+    }
+
+    uint32_t tail = (job_system.head + job_system.count) % JOB_QUEUE_CAP;
+    job_system.queue[tail] = job;
+    job_system.count++;
+    pthread_cond_signal(&job_system.not_empty);
+    pthread_mutex_unlock(&job_system.mutex);
+}
+
+bool jobs_done(job_counter_t *counter)
+{
+    return atomic_load_explicit(&counter->pending, memory_order_acquire) == 0;
+}
+
+void jobs_wait(job_counter_t *counter)
+{
+    while (!jobs_done(counter)) {
+        //help out instead of sleeping
+        job_t job;
+        pthread_mutex_lock(&job_system.mutex);
+        bool popped = jobs_pop(&job);
+        pthread_mutex_unlock(&job_system.mutex);
+
+        if (popped) {
+            jobs_execute(&job);
+        } else {
+            sched_yield();
+        }
+    }
+}
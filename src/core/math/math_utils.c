@@ -5,25 +5,189 @@
 #include <stdint.h>
 #include <assert.h>
 #include <math.h>
+#include <string.h>
+
+//! @brief: above this cosine sin(angle) is too small to divide by and slerp falls back to lerp
+#define QUAT_SLERP_LERP_THRESHOLD 0.9995f
+
+//! @brief: out = a * b. Rows of b are loaded up front and every row of out only reads the same row of a,
+//          so out may alias a or b.
+static inline void mat4_multiply_kernel(const mat4f_t *a, const mat4f_t *b, mat4f_t *out)
+{
+#if MATH_SIMD_AVX
+    __m256 b0 = _mm256_broadcast_ps((const __m128 *)b->m[0]);
+    __m256 b1 = _mm256_broadcast_ps((const __m128 *)b->m[1]);
+    __m256 b2 = _mm256_broadcast_ps((const __m128 *)b->m[2]);
+    __m256 b3 = _mm256_broadcast_ps((const __m128 *)b->m[3]);
+
+    //two rows of a per register, the shuffles splat a->m[row][k] across each half
+    for (uint32_t i = 0; i < 4; i += 2) {
+        __m256 rows = _mm256_loadu_ps(a->m[i]);
+        __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2));
+        r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3));
+        _mm256_storeu_ps(out->m[i], r);
+    }
+#elif MATH_SIMD_SSE
+    __m128 b0 = _mm_loadu_ps(b->m[0]);
+    __m128 b1 = _mm_loadu_ps(b->m[1]);
+    __m128 b2 = _mm_loadu_ps(b->m[2]);
+    __m128 b3 = _mm_loadu_ps(b->m[3]);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        __m128 row = _mm_loadu_ps(a->m[i]);
+        __m128 r = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), b2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), b3));
+        _mm_storeu_ps(out->m[i], r);
+    }
+#else
+    mat4f_t r;
+    r.m[0][0] = a->m[0][0] * b->m[0][0] + a->m[0][1] * b->m[1][0] + a->m[0][2] * b->m[2][0] + a->m[0][3] * b->m[3][0]; 
+    r.m[0][1] = a->m[0][0] * b->m[0][1] + a->m[0][1] * b->m[1][1] + a->m[0][2] * b->m[2][1] + a->m[0][3] * b->m[3][1]; 
+    r.m[0][2] = a->m[0][0] * b->m[0][2] + a->m[0][1] * b->m[1][2] + a->m[0][2] * b->m[2][2] + a->m[0][3] * b->m[3][2]; 
+    r.m[0][3] = a->m[0][0] * b->m[0][3] + a->m[0][1] * b->m[1][3] + a->m[0][2] * b->m[2][3] + a->m[0][3] * b->m[3][3]; 
+    r.m[1][0] = a->m[1][0] * b->m[0][0] + a->m[1][1] * b->m[1][0] + a->m[1][2] * b->m[2][0] + a->m[1][3] * b->m[3][0]; 
+    r.m[1][1] = a->m[1][0] * b->m[0][1] + a->m[1][1] * b->m[1][1] + a->m[1][2] * b->m[2][1] + a->m[1][3] * b->m[3][1]; 
+    r.m[1][2] = a->m[1][0] * b->m[0][2] + a->m[1][1] * b->m[1][2] + a->m[1][2] * b->m[2][2] + a->m[1][3] * b->m[3][2]; 
+    r.m[1][3] = a->m[1][0] * b->m[0][3] + a->m[1][1] * b->m[1][3] + a->m[1][2] * b->m[2][3] + a->m[1][3] * b->m[3][3]; 
+    r.m[2][0] = a->m[2][0] * b->m[0][0] + a->m[2][1] * b->m[1][0] + a->m[2][2] * b->m[2][0] + a->m[2][3] * b->m[3][0]; 
+    r.m[2][1] = a->m[2][0] * b->m[0][1] + a->m[2][1] * b->m[1][1] + a->m[2][2] * b->m[2][1] + a->m[2][3] * b->m[3][1]; 
+    r.m[2][2] = a->m[2][0] * b->m[0][2] + a->m[2][1] * b->m[1][2] + a->m[2][2] * b->m[2][2] + a->m[2][3] * b->m[3][2]; 
+    r.m[2][3] = a->m[2][0] * b->m[0][3] + a->m[2][1] * b->m[1][3] + a->m[2][2] * b->m[2][3] + a->m[2][3] * b->m[3][3]; 
+    r.m[3][0] = a->m[3][0] * b->m[0][0] + a->m[3][1] * b->m[1][0] + a->m[3][2] * b->m[2][0] + a->m[3][3] * b->m[3][0]; 
+    r.m[3][1] = a->m[3][0] * b->m[0][1] + a->m[3][1] * b->m[1][1] + a->m[3][2] * b->m[2][1] + a->m[3][3] * b->m[3][1]; 
+    r.m[3][2] = a->m[3][0] * b->m[0][2] + a->m[3][1] * b->m[1][2] + a->m[3][2] * b->m[2][2] + a->m[3][3] * b->m[3][2]; 
+    r.m[3][3] = a->m[3][0] * b->m[0][3] + a->m[3][1] * b->m[1][3] + a->m[3][2] * b->m[2][3] + a->m[3][3] * b->m[3][3];
+    *out = r;
+#endif
+}
 
 void mat4_multiply(const mat4f_t *a, const mat4f_t *b, mat4f_t *out)
 {
-    out->m[0][0] = a->m[0][0] * b->m[0][0] + a->m[0][1] * b->m[1][0] + a->m[0][2] * b->m[2][0] + a->m[0][3] * b->m[3][0]; 
-    out->m[0][1] = a->m[0][0] * b->m[0][1] + a->m[0][1] * b->m[1][1] + a->m[0][2] * b->m[2][1] + a->m[0][3] * b->m[3][1]; 
-    out->m[0][2] = a->m[0][0] * b->m[0][2] + a->m[0][1] * b->m[1][2] + a->m[0][2] * b->m[2][2] + a->m[0][3] * b->m[3][2]; 
-    out->m[0][3] = a->m[0][0] * b->m[0][3] + a->m[0][1] * b->m[1][3] + a->m[0][2] * b->m[2][3] + a->m[0][3] * b->m[3][3]; 
-    out->m[1][0] = a->m[1][0] * b->m[0][0] + a->m[1][1] * b->m[1][0] + a->m[1][2] * b->m[2][0] + a->m[1][3] * b->m[3][0]; 
-    out->m[1][1] = a->m[1][0] * b->m[0][1] + a->m[1][1] * b->m[1][1] + a->m[1][2] * b->m[2][1] + a->m[1][3] * b->m[3][1]; 
-    out->m[1][2] = a->m[1][0] * b->m[0][2] + a->m[1][1] * b->m[1][2] + a->m[1][2] * b->m[2][2] + a->m[1][3] * b->m[3][2]; 
-    out->m[1][3] = a->m[1][0] * b->m[0][3] + a->m[1][1] * b->m[1][3] + a->m[1][2] * b->m[2][3] + a->m[1][3] * b->m[3][3]; 
-    out->m[2][0] = a->m[2][0] * b->m[0][0] + a->m[2][1] * b->m[1][0] + a->m[2][2] * b->m[2][0] + a->m[2][3] * b->m[3][0]; 
-    out->m[2][1] = a->m[2][0] * b->m[0][1] + a->m[2][1] * b->m[1][1] + a->m[2][2] * b->m[2][1] + a->m[2][3] * b->m[3][1]; 
-    out->m[2][2] = a->m[2][0] * b->m[0][2] + a->m[2][1] * b->m[1][2] + a->m[2][2] * b->m[2][2] + a->m[2][3] * b->m[3][2]; 
-    out->m[2][3] = a->m[2][0] * b->m[0][3] + a->m[2][1] * b->m[1][3] + a->m[2][2] * b->m[2][3] + a->m[2][3] * b->m[3][3]; 
-    out->m[3][0] = a->m[3][0] * b->m[0][0] + a->m[3][1] * b->m[1][0] + a->m[3][2] * b->m[2][0] + a->m[3][3] * b->m[3][0]; 
-    out->m[3][1] = a->m[3][0] * b->m[0][1] + a->m[3][1] * b->m[1][1] + a->m[3][2] * b->m[2][1] + a->m[3][3] * b->m[3][1]; 
-    out->m[3][2] = a->m[3][0] * b->m[0][2] + a->m[3][1] * b->m[1][2] + a->m[3][2] * b->m[2][2] + a->m[3][3] * b->m[3][2]; 
-    out->m[3][3] = a->m[3][0] * b->m[0][3] + a->m[3][1] * b->m[1][3] + a->m[3][2] * b->m[2][3] + a->m[3][3] * b->m[3][3]; 
+    mat4_multiply_kernel(a, b, out);
+}
+
+void mat4_multiply_n(const mat4f_t *a, const mat4f_t *b, mat4f_t *out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        mat4_multiply_kernel(&a[i], &b[i], &out[i]);
+    }
+}
+
+affine3x4_t affine_identity(void)
+{
+    affine3x4_t result = {0};
+    result.m[0][0] = 1.0f;
+    result.m[1][1] = 1.0f;
+    result.m[2][2] = 1.0f;
+    return result;
+}
+
+void affine_from_mat4(const mat4f_t *in, affine3x4_t *out)
+{
+    for (uint32_t row = 0; row < 3; row++) {
+        out->m[row][0] = in->m[0][row];
+        out->m[row][1] = in->m[1][row];
+        out->m[row][2] = in->m[2][row];
+        out->m[row][3] = in->m[3][row];
+    }
+}
+
+void affine_to_mat4(const affine3x4_t *in, mat4f_t *out)
+{
+    for (uint32_t row = 0; row < 4; row++) {
+        out->m[row][0] = in->m[0][row];
+        out->m[row][1] = in->m[1][row];
+        out->m[row][2] = in->m[2][row];
+        out->m[row][3] = row == 3 ? 1.0f : 0.0f;
+    }
+}
+
+//! @brief: row j of out is b[j][0..2] times the rows of a, plus b's translation
+static inline void affine_multiply_kernel(const affine3x4_t *a, const affine3x4_t *b, affine3x4_t *out)
+{
+#if MATH_SIMD_SSE
+    __m128 a0 = _mm_loadu_ps(a->m[0]);
+    __m128 a1 = _mm_loadu_ps(a->m[1]);
+    __m128 a2 = _mm_loadu_ps(a->m[2]);
+    __m128 w  = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+    for (uint32_t j = 0; j < 3; j++) {
+        __m128 row = _mm_loadu_ps(b->m[j]);
+        __m128 r = _mm_mul_ps(_mm_shuffle_ps(row, row, 0x00), a0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0x55), a1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xAA), a2));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(row, row, 0xFF), w));
+        _mm_storeu_ps(out->m[j], r);
+    }
+#else
+    affine3x4_t r;
+    for (uint32_t j = 0; j < 3; j++) {
+        for (uint32_t c = 0; c < 4; c++) {
+            r.m[j][c] = b->m[j][0] * a->m[0][c] + b->m[j][1] * a->m[1][c] + b->m[j][2] * a->m[2][c];
+        }
+        r.m[j][3] += b->m[j][3];
+    }
+    *out = r;
+#endif
+}
+
+void affine_multiply(const affine3x4_t *a, const affine3x4_t *b, affine3x4_t *out)
+{
+    affine_multiply_kernel(a, b, out);
+}
+
+void affine_multiply_n(const affine3x4_t *a, const affine3x4_t *b, affine3x4_t *out, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        affine_multiply_kernel(&a[i], &b[i], &out[i]);
+    }
+}
+
+void affine_inverse(const affine3x4_t *in, affine3x4_t *out)
+{
+    const float (*m)[4] = in->m;
+
+    //adjugate of the 3x3 part
+    float c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    float c01 = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+    float c02 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+    float c10 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    float c11 = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+    float c12 = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+    float c20 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    float c21 = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+    float c22 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+
+    float d = 1.0f / (m[0][0] * c00 + m[0][1] * c10 + m[0][2] * c20);
+    float tx = m[0][3], ty = m[1][3], tz = m[2][3];
+
+    affine3x4_t r;
+    r.m[0][0] = c00 * d; r.m[0][1] = c01 * d; r.m[0][2] = c02 * d;
+    r.m[1][0] = c10 * d; r.m[1][1] = c11 * d; r.m[1][2] = c12 * d;
+    r.m[2][0] = c20 * d; r.m[2][1] = c21 * d; r.m[2][2] = c22 * d;
+    for (uint32_t j = 0; j < 3; j++) {
+        r.m[j][3] = -(r.m[j][0] * tx + r.m[j][1] * ty + r.m[j][2] * tz);
+    }
+    *out = r;
+}
+
+void affine_inverse_rigid(const affine3x4_t *in, affine3x4_t *out)
+{
+    const float (*m)[4] = in->m;
+    float tx = m[0][3], ty = m[1][3], tz = m[2][3];
+
+    affine3x4_t r;
+    for (uint32_t j = 0; j < 3; j++) {
+        r.m[j][0] = m[0][j];
+        r.m[j][1] = m[1][j];
+        r.m[j][2] = m[2][j];
+        r.m[j][3] = -(r.m[j][0] * tx + r.m[j][1] * ty + r.m[j][2] * tz);
+    }
+    *out = r;
 }
 
 vec3f_t vec3_normalize(vec3f_t in)
@@ -327,20 +491,69 @@ void quat_to_rot_mat4(quat_t quat, mat4f_t *rot)
     rot->m[3][3] = 1.0f;
 }
 
-void transform_from_TRS(mat4f_t *transform, vec3f_t translation, quat_t rotation, vec3f_t scale)
+void mat4_from_TRS(mat4f_t *out, vec3f_t translation, quat_t rotation, vec3f_t scale)
 {
-    mat4f_t scale_mat = mat4_scale(scale.x, scale.y, scale.z);
-    mat4f_t rot_mat = mat4_rotate_w_quat(rotation);
-    mat4f_t trans_mat = mat4_translate(translation.x, translation.y, translation.z);
+    //scale * rotation * translation: rotation rows scaled per axis, translation in the last row
+    float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+    float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+    float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+    out->m[0][0] = scale.x * (1.0f - 2.0f * (yy + zz));
+    out->m[0][1] = scale.x * 2.0f * (xy + wz);
+    out->m[0][2] = scale.x * 2.0f * (xz - wy);
+    out->m[0][3] = 0.0f;
+
+    out->m[1][0] = scale.y * 2.0f * (xy - wz);
+    out->m[1][1] = scale.y * (1.0f - 2.0f * (zz + xx));
+    out->m[1][2] = scale.y * 2.0f * (yz + wx);
+    out->m[1][3] = 0.0f;
+
+    out->m[2][0] = scale.z * 2.0f * (xz + wy);
+    out->m[2][1] = scale.z * 2.0f * (yz - wx);
+    out->m[2][2] = scale.z * (1.0f - 2.0f * (xx + yy));
+    out->m[2][3] = 0.0f;
+
+    out->m[3][0] = translation.x;
+    out->m[3][1] = translation.y;
+    out->m[3][2] = translation.z;
+    out->m[3][3] = 1.0f;
+}
 
-    mat4f_t scaled = {0};
-    mat4f_t rotated = {0};
+void affine_from_TRS(affine3x4_t *out, vec3f_t translation, quat_t rotation, vec3f_t scale)
+{
+    //the columns of mat4_from_TRS
+    float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+    float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+    float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+    out->m[0][0] = scale.x * (1.0f - 2.0f * (yy + zz));
+    out->m[0][1] = scale.y * 2.0f * (xy - wz);
+    out->m[0][2] = scale.z * 2.0f * (xz + wy);
+    out->m[0][3] = translation.x;
+
+    out->m[1][0] = scale.x * 2.0f * (xy + wz);
+    out->m[1][1] = scale.y * (1.0f - 2.0f * (zz + xx));
+    out->m[1][2] = scale.z * 2.0f * (yz - wx);
+    out->m[1][3] = translation.y;
+
+    out->m[2][0] = scale.x * 2.0f * (xz - wy);
+    out->m[2][1] = scale.y * 2.0f * (yz + wx);
+    out->m[2][2] = scale.z * (1.0f - 2.0f * (xx + yy));
+    out->m[2][3] = translation.z;
+}
 
-    mat4f_t temp = *transform;
-    
-    mat4_multiply(&temp, &scale_mat, &scaled);
-    mat4_multiply(&scaled, &rot_mat, &rotated);
-    mat4_multiply(&rotated, &trans_mat, transform);
+void transform_from_TRS(mat4f_t *transform, vec3f_t translation, quat_t rotation, vec3f_t scale)
+{
+    mat4f_t trs;
+    mat4_from_TRS(&trs, translation, rotation, scale);
+
+    //nodes almost always carry either a matrix or TRS, skip the multiply when the matrix is identity
+    mat4f_t identity = mat4_identity();
+    if (memcmp(transform, &identity, sizeof(identity)) == 0) {
+        *transform = trs;
+    } else {
+        mat4_multiply_kernel(transform, &trs, transform);
+    }
 }
 
 vec3f_t vec3_lerp(vec3f_t a, vec3f_t b, float t)
@@ -430,15 +643,201 @@ quat_t quat_slerp(quat_t a, quat_t b, float t)
     }
 
     //perform a linear interpolation when cos_theta is close to one to avoid side effect of sin(angle) becoming a zero denominator
-    if (cos_theta > nextafterf(1.0f, -INFINITY)) {
+    if (cos_theta > QUAT_SLERP_LERP_THRESHOLD) {
         result = quat_lerp(a,z,t);
     } else {
-        float angle = acosf(cos_theta);
-        result.w = a.w * sinf((1.0f - t) * angle) + z.w * sinf(t * angle) / sinf(angle);
-        result.x = a.x * sinf((1.0f - t) * angle) + z.x * sinf(t * angle) / sinf(angle);
-        result.y = a.y * sinf((1.0f - t) * angle) + z.y * sinf(t * angle) / sinf(angle);
-        result.z = a.z * sinf((1.0f - t) * angle) + z.z * sinf(t * angle) / sinf(angle);
+        float angle     = acosf(cos_theta);
+        float inv_sin   = 1.0f / sinf(angle);
+        float weight_a  = sinf((1.0f - t) * angle) * inv_sin;
+        float weight_b  = sinf(t * angle) * inv_sin;
+        result.w = a.w * weight_a + z.w * weight_b;
+        result.x = a.x * weight_a + z.x * weight_b;
+        result.y = a.y * weight_a + z.y * weight_b;
+        result.z = a.z * weight_a + z.z * weight_b;
     }
     return result;
 }
 
+quat_t quat_nlerp(quat_t a, quat_t b, float t)
+{
+    //shortest way around, same as slerp
+    if (quat_dot(a, b) < 0) {
+        b.w = -b.w;
+        b.x = -b.x;
+        b.y = -b.y;
+        b.z = -b.z;
+    }
+    return quat_normalize(quat_lerp(a, b, t));
+}
+
+#if MATH_SIMD_SSE
+typedef struct
+{
+    __m128 w, x, y, z;
+} quat4_t;
+
+//! @brief: four quaternions to one register per component
+static inline quat4_t quat4_load(const quat_t *q)
+{
+    quat4_t r;
+    r.w = _mm_loadu_ps(&q[0].w);
+    r.x = _mm_loadu_ps(&q[1].w);
+    r.y = _mm_loadu_ps(&q[2].w);
+    r.z = _mm_loadu_ps(&q[3].w);
+    _MM_TRANSPOSE4_PS(r.w, r.x, r.y, r.z);
+    return r;
+}
+
+static inline void quat4_store(quat4_t q, quat_t *out)
+{
+    _MM_TRANSPOSE4_PS(q.w, q.x, q.y, q.z);
+    _mm_storeu_ps(&out[0].w, q.w);
+    _mm_storeu_ps(&out[1].w, q.x);
+    _mm_storeu_ps(&out[2].w, q.y);
+    _mm_storeu_ps(&out[3].w, q.z);
+}
+
+//! @brief: flips b where the dot is negative and returns the absolute dot
+static inline __m128 quat4_align(const quat4_t *a, quat4_t *b)
+{
+    __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a->w, b->w), _mm_mul_ps(a->x, b->x)),
+                            _mm_add_ps(_mm_mul_ps(a->y, b->y), _mm_mul_ps(a->z, b->z)));
+    __m128 sign = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+    b->w = _mm_xor_ps(b->w, sign);
+    b->x = _mm_xor_ps(b->x, sign);
+    b->y = _mm_xor_ps(b->y, sign);
+    b->z = _mm_xor_ps(b->z, sign);
+    return _mm_xor_ps(dot, sign);
+}
+
+static inline quat4_t quat4_blend(const quat4_t *a, const quat4_t *b, __m128 weight_a, __m128 weight_b)
+{
+    quat4_t r;
+    r.w = _mm_add_ps(_mm_mul_ps(a->w, weight_a), _mm_mul_ps(b->w, weight_b));
+    r.x = _mm_add_ps(_mm_mul_ps(a->x, weight_a), _mm_mul_ps(b->x, weight_b));
+    r.y = _mm_add_ps(_mm_mul_ps(a->y, weight_a), _mm_mul_ps(b->y, weight_b));
+    r.z = _mm_add_ps(_mm_mul_ps(a->z, weight_a), _mm_mul_ps(b->z, weight_b));
+    return r;
+}
+
+static inline quat4_t quat4_normalize(quat4_t q)
+{
+    __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(q.w, q.w), _mm_mul_ps(q.x, q.x)),
+                                        _mm_add_ps(_mm_mul_ps(q.y, q.y), _mm_mul_ps(q.z, q.z))));
+    //zero length stays zero like quat_normalize
+    __m128 inv = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), len), _mm_cmpgt_ps(len, _mm_setzero_ps()));
+    q.w = _mm_mul_ps(q.w, inv);
+    q.x = _mm_mul_ps(q.x, inv);
+    q.y = _mm_mul_ps(q.y, inv);
+    q.z = _mm_mul_ps(q.z, inv);
+    return q;
+}
+
+//! @brief: sin on [0, pi/2], Taylor series to x^11, error below 6e-8
+static inline __m128 sin4_quadrant(__m128 x)
+{
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(-1.0f / 39916800.0f);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 362880.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 5040.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f / 120.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(-1.0f / 6.0f));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+    return _mm_mul_ps(p, x);
+}
+
+//! @brief: acos on [0, 1], Abramowitz and Stegun 4.4.46, error below 2e-8
+static inline __m128 acos4_positive(__m128 x)
+{
+    __m128 p = _mm_set1_ps(-0.0012624911f);
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0066700901f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0170881256f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0308918810f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.0501743046f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(0.0889789874f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(-0.2145988016f));
+    p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(1.5707963050f));
+    __m128 one_minus = _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x), _mm_setzero_ps());
+    return _mm_mul_ps(_mm_sqrt_ps(one_minus), p);
+}
+
+static void quat4_nlerp(const quat_t *a, const quat_t *b, const float *t, quat_t *out)
+{
+    quat4_t qa = quat4_load(a);
+    quat4_t qb = quat4_load(b);
+    quat4_align(&qa, &qb);
+
+    __m128 weight_b = _mm_loadu_ps(t);
+    __m128 weight_a = _mm_sub_ps(_mm_set1_ps(1.0f), weight_b);
+    quat4_store(quat4_normalize(quat4_blend(&qa, &qb, weight_a, weight_b)), out);
+}
+
+static void quat4_slerp(const quat_t *a, const quat_t *b, const float *t, quat_t *out)
+{
+    quat4_t qa = quat4_load(a);
+    quat4_t qb = quat4_load(b);
+    __m128 cos_theta = quat4_align(&qa, &qb);
+
+    __m128 tb = _mm_loadu_ps(t);
+    __m128 ta = _mm_sub_ps(_mm_set1_ps(1.0f), tb);
+
+    __m128 angle   = acos4_positive(cos_theta);
+    __m128 inv_sin = _mm_div_ps(_mm_set1_ps(1.0f), sin4_quadrant(angle));
+    __m128 weight_a = _mm_mul_ps(sin4_quadrant(_mm_mul_ps(ta, angle)), inv_sin);
+    __m128 weight_b = _mm_mul_ps(sin4_quadrant(_mm_mul_ps(tb, angle)), inv_sin);
+
+    //lanes that are nearly parallel fall back to a lerp, like quat_slerp
+    __m128 lerp = _mm_cmpgt_ps(cos_theta, _mm_set1_ps(QUAT_SLERP_LERP_THRESHOLD));
+    weight_a = _mm_or_ps(_mm_and_ps(lerp, ta), _mm_andnot_ps(lerp, weight_a));
+    weight_b = _mm_or_ps(_mm_and_ps(lerp, tb), _mm_andnot_ps(lerp, weight_b));
+
+    quat4_store(quat4_blend(&qa, &qb, weight_a, weight_b), out);
+}
+
+//! @brief: runs a four wide kernel over count quaternions, the tail is padded through a small copy
+static void quat4_run(void (*kernel)(const quat_t *, const quat_t *, const float *, quat_t *),
+                      const quat_t *a, const quat_t *b, const float *t, quat_t *out, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        kernel(&a[i], &b[i], &t[i], &out[i]);
+    }
+
+    uint32_t rest = count - i;
+    if (rest > 0) {
+        quat_t pad_a[4] = {0}, pad_b[4] = {0}, pad_out[4];
+        float pad_t[4] = {0};
+        for (uint32_t j = 0; j < rest; j++) {
+            pad_a[j] = a[i + j];
+            pad_b[j] = b[i + j];
+            pad_t[j] = t[i + j];
+        }
+        kernel(pad_a, pad_b, pad_t, pad_out);
+        for (uint32_t j = 0; j < rest; j++) {
+            out[i + j] = pad_out[j];
+        }
+    }
+}
+#endif
+
+void quat_nlerp_n(const quat_t *a, const quat_t *b, const float *t, quat_t *out, uint32_t count)
+{
+#if MATH_SIMD_SSE
+    quat4_run(quat4_nlerp, a, b, t, out, count);
+#else
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = quat_nlerp(a[i], b[i], t[i]);
+    }
+#endif
+}
+
+void quat_slerp_n(const quat_t *a, const quat_t *b, const float *t, quat_t *out, uint32_t count)
+{
+#if MATH_SIMD_SSE
+    quat4_run(quat4_slerp, a, b, t, out, count);
+#else
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = quat_slerp(a[i], b[i], t[i]);
+    }
+#endif
+}
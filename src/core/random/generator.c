@@ -1,118 +1,117 @@
 #include <generator.h>
+#include <tilemap.h>
 #include <logger.h>
-#include <collision.h>
 #include <memory.h>
 #include <math_types.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <assert.h>
 
-#define GRID_SIZE                 127
-#define ROOM_COUNT                50
-#define QUEUE_CAP                 2048
-#define MAX_CONNECTORS_PER_REGION 72 //19 * 2  + 17 * 2
+#define FIRST_ROOM_SIZE           11
+#define MIN_ROOM_SIZE             9
+#define MAX_ROOM_SIZE             17
+#define ROOM_TRIES_PER_ROOM       5
+//! region adjacency is planar, so there are at most 3 * region_count connected pairs
+#define CONNECTOR_SLOTS_PER_REGION 8
 
 static vec2i_t cardinal[4] = {{-1,0}, {0,1}, {0,-1}, {1,0}};
 
-enum
+typedef struct
 {
-    WALL = 0x1,
-    FLOOR = 0x2,
-    INVALID_TILE = 0x0
-};
+    uint64_t state;
+}rng_t;
 
-typedef struct __region_connector_t
+//one connector (door) per pair of adjacent regions
+typedef struct
 {
-    struct __region_connector_t *next;
-    vec2i_t p;
-    uint8_t region; //which region does this connector connect to?
+    uint64_t key; //(from << 32) | to, 0 means empty slot
+    uint32_t cell;
 }region_connector_t;
 
-typedef struct 
+//splitmix64
+static inline uint64_t rng_next(rng_t *rng)
 {
-    uint8_t tile;
-    uint8_t region;
-}grid_tile_t;
-
-typedef struct 
-{
-    grid_tile_t *data;
-    int32_t width;
-    int32_t height;
-    int32_t region_count;
-}grid_t;
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
 
-static float rng_in_range(float min, float max)
+//! @brief: returns a number in [min, max)
+static inline int32_t rng_in_range(rng_t *rng, int32_t min, int32_t max)
 {
-    double scale =  rand() / (double)RAND_MAX;
-    return (float)(min + scale * (max - min));
+    if (max <= min) return min;
+    return min + (int32_t)(rng_next(rng) % (uint64_t)(max - min));
 }
 
-static inline uint8_t grid_get_region(grid_t *grid, int32_t row, int32_t col)
+static inline uint32_t grid_get_region(dungeon_t *grid, int32_t row, int32_t col)
 {
     if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) return 0;
-    return (grid->data[grid->width * row + col]).region;
+    return grid->regions[grid->width * row + col];
 }
 
-static inline uint8_t grid_get_tile(grid_t *grid, int32_t row, int32_t col)
+static inline uint8_t grid_get_tile(dungeon_t *grid, int32_t row, int32_t col)
 {
     if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) return INVALID_TILE;
-    return (grid->data[grid->width * row + col]).tile;
+    return grid->tiles[grid->width * row + col];
 }
 
-static inline void grid_set_region(grid_t *grid, int32_t row, int32_t col, uint8_t val)
+static inline void grid_set_region(dungeon_t *grid, int32_t row, int32_t col, uint32_t val)
 {
     if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) {
         assert(false && "out of bounds grid_set");
     }
-    grid->data[grid->width * row + col].region = val;
+    grid->regions[grid->width * row + col] = val;
 }
 
-static inline void grid_set_tile(grid_t *grid, int32_t row, int32_t col, uint8_t val)
+static inline void grid_set_tile(dungeon_t *grid, int32_t row, int32_t col, uint8_t val)
 {
     if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) {
         assert(false && "out of bounds grid_set");
     }
-    grid->data[grid->width * row + col].tile = val;
+    grid->tiles[grid->width * row + col] = val;
 }
 
-static inline void grid_set(grid_t *grid, int32_t row, int32_t col, grid_tile_t val)
+static inline void grid_set(dungeon_t *grid, int32_t row, int32_t col, uint8_t tile, uint32_t region)
 {
     if (row < 0 || row >= grid->height || col < 0 || col >= grid->width) {
         assert(false && "out of bounds grid_set");
     }
-    grid->data[grid->width * row + col] = val;
+    grid->tiles[grid->width * row + col]   = tile;
+    grid->regions[grid->width * row + col] = region;
 }
 
-
-static inline void grid_init(grid_t *grid, int32_t width, int32_t height)
+static inline void grid_init(dungeon_t *grid, int32_t width, int32_t height)
 {
     grid->width = width;
     grid->height = height;
     grid->region_count = 0;
 
-    grid->data = memory_alloc(sizeof(grid_tile_t) * grid->width * grid->height, MEM_TAG_TEMP);//already memset'd
-    for (uint32_t row = 0; row < grid->height; row++) {
-        for (uint32_t col = 0; col < grid->width; col++) {
-            grid_set_tile(grid, row, col, WALL);
-            grid_set_region(grid, row, col, 0);
-        }
-    }
+    uint32_t cell_count = (uint32_t)width * (uint32_t)height;
+    memset(grid->tiles, WALL, cell_count);
+    memset(grid->regions, 0, cell_count * sizeof(uint32_t));
 }
 
-static bool can_carve(grid_t *grid, vec2i_t p, vec2i_t dir)
+//! @brief: number of odd cells, which bounds both the maze stack and the connector table
+static inline uint32_t grid_odd_cell_count(int32_t width, int32_t height)
+{
+    return (uint32_t)(width / 2) * (uint32_t)(height / 2);
+}
+
+static bool can_carve(dungeon_t *grid, vec2i_t p, vec2i_t dir)
 {
     int x1 = p.x;
     int x2 = p.x + dir.x * 3;
     int y1 = p.y;
     int y2 = p.y + dir.y * 3;
 
-    if (x1 < 0 || x1 >= GRID_SIZE ||
-        x2 < 0 || x2 >= GRID_SIZE ||
-        y1 < 0 || y1 >= GRID_SIZE ||
-        y2 < 0 || y2 >= GRID_SIZE) {
+    if (x1 < 0 || x1 >= grid->width ||
+        x2 < 0 || x2 >= grid->width ||
+        y1 < 0 || y1 >= grid->height ||
+        y2 < 0 || y2 >= grid->height) {
         return false;
     }
 
@@ -121,13 +120,12 @@ static bool can_carve(grid_t *grid, vec2i_t p, vec2i_t dir)
     return (grid_get_tile(grid, y,x) == WALL);
 }
 
-static void grow_maze(grid_t *grid, int32_t x, int32_t y)
+//! @brief: every push carves a new odd cell, so the stack never holds more than grid_odd_cell_count entries
+static void grow_maze(dungeon_t *grid, rng_t *rng, int32_t x, int32_t y, vec2i_t *queue, uint32_t queue_cap)
 {
     grid->region_count++;
 
-    vec2i_t queue[QUEUE_CAP];
     uint32_t queue_count = 0;
-    memset(queue, 0, sizeof(queue));
 
     vec2i_t start = (vec2i_t){x,y};
     queue[queue_count++] = start;
@@ -145,14 +143,14 @@ static void grow_maze(grid_t *grid, int32_t x, int32_t y)
         }
 
         if (direction_count > 0) {
-            assert(queue_count < QUEUE_CAP);
+            assert(queue_count < queue_cap);
 
-            int32_t dir_index = rand() % direction_count;
+            int32_t dir_index = rng_in_range(rng, 0, direction_count);
             vec2i_t dir = directions[dir_index];
 
-            grid_set(grid, current.y + dir.y, current.x + dir.x, (grid_tile_t){FLOOR, grid->region_count});
-            grid_set(grid, current.y + dir.y * 2, current.x + dir.x * 2, (grid_tile_t){FLOOR, grid->region_count});
-            
+            grid_set(grid, current.y + dir.y, current.x + dir.x, FLOOR, grid->region_count);
+            grid_set(grid, current.y + dir.y * 2, current.x + dir.x * 2, FLOOR, grid->region_count);
+
             queue[queue_count++] = (vec2i_t){current.x + dir.x * 2, current.y + dir.y * 2};
         } else {
             queue_count--;
@@ -160,59 +158,61 @@ static void grow_maze(grid_t *grid, int32_t x, int32_t y)
     }
 }
 
-static region_connector_t *append_connector_to_tail(region_connector_t *head, region_connector_t *node)
+static inline uint64_t connector_hash(uint64_t key)
 {
-    if (!head) {
-        head = node;
-    } else {
-        region_connector_t *p = head;
-        while(p->next) {
-            p = p->next;
-        }
-        p->next = node;
-    }
-    return head;
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return key;
 }
 
-//we will need to keep deleting until this returns false
-static bool delete_connector(region_connector_t **head, uint8_t region)
+//! @brief: keeps the first connector found for a pair of regions, returns false if the table is full
+static bool add_connector(region_connector_t *connectors, uint32_t capacity, uint32_t *count, uint32_t from, uint32_t to, uint32_t cell)
 {
-    region_connector_t *temp = *head;
-    region_connector_t *prev = NULL;
-
-    if (temp && temp->region == region) {
-        *head = temp->next;
-        return true;
-    }
+    uint64_t key = from < to ? (((uint64_t)from << 32) | to) : (((uint64_t)to << 32) | from);
+    uint32_t mask = capacity - 1;
+    uint32_t slot = (uint32_t)connector_hash(key) & mask;
 
-    while (temp && temp->region != region) {
-        prev = temp;
-        temp = temp->next;
+    while (connectors[slot].key != 0) {
+        if (connectors[slot].key == key) return true;
+        slot = (slot + 1) & mask;
     }
 
-    if (!temp) return false;
+    //keep the load factor under 3/4 so probing stays short
+    if ((*count + 1) * 4 > capacity * 3) return false;
 
-    prev->next = temp->next;
+    connectors[slot].key  = key;
+    connectors[slot].cell = cell;
+    (*count)++;
     return true;
 }
 
-static void connect_regions(grid_t *grid)
+//! @brief: opens one door in the wall between every pair of adjacent regions.
+//          Connectors are gathered first and carved afterwards so new doors don't create new connectors.
+static bool connect_regions(dungeon_t *grid, void *scratch, size_t scratch_size)
 {
-    region_connector_t ** region_connectors = memory_alloc(grid->region_count * sizeof(region_connector_t*), MEM_TAG_TEMP); //array of linked lists
-    for (uint32_t i = 0; i < grid->region_count; i++) {
-        region_connectors[i] = NULL;
+    uint32_t capacity = 1;
+    while (capacity < grid->region_count * CONNECTOR_SLOTS_PER_REGION) capacity <<= 1;
+
+    if (capacity * sizeof(region_connector_t) > scratch_size) {
+        LOGE("Too many regions (%u) to connect", grid->region_count);
+        return false;
     }
 
-    for (uint32_t row = 1; row < grid->height - 1; row++) {
-        for (uint32_t col = 1; col < grid->width - 1; col++) {
+    region_connector_t *connectors = (region_connector_t *)scratch;
+    memset(connectors, 0, capacity * sizeof(region_connector_t));
+    uint32_t connector_count = 0;
+
+    for (int32_t row = 1; row < grid->height - 1; row++) {
+        for (int32_t col = 1; col < grid->width - 1; col++) {
             if (grid_get_tile(grid, row, col) == WALL)
             {
-                uint8_t from = 0; //index into the region_connectors array
-                uint8_t to   = 0; //region field in region_connector_t struct
+                uint32_t from = 0;
+                uint32_t to   = 0;
 
                 for (uint32_t i = 0; i < 4; i++) {
-                    uint8_t region = grid_get_region(grid, row + cardinal[i].y, col + cardinal[i].x);
-                    uint8_t tile   = grid_get_tile(grid, row + cardinal[i].y, col + cardinal[i].x);
+                    uint32_t region = grid_get_region(grid, row + cardinal[i].y, col + cardinal[i].x);
+                    uint8_t tile    = grid_get_tile(grid, row + cardinal[i].y, col + cardinal[i].x);
                     if (tile == FLOOR &&  region != 0) {
                         if (from == 0) {
                             from = region;
@@ -222,18 +222,10 @@ static void connect_regions(grid_t *grid)
                     }
 
                     if (from && to) {
-                        //create two nodes, add one to 'from' list, one to 'to' list
-                        region_connector_t *conn_from = memory_alloc(sizeof(region_connector_t), MEM_TAG_TEMP);
-                        conn_from->next = NULL;
-                        conn_from->region = to;
-                        conn_from->p = (vec2i_t){col,row};
-                        region_connectors[from - 1] = append_connector_to_tail(region_connectors[from - 1], conn_from);
-
-                        region_connector_t *conn_to   = memory_alloc(sizeof(region_connector_t), MEM_TAG_TEMP);
-                        conn_to->next   = NULL;
-                        conn_to->region = from;
-                        conn_to->p      = (vec2i_t){col,row};
-                        region_connectors[to - 1] = append_connector_to_tail(region_connectors[to - 1], conn_to);
+                        if (!add_connector(connectors, capacity, &connector_count, from, to, (uint32_t)(grid->width * row + col))) {
+                            LOGE("Connector table is full");
+                            return false;
+                        }
                         break;
                     }
                 }
@@ -241,164 +233,214 @@ static void connect_regions(grid_t *grid)
         }
     }
 
-    //now we have linked lists for each room. 
-    //Once a connector has been found, print the connection and remove all other connections between these two rooms
-    for (uint32_t i = 0; i < grid->region_count; i++) {
-        region_connector_t *head = region_connectors[i];
-        while (head) {
-            uint8_t to   = head->region;
-            uint8_t from = (uint8_t)(i + 1);
-
-            //make this point a floor
-            grid_set(grid, head->p.y, head->p.x, (grid_tile_t){FLOOR, from});
-            //delete from->to
-            while (delete_connector(&head, to)){}
-
-            //delete to->from too
-            region_connector_t *to_head = region_connectors[to - 1];
-            while(delete_connector(&to_head, from)) {}
+    //now open a door for every connected pair
+    for (uint32_t i = 0; i < capacity; i++) {
+        region_connector_t *connector = &connectors[i];
+        if (connector->key == 0) continue;
+
+        uint32_t from = (uint32_t)(connector->key >> 32);
+        grid->tiles[connector->cell]   = FLOOR;
+        grid->regions[connector->cell] = from;
+    }
+    return true;
+}
+
+static inline uint32_t count_exits(dungeon_t *grid, int32_t row, int32_t col, int32_t *exit_row, int32_t *exit_col)
+{
+    uint32_t exits = 0;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        int32_t r = row + cardinal[i].y;
+        int32_t c = col + cardinal[i].x;
+        if (grid_get_tile(grid, r, c) != WALL) {
+            exits++;
+            *exit_row = r;
+            *exit_col = c;
         }
     }
+    return exits;
 }
 
-void remove_dead_ends(grid_t *grid)
+//! @brief: walling off a dead end can only turn its single exit into a dead end,
+//          so every dead end is followed back down its corridor in a single pass over the grid.
+static void remove_dead_ends(dungeon_t *grid)
 {
-    bool done = false;
-
-    while(!done) {
-        done = true;
-
-        for (uint32_t row = 1; row < grid->height - 1; row++) {
-            for (uint32_t col = 1; col < grid->width - 1; col++) {
-                if (grid_get_tile(grid, row,col) == WALL) continue;
-                
-                uint32_t exits = 0;
-                for (uint32_t i = 0; i < 4; i++)
-                {
-                    if (grid_get_tile(grid, row + cardinal[i].y, col + cardinal[i].x) != WALL) exits++;
-                }
-                if (exits != 1) continue;
+    for (int32_t row = 1; row < grid->height - 1; row++) {
+        for (int32_t col = 1; col < grid->width - 1; col++) {
+            int32_t r = row;
+            int32_t c = col;
 
-                done = false;
-                grid_set_tile(grid, row, col, WALL);
+            while (r >= 1 && r < grid->height - 1 && c >= 1 && c < grid->width - 1) {
+                if (grid_get_tile(grid, r, c) == WALL) break;
+
+                int32_t next_row = 0;
+                int32_t next_col = 0;
+                if (count_exits(grid, r, c, &next_row, &next_col) != 1) break;
+
+                grid_set_tile(grid, r, c, WALL);
+                r = next_row;
+                c = next_col;
             }
         }
     }
 }
 
-void create_dungeon(void)
+static void carve_room(dungeon_t *grid, int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    uint32_t max_tries = 250;
+    for (int32_t row = y; row < y + height; row++) {
+        for (int32_t col = x; col < x + width; col++) {
+            grid_set(grid, row, col, FLOOR, grid->region_count);
+        }
+    }
+}
 
-    float map_width = (float)GRID_SIZE;
-    float map_height = (float)GRID_SIZE;
+//! @brief: rooms are the only floor tiles at this point, so an overlap test against the grid
+//          is the same as testing against every room placed so far
+static bool room_overlaps(dungeon_t *grid, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    for (int32_t row = y; row < y + height; row++) {
+        const uint8_t *tiles = &grid->tiles[grid->width * row];
+        for (int32_t col = x; col < x + width; col++) {
+            if (tiles[col] != WALL) return true;
+        }
+    }
+    return false;
+}
 
-    uint32_t room_count = 0;
-    rect_t rooms[ROOM_COUNT];
+//! @brief: opens the border tile next to an odd cell. Odd cells are always floor after the maze pass,
+//          so the door is reachable and keeps its corridor from being removed as a dead end.
+static void carve_door(dungeon_t *grid, int32_t row, int32_t col, int32_t inner_row, int32_t inner_col)
+{
+    if (grid_get_tile(grid, inner_row, inner_col) != FLOOR) {
+        LOGE("Door at %d,%d does not lead to an odd cell", row, col);
+        return;
+    }
+    grid_set(grid, row, col, FLOOR, grid_get_region(grid, inner_row, inner_col));
+}
 
-    grid_t grid;
-    grid_init(&grid, GRID_SIZE, GRID_SIZE);
+static void carve_doors(dungeon_t *grid, const int32_t doors[4])
+{
+    int32_t w = grid->width;
+    int32_t h = grid->height;
 
-    grid.region_count++;
+    if (doors[DUNGEON_NORTH] > 0 && doors[DUNGEON_NORTH] < w - 1) {
+        carve_door(grid, 0, doors[DUNGEON_NORTH], 1, doors[DUNGEON_NORTH]);
+    }
+    if (doors[DUNGEON_EAST] > 0 && doors[DUNGEON_EAST] < h - 1) {
+        carve_door(grid, doors[DUNGEON_EAST], w - 1, doors[DUNGEON_EAST], w - 2);
+    }
+    if (doors[DUNGEON_SOUTH] > 0 && doors[DUNGEON_SOUTH] < w - 1) {
+        carve_door(grid, h - 1, doors[DUNGEON_SOUTH], h - 2, doors[DUNGEON_SOUTH]);
+    }
+    if (doors[DUNGEON_WEST] > 0 && doors[DUNGEON_WEST] < h - 1) {
+        carve_door(grid, doors[DUNGEON_WEST], 0, doors[DUNGEON_WEST], 1);
+    }
+}
 
-    rect_t *first_room = &rooms[room_count++];
-    first_room->min.x = 1;
-    first_room->min.y = 1;
-    first_room->size.x = 11;
-    first_room->size.y = 11;
+size_t dungeon_scratch_size(int32_t width, int32_t height)
+{
+    //! maze stack and connector table are never used at the same time, so they share a block
+    return (grid_odd_cell_count(width, height) + 1) * sizeof(vec2i_t);
+}
 
-    for (uint32_t row = 1; row < 12; row++) {
-        for (uint32_t col = 1; col < 12; col++) {
-            grid_set_tile(&grid, row, col, FLOOR);
-            grid_set_region(&grid, row,col,grid.region_count);
-        }
-    }
+bool dungeon_generate(dungeon_t *grid, const dungeon_config_t *config, void *scratch, size_t scratch_size)
+{
+    assert(grid->tiles && grid->regions);
+    assert(scratch_size >= dungeon_scratch_size(config->width, config->height));
 
-    for (uint32_t i = 0; i < max_tries; i++) {
-        //room size needs to be odd according to bob nystrom:
-        //https://github.com/munificent/hauberk/blob/db360d9efa714efb6d937c31953ef849c7394a39/lib/src/content/dungeon.dart
-        int width = (int)rng_in_range(9.0f, 18.0f);
-        int height = (int)rng_in_range(9.0f, 18.0f);
+    rng_t rng = {config->seed};
+    uint32_t max_tries = config->room_count * ROOM_TRIES_PER_ROOM;
 
-        if (width % 2 == 0) width++;
-        if (height % 2 == 0) height++;
+    grid_init(grid, config->width, config->height);
 
-        int x = (int)rng_in_range(0, map_width - width);
-        int y = (int)rng_in_range(0, map_height - height);
+    uint32_t queue_cap = grid_odd_cell_count(grid->width, grid->height) + 1;
+    uint32_t room_count = 0;
 
-        if (x % 2 == 0) x++;
-        if (y % 2 == 0) y++;
+    grid->region_count++;
+    carve_room(grid, 1, 1, FIRST_ROOM_SIZE, FIRST_ROOM_SIZE);
+    room_count++;
 
-        rect_t room = (rect_t){{x,y},{width, height}};
-        bool collided = false;
-        for (uint32_t j = 0; j < room_count; j++) {
-            rect_t other = rooms[j];
-            if (rect_vs_rect(room, other)) {
-                collided = true;
-                break;
-            }
-        }
+    for (uint32_t i = 0; i < max_tries && room_count < config->room_count; i++) {
+        //room size needs to be odd according to bob nystrom:
+        //https://github.com/munificent/hauberk/blob/db360d9efa714efb6d937c31953ef849c7394a39/lib/src/content/dungeon.dart
+        int32_t width  = rng_in_range(&rng, MIN_ROOM_SIZE, MAX_ROOM_SIZE + 1) | 1;
+        int32_t height = rng_in_range(&rng, MIN_ROOM_SIZE, MAX_ROOM_SIZE + 1) | 1;
+
+        //rooms start on odd tiles and keep a one tile border around the map
+        int32_t x_slots = (grid->width - 1 - width) / 2;
+        int32_t y_slots = (grid->height - 1 - height) / 2;
+        if (x_slots <= 0 || y_slots <= 0) continue;
+
+        int32_t x = 1 + 2 * rng_in_range(&rng, 0, x_slots);
+        int32_t y = 1 + 2 * rng_in_range(&rng, 0, y_slots);
 
-        if (collided) continue;
+        if (room_overlaps(grid, x, y, width, height)) continue;
 
         //we were able to place the room;
-        rooms[room_count++] = room;
+        room_count++;
         //new room means new region
-        grid.region_count++;
-
-        for (uint32_t row = y; row < y + height; row++) {
-            for (uint32_t col = x; col < x + width; col++) {
-                grid_set_tile(&grid, row, col, FLOOR);
-                grid_set_region(&grid, row, col, grid.region_count);
-            }
-        }
-        if (room_count == ROOM_COUNT) break;
+        grid->region_count++;
+        carve_room(grid, x, y, width, height);
     }
 
-
     //now carve mazes
-    for (uint32_t row = 1; row < grid.height; row += 2) {
-        for (uint32_t col = 1; col < grid.width; col += 2) {
-            if (grid_get_tile(&grid, row, col) == WALL) {
-                grow_maze(&grid, col, row);
+    for (int32_t row = 1; row < grid->height; row += 2) {
+        for (int32_t col = 1; col < grid->width; col += 2) {
+            if (grid_get_tile(grid, row, col) == WALL) {
+                grow_maze(grid, &rng, col, row, (vec2i_t *)scratch, queue_cap);
             }
         }
     }
 
     //for every point in the map, have a list of regions it connects
-    connect_regions(&grid);
+    if (!connect_regions(grid, scratch, scratch_size)) {
+        return false;
+    }
+
+    carve_doors(grid, config->doors);
+
     //remove dead ends
-    remove_dead_ends(&grid);
+    remove_dead_ends(grid);
+    return true;
+}
 
-    //now write to file
-    FILE *test_map = fopen("./assets/tilemaps/dungeon.map", "w");
-    char *buf = memory_alloc(1024*1024, MEM_TAG_TEMP);
-    char *ptr = buf;
-    for (uint32_t row = 0; row  < GRID_SIZE; row++) {
-        for (uint32_t col = 0; col < GRID_SIZE; col++) {
-            int val = 11;
-            if (grid_get_tile(&grid, row,col) == FLOOR) val = 140;
-            ptr += sprintf(ptr, "%03d,",val);
-        }
-        ptr += sprintf(ptr, "\n");
+bool create_dungeon(dungeon_t *grid, const dungeon_config_t *config)
+{
+    if (config->width < FIRST_ROOM_SIZE + 2 || config->height < FIRST_ROOM_SIZE + 2) {
+        LOGE("Dungeon size %dx%d is too small", config->width, config->height);
+        return false;
     }
-    fwrite(buf, 1, (size_t)(ptr - buf), test_map);
-    fclose(test_map);
 
-    ptr = buf;
-    memset(buf, 0, 1024 * 1024);
+    if ((uint64_t)config->width * (uint64_t)config->height * sizeof(uint32_t) > UINT32_MAX) {
+        LOGE("Dungeon size %dx%d is too large", config->width, config->height);
+        return false;
+    }
 
-    //visualisation
-    for (uint32_t row = 0; row  < GRID_SIZE; row++) {
-        for (uint32_t col = 0; col < GRID_SIZE; col++) {
-            ptr += sprintf(ptr, "%03d,",grid_get_region(&grid, row, col));
-        }
-        ptr += sprintf(ptr, "\n");
+    uint32_t cell_count = (uint32_t)config->width * (uint32_t)config->height;
+    grid->tiles   = memory_alloc(cell_count * sizeof(uint8_t), MEM_TAG_HEAP);
+    grid->regions = memory_alloc(cell_count * sizeof(uint32_t), MEM_TAG_HEAP);
+
+    size_t scratch_size = dungeon_scratch_size(config->width, config->height);
+    void *scratch       = memory_alloc((uint32_t)scratch_size, MEM_TAG_HEAP);
+
+    bool success = dungeon_generate(grid, config, scratch, scratch_size);
+    memory_dealloc(scratch);
+
+    if (!success) {
+        destroy_dungeon(grid);
+        return false;
     }
 
-    test_map = fopen("./assets/tilemaps/test.map", "w");
-    fwrite(buf, 1, (size_t)(ptr - buf), test_map);
-    fclose(test_map);
+    //now write to file
+    tilemap_write(grid, "./assets/tilemaps/dungeon.tmap", true);
 
     LOGI("SUCCESS");
+    return true;
+}
+
+void destroy_dungeon(dungeon_t *grid)
+{
+    if (grid->tiles) memory_dealloc(grid->tiles);
+    if (grid->regions) memory_dealloc(grid->regions);
+    memset(grid, 0, sizeof(*grid));
 }
@@ -0,0 +1,226 @@
+#include <tilemap.h>
+#include <logger.h>
+#include <memory.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+#define TILEMAP_ALIGN(x) (((x) + 7) & ~(uint64_t)7)
+#define TILEMAP_MAX_RUN  UINT8_MAX
+
+static uint64_t tilemap_tile_runs(const uint8_t *tiles, uint64_t count)
+{
+    uint64_t runs = 0;
+    for (uint64_t i = 0; i < count; runs++) {
+        uint64_t run = 1;
+        while (i + run < count && run < TILEMAP_MAX_RUN && tiles[i + run] == tiles[i]) run++;
+        i += run;
+    }
+    return runs;
+}
+
+static uint64_t tilemap_region_runs(const uint32_t *regions, uint64_t count)
+{
+    uint64_t runs = 0;
+    for (uint64_t i = 0; i < count; runs++) {
+        uint64_t run = 1;
+        while (i + run < count && regions[i + run] == regions[i]) run++;
+        i += run;
+    }
+    return runs;
+}
+
+static void tilemap_write_tile_runs(FILE *file, const uint8_t *tiles, uint64_t count)
+{
+    for (uint64_t i = 0; i < count;) {
+        uint64_t run = 1;
+        while (i + run < count && run < TILEMAP_MAX_RUN && tiles[i + run] == tiles[i]) run++;
+
+        uint8_t pair[2] = {(uint8_t)run, tiles[i]};
+        fwrite(pair, 1, sizeof(pair), file);
+        i += run;
+    }
+}
+
+static void tilemap_write_region_runs(FILE *file, const uint32_t *regions, uint64_t count)
+{
+    for (uint64_t i = 0; i < count;) {
+        uint64_t run = 1;
+        while (i + run < count && regions[i + run] == regions[i]) run++;
+
+        uint32_t pair[2] = {(uint32_t)run, regions[i]};
+        fwrite(pair, 1, sizeof(pair), file);
+        i += run;
+    }
+}
+
+static void tilemap_write_padding(FILE *file, uint64_t offset)
+{
+    static const uint8_t zeros[8] = {0};
+    fwrite(zeros, 1, TILEMAP_ALIGN(offset) - offset, file);
+}
+
+bool tilemap_write(const dungeon_t *dungeon, const char *path, bool compress)
+{
+    uint64_t cell_count = (uint64_t)dungeon->width * (uint64_t)dungeon->height;
+
+    tilemap_header_t header = {0};
+    header.magic        = TILEMAP_MAGIC;
+    header.version      = TILEMAP_VERSION;
+    header.width        = dungeon->width;
+    header.height       = dungeon->height;
+    header.region_count = dungeon->region_count;
+    header.tiles_size   = cell_count * sizeof(uint8_t);
+    header.regions_size = cell_count * sizeof(uint32_t);
+
+    //only keep runs when they actually save space, maze corridors are mostly short runs
+    if (compress) {
+        uint64_t tiles_size = tilemap_tile_runs(dungeon->tiles, cell_count) * 2 * sizeof(uint8_t);
+        if (tiles_size < header.tiles_size) {
+            header.flags     |= TILEMAP_FLAG_RLE_TILES;
+            header.tiles_size = tiles_size;
+        }
+
+        uint64_t regions_size = tilemap_region_runs(dungeon->regions, cell_count) * 2 * sizeof(uint32_t);
+        if (regions_size < header.regions_size) {
+            header.flags       |= TILEMAP_FLAG_RLE_REGIONS;
+            header.regions_size = regions_size;
+        }
+    }
+
+    header.tiles_offset   = TILEMAP_ALIGN(sizeof(header));
+    header.regions_offset = TILEMAP_ALIGN(header.tiles_offset + header.tiles_size);
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        LOGE("Unable to open %s for writing", path);
+        return false;
+    }
+
+    fwrite(&header, 1, sizeof(header), file);
+    tilemap_write_padding(file, sizeof(header));
+
+    if (header.flags & TILEMAP_FLAG_RLE_TILES) {
+        tilemap_write_tile_runs(file, dungeon->tiles, cell_count);
+    } else {
+        fwrite(dungeon->tiles, 1, header.tiles_size, file);
+    }
+    tilemap_write_padding(file, header.tiles_offset + header.tiles_size);
+
+    if (header.flags & TILEMAP_FLAG_RLE_REGIONS) {
+        tilemap_write_region_runs(file, dungeon->regions, cell_count);
+    } else {
+        fwrite(dungeon->regions, 1, header.regions_size, file);
+    }
+
+    bool success = !ferror(file);
+    if (fclose(file) != 0) success = false;
+
+    if (!success) LOGE("Unable to write %s", path);
+    return success;
+}
+
+static bool tilemap_decode_tiles(const uint8_t *src, uint64_t size, uint8_t *dst, uint64_t count)
+{
+    uint64_t written = 0;
+    for (uint64_t i = 0; i + 1 < size; i += 2) {
+        uint8_t run = src[i];
+        if (run == 0 || written + run > count) return false;
+
+        memset(dst + written, src[i + 1], run);
+        written += run;
+    }
+    return written == count;
+}
+
+static bool tilemap_decode_regions(const uint32_t *src, uint64_t size, uint32_t *dst, uint64_t count)
+{
+    uint64_t written = 0;
+    for (uint64_t i = 0; i + 1 < size / sizeof(uint32_t); i += 2) {
+        uint32_t run = src[i];
+        if (run == 0 || written + run > count) return false;
+
+        for (uint32_t j = 0; j < run; j++) dst[written + j] = src[i + 1];
+        written += run;
+    }
+    return written == count;
+}
+
+static bool tilemap_section_valid(const mapped_file_t *file, uint64_t offset, uint64_t size)
+{
+    return (offset % 8) == 0 && offset <= file->size && size <= file->size - offset;
+}
+
+bool tilemap_open(tilemap_t *map, const char *path)
+{
+    memset(map, 0, sizeof(*map));
+
+    if (!map_whole_file(path, &map->file)) return false;
+
+    const tilemap_header_t *header = (const tilemap_header_t *)map->file.data;
+    if (map->file.size < sizeof(*header) || header->magic != TILEMAP_MAGIC) {
+        LOGE("%s is not a tilemap", path);
+        tilemap_close(map);
+        return false;
+    }
+
+    if (header->version != TILEMAP_VERSION) {
+        LOGE("%s has version %u, expected %u", path, header->version, TILEMAP_VERSION);
+        tilemap_close(map);
+        return false;
+    }
+
+    uint64_t cell_count = (uint64_t)header->width * (uint64_t)header->height;
+    bool rle_tiles      = header->flags & TILEMAP_FLAG_RLE_TILES;
+    bool rle_regions    = header->flags & TILEMAP_FLAG_RLE_REGIONS;
+
+    if (header->width <= 0 || header->height <= 0 ||
+        cell_count * sizeof(uint32_t) > UINT32_MAX ||
+        !tilemap_section_valid(&map->file, header->tiles_offset, header->tiles_size) ||
+        !tilemap_section_valid(&map->file, header->regions_offset, header->regions_size) ||
+        (!rle_tiles && header->tiles_size != cell_count) ||
+        (!rle_regions && header->regions_size != cell_count * sizeof(uint32_t))) {
+        LOGE("%s has a corrupt header", path);
+        tilemap_close(map);
+        return false;
+    }
+
+    map->width        = header->width;
+    map->height       = header->height;
+    map->region_count = header->region_count;
+    map->tiles        = map->file.data + header->tiles_offset;
+    map->regions      = (const uint32_t *)(map->file.data + header->regions_offset);
+
+    if (!rle_tiles && !rle_regions) return true;
+
+    //compressed sections are decoded once into a single block
+    uint64_t tiles_size = TILEMAP_ALIGN(cell_count);
+    map->decoded = memory_alloc((uint32_t)(tiles_size + cell_count * sizeof(uint32_t)), MEM_TAG_HEAP);
+    uint8_t *tiles    = (uint8_t *)map->decoded;
+    uint32_t *regions = (uint32_t *)(tiles + tiles_size);
+
+    bool success = true;
+    if (rle_tiles) {
+        success &= tilemap_decode_tiles(map->tiles, header->tiles_size, tiles, cell_count);
+        map->tiles = tiles;
+    }
+    if (rle_regions) {
+        success &= tilemap_decode_regions(map->regions, header->regions_size, regions, cell_count);
+        map->regions = regions;
+    }
+
+    if (!success) {
+        LOGE("%s has corrupt runs", path);
+        tilemap_close(map);
+        return false;
+    }
+    return true;
+}
+
+void tilemap_close(tilemap_t *map)
+{
+    if (map->decoded) memory_dealloc(map->decoded);
+    unmap_whole_file(&map->file);
+    memset(map, 0, sizeof(*map));
+}
@@ -0,0 +1,206 @@
+#include <world_streamer.h>
+#include <logger.h>
+#include <memory.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stb/stb_ds.h>
+
+#define WORLD_CHUNK_NONE      UINT32_MAX
+#define WORLD_SEAM_VERTICAL   0x1
+#define WORLD_SEAM_HORIZONTAL 0x2
+
+static inline uint64_t world_mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t world_chunk_key(int32_t cx, int32_t cy)
+{
+    return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy;
+}
+
+static inline uint64_t world_hash(uint64_t seed, int32_t x, int32_t y, uint32_t salt)
+{
+    return world_mix(seed ^ world_mix(world_chunk_key(x, y) + salt * 0x9E3779B97F4A7C15ULL));
+}
+
+//! @brief: floor division, so negative tiles end up in negative chunks
+static inline int32_t world_tile_to_chunk(int32_t tile)
+{
+    return tile >= 0 ? tile / WORLD_CHUNK_SIZE : -((-tile + WORLD_CHUNK_SIZE - 1) / WORLD_CHUNK_SIZE);
+}
+
+//! @brief: odd door offset for the seam east (vertical) or south (horizontal) of chunk x,y.
+//          Both neighbours hash the same seam, so their doors line up without knowing about each other.
+static inline int32_t world_seam_offset(uint64_t seed, int32_t x, int32_t y, uint32_t seam)
+{
+    return 1 + 2 * (int32_t)(world_hash(seed, x, y, seam) % ((WORLD_CHUNK_SIZE - 1) / 2));
+}
+
+static void world_generate_chunk(void *data)
+{
+    world_chunk_t *chunk   = (world_chunk_t *)data;
+    world_config_t *config = &chunk->world->config;
+
+    dungeon_config_t dungeon_config = {0};
+    dungeon_config.width      = WORLD_CHUNK_SIZE;
+    dungeon_config.height     = WORLD_CHUNK_SIZE;
+    dungeon_config.room_count = config->room_count;
+    dungeon_config.seed       = world_hash(config->seed, chunk->cx, chunk->cy, 0);
+    dungeon_config.doors[DUNGEON_NORTH] = world_seam_offset(config->seed, chunk->cx, chunk->cy - 1, WORLD_SEAM_HORIZONTAL);
+    dungeon_config.doors[DUNGEON_SOUTH] = world_seam_offset(config->seed, chunk->cx, chunk->cy, WORLD_SEAM_HORIZONTAL);
+    dungeon_config.doors[DUNGEON_WEST]  = world_seam_offset(config->seed, chunk->cx - 1, chunk->cy, WORLD_SEAM_VERTICAL);
+    dungeon_config.doors[DUNGEON_EAST]  = world_seam_offset(config->seed, chunk->cx, chunk->cy, WORLD_SEAM_VERTICAL);
+
+    bool success = dungeon_generate(&chunk->dungeon,
+                                    &dungeon_config,
+                                    chunk->scratch,
+                                    dungeon_scratch_size(WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE));
+
+    atomic_store_explicit(&chunk->state, success ? CHUNK_STATE_RESIDENT : CHUNK_STATE_FAILED, memory_order_release);
+}
+
+bool world_streamer_init(world_streamer_t *world, const world_config_t *config)
+{
+    memset(world, 0, sizeof(*world));
+    world->config = *config;
+
+    size_t cell_count   = WORLD_CHUNK_SIZE * WORLD_CHUNK_SIZE;
+    size_t scratch_size = dungeon_scratch_size(WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE);
+    size_t slot_size    = cell_count * sizeof(uint32_t) + cell_count + scratch_size;
+    //scratch goes first, the connector table in it needs 8 byte alignment
+    slot_size = (slot_size + 7) & ~(size_t)7;
+
+    uint32_t needed = (uint32_t)((2 * config->radius + 1) * (2 * config->radius + 1));
+    world->chunk_capacity = (uint32_t)(config->memory_budget / (slot_size + sizeof(world_chunk_t)));
+
+    if (world->chunk_capacity < needed) {
+        LOGE("World memory budget of %u bytes holds %u chunks, radius %d needs %u",
+             config->memory_budget, world->chunk_capacity, config->radius, needed);
+        return false;
+    }
+
+    world->chunks      = memory_alloc(world->chunk_capacity * sizeof(world_chunk_t), MEM_TAG_HEAP);
+    world->slot_memory = memory_alloc((uint32_t)(world->chunk_capacity * slot_size), MEM_TAG_HEAP);
+
+    for (uint32_t i = 0; i < world->chunk_capacity; i++) {
+        world_chunk_t *chunk = &world->chunks[i];
+        uint8_t *slot        = world->slot_memory + i * slot_size;
+
+        chunk->world           = world;
+        chunk->scratch         = slot;
+        chunk->dungeon.regions = (uint32_t *)(slot + scratch_size);
+        chunk->dungeon.tiles   = slot + scratch_size + cell_count * sizeof(uint32_t);
+        atomic_init(&chunk->state, CHUNK_STATE_FREE);
+    }
+
+    hash_map_init(world->lookup, WORLD_CHUNK_NONE);
+    LOGI("World streamer holds %u chunks of %dx%d tiles", world->chunk_capacity, WORLD_CHUNK_SIZE, WORLD_CHUNK_SIZE);
+    return true;
+}
+
+//! @brief: a free slot, or the least recently used finished chunk that wasn't touched this frame
+static world_chunk_t *world_acquire_slot(world_streamer_t *world)
+{
+    world_chunk_t *lru = NULL;
+    for (uint32_t i = 0; i < world->chunk_capacity; i++) {
+        world_chunk_t *chunk = &world->chunks[i];
+        uint32_t state = atomic_load_explicit(&chunk->state, memory_order_acquire);
+
+        if (state == CHUNK_STATE_FREE) return chunk;
+        //the job still owns generating slots
+        if (state == CHUNK_STATE_GENERATING || chunk->last_used == world->frame) continue;
+
+        if (!lru || chunk->last_used < lru->last_used) lru = chunk;
+    }
+
+    if (lru) {
+        (void)hmdel(world->lookup, world_chunk_key(lru->cx, lru->cy));
+        atomic_store_explicit(&lru->state, CHUNK_STATE_FREE, memory_order_relaxed);
+    }
+    return lru;
+}
+
+void world_streamer_update(world_streamer_t *world, int32_t tile_x, int32_t tile_y)
+{
+    if (!world->chunks) return;
+    world->frame++;
+
+    int32_t center_x = world_tile_to_chunk(tile_x);
+    int32_t center_y = world_tile_to_chunk(tile_y);
+    int32_t radius   = world->config.radius;
+
+    //touch everything we still have first so none of it gets evicted below
+    for (int32_t cy = center_y - radius; cy <= center_y + radius; cy++) {
+        for (int32_t cx = center_x - radius; cx <= center_x + radius; cx++) {
+            uint32_t index = hmget(world->lookup, world_chunk_key(cx, cy));
+            if (index != WORLD_CHUNK_NONE) world->chunks[index].last_used = world->frame;
+        }
+    }
+
+    //queue missing chunks in rings so the closest ones are generated first
+    for (int32_t ring = 0; ring <= radius; ring++) {
+        for (int32_t cy = center_y - ring; cy <= center_y + ring; cy++) {
+            for (int32_t cx = center_x - ring; cx <= center_x + ring; cx++) {
+                if (abs(cx - center_x) != ring && abs(cy - center_y) != ring) continue;
+
+                uint64_t key = world_chunk_key(cx, cy);
+                if (hmget(world->lookup, key) != WORLD_CHUNK_NONE) continue;
+
+                world_chunk_t *chunk = world_acquire_slot(world);
+                if (!chunk) {
+                    //everything is in flight, try again next frame
+                    return;
+                }
+
+                chunk->cx        = cx;
+                chunk->cy        = cy;
+                chunk->last_used = world->frame;
+                atomic_store_explicit(&chunk->state, CHUNK_STATE_GENERATING, memory_order_relaxed);
+                hmput(world->lookup, key, (uint32_t)(chunk - world->chunks));
+
+                jobs_submit(world_generate_chunk, chunk, &world->jobs);
+            }
+        }
+    }
+}
+
+const dungeon_t *world_streamer_get_chunk(world_streamer_t *world, int32_t cx, int32_t cy)
+{
+    if (!world->chunks) return NULL;
+
+    uint32_t index = hmget(world->lookup, world_chunk_key(cx, cy));
+    if (index == WORLD_CHUNK_NONE) return NULL;
+
+    world_chunk_t *chunk = &world->chunks[index];
+    if (atomic_load_explicit(&chunk->state, memory_order_acquire) != CHUNK_STATE_RESIDENT) return NULL;
+    return &chunk->dungeon;
+}
+
+uint8_t world_streamer_get_tile(world_streamer_t *world, int32_t x, int32_t y)
+{
+    int32_t cx = world_tile_to_chunk(x);
+    int32_t cy = world_tile_to_chunk(y);
+
+    const dungeon_t *dungeon = world_streamer_get_chunk(world, cx, cy);
+    if (!dungeon) return INVALID_TILE;
+
+    int32_t col = x - cx * WORLD_CHUNK_SIZE;
+    int32_t row = y - cy * WORLD_CHUNK_SIZE;
+    return dungeon->tiles[row * WORLD_CHUNK_SIZE + col];
+}
+
+void world_streamer_shutdown(world_streamer_t *world)
+{
+    //jobs write into slot memory, let them finish first
+    jobs_wait(&world->jobs);
+
+    hmfree(world->lookup);
+    if (world->chunks) memory_dealloc(world->chunks);
+    if (world->slot_memory) memory_dealloc(world->slot_memory);
+    memset(world, 0, sizeof(*world));
+}
@@ -20,6 +20,7 @@ bool renderer_initialize(renderer_t *renderer, window_t *window, renderer_config
     renderer->renderbuffers = renderbuffers;
     renderer->textures = textures;
     renderer->current_frame = 0;
+    renderer->frame_count   = 0;
     renderer->uniform_buffer_index = 0;
     renderer->current_shader = NULL;
     renderer->backend = memory_alloc(sizeof(renderer_backend_t), MEM_TAG_PERMANENT); 
@@ -41,8 +42,16 @@ bool renderer_initialize(renderer_t *renderer, window_t *window, renderer_config
     renderer->backend->use_shader = vulkan_backend_use_shader;
     renderer->backend->shader_bind_resource = vulkan_backend_shader_bind_resource;
     renderer->backend->create_render_data = vulkan_backend_create_render_data;
+    renderer->backend->destroy_render_data = vulkan_backend_destroy_render_data;
     renderer->backend->create_texture = vulkan_backend_create_texture;
+    renderer->backend->create_texture_from_pixels = vulkan_backend_create_texture_from_pixels;
+    renderer->backend->destroy_texture = vulkan_backend_destroy_texture;
+    renderer->backend->destroy_renderbuffer = vulkan_backend_destroy_renderbuffer;
     renderer->backend->copy_to_renderbuffer = vulkan_backend_copy_to_renderbuffer;
+    renderer->backend->map_renderbuffer = vulkan_backend_map_renderbuffer;
+    renderer->backend->begin_uploads = vulkan_backend_begin_uploads;
+    renderer->backend->end_uploads = vulkan_backend_end_uploads;
+    renderer->backend->uploads_finished = vulkan_backend_uploads_finished;
     renderer->backend->bind_index_buffers = vulkan_backend_bind_index_buffers;
     renderer->backend->bind_vertex_buffers = vulkan_backend_bind_vertex_buffers;
     renderer->backend->push_constants = vulkan_backend_push_constants;
@@ -82,6 +91,7 @@ bool renderer_frame_submit(renderer_t *renderer, frame_data_t *frame_data)
     bool success = renderer->backend->frame_submit(renderer->backend, NULL);
     if (success) {
         renderer->current_frame = (renderer->current_frame + 1) % renderer->max_frames_in_flight;
+        renderer->frame_count++;
     }
     return success;
 }
@@ -169,6 +179,36 @@ bool renderer_create_texture(renderer_t *renderer, texture_t *texture, const cha
     return renderer->backend->create_texture(renderer->backend, texture, file_path);
 }
 
+bool renderer_create_texture_from_pixels(renderer_t *renderer, texture_t *texture, const void *pixels, uint32_t width, uint32_t height)
+{
+    return renderer->backend->create_texture_from_pixels(renderer->backend, texture, pixels, width, height);
+}
+
+void renderer_destroy_texture(renderer_t *renderer, texture_t *texture)
+{
+    renderer->backend->destroy_texture(renderer->backend, texture);
+}
+
+void renderer_destroy_renderbuffer(renderer_t *renderer, renderbuffer_t *renderbuffer)
+{
+    renderer->backend->destroy_renderbuffer(renderer->backend, renderbuffer);
+}
+
+bool renderer_begin_uploads(renderer_t *renderer)
+{
+    return renderer->backend->begin_uploads(renderer->backend);
+}
+
+bool renderer_end_uploads(renderer_t *renderer)
+{
+    return renderer->backend->end_uploads(renderer->backend);
+}
+
+bool renderer_uploads_finished(renderer_t *renderer, bool wait)
+{
+    return renderer->backend->uploads_finished(renderer->backend, wait);
+}
+
 bool renderer_create_renderbuffer(renderer_t *renderer, 
                                   renderbuffer_t *renderbuffer,
                                   renderbuffer_type_e type, 
@@ -185,6 +225,11 @@ void renderer_copy_to_renderbuffer(renderer_t *renderer, renderbuffer_t *renderb
     return renderer->backend->copy_to_renderbuffer(renderer->backend, renderbuffer, src, size);
 }
 
+void *renderer_map_renderbuffer(renderer_t *renderer, renderbuffer_t *renderbuffer)
+{
+    return renderer->backend->map_renderbuffer(renderer->backend, renderbuffer);
+}
+
 bool renderer_bind_vertex_buffers(renderer_t *renderer, renderbuffer_t *vertex_buffer)
 {
     return renderer->backend->bind_vertex_buffers(renderer->backend, vertex_buffer);
@@ -210,6 +255,11 @@ void *renderer_create_render_data(renderer_t *renderer, render_data_type_e type,
     return renderer->backend->create_render_data(renderer->backend, renderer->renderbuffers, type, data);
 }
 
+void renderer_destroy_render_data(renderer_t *renderer, render_data_type_e type, void *render_data)
+{
+    renderer->backend->destroy_render_data(renderer->backend, type, render_data);
+}
+
 bool renderer_initialize_shader(renderer_t *renderer, renderer_shader_type_e shader_type, shader_resource_list_t *resources)
 {
     return renderer->backend->initialize_shader(renderer->backend, &renderer->shaders[shader_type], resources);
@@ -524,6 +524,11 @@ static void create_sync_primitives(vulkan_context_t *ctx)
         VK_CHECK(vkCreateSemaphore(ctx->logical_device, &sem_info, NULL, &ctx->present_complete_semaphores[i]));
         VK_CHECK(vkCreateFence(ctx->logical_device, &fence_info, NULL, &ctx->wait_fences[i]));
     }
+
+    //unsignaled, the upload batch resets it after every wait
+    VkFenceCreateInfo upload_fence_info = {0};
+    upload_fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VK_CHECK(vkCreateFence(ctx->logical_device, &upload_fence_info, NULL, &ctx->upload_batch.fence));
 }
 
 static void create_command_buffers(vulkan_context_t *context)
@@ -549,6 +554,8 @@ static void create_descriptor_pool(vulkan_context_t *context)
     pool_sizes[2].descriptorCount = context->max_frames_in_flight; //one uniform buffer per frame in flight
     
     VkDescriptorPoolCreateInfo pool_info = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    //instances that are destroyed give their sets back
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
     pool_info.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]);
     pool_info.pPoolSizes = pool_sizes;
     pool_info.maxSets = MAX_COMBINED_IMAGE_SAMPLER_COUNT + MAX_SSBO_COUNT + 2; //one uniform buffer per frame in flight
@@ -607,6 +614,8 @@ void vulkan_backend_shutdown(struct renderer_backend_t *backend)
 {
     vulkan_context_t *context = (vulkan_context_t *)backend->internal_context;
     vkDeviceWaitIdle(context->logical_device);
+    vulkan_backend_uploads_finished(backend, true);
+    vkDestroyFence(context->logical_device, context->upload_batch.fence, NULL);
 
     //destroy device
     context->graphics_queue = NULL;
@@ -783,6 +792,13 @@ void vulkan_backend_copy_to_renderbuffer(struct renderer_backend_t *backend, ren
     memcpy(vulkan_buffer->mapped, src, size);
 }
 
+void *vulkan_backend_map_renderbuffer(struct renderer_backend_t *backend, renderbuffer_t *renderbuffer)
+{
+    vulkan_context_t *context = (vulkan_context_t*)backend->internal_context;
+    vulkan_buffer_t *vulkan_buffer = bulk_data_getp_null_vulkan_buffer_t(context->buffers, renderbuffer->buffers[context->current_frame]);
+    return vulkan_buffer->mapped;
+}
+
 static bool vulkan_backend_create_device_local_buffer(vulkan_context_t *context, 
                                                       vulkan_buffer_t *buffer, 
                                                       uint32_t size,
@@ -804,16 +820,84 @@ static bool vulkan_backend_create_device_local_buffer(vulkan_context_t *context,
 
     create_vulkan_buffer(buffer, context, size, flags, mem_flags);
     
-    VkCommandBuffer copy_cmd = begin_command_buffer(context->logical_device, context->graphics_command_pool);
+    VkCommandBuffer copy_cmd = vulkan_begin_upload(context);
     
     VkBufferCopy copy_region = {};
     copy_region.size = size;
     vkCmdCopyBuffer(copy_cmd, staging_buffer.buffer, buffer->buffer, 1, &copy_region);
 
-    end_command_buffer(&copy_cmd, context->logical_device, context->graphics_command_pool, context->graphics_queue);
+    vulkan_end_upload(context, &copy_cmd, &staging_buffer);
+    return true;
+}
+
+bool vulkan_backend_begin_uploads(struct renderer_backend_t *backend)
+{
+    vulkan_context_t *context = (vulkan_context_t *)backend->internal_context;
+    vulkan_upload_batch_t *batch = &context->upload_batch;
+    if (batch->recording || batch->in_flight) {
+        LOGE("The previous upload batch has not finished yet");
+        return false;
+    }
+
+    batch->command_buffer       = begin_command_buffer(context->logical_device, context->graphics_command_pool);
+    batch->staging_buffer_count = 0;
+    batch->recording            = true;
+    return true;
+}
+
+bool vulkan_backend_end_uploads(struct renderer_backend_t *backend)
+{
+    vulkan_context_t *context = (vulkan_context_t *)backend->internal_context;
+    vulkan_upload_batch_t *batch = &context->upload_batch;
+    if (!batch->recording) return false;
+    batch->recording = false;
+
+    if (batch->staging_buffer_count == 0) {
+        //nothing was recorded
+        vkEndCommandBuffer(batch->command_buffer);
+        vkFreeCommandBuffers(context->logical_device, context->graphics_command_pool, 1, &batch->command_buffer);
+        return true;
+    }
+
+    //frames submitted after this one read the vertices and indices, images are transitioned by their own barriers
+    VkMemoryBarrier barrier = {VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    vkCmdPipelineBarrier(batch->command_buffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                         0,
+                         1, &barrier,
+                         0, NULL,
+                         0, NULL);
+    vkEndCommandBuffer(batch->command_buffer);
+
+    VkSubmitInfo submit_info = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &batch->command_buffer;
+    VK_CHECK(vkQueueSubmit(context->graphics_queue, 1, &submit_info, batch->fence));
+    batch->in_flight = true;
+    return true;
+}
 
-    vkDestroyBuffer(context->logical_device, staging_buffer.buffer, NULL);
-    vkFreeMemory(context->logical_device, staging_buffer.memory, NULL);
+bool vulkan_backend_uploads_finished(struct renderer_backend_t *backend, bool wait)
+{
+    vulkan_context_t *context = (vulkan_context_t *)backend->internal_context;
+    vulkan_upload_batch_t *batch = &context->upload_batch;
+    if (!batch->in_flight) return true;
+
+    VkResult result = wait ? vkWaitForFences(context->logical_device, 1, &batch->fence, VK_TRUE, UINT64_MAX) :
+                             vkGetFenceStatus(context->logical_device, batch->fence);
+    if (result != VK_SUCCESS) return false;
+
+    VK_CHECK(vkResetFences(context->logical_device, 1, &batch->fence));
+    vkFreeCommandBuffers(context->logical_device, context->graphics_command_pool, 1, &batch->command_buffer);
+    for (uint32_t i = 0; i < batch->staging_buffer_count; i++) {
+        vkDestroyBuffer(context->logical_device, batch->staging_buffers[i].buffer, NULL);
+        vkFreeMemory(context->logical_device, batch->staging_buffers[i].memory, NULL);
+    }
+    batch->staging_buffer_count = 0;
+    batch->in_flight = false;
     return true;
 }
 
@@ -1018,16 +1102,17 @@ void *vulkan_backend_create_render_data(struct renderer_backend_t *backend,
         case (RENDER_DATA_SKINNED_MODEL):
         {
             vulkan_skinned_model_render_data_t *render_data = memory_alloc(sizeof(vulkan_skinned_model_render_data_t), MEM_TAG_HEAP);
-            skinned_model_t *skinned_model = (skinned_model_t *)data;
+            render_data_config_t *config = (render_data_config_t *)data;
+            assert(config->type == RENDER_DATA_SKINNED_MODEL && config->texture_count > 0);
+            assert(config->buffer_count <= sizeof(render_data->ssbo_indices) / sizeof(render_data->ssbo_indices[0]));
 
             //buffers
-            renderbuffer_t *ssbo = bulk_data_getp_null_renderbuffer_t(renderbuffers, skinned_model->skin.ssbo);
-            for (uint32_t i = 0; i < ssbo->buffer_count; i++) {
-                render_data->ssbo_indices[i] = ssbo->buffers[i];
+            for (uint32_t i = 0; i < config->buffer_count; i++) {
+                render_data->ssbo_indices[i] = config->buffer_indices[i];
             }
 
             //image sampler
-            render_data->texture_index = skinned_model->materials[0].base_color_texture;
+            render_data->texture_index = config->texture_indices[0];
             result = render_data;
             break;
         }
@@ -1354,6 +1439,16 @@ bool vulkan_backend_use_shader(renderer_backend_t *backend, shader_t *shader)
     return true;
 }
 
+//! @brief: RGBA8 bytes of the texture and its mips, what the budget of the asset store counts
+static uint32_t vulkan_texture_size(const vulkan_texture_t *texture)
+{
+    uint32_t size = 0;
+    for (uint32_t i = 0; i < MAX(texture->mip_levels, 1); i++) {
+        size += MAX(texture->w >> i, 1) * MAX(texture->h >> i, 1) * 4;
+    }
+    return size;
+}
+
 bool vulkan_backend_create_texture(renderer_backend_t *backend, texture_t *texture, const char *file_path)
 {
     vulkan_context_t *context = (vulkan_context_t*)backend->internal_context;
@@ -1377,10 +1472,56 @@ bool vulkan_backend_create_texture(renderer_backend_t *backend, texture_t *textu
     }
 
     texture->internal_data = vulkan_texture;
+    texture->size = vulkan_texture_size(vulkan_texture);
     //descriptor stuff
     return true;
 }
 
+bool vulkan_backend_create_texture_from_pixels(renderer_backend_t *backend, texture_t *texture, const void *pixels, uint32_t width, uint32_t height)
+{
+    vulkan_context_t *context = (vulkan_context_t*)backend->internal_context;
+
+    uint32_t tex_slot = bulk_data_allocate_slot_vulkan_texture_t(context->textures);
+    vulkan_texture_t *vulkan_texture = bulk_data_getp_null_vulkan_texture_t(context->textures, tex_slot);
+
+    //4 components are copied into the staging buffer as they are
+    vulkan_texture_from_buffer(vulkan_texture, context, (void *)pixels, width, height, 4, 1);
+    texture->internal_data = vulkan_texture;
+    texture->size = vulkan_texture_size(vulkan_texture);
+    return true;
+}
+
+void vulkan_backend_destroy_texture(renderer_backend_t *backend, texture_t *texture)
+{
+    vulkan_context_t *context = (vulkan_context_t*)backend->internal_context;
+    vulkan_texture_t *vulkan_texture = (vulkan_texture_t *)texture->internal_data;
+    if (!vulkan_texture) return;
+
+    vkDestroySampler(context->logical_device, vulkan_texture->sampler, NULL);
+    vkDestroyImageView(context->logical_device, vulkan_texture->view, NULL);
+    vkDestroyImage(context->logical_device, vulkan_texture->image, NULL);
+    vkFreeMemory(context->logical_device, vulkan_texture->memory, NULL);
+    bulk_data_delete_item_vulkan_texture_t(context->textures, bulk_data_index_vulkan_texture_t(context->textures, vulkan_texture));
+
+    texture->internal_data = NULL;
+    texture->size = 0;
+}
+
+void vulkan_backend_destroy_renderbuffer(renderer_backend_t *backend, renderbuffer_t *renderbuffer)
+{
+    vulkan_context_t *context = (vulkan_context_t*)backend->internal_context;
+    for (uint32_t i = 0; i < renderbuffer->buffer_count; i++) {
+        vulkan_buffer_t *buffer = bulk_data_getp_null_vulkan_buffer_t(context->buffers, renderbuffer->buffers[i]);
+        if (!buffer) continue;
+        //freeing the memory unmaps it
+        vkDestroyBuffer(context->logical_device, buffer->buffer, NULL);
+        vkFreeMemory(context->logical_device, buffer->memory, NULL);
+        bulk_data_delete_item_vulkan_buffer_t(context->buffers, renderbuffer->buffers[i]);
+    }
+    renderbuffer->buffer_count = 0;
+    renderbuffer->size = 0;
+}
+
 bool vulkan_backend_end_rendering(renderer_backend_t *backend)
 {
     vulkan_context_t *context = (vulkan_context_t*)backend->internal_context;
@@ -1450,6 +1591,33 @@ bool vulkan_backend_draw_indexed(struct renderer_backend_t *backend, int32_t ver
     return true;
 }
 
+void vulkan_backend_destroy_render_data(renderer_backend_t *backend, render_data_type_e type, void *render_data)
+{
+    vulkan_context_t *context = (vulkan_context_t *)backend->internal_context;
+    if (!render_data) return;
+
+    //sets are only allocated once the shader is initialised with the render data
+    VkDescriptorSet *sets = NULL;
+    switch(type)
+    {
+        case (RENDER_DATA_SKINNED_MODEL):
+            sets = ((vulkan_skinned_model_render_data_t *)render_data)->descriptor_sets;
+            break;
+        case (RENDER_DATA_SCENE_UNIFORMS):
+            sets = ((vulkan_uniform_buffer_render_data_t *)render_data)->descriptor_sets;
+            break;
+        default:
+            LOGE("Shader is not supported");
+            break;
+    }
+    for (uint32_t i = 0; sets && i < 3; i++) {
+        if (sets[i] != VK_NULL_HANDLE) {
+            VK_CHECK(vkFreeDescriptorSets(context->logical_device, context->descriptor_pool, 1, &sets[i]));
+        }
+    }
+    memory_dealloc(render_data);
+}
+
 bool vulkan_backend_shader_bind_resource(renderer_backend_t *backend, shader_t *shader, render_data_type_e type, void *render_data)
 {
     vulkan_context_t *context = (vulkan_context_t *)backend->internal_context;
@@ -50,3 +50,25 @@ void end_command_buffer(VkCommandBuffer *buffer, VkDevice device, VkCommandPool
     vkFreeCommandBuffers(device, pool, 1, buffer);
 }
 
+VkCommandBuffer vulkan_begin_upload(vulkan_context_t *context)
+{
+    vulkan_upload_batch_t *batch = &context->upload_batch;
+    if (batch->recording && batch->staging_buffer_count < MAX_BATCHED_UPLOADS) {
+        return batch->command_buffer;
+    }
+    return begin_command_buffer(context->logical_device, context->graphics_command_pool);
+}
+
+void vulkan_end_upload(vulkan_context_t *context, VkCommandBuffer *command_buffer, vulkan_buffer_t *staging)
+{
+    vulkan_upload_batch_t *batch = &context->upload_batch;
+    if (batch->recording && *command_buffer == batch->command_buffer) {
+        //the copies run when the batch is submitted
+        batch->staging_buffers[batch->staging_buffer_count++] = *staging;
+        return;
+    }
+
+    end_command_buffer(command_buffer, context->logical_device, context->graphics_command_pool, context->graphics_queue);
+    vkDestroyBuffer(context->logical_device, staging->buffer, NULL);
+    vkFreeMemory(context->logical_device, staging->memory, NULL);
+}
@@ -12,37 +12,26 @@
 #include <ktx.h>
 #include <ktxvulkan.h>
 
-static void copy_buffer_to_image(VkDevice device,
-                                 VkCommandPool cmd_pool,
-                                 VkQueue queue,
+static void copy_buffer_to_image(VkCommandBuffer command_buffer,
                                  VkBuffer buffer, 
                                  VkImage image, 
-                                 uint32_t w, 
-                                 uint32_t h,
                                  VkBufferImageCopy *buffer_copy_regions,
                                  uint32_t buffer_copy_region_count)
 {
-    VkCommandBuffer commandBuffer = begin_command_buffer(device, cmd_pool);
-    vkCmdCopyBufferToImage(commandBuffer, 
+    vkCmdCopyBufferToImage(command_buffer, 
                            buffer, 
                            image, 
                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
                            buffer_copy_region_count, 
                            buffer_copy_regions);
-    end_command_buffer(&commandBuffer, device, cmd_pool, queue);
 }
 
-static void transition_image_layout(VkDevice device,
-                                    VkCommandPool pool,
-                                    VkQueue queue,
+static void transition_image_layout(VkCommandBuffer command_buffer,
                                     VkImage image,
-                                    VkFormat format,
                                     VkImageLayout old_layout,
                                     VkImageLayout new_layout,
                                     uint32_t mip_levels)
 {
-    VkCommandBuffer commandBuffer = begin_command_buffer(device, pool);
-
     VkImageMemoryBarrier barrier = {};
     barrier.sType     = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = old_layout,
@@ -73,15 +62,39 @@ static void transition_image_layout(VkDevice device,
         destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
     }
 
-    vkCmdPipelineBarrier(commandBuffer, 
+    vkCmdPipelineBarrier(command_buffer, 
                          sourceStage,
                          destinationStage,
                          0, 
                          0, NULL,
                          0, NULL,
                          1, &barrier);
+}
 
-    end_command_buffer(&commandBuffer, device, pool, queue); 
+//! @brief: both layout transitions and the copy go into one command buffer, see vulkan_begin_upload
+static void upload_image(vulkan_context_t *context,
+                         vulkan_texture_t *texture,
+                         vulkan_buffer_t *staging_buffer,
+                         VkBufferImageCopy *buffer_copy_regions,
+                         uint32_t buffer_copy_region_count)
+{
+    VkCommandBuffer command_buffer = vulkan_begin_upload(context);
+    transition_image_layout(command_buffer,
+                            texture->image,
+                            VK_IMAGE_LAYOUT_UNDEFINED,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            texture->mip_levels);
+    copy_buffer_to_image(command_buffer,
+                         staging_buffer->buffer,
+                         texture->image,
+                         buffer_copy_regions,
+                         buffer_copy_region_count);
+    transition_image_layout(command_buffer,
+                            texture->image,
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                            texture->mip_levels);
+    vulkan_end_upload(context, &command_buffer, staging_buffer);
 }
 
 static void create_image(vulkan_texture_t *texture,
@@ -197,33 +210,7 @@ void vulkan_texture_from_buffer(vulkan_texture_t *texture,
                  &context->memory_properties, 
                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
     
-    transition_image_layout(context->logical_device,
-                            context->graphics_command_pool,
-                            context->graphics_queue,
-                            texture->image,
-                            format,
-                            VK_IMAGE_LAYOUT_UNDEFINED,
-                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                            texture->mip_levels);
-    
-    copy_buffer_to_image(context->logical_device,
-                         context->graphics_command_pool,
-                         context->graphics_queue,
-                         staging_buffer.buffer,
-                         texture->image,
-                         w, h, &region, 1);
-
-    transition_image_layout(context->logical_device,
-                            context->graphics_command_pool,
-                            context->graphics_queue,
-                            texture->image,
-                            format,
-                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                            texture->mip_levels);
-
-    vkDestroyBuffer(context->logical_device, staging_buffer.buffer,NULL);
-    vkFreeMemory(context->logical_device, staging_buffer.memory, NULL);
+    upload_image(context, texture, &staging_buffer, &region, 1);
 
     texture->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     
@@ -323,35 +310,7 @@ bool vulkan_ktx_texture_from_file(vulkan_texture_t *texture, vulkan_context_t *c
                  VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                  &context->memory_properties, 
                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-    transition_image_layout(context->logical_device,
-                            context->graphics_command_pool,
-                            context->graphics_queue,
-                            texture->image,
-                            format,
-                            VK_IMAGE_LAYOUT_UNDEFINED,
-                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                            texture->mip_levels);
-    copy_buffer_to_image(context->logical_device,
-                         context->graphics_command_pool,
-                         context->graphics_queue,
-                         staging_buffer.buffer,
-                         texture->image,
-                         texture->w,
-                         texture->h,
-                         buffer_copy_regions,
-                         buffer_copy_region_count);
-
-    transition_image_layout(context->logical_device,
-                            context->graphics_command_pool,
-                            context->graphics_queue,
-                            texture->image,
-                            format,
-                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                            texture->mip_levels);
-    
-    vkDestroyBuffer(context->logical_device, staging_buffer.buffer,NULL);
-    vkFreeMemory(context->logical_device, staging_buffer.memory, NULL);
+    upload_image(context, texture, &staging_buffer, buffer_copy_regions, buffer_copy_region_count);
 
     ktxTexture_Destroy(ktx_texture);
 
@@ -133,3 +133,15 @@ const char *string_get_file_directory(const char *file_path, memory_tag_t tag)
 
     return result;
 }
+
+uint64_t string_hash(const char *string)
+{
+    if (!string) return 0;
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *c = string; *c; c++) {
+        hash ^= (uint8_t)*c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -3,7 +3,14 @@
 #include <logger.h>
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
+#if defined (__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 uint8_t *read_whole_file(const char *file_path, long *size, memory_tag_t tag)
 {
@@ -27,3 +34,46 @@ uint8_t *read_whole_file(const char *file_path, long *size, memory_tag_t tag)
 
     return file_buf;
 }
+
+bool map_whole_file(const char *file_path, mapped_file_t *file)
+{
+    memset(file, 0, sizeof(*file));
+#if defined (__linux__)
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        LOGE("Unable to open %s", file_path);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        LOGE("Unable to stat %s", file_path);
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    //the mapping keeps the file alive
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        LOGE("Unable to map %s", file_path);
+        return false;
+    }
+
+    file->data = data;
+    file->size = (size_t)st.st_size;
+    return true;
+#else
+    LOGE("map_whole_file is not implemented on this platform");
+    return false;
+#endif
+}
+
+void unmap_whole_file(mapped_file_t *file)
+{
+#if defined (__linux__)
+    if (file->data) munmap((void *)file->data, file->size);
+#endif
+    memset(file, 0, sizeof(*file));
+}
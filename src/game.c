@@ -6,9 +6,15 @@
 #include "widget.c"
 
 #include "systems/animation.c"
+#include "systems/animation_compression.c"
+#include "systems/animation_system.c"
 #include "systems/collision.c"
+#include "systems/pathfinding.c"
 
 #include "core/random/generator.c"
+#include "core/random/tilemap.c"
+#include "core/random/world_streamer.c"
+#include "core/jobs/jobs.c"
 #include "core/memory/memory.c"
 #include "core/string/string.c"
 #include "core/math/math_utils.c"
@@ -29,6 +35,9 @@
 
 static void setup(game_t *game)
 {
+    //the player drives no instance until one is bound to it below
+    game->player_data.animated_instance = UINT32_MAX;
+
     //add all the resources
 #if 1
     const char *asset_id = "heraklios";
@@ -38,21 +47,42 @@ static void setup(game_t *game)
                                   &game->renderer, 
                                   asset_id,
                                   file_path,
+                                  NULL,
                                   &game->bulk_data.renderbuffers);
 
 
-    uint32_t index = asset_store_get_asset_index(&game->asset_store, asset_id, ASSET_TYPE_SKINNED_MODEL);
-    game->skinned_model_index = index;
-    
+    //held for as long as the instance draws it, so it is never evicted
+    uint32_t index = asset_store_acquire(&game->asset_store, asset_id, ASSET_TYPE_SKINNED_MODEL);
     skinned_model_t *model = asset_store_get_asset_ptr_null(&game->asset_store, asset_id, ASSET_TYPE_SKINNED_MODEL);
-    skinned_model_update_animation(model, &game->renderer, DELTA_TIME);
+    skeleton_t *skeleton = bulk_data_getp_null_skeleton_t(&game->bulk_data.skeletons, model->skeleton);
+
+    //instances share the model, each one only holds its clip, pose and joint palette
+    uint32_t instance_index = bulk_data_allocate_slot_animated_instance_t(&game->bulk_data.animated_instances);
+    animated_instance_t *instance = bulk_data_getp_null_animated_instance_t(&game->bulk_data.animated_instances, instance_index);
+    animated_instance_init(instance, model, index, skeleton);
+    //layer 0 follows the entity state, cross-fading between clips on every change
+    animated_instance_map_state(instance, ENTITY_STATE_IDLE, skeleton->animation_count > 1 ? 1 : 0, 0.2f);
+    animated_instance_map_state(instance, ENTITY_STATE_RUN, 0, 0.2f);
+    animated_instance_set_state(instance, skeleton, ENTITY_STATE_IDLE);
+    animated_instance_update(instance, skeleton, DELTA_TIME);
+    if (skinned_model_create_instance(model, skeleton, instance, &game->renderer)) {
+        game->player_data.animated_instance = instance_index;
+    } else {
+        skinned_model_destroy_instance(&game->bulk_data.animated_instances, instance_index, &game->asset_store, &game->renderer);
+        asset_store_release(&game->asset_store, asset_id, ASSET_TYPE_SKINNED_MODEL);
+    }
     
-    //renderer fetch shader resources
+    //renderer fetch shader resources, one descriptor set per instance
+    bulk_data_animated_instance_t *instances = &game->bulk_data.animated_instances;
     shader_resource_list_t resources = {0};
     resources.globals_data     = game->renderer.uniform_buffer_render_data;
-    resources.instance_count   = 1;
-    resources.instance_data = memory_alloc(sizeof(void*) * resources.instance_count, MEM_TAG_TEMP);
-    resources.instance_data[0] = model->rendering_data;
+    resources.instance_data = memory_alloc(sizeof(void*) * instances->count, MEM_TAG_TEMP);
+    for (uint32_t i = 0; i < instances->count; i++) {
+        animated_instance_t *it = bulk_data_getp_null_animated_instance_t(instances, i);
+        if (it && it->rendering_data) {
+            resources.instance_data[resources.instance_count++] = it->rendering_data;
+        }
+    }
     renderer_initialize_shader(&game->renderer, SHADER_TYPE_SKINNED_GEOMETRY, &resources);
 
 #endif
@@ -67,6 +97,13 @@ static void setup(game_t *game)
     game->renderer.camera.znear    = 0.1f;
     game->renderer.camera.aspect   = (float)game->window_width / (float)game->window_height;
 
+    world_config_t world_config = {0};
+    world_config.seed          = (uint64_t)time(NULL);
+    world_config.room_count    = 8;
+    world_config.radius        = 2;
+    world_config.memory_budget = MEGABYTES(4);
+    world_streamer_init(&game->world, &world_config);
+
     game->performance_freq = SDL_GetPerformanceFrequency();
     game->previous_counter = SDL_GetPerformanceCounter();
 }
@@ -79,6 +116,11 @@ static void update(game_t *game)
         return;
     }
 
+    //assets loaded in the background show up here, the temp memory of their creation is reset with the sim's
+    memory_begin(MEM_TAG_TEMP);
+    asset_store_update_loads(&game->asset_store, &game->renderer);
+    asset_store_update_residency(&game->asset_store, &game->renderer);
+
     memory_begin(MEM_TAG_RENDER);
 
     uint64_t now = SDL_GetPerformanceCounter();
@@ -92,8 +134,26 @@ static void update(game_t *game)
 #endif
         memory_begin(MEM_TAG_SIM);
 
-        skinned_model_t *model = bulk_data_getp_null_skinned_model_t(&game->bulk_data.skinned_models, game->skinned_model_index);
-        skinned_model_update_animation(model, &game->renderer, DELTA_TIME);
+        //animate all instances, in parallel batches on the job system. Far ones update at a lower rate
+        animation_system_begin(&game->animation);
+        for (uint32_t i = 0; i < game->bulk_data.animated_instances.count; i++) {
+            animated_instance_t *instance = bulk_data_getp_null_animated_instance_t(&game->bulk_data.animated_instances, i);
+            if (instance) {
+                skeleton_t *skeleton = bulk_data_getp_null_skeleton_t(&game->bulk_data.skeletons, instance->skeleton);
+                //the root node's translation, instances have no transform of their own
+                const affine3x4_t *root = &instance->global_matrices[0];
+                vec3f_t to_camera = vec3_subtract(game->renderer.camera.position, (vec3f_t){root->m[0][3], root->m[1][3], root->m[2][3]});
+                float distance = sqrtf(vec3_dot(to_camera, to_camera));
+                animation_system_set_lod(&game->animation, instance, animation_system_select_lod(&game->animation, distance));
+                animation_system_add(&game->animation, instance, skeleton);
+            }
+        }
+        animation_system_update(&game->animation, DELTA_TIME);
+
+        //the camera stands in for the player until the player is spawned in the dungeon
+        vec3f_t camera_p = game->renderer.camera.position;
+        world_streamer_update(&game->world, (int32_t)floorf(camera_p.x), (int32_t)floorf(camera_p.z));
+
         //update all entities
         for (uint32_t i = 0; i < game->bulk_data.entities.count; i++) {
 
@@ -104,8 +164,16 @@ static void update(game_t *game)
                 switch (e->type)
                 {
                     case(ENTITY_TYPE_PLAYER):
+                    {
                         update_player(e, &game->input, DELTA_TIME, &game->bulk_data.entities);
+                        player_t *player = (player_t*)e->data;
+                        animated_instance_t *instance = bulk_data_getp_null_animated_instance_t(&game->bulk_data.animated_instances, player->animated_instance);
+                        if (instance) {
+                            skeleton_t *skeleton = bulk_data_getp_null_skeleton_t(&game->bulk_data.skeletons, instance->skeleton);
+                            animated_instance_set_state(instance, skeleton, e->state);
+                        }
                         break;
+                    }
                     case(ENTITY_TYPE_WEAPON):
                         e->p = game->player_entity->p;
                         break;
@@ -142,6 +210,18 @@ static void render(game_t *game)
                                   &scene_uniforms, 
                                   sizeof(scene_uniforms));
 
+    //joint palettes go straight into this frame's mapped buffers, only for poses the buffer does not hold yet
+    for (uint32_t i = 0; i < game->bulk_data.animated_instances.count; i++) {
+        animated_instance_t *instance = bulk_data_getp_null_animated_instance_t(&game->bulk_data.animated_instances, i);
+        if (instance && instance->rendering_data) {
+            skinned_model_t *model = bulk_data_getp_null_skinned_model_t(&game->bulk_data.skinned_models, instance->model);
+            skeleton_t *skeleton = bulk_data_getp_null_skeleton_t(&game->bulk_data.skeletons, instance->skeleton);
+            animation_system_queue_palette(&game->animation, instance, skeleton, model,
+                                           skinned_model_map_palette(instance, &game->renderer), game->renderer.current_frame);
+        }
+    }
+    animation_system_write_palettes(&game->animation);
+
     //begin rendering
     renderer_begin_rendering(&game->renderer);
     //use shader
@@ -157,8 +237,13 @@ static void render(game_t *game)
 
     //draw calls
     //...
-    skinned_model_t *model = bulk_data_getp_null_skinned_model_t(&game->bulk_data.skinned_models, game->skinned_model_index);
-    skinned_model_draw(model, &game->renderer, &game->renderer.shaders[SHADER_TYPE_SKINNED_GEOMETRY]);
+    for (uint32_t i = 0; i < game->bulk_data.animated_instances.count; i++) {
+        animated_instance_t *instance = bulk_data_getp_null_animated_instance_t(&game->bulk_data.animated_instances, i);
+        if (instance && instance->rendering_data) {
+            skinned_model_t *model = bulk_data_getp_null_skinned_model_t(&game->bulk_data.skinned_models, instance->model);
+            skinned_model_draw(model, instance, &game->renderer, &game->renderer.shaders[SHADER_TYPE_SKINNED_GEOMETRY]);
+        }
+    }
 
     renderer_end_rendering(&game->renderer);
     renderer_frame_submit(&game->renderer, NULL); 
@@ -173,6 +258,10 @@ void game_run(game_t *game)
         render(game);
     }
 
+    world_streamer_shutdown(&game->world);
+    asset_store_shutdown(&game->asset_store);
+    animation_system_destroy(&game->animation);
+    jobs_shutdown();
     memory_uninit();
 }
 
@@ -210,6 +299,8 @@ void game_init(game_t *game)
 
     srand(time(NULL));
     memory_init();
+    jobs_init(0);
+    animation_system_init(&game->animation);
 
     bulk_data_init_entity_t(&game->bulk_data.entities);
     bulk_data_init_weapon_t(&game->bulk_data.weapons);
@@ -217,8 +308,11 @@ void game_init(game_t *game)
     bulk_data_init_renderbuffer_t(&game->bulk_data.renderbuffers);
     bulk_data_init_texture_t(&game->bulk_data.textures);
     bulk_data_init_skinned_model_t(&game->bulk_data.skinned_models);
+    bulk_data_init_animated_instance_t(&game->bulk_data.animated_instances);
+    bulk_data_init_skeleton_t(&game->bulk_data.skeletons);
 
-    asset_store_init(&game->asset_store, &game->bulk_data.textures, &game->bulk_data.skinned_models);
+    asset_store_init(&game->asset_store, &game->bulk_data.textures, &game->bulk_data.skinned_models, &game->bulk_data.skeletons);
+    game->asset_store.animation_compression = animation_compression_default_config();
 
     memset(&game->renderer, 0, sizeof(game->renderer));
 
@@ -0,0 +1,126 @@
+#ifndef ANIMATION_H_
+#define ANIMATION_H_
+
+#include <asset_types.h>
+
+//! @brief: how many keys the cursor walks forward before falling back to a binary search
+#define ANIMATION_CURSOR_MAX_STEPS 4
+//! @brief: the three smallest components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+#define ANIMATION_QUAT48_RANGE     0.70710678f
+//! @brief: joint matrices animation_compute_palette builds on the stack before writing them out
+#define ANIMATION_PALETTE_BLOCK    16
+
+/**
+ * @brief: Index of the key that starts the interval holding time, so inputs[key] <= time < inputs[key + 1].
+ *         cursor is the key found on the previous call. During playback time only moves forward a little,
+ *         so the search is a step or two from the cursor. Seeks and loops fall back to a binary search.
+ *         Times before the first key return 0, times after the last key return input_count - 1.
+ */
+uint32_t animation_sampler_find_key(const animation_sampler_t *sampler, float time, uint32_t *cursor);
+/**
+ * @brief: Allocates one heap block for the samplers, channels and key_count floats of keys of a clip.
+ *         Returns the key storage, the caller points the samplers' inputs and outputs into it.
+ */
+float   *animation_create_storage(animation_t *animation, uint32_t sampler_count, uint32_t channel_count, size_t key_count);
+void     animation_destroy(animation_t *animation);
+/**
+ * @brief: Exact copy of a glTF animation, keys keep their stored width. node_remap takes a glTF node index to
+ *         a model node index, NULL keeps glTF indices.
+ */
+bool     animation_create_from_gltf(animation_t *animation, gltf_model_t *gltf_model, uint32_t index, const uint32_t *node_remap);
+/**
+ * @brief: Output key of a sampler widened to a vec4f_t, unused components are zero.
+ */
+vec4f_t  animation_sampler_get_output(const animation_sampler_t *sampler, uint32_t key);
+/**
+ * @brief: Value of a sampler at time for a channel path, rotations come back as normalised x, y, z, w.
+ *         Handles step, linear and cubic spline samplers in any key format.
+ */
+vec4f_t  animation_sampler_evaluate(const animation_sampler_t *sampler, uint32_t path, float time, uint32_t *cursor);
+/**
+ * @brief: Writes the value of every channel at time into pose, nodes the clip does not animate keep their value.
+ *         cursors holds one key per channel of the clip.
+ */
+void     animation_sample(const animation_t *animation, float time, uint32_t *cursors, animation_pose_t *pose);
+/**
+ * @brief: animation_sample leaving out the channels of nodes set in skip_nodes, NULL samples every channel.
+ */
+void     animation_sample_nodes(const animation_t *animation, float time, uint32_t *cursors, const bool *skip_nodes, animation_pose_t *pose);
+void     animation_pose_set_rest(animation_pose_t *pose, const skeleton_t *skeleton);
+/**
+ * @brief: out = lerp(a, b, weights[node]) for the first node_count nodes, rotations along the shortest arc.
+ *         out may be a or b.
+ */
+void     animation_pose_blend(animation_pose_t *out, const animation_pose_t *a, const animation_pose_t *b, const float *weights, uint32_t node_count);
+/**
+ * @brief: Adds the difference of additive from reference onto out, scaled per node by weights. Translations add,
+ *         rotations and scales compose.
+ */
+void     animation_pose_add(animation_pose_t *out, const animation_pose_t *additive, const animation_pose_t *reference, const float *weights, uint32_t node_count);
+/**
+ * @brief: Model space transform of every node from a local pose, one pass since nodes are stored parent before child.
+ */
+void     animation_compute_global_matrices(const skeleton_t *skeleton, const animation_pose_t *pose, affine3x4_t *global_matrices);
+/**
+ * @brief: Skinning matrices of the skeleton's joints relative to the node the mesh hangs off, joint_count of them.
+ *         palette is only written, in order, so it can point into a mapped storage buffer.
+ */
+void     animation_compute_palette(const skeleton_t *skeleton, uint32_t mesh_node, const affine3x4_t *global_matrices, affine3x4_t *palette);
+/**
+ * @brief: Expands joint_count joint matrices into the mat4 palette the skinning shader reads. palette is only
+ *         written, in order, so it can point into a mapped storage buffer.
+ */
+void     animation_write_palette(const affine3x4_t *joints, uint32_t joint_count, mat4f_t *palette);
+/**
+ * @brief: Samples a clip at sample_rate frames per second into palettes for the model whose mesh hangs off
+ *         mesh_node, from the clip's first key to its last. animation_baked_clip_destroy frees them.
+ */
+bool     animation_bake(animation_baked_clip_t *baked, const skeleton_t *skeleton, uint32_t mesh_node, uint32_t animation, float sample_rate);
+void     animation_baked_clip_destroy(animation_baked_clip_t *baked);
+/**
+ * @brief: Palette and mesh node transform of a baked clip at time, the nearest frame or a lerp of the two around
+ *         time. palette is only written, in order.
+ */
+void     animation_baked_sample(const animation_baked_clip_t *baked, float time, bool interpolate, affine3x4_t *palette, affine3x4_t *mesh_transform);
+
+/**
+ * @brief: Rest pose of the model's skeleton, no clip playing until animated_instance_play. model_index is the bulk
+ *         data index of model, render data is created separately by skinned_model_create_instance.
+ *         Layer 0 overrides the whole skeleton, the other layers have no weight.
+ */
+void     animated_instance_init(animated_instance_t *instance, const skinned_model_t *model, uint32_t model_index, const skeleton_t *skeleton);
+/**
+ * @brief: How a layer combines with the layers below it. mask_root limits the layer to the subtree of a node,
+ *         e.g. the spine for an upper body layer, UINT32_MAX covers every node.
+ */
+void     animated_instance_set_layer(animated_instance_t *instance, const skeleton_t *skeleton, uint32_t layer, animation_blend_mode_e mode, float weight, uint32_t mask_root);
+/**
+ * @brief: Starts a clip on a layer from its first key. With a fade_duration the clip that was playing keeps
+ *         running and is cross-faded out over that many seconds, otherwise it is cut.
+ */
+void     animated_instance_play(animated_instance_t *instance, const skeleton_t *skeleton, uint32_t layer, uint32_t animation, float fade_duration);
+/**
+ * @brief: Loops a clip baked into the model in place of the layers, for crowds. Updates only advance its time,
+ *         animated_instance_play goes back to sampling. Only the mesh node's global matrix follows the
+ *         baked clip, the others keep the last sampled pose.
+ */
+void     animated_instance_play_baked(animated_instance_t *instance, const skinned_model_t *model, const skeleton_t *skeleton, uint32_t animation, bool interpolate);
+void     animated_instance_stop(animated_instance_t *instance, uint32_t layer);
+/**
+ * @brief: Clip played on layer 0 when the instance enters state, e.g. an entity_state_t.
+ */
+void     animated_instance_map_state(animated_instance_t *instance, uint32_t state, uint32_t animation, float fade_duration);
+/**
+ * @brief: Cross-fades layer 0 to the clip of state when state differs from the last one, safe to call every tick.
+ */
+void     animated_instance_set_state(animated_instance_t *instance, const skeleton_t *skeleton, uint32_t state);
+/**
+ * @brief: Advances and loops the clips of every layer, blends the layers bottom up over the rest pose and
+ *         updates the global matrices. CPU only.
+ */
+void     animated_instance_update(animated_instance_t *instance, const skeleton_t *skeleton, float dt);
+/**
+ * @brief: Model space transform of a node from the last update, for attaching things to bones.
+ */
+const affine3x4_t *animated_instance_get_node_transform(const animated_instance_t *instance, uint32_t node);
+#endif
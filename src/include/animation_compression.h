@@ -0,0 +1,26 @@
+#ifndef ANIMATION_COMPRESSION_H_
+#define ANIMATION_COMPRESSION_H_
+
+#include <asset_types.h>
+
+typedef struct
+{
+    float rotation;     //radians
+    float translation;
+    float scale;
+} animation_error_t;
+
+animation_compression_config_t animation_compression_default_config(void);
+/**
+ * @brief: Drops every key that interpolation between its neighbours reproduces within the tolerance of its track,
+ *         optionally refits linear tracks as cubic splines and quantizes what is left. result is a new clip with
+ *         the same channels and samplers as source, source is left alone.
+ */
+bool animation_compress(const animation_t *source, const animation_compression_config_t *config, animation_t *result);
+/**
+ * @brief: Largest difference per path between two clips with the same channels, probed at every key of reference
+ *         and halfway between keys.
+ */
+void animation_measure_error(const animation_t *reference, const animation_t *clip, animation_error_t *error);
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef ANIMATION_SYSTEM_H_
+#define ANIMATION_SYSTEM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <asset_types.h>
+#include <jobs.h>
+
+//! @brief instances one job evaluates
+#define ANIMATION_BATCH_SIZE 8
+
+//! @brief: update rate tiers, an instance in tier n is evaluated every 2^n ticks, 60/30/15/7.5 Hz at the 60 Hz tick
+typedef enum
+{
+    ANIMATION_LOD_FULL,
+    ANIMATION_LOD_HALF,
+    ANIMATION_LOD_QUARTER,
+    ANIMATION_LOD_EIGHTH,
+    ANIMATION_LOD_COUNT
+} animation_lod_e;
+
+typedef struct
+{
+    animated_instance_t *instance;
+    const skeleton_t    *skeleton;
+    //! @brief palette writes only, the model drawn and where the palette goes
+    const skinned_model_t *model;
+    mat4f_t             *palette;
+} animation_task_t;
+
+typedef struct
+{
+    animation_task_t *tasks;
+    uint32_t          count;
+    float             dt;
+    //! @brief seconds the batch took on the thread that ran it
+    double            time;
+} animation_batch_t;
+
+//! @brief: evaluates every animated instance of a tick on the job system and writes their joint palettes straight
+//!         into the mapped storage buffers of the frame being recorded, see animation_system_update and
+//!         animation_system_write_palettes
+typedef struct
+{
+    //! NOTE: MEM_TAG_HEAP, refilled every pass by animation_system_add
+    animation_task_t   *tasks;
+    uint32_t            task_count;
+    uint32_t            task_capacity;
+
+    //! @brief instances queued but not due this pass. MEM_TAG_HEAP
+    animated_instance_t **skipped;
+    uint32_t            skipped_count;
+    uint32_t            skipped_capacity;
+
+    //! NOTE: MEM_TAG_HEAP, refilled every frame by animation_system_queue_palette
+    animation_task_t   *palette_tasks;
+    uint32_t            palette_task_count;
+    uint32_t            palette_task_capacity;
+    uint32_t            palette_skip_count;
+
+    animation_batch_t  *batches;
+    uint32_t            batch_capacity;
+
+    job_counter_t       jobs;
+    //! @brief passes run since init, drives the LOD intervals
+    uint64_t            tick;
+
+    //! @brief camera distance at which each coarser tier starts, increasing
+    float               lod_distances[ANIMATION_LOD_COUNT - 1];
+    //! @brief first tier that skips leaf nodes, ANIMATION_LOD_COUNT for none
+    uint32_t            lod_skip_leaves;
+    //! @brief phase handed to the next instance entering a tier, spreads a tier's instances over its interval
+    uint32_t            lod_next_phase[ANIMATION_LOD_COUNT];
+
+    //! @brief counters of the last pass, times in seconds
+    uint32_t            instance_count;
+    //! @brief instances evaluated, the rest kept their pose
+    uint32_t            evaluated_count;
+    uint32_t            lod_counts[ANIMATION_LOD_COUNT];
+    uint32_t            batch_count;
+    //! @brief wall clock from the first submit until the last batch finished
+    double              pass_time;
+    //! @brief summed over the batches, pass_time * threads when the batches scale perfectly
+    double              batch_time;
+
+    //! @brief counters of the last palette write, palettes already in the frame's buffer are not written again
+    uint32_t            palettes_written;
+    uint32_t            palettes_skipped;
+    double              palette_time;
+
+    //! @brief sums over every pass since init, for averages
+    uint64_t            pass_count;
+    double              total_pass_time;
+    double              total_batch_time;
+} animation_system_t;
+
+void     animation_system_init(animation_system_t *system);
+void     animation_system_destroy(animation_system_t *system);
+/**
+ * @brief: Starts collecting the instances of the next pass.
+ */
+void     animation_system_begin(animation_system_t *system);
+/**
+ * @brief: Tier for an instance at distance from the camera, see lod_distances.
+ */
+uint32_t animation_system_select_lod(const animation_system_t *system, float distance);
+/**
+ * @brief: Moves an instance to a tier. An instance entering a tier gets the next phase of it, so the tier's
+ *         instances are evaluated on different ticks instead of all on the same one.
+ */
+void     animation_system_set_lod(animation_system_t *system, animated_instance_t *instance, uint32_t lod);
+/**
+ * @brief: Queues an instance for the next pass when its tier is due this tick, otherwise it keeps its pose and
+ *         catches up on the time at its next evaluation. Main thread only.
+ */
+void     animation_system_add(animation_system_t *system, animated_instance_t *instance, const skeleton_t *skeleton);
+/**
+ * @brief: Advances, samples and blends every queued instance and computes its global matrices,
+ *         ANIMATION_BATCH_SIZE instances per job. Returns once every batch is done, the calling thread runs
+ *         batches too.
+ */
+void     animation_system_update(animation_system_t *system, float dt);
+/**
+ * @brief: Queues the palette of an instance for palette, the mapped storage buffer of frame, see
+ *         renderer_map_renderbuffer. Nothing is queued when that buffer already holds the palette of the
+ *         instance's current pose. Only once the frame's fence has been waited on, main thread only.
+ */
+void     animation_system_queue_palette(animation_system_t *system, animated_instance_t *instance, const skeleton_t *skeleton,
+                                        const skinned_model_t *model, mat4f_t *palette, uint32_t frame);
+/**
+ * @brief: Writes every queued palette into its buffer on the job system and clears the queue. Instances playing a
+ *         baked clip copy or lerp the model's baked frames.
+ */
+void     animation_system_write_palettes(animation_system_t *system);
+#endif
@@ -7,11 +7,75 @@
 
 struct bulk_data_renderbuffer_t;
 struct bulk_data_skinned_model_t;
+struct bulk_data_skeleton_t;
 struct bulk_data_texture_t;
 
-void asset_store_init(asset_store_t *asset_store, struct bulk_data_texture_t *textures, struct bulk_data_skinned_model_t *skinned_models);
+void asset_store_init(asset_store_t *asset_store, struct bulk_data_texture_t *textures, struct bulk_data_skinned_model_t *skinned_models, struct bulk_data_skeleton_t *skeletons);
 void asset_store_add_texture(asset_store_t *asset_store, renderer_t *renderer, const char *asset_id, const char *file_path);
-void asset_store_add_skinned_model(asset_store_t *asset_store, renderer_t *renderer, const char *asset_id, const char *file_path, struct bulk_data_renderbuffer_t *renderbuffers);
+/**
+ * @brief: skeleton_id names the rig the model is skinned against, NULL uses asset_id. The first model of a rig
+ *         creates the skeleton and its clips from its own file, later ones bind to it by node name.
+ *         A .skm written by tools/model_cooker is mapped and uploaded as it is, see cooked_model.h.
+ */
+void asset_store_add_skinned_model(asset_store_t *asset_store, renderer_t *renderer, const char *asset_id, const char *file_path, const char *skeleton_id, struct bulk_data_renderbuffer_t *renderbuffers);
+/**
+ * @brief: Clips of a glTF file authored for an already loaded skeleton, playable on every model bound to it.
+ */
+bool asset_store_add_animations(asset_store_t *asset_store, const char *skeleton_id, const char *file_path);
+/**
+ * @brief: Asynchronous asset_store_add_texture and asset_store_add_skinned_model. The file is read and decoded by a
+ *         job, the asset is created on the main thread by asset_store_update_loads and added to the store once its
+ *         copies have executed. The strings are kept like the synchronous calls keep them, they must outlive the
+ *         store. Loading an id that is pending returns its handle.
+ *         glTF files are parsed, converted and their images decoded by the job too, the main thread still builds
+ *         the skeleton and its clips, which a cooked model has ready, see cooked_model.h.
+ */
+asset_load_handle_t asset_store_load_texture_async(asset_store_t *asset_store, const char *asset_id, const char *file_path);
+asset_load_handle_t asset_store_load_skinned_model_async(asset_store_t *asset_store, const char *asset_id, const char *file_path, const char *skeleton_id);
+/**
+ * @brief: Once per frame, outside of rendering. Adds the loads whose copies have executed to the store, then creates
+ *         finished loads up to upload_budget bytes and submits their copies in one batch. Never waits on the GPU.
+ */
+void asset_store_update_loads(asset_store_t *asset_store, renderer_t *renderer);
+asset_load_state_e asset_store_load_state(asset_store_t *asset_store, asset_load_handle_t handle);
+//! @brief: Blocks until every load is in the store or failed
+void asset_store_wait_loads(asset_store_t *asset_store, renderer_t *renderer);
+//! @brief: Waits for the jobs and drops the loads that haven't been created yet
+void asset_store_shutdown(asset_store_t *asset_store);
+/**
+ * @brief: Keys of the shared textures and renderbuffers. A file is keyed by its canonical path, data by its bytes,
+ *         seed tells apart equal bytes that make different resources, e.g. image sizes. Both hash the bytes twice
+ *         so that two resources are only shared when the hashes of both agree.
+ */
+asset_key_t asset_store_file_key(const char *file_path);
+asset_key_t asset_store_content_key(const void *data, size_t size, uint64_t seed);
+/**
+ * @brief: Slot of key in shared with one more reference, UINT32_MAX if nothing has been created for it yet. A new
+ *         slot is added with asset_store_add_shared, which holds the first reference. A slot added for a key whose
+ *         hash is taken by other bytes stays private and is released as if it was never shared.
+ */
+uint32_t asset_store_acquire_shared(shared_hash_entry_t **shared, asset_key_t key);
+void     asset_store_add_shared(shared_hash_entry_t **shared, asset_key_t key, uint32_t slot, uint32_t size);
+//! @brief: Drops a reference to slot, true when it was the last one and slot is not shared anymore
+bool     asset_store_release_shared(shared_hash_entry_t **shared, uint32_t slot);
+/**
+ * @brief: asset_store_get_asset_index with a reference that keeps the asset resident until it is released. Assets
+ *         nothing references are evicted least recently used first once the store is over its memory_budget.
+ */
+uint32_t asset_store_acquire(asset_store_t *asset_store, const char *asset_id, asset_type_e type);
+void     asset_store_release(asset_store_t *asset_store, const char *asset_id, asset_type_e type);
+/**
+ * @brief: Once per frame, outside of rendering. Destroys the textures and buffers of evicted assets once the frames
+ *         in flight that may read them have finished, then evicts unreferenced assets until memory_used fits
+ *         memory_budget. Evicted assets are gone from the maps right away.
+ */
+void     asset_store_update_residency(asset_store_t *asset_store, renderer_t *renderer);
+/**
+ * @brief: Destroys a texture or renderbuffer slot no asset shares, and render data that points at it, once the frames
+ *         in flight that may read them have finished. slot is UINT32_MAX and render_data NULL for none.
+ */
+void     asset_store_retire(asset_store_t *asset_store, renderer_t *renderer, asset_type_e type, uint32_t slot,
+                            render_data_type_e render_data_type, void *render_data);
 uint32_t asset_store_get_asset_index(asset_store_t *asset_store, const char *asset_id, asset_type_e type);
 void *asset_store_get_asset_ptr_null(asset_store_t *asset_store, const char *asset_id, asset_type_e type);
 #endif
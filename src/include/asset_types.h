@@ -8,19 +8,21 @@
 #include <stb/stb_ds.h>
 #include <containers.h>
 #include <math_types.h>
+#include <utils.h>
 
 #define ENTITY_CAN_COLLIDE 0x1
 #define NIL UINT32_MAX
 #define MODEL_NODE_CHILDREN_COUNT 8
-#define MAX_ANIMATION_SAMPLER_INPUT_COUNT  128
-#define MAX_ANIMATION_SAMPLER_OUTPUT_COUNT 128
-#define MAX_ANIMATION_CHANNEL_COUNT        64
+#define MAX_ANIMATION_CHANNEL_COUNT        216 //translation, rotation and scale of every node
 #define MAX_ANIMATIONS_PER_MODEL           32
 #define MAX_MATERIALS_PER_MODEL            2
 #define MAX_TEXTURES_PER_MODEL             16
 #define MAX_NODES_PER_MODEL                72
 #define MAX_BONES_PER_SKIN                 256
 #define MAX_PRIMITIVES_PER_MESH            4
+#define MAX_ANIMATION_LAYERS               3
+#define MAX_ANIMATION_STATES               8
+#define MAX_PALETTE_BUFFERS                3 //one per frame in flight, at most MAX_BUFFERS_PER_RENDERBUFFER
 
 typedef enum 
 {
@@ -76,6 +78,17 @@ typedef enum
     CUBIC_SPLINE_INTERPOLATION
 }animation_sampler_interpolation_e;
 
+//! @brief: how a sampler stores its output keys, see animation_sampler_get_output
+typedef enum
+{
+    //! components floats per key
+    ANIMATION_KEY_FORMAT_FLOAT,
+    //! unit quaternion in 3 uint16: 2 bit index of the largest component, the other three in 15 bits each
+    ANIMATION_KEY_FORMAT_QUAT48,
+    //! components uint16 per key, mapped onto range_min + range_extent * [0, 1]
+    ANIMATION_KEY_FORMAT_RANGE16,
+}animation_key_format_e;
+
 typedef enum
 {
     OPAQUE,
@@ -158,8 +171,11 @@ typedef struct
 
 typedef struct
 {
-    uint8_t *data;
+    //! NOTE: points into the mapped file of a .glb or the buffer's own mapped file, read only
+    const uint8_t *data;
     uint32_t size;
+    //! @brief the external file of the buffer, unmapped by model_release_gltf
+    mapped_file_t file;
 }gltf_buffer_t;
 
 typedef struct 
@@ -270,6 +286,16 @@ typedef struct
     uint32_t wrap_t;
 }gltf_sampler_t;
 
+//! @brief: memory of one glTF load, reserved up front and committed as it is touched. What doesn't fit is
+//          allocated from the libc heap and chained, all of it is freed at once with the model
+typedef struct
+{
+    uint8_t *base;
+    size_t   used;
+    size_t   capacity;
+    void    *overflow;
+} json_arena_t;
+
 typedef struct
 {
     const char         *path;
@@ -314,6 +340,11 @@ typedef struct
     gltf_sampler_t     *samplers;
     uint32_t            sampler_count;
 
+    //! @brief the .glb the first buffer points into, unmapped by model_release_gltf
+    mapped_file_t       file;
+    //! @brief everything above and the geometry converted from it, the model itself included
+    json_arena_t        arena;
+
     uint32_t            vertex_buffer;
     uint32_t            index_buffer;
 } gltf_model_t;
@@ -321,6 +352,9 @@ typedef struct
 typedef enum {
     ASSET_TYPE_TEXTURE,
     ASSET_TYPE_SKINNED_MODEL,
+    ASSET_TYPE_SKELETON,
+    //! vertex and index buffers, shared by skinned models and not in a map of their own
+    ASSET_TYPE_RENDERBUFFER,
 }asset_type_e;
 
 typedef struct
@@ -366,10 +400,8 @@ typedef struct
 typedef struct 
 {
     uint8_t   joints[MAX_BONES_PER_SKIN];
-    mat4f_t   inverse_bind_matrices[MAX_BONES_PER_SKIN];
+    affine3x4_t inverse_bind_matrices[MAX_BONES_PER_SKIN];
     uint32_t  joint_count;
-    //bulk data
-    uint32_t  ssbo;
     uint8_t   skeleton_root;
 } skin_t;
 
@@ -385,15 +417,33 @@ typedef struct
     mesh_primitive_t primitives[MAX_PRIMITIVES_PER_MESH];
 }mesh_t;
 
-typedef struct 
+//! @brief: vertices and 32 bit indices of every primitive of a model, laid out as the GPU buffers take them
+typedef struct
 {
-    uint32_t  interpolation;
+    skinned_vertex_t *vertices;
+    uint32_t          vertex_count;
+    uint32_t         *indices;
+    uint32_t          index_count;
+} skinned_geometry_t;
 
-    float     inputs[MAX_ANIMATION_SAMPLER_INPUT_COUNT];
-    uint32_t  input_count;
-
-    vec4f_t   outputs[MAX_ANIMATION_SAMPLER_OUTPUT_COUNT];
-    uint32_t  output_count;
+typedef struct 
+{
+    uint32_t     interpolation;
+    //! @brief values per output key, 3 for translation and scale, 4 for rotation
+    uint32_t     components;
+    //! @brief animation_key_format_e, range is only used by ANIMATION_KEY_FORMAT_RANGE16
+    uint32_t     format;
+    vec4f_t      range_min;
+    vec4f_t      range_extent;
+
+    //! NOTE: inputs and outputs point into the key block of the clip. 
+    //        Samplers that read the same glTF input accessor share one time array.
+    //        Cubic spline samplers have three outputs per input: in tangent, value, out tangent.
+    const float *inputs;
+    uint32_t     input_count;
+
+    const void  *outputs;
+    uint32_t     output_count;
 } animation_sampler_t;
 
 typedef struct 
@@ -405,19 +455,59 @@ typedef struct
 
 typedef struct 
 {
-    //! NOTE: heap
+    //! NOTE: heap, one block holding the samplers, channels and keys of the clip. See animation_create_storage
+    void    *data;
+    size_t   data_size;
+
     animation_sampler_t *samplers;
     uint32_t sampler_count;
     
-    //! NOTE: heap
     animation_channel_t *channels;
     uint32_t channel_count;
 
     float start_time;
     float end_time;
-    float current_time;
 } animation_t;
 
+//! @brief: local TRS of every node of a skeleton, one array per component so blends run as flat loops
+typedef struct
+{
+    vec3f_t translations[MAX_NODES_PER_MODEL];
+    quat_t  rotations[MAX_NODES_PER_MODEL];
+    vec3f_t scales[MAX_NODES_PER_MODEL];
+} animation_pose_t;
+
+typedef enum
+{
+    //! @brief lerps the pose below towards the layer's clip
+    ANIMATION_BLEND_OVERRIDE,
+    //! @brief adds the difference of the layer's clip from its first key onto the pose below
+    ANIMATION_BLEND_ADDITIVE
+} animation_blend_mode_e;
+
+//! @brief: one clip being played, UINT32_MAX when there is none
+typedef struct
+{
+    uint32_t       animation;
+    float          time;
+    //! @brief key found by the last sample of each channel of the clip, see animation_sampler_find_key
+    uint32_t       cursors[MAX_ANIMATION_CHANNEL_COUNT];
+} animation_playback_t;
+
+typedef struct
+{
+    //! @brief the clip playing and the one it is cross-fading from, current indexes it
+    animation_playback_t playbacks[2];
+    uint32_t       current;
+    float          fade_time;
+    float          fade_duration;
+
+    uint32_t       mode;    //animation_blend_mode_e
+    float          weight;
+    //! @brief per node weight of the layer, 1 inside its mask and 0 outside
+    float          node_weights[MAX_NODES_PER_MODEL];
+} animation_layer_t;
+
 typedef struct
 {
     uint32_t    parent;
@@ -425,40 +515,213 @@ typedef struct
     quat_t      rotation;
     vec3f_t     translation;
     vec3f_t     scale;
-    mat4f_t     local_transform;
+    affine3x4_t local_transform;
     uint32_t    skin;
     uint32_t    mesh;
 }model_node_t;
 
+//! NOTE: a rig, shared by every skinned model bound to it and by the clips authored for it. Read only once loaded
 typedef struct
 {
-    //! @brief rendering api specific data. i.e. descriptor sets for vulkan. allocated on MEM_TAG_HEAP
-    void           *rendering_data;
+    //! nodes are stored in struct, parents come before their children. TRS is the rest pose
+    model_node_t   nodes[MAX_NODES_PER_MODEL];
+    //! @brief string_hash of the glTF node names, binds meshes and clips from other files of the rig
+    uint64_t       node_names[MAX_NODES_PER_MODEL];
+    uint32_t       node_count;
+    //! @brief nodes without children, coarse animation LODs leave them in the pose of the layer below
+    bool           leaf_nodes[MAX_NODES_PER_MODEL];
 
-    uint32_t        vertex_buffer;
-    uint32_t        index_buffer;
+    skin_t         skin;
 
     //! animations are stored in struct
     animation_t    animations[MAX_ANIMATIONS_PER_MODEL];        
     uint32_t       animation_count;
+} skeleton_t;
 
-    //! nodes are stored in struct
-    model_node_t   nodes[MAX_NODES_PER_MODEL];
-    uint32_t       node_count;
+//! @brief: a clip sampled into joint palettes at a fixed rate, for instances that only play it, see animation_bake
+typedef struct
+{
+    //! @brief frame_count palettes of joint_count matrices, then the mesh node's transform of every frame.
+    //!        One block, MEM_TAG_HEAP
+    affine3x4_t   *palettes;
+    affine3x4_t   *mesh_transforms;
+    uint32_t       frame_count;
+    uint32_t       joint_count;
+    float          sample_rate;
+    float          start_time;
+} animation_baked_clip_t;
+
+//! NOTE: loaded once and read only afterwards, every animated_instance_t of the model shares it
+typedef struct
+{
+    uint32_t        vertex_buffer;
+    uint32_t        index_buffer;
 
-    uint8_t        skeleton_root;
+    //! NOTE: bulk data index of the skeleton_t
+    uint32_t       skeleton;
+    //! @brief skeleton node the mesh hangs off
+    uint32_t       mesh_node;
 
-    skin_t         skin;
     material_t     materials[MAX_MATERIALS_PER_MODEL];
     uint32_t       material_count;
+    //! @brief texture slots of the model's images, one reference each, see asset_store_acquire_shared
+    uint32_t       textures[MAX_TEXTURES_PER_MODEL];
+    uint32_t       texture_count;
 
     mesh_t         mesh;
 
-    uint32_t       active_animation;
+    //! @brief the skeleton's clips baked against this mesh, indexed like skeleton_t animations. Empty unless the
+    //!        model was loaded with an animation bake rate
+    animation_baked_clip_t baked_clips[MAX_ANIMATIONS_PER_MODEL];
+    uint32_t       baked_clip_count;
 } skinned_model_t;
 
+//! @brief: one animated character. Only playback state and the evaluated pose, the model is shared.
+typedef struct
+{
+    //! NOTE: bulk data indices of the skinned_model_t and of its skeleton_t
+    uint32_t       model;
+    uint32_t       skeleton;
+
+    //! @brief evaluated bottom up, layer 0 is the base and starts from the rest pose
+    animation_layer_t layers[MAX_ANIMATION_LAYERS];
+
+    //! @brief baked clip of the model played instead of the layers, UINT32_MAX when sampled.
+    //!        Its time is kept in layer 0's playback, see animated_instance_play_baked
+    uint32_t       baked_clip;
+    //! @brief lerp between the two nearest baked frames instead of taking the nearest one
+    bool           baked_interpolate;
+
+    //! @brief gameplay state driving layer 0, see animated_instance_set_state
+    uint32_t       state;
+    uint32_t       state_animations[MAX_ANIMATION_STATES];
+    float          state_fade_durations[MAX_ANIMATION_STATES];
+
+    animation_pose_t pose;
+    //! @brief model space node transforms, written by animated_instance_update
+    affine3x4_t    global_matrices[MAX_NODES_PER_MODEL];
+    //! @brief bumped by every animated_instance_update that changed the pose
+    uint32_t       pose_version;
+    //! @brief no clip has played since the pose was last set to the rest pose, updates leave it alone
+    bool           rest_pose;
+    //! @brief pose_version whose palette each per frame buffer of the ssbo holds, 0 for none
+    uint32_t       palette_versions[MAX_PALETTE_BUFFERS];
+
+    //! @brief animation LOD tier, see animation_system_set_lod
+    uint32_t       lod;
+    //! @brief tick within the tier's update interval the instance is evaluated on
+    uint32_t       lod_phase;
+    //! @brief time skipped since the last evaluation, the next one advances the clips by it
+    float          lod_dt;
+    //! @brief leaf nodes are not sampled and keep the pose of the layer below, see skeleton_t leaf_nodes
+    bool           skip_leaf_nodes;
+
+    //! NOTE: bulk data index of the joint palette storage buffer
+    uint32_t       ssbo;
+    //! @brief rendering api specific data. i.e. descriptor sets for vulkan. allocated on MEM_TAG_HEAP
+    void          *rendering_data;
+} animated_instance_t;
+
+//! @brief: import time animation compression, see animation_compress
+typedef struct
+{
+    bool  enabled;
+    //! @brief quantize rotations to 48 bits and translations and scales to 16 bits per component
+    bool  quantize;
+    //! @brief allow fitting linear tracks with cubic splines when that takes fewer bytes
+    bool  allow_cubic;
+    //! @brief max error of a dropped key. radians for rotations, model units for translations and scales
+    float rotation_tolerance;
+    float translation_tolerance;
+    float scale_tolerance;
+} animation_compression_config_t;
+
+//! @brief: where an asynchronous load is, see asset_store_load_texture_async
+typedef enum
+{
+    //! the handle was recycled, look the asset up by its id
+    ASSET_LOAD_NONE,
+    //! a worker is reading or decoding the file, or it waits for the main thread
+    ASSET_LOAD_PENDING,
+    //! created, its copies have been submitted and are not done yet
+    ASSET_LOAD_UPLOADING,
+    //! in the store, asset_store_get_asset_index finds it
+    ASSET_LOAD_COMPLETE,
+    ASSET_LOAD_FAILED,
+}asset_load_state_e;
+
+typedef uint32_t asset_load_handle_t;
+#define ASSET_LOAD_HANDLE_INVALID UINT32_MAX
+
+//! @brief: key of a shared texture or renderbuffer, check is a second independent hash of the same bytes
+typedef struct
+{
+    uint64_t hash;
+    uint64_t check;
+}asset_key_t;
+
+//! @brief: a texture or renderbuffer slot and how many assets use it
+typedef struct
+{
+    uint32_t slot;
+    uint32_t ref_count;
+    //! @brief device memory, counted against the gpu budget once however many assets share it
+    uint32_t size;
+    //! @brief asset_key_t.check of the slot, an asset whose hash collides with it gets a slot of its own
+    uint64_t check;
+}asset_shared_t;
+
+typedef struct
+{
+    uint64_t       key;
+    asset_shared_t value;
+}shared_hash_entry_t;
+
+//! @brief: bytes of resident assets, 0 leaves them unlimited
+typedef struct
+{
+    //! @brief skeletons with their clips and the clips baked for skinned models
+    uint64_t cpu;
+    //! @brief textures, vertex and index buffers
+    uint64_t gpu;
+}asset_memory_t;
+
+//! @brief: an asset in one of the maps of the store
+typedef struct
+{
+    const char  *asset_id;
+    asset_type_e type;
+    uint32_t     slot;
+    //! @brief asset_store_acquire calls not released yet, skinned models hold one on their skeleton
+    uint32_t     ref_count;
+    //! @brief frame_count of the renderer when it was last acquired or released, the least recent goes first
+    uint64_t     last_used;
+}asset_resident_t;
+
+typedef struct
+{
+    //! @brief asset_store_resident_key of the id and type
+    uint64_t         key;
+    asset_resident_t value;
+}resident_hash_entry_t;
+
+//! @brief: a texture or renderbuffer no asset uses anymore that frames in flight may still read
+typedef struct
+{
+    asset_type_e type;
+    //! @brief UINT32_MAX when only render data is retired
+    uint32_t     slot;
+    //! @brief render data that points at the slot, destroyed with it, NULL for none
+    void        *render_data;
+    uint32_t     render_data_type; //render_data_type_e
+    //! @brief destroyed once the renderer's frame_count reaches it
+    uint64_t     frame;
+}asset_retired_t;
+
 struct bulk_data_texture_t;
 struct bulk_data_skinned_model_t;
+struct bulk_data_skeleton_t;
+struct asset_loader_t;
 
 //! NOTE: this structure only holds indices to bulk data
 typedef struct 
@@ -469,6 +732,28 @@ typedef struct
     //data related to skinned models
     string_hash_entry_t        *skinned_model_map;
     struct bulk_data_skinned_model_t  *skinned_models;
+    //rigs and their clips, shared between skinned models
+    string_hash_entry_t        *skeleton_map;
+    struct bulk_data_skeleton_t       *skeletons;
+    //! @brief applied to the clips of every skinned model added afterwards
+    animation_compression_config_t     animation_compression;
+    //! @brief samples per second the clips of skinned models added afterwards are baked at, 0 bakes nothing
+    float                              animation_bake_rate;
+    //! @brief textures by asset_store_file_key or asset_store_content_key and vertex and index buffers by
+    //!        asset_store_content_key, every model that loads the same image or geometry shares the slot
+    shared_hash_entry_t               *shared_textures;
+    shared_hash_entry_t               *shared_renderbuffers;
+    //! @brief every asset in the maps, unreferenced ones are evicted least recently used first past memory_budget
+    resident_hash_entry_t             *residents;
+    asset_retired_t                   *retired;
+    asset_memory_t                     memory_budget;
+    //! @brief as of the last asset_store_update_residency
+    asset_memory_t                     memory_used;
+    uint64_t                           frame;
+    //! @brief asynchronous loads, private to asset_store.c
+    struct asset_loader_t             *loader;
+    //! @brief bytes of finished loads asset_store_update_loads creates and submits per call, at least one load goes
+    uint32_t                           upload_budget;
 }asset_store_t;
 
 
@@ -425,4 +425,98 @@ void bulk_data_init_renderbuffer_t(bulk_data_renderbuffer_t *bd)
 	dummy->generation = 0;
 }
 
+#include "bulk_data_types.h"
+
+void bulk_data_delete_item_animated_instance_t(bulk_data_animated_instance_t *bd, uint32_t i)
+{
+	if (i >= bd->count) return;
+	bd->items[i].next = bd->items[0].next;
+	bd->items[i].data_type = FREELIST_ITEM;
+	bd->items[i].generation++;
+	bd->items[0].next = i;
+}
+
+uint32_t bulk_data_allocate_slot_animated_instance_t(bulk_data_animated_instance_t *bd)
+{
+	uint32_t slot = bd->items[0].next;
+	bd->items[0].next = bd->items[slot].next;
+	if (slot) {
+		bd->items[slot].data_type = OBJECT_ITEM;
+		return slot;
+	}
+	slot = bd->count++;
+	bd->items[slot].data_type = OBJECT_ITEM;
+	return slot;
+}
+
+animated_instance_t *bulk_data_getp_null_animated_instance_t(bulk_data_animated_instance_t *bd, uint32_t i)
+{
+	if (i > bd->count) return NULL;
+	item_animated_instance_t *it = &bd->items[i];
+	if (it->data_type == FREELIST_ITEM) return NULL;
+	return &it->data;
+}
+
+uint32_t bulk_data_index_animated_instance_t(bulk_data_animated_instance_t *bd, animated_instance_t *ptr)
+{
+	uint32_t index = (ptr - &bd->items[0].data);
+	return index;
+}
+
+void bulk_data_init_animated_instance_t(bulk_data_animated_instance_t *bd)
+{
+	memset(bd, 0, sizeof(*bd));
+	bd->items = memory_alloc(GIGABYTES(1), MEM_TAG_BULK_DATA);
+	item_animated_instance_t *dummy = &bd->items[bd->count++];
+	dummy->next = 0;
+	dummy->generation = 0;
+}
+
+#include "bulk_data_types.h"
+
+void bulk_data_delete_item_skeleton_t(bulk_data_skeleton_t *bd, uint32_t i)
+{
+	if (i >= bd->count) return;
+	bd->items[i].next = bd->items[0].next;
+	bd->items[i].data_type = FREELIST_ITEM;
+	bd->items[i].generation++;
+	bd->items[0].next = i;
+}
+
+uint32_t bulk_data_allocate_slot_skeleton_t(bulk_data_skeleton_t *bd)
+{
+	uint32_t slot = bd->items[0].next;
+	bd->items[0].next = bd->items[slot].next;
+	if (slot) {
+		bd->items[slot].data_type = OBJECT_ITEM;
+		return slot;
+	}
+	slot = bd->count++;
+	bd->items[slot].data_type = OBJECT_ITEM;
+	return slot;
+}
+
+skeleton_t *bulk_data_getp_null_skeleton_t(bulk_data_skeleton_t *bd, uint32_t i)
+{
+	if (i > bd->count) return NULL;
+	item_skeleton_t *it = &bd->items[i];
+	if (it->data_type == FREELIST_ITEM) return NULL;
+	return &it->data;
+}
+
+uint32_t bulk_data_index_skeleton_t(bulk_data_skeleton_t *bd, skeleton_t *ptr)
+{
+	uint32_t index = (ptr - &bd->items[0].data);
+	return index;
+}
+
+void bulk_data_init_skeleton_t(bulk_data_skeleton_t *bd)
+{
+	memset(bd, 0, sizeof(*bd));
+	bd->items = memory_alloc(GIGABYTES(1), MEM_TAG_BULK_DATA);
+	item_skeleton_t *dummy = &bd->items[bd->count++];
+	dummy->next = 0;
+	dummy->generation = 0;
+}
+
 #endif
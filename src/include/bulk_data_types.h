@@ -206,6 +206,48 @@ typedef struct bulk_data_renderbuffer_t
 	uint32_t count;
 } bulk_data_renderbuffer_t;
 
+typedef struct 
+{
+	skeleton_t data;
+}object_skeleton_t;
+
+typedef struct
+{
+	data_type_e data_type;
+	uint32_t generation;
+	union {
+		object_skeleton_t;
+		freelist_item_t;
+	};
+}item_skeleton_t;
+
+typedef struct bulk_data_skeleton_t
+{
+	item_skeleton_t *items;
+	uint32_t count;
+} bulk_data_skeleton_t;
+
+typedef struct 
+{
+	animated_instance_t data;
+}object_animated_instance_t;
+
+typedef struct
+{
+	data_type_e data_type;
+	uint32_t generation;
+	union {
+		object_animated_instance_t;
+		freelist_item_t;
+	};
+}item_animated_instance_t;
+
+typedef struct bulk_data_animated_instance_t
+{
+	item_animated_instance_t *items;
+	uint32_t count;
+} bulk_data_animated_instance_t;
+
 typedef struct bulk_data_t {
 	bulk_data_entity_t entities;
 	bulk_data_weapon_t weapons;
@@ -216,6 +258,8 @@ typedef struct bulk_data_t {
 	bulk_data_vulkan_buffer_t vulkan_buffers;
 	bulk_data_skinned_model_t skinned_models;
 	bulk_data_renderbuffer_t renderbuffers;
+	bulk_data_animated_instance_t animated_instances;
+	bulk_data_skeleton_t skeletons;
 }bulk_data_t;
 
 #endif
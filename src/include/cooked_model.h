@@ -0,0 +1,112 @@
+#ifndef COOKED_MODEL_H_
+#define COOKED_MODEL_H_
+
+#include <asset_types.h>
+
+//! @brief: a skinned model with its skeleton, clips and textures in the layout the engine keeps them in, written by
+//!         tools/model_cooker and mapped by the loader, see asset_store_add_skinned_model.
+//!         The sections hold engine structs as they are in memory, bump COOKED_MODEL_VERSION whenever one of
+//!         model_node_t, skin_t, material_t, mesh_t, skinned_vertex_t, animation_sampler_t or animation_channel_t
+//!         changes and cook the models again.
+#define COOKED_MODEL_MAGIC      0x4c444d53 //SMDL
+#define COOKED_MODEL_VERSION    1
+#define COOKED_MODEL_EXTENSION  "skm"
+//! @brief sections start at multiples of it so the mapped structs are aligned
+#define COOKED_MODEL_ALIGNMENT  16
+
+typedef enum
+{
+    //! @brief width * height RGBA8 pixels, one mip
+    COOKED_IMAGE_RGBA8,
+    //! @brief NUL terminated path of an image the cooker did not decode, ktx files, loaded with renderer_create_texture
+    COOKED_IMAGE_FILE,
+} cooked_image_format_e;
+
+typedef struct
+{
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t size;
+    uint64_t offset;
+} cooked_image_t;
+
+//! @brief: one clip, data is a copy of animation_t data with the sampler inputs and outputs as offsets into it
+typedef struct
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t sampler_count;
+    uint32_t channel_count;
+    float    start_time;
+    float    end_time;
+} cooked_animation_t;
+
+//! NOTE: offsets are in bytes from the start of the file
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+
+    uint32_t node_count;
+    uint32_t mesh_node;
+    uint32_t material_count;
+    uint32_t image_count;
+    uint32_t animation_count;
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t padding;
+
+    //! @brief primitive ranges into the index section
+    mesh_t   mesh;
+
+    //! @brief model_node_t, uint64_t name hashes and bool leaf flags, node_count of each, then one skin_t
+    uint64_t nodes;
+    uint64_t node_names;
+    uint64_t leaf_nodes;
+    uint64_t skin;
+    //! @brief material_t whose texture indices are image indices
+    uint64_t materials;
+    uint64_t images;
+    uint64_t animations;
+    uint64_t vertices;
+    uint64_t indices;
+} cooked_model_header_t;
+
+//! @brief: a mapped cooked model, the pointers point into the file
+typedef struct
+{
+    mapped_file_t                file;
+    const cooked_model_header_t *header;
+
+    const model_node_t          *nodes;
+    const uint64_t              *node_names;
+    const bool                  *leaf_nodes;
+    const skin_t                *skin;
+    const material_t            *materials;
+    const cooked_image_t        *images;
+    const cooked_animation_t    *animations;
+    const skinned_vertex_t      *vertices;
+    const uint32_t              *indices;
+} cooked_model_t;
+
+/**
+ * @brief: Writes the mesh, skeleton, clips and images of a glTF file to path, images are decoded to RGBA8.
+ *         compression is applied to the clips like asset_store_add_skinned_model does.
+ */
+bool        cooked_model_write(gltf_model_t *gltf_model, const animation_compression_config_t *compression, const char *path);
+/**
+ * @brief: Maps a cooked model and checks its header, that every section lies inside the file and that the node,
+ *         joint, vertex, material and image indices the sections store are in range.
+ */
+bool        cooked_model_open(cooked_model_t *cooked, const char *path);
+void        cooked_model_close(cooked_model_t *cooked);
+/**
+ * @brief: Heap copy of a cooked clip with its sampler pointers restored, freed by animation_destroy. Fails when
+ *         a sampler's keys don't fit in the clip or a channel names a sampler or node it doesn't have.
+ */
+bool        cooked_model_load_animation(const cooked_model_t *cooked, uint32_t index, animation_t *animation);
+const void *cooked_model_image_data(const cooked_model_t *cooked, uint32_t index);
+
+#endif
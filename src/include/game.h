@@ -3,6 +3,8 @@
 
 #include <game_types.h>
 #include <bulk_data_types.h>
+#include <world_streamer.h>
+#include <animation_system.h>
 
 typedef struct 
 {
@@ -14,9 +16,9 @@ typedef struct
     asset_store_t      asset_store;
     renderer_t         renderer;
     bulk_data_t        bulk_data;
+    world_streamer_t   world;
+    animation_system_t animation;
     
-    //temporary
-    uint32_t skinned_model_index;
     //one player per game
     player_t           player_data;
     entity_t          *player_entity;
@@ -103,6 +103,8 @@ typedef struct
 
     uint32_t      animation_chunk_count;
     float         anim_timer;
+    //! NOTE: bulk data index of the animated_instance_t driven by the player's state, UINT32_MAX for none
+    uint32_t      animated_instance;
 
     entity_t     *weapon;
 } player_t;
@@ -1,6 +1,55 @@
 #ifndef GENERATOR_H_
 #define GENERATOR_H_
 
-void create_dungeon(void);
-#endif
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+    WALL = 0x1,
+    FLOOR = 0x2,
+    INVALID_TILE = 0x0
+};
+
+enum
+{
+    DUNGEON_NORTH,
+    DUNGEON_EAST,
+    DUNGEON_SOUTH,
+    DUNGEON_WEST
+};
 
+typedef struct
+{
+    //! @brief map size in tiles. odd sizes give the maze a closed border
+    int32_t  width;
+    int32_t  height;
+    //! @brief maximum number of rooms, the generator gives up after room_count * 5 failed placements
+    uint32_t room_count;
+    uint64_t seed;
+    //! @brief odd tile offset along each border (DUNGEON_NORTH..DUNGEON_WEST) to open a door at, 0 keeps the border closed
+    int32_t  doors[4];
+}dungeon_config_t;
+
+typedef struct
+{
+    //! @brief width * height tiles, row major. allocated on MEM_TAG_HEAP
+    uint8_t  *tiles;
+    //! @brief width * height region ids, 0 means no region
+    uint32_t *regions;
+    int32_t   width;
+    int32_t   height;
+    uint32_t  region_count;
+}dungeon_t;
+
+bool   create_dungeon(dungeon_t *dungeon, const dungeon_config_t *config);
+/**
+ * @brief: Generates into caller owned memory and touches no global state, so it is safe to call from job threads.
+ *         dungeon->tiles and dungeon->regions need room for width * height entries,
+ *         scratch needs dungeon_scratch_size bytes.
+ */
+bool   dungeon_generate(dungeon_t *dungeon, const dungeon_config_t *config, void *scratch, size_t scratch_size);
+size_t dungeon_scratch_size(int32_t width, int32_t height);
+void   destroy_dungeon(dungeon_t *dungeon);
+#endif
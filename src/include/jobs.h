@@ -0,0 +1,38 @@
+#ifndef JOBS_H_
+#define JOBS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+typedef void (*job_fn_t)(void *data);
+
+/**
+ * @brief: counts jobs that have been submitted but not finished yet.
+ *         Zero initialise, pass it to jobs_submit and wait on it with jobs_wait.
+ */
+typedef struct
+{
+    atomic_uint pending;
+}job_counter_t;
+
+/**
+ * @brief: Start the worker threads. worker_count 0 means one worker per core minus the main thread.
+ */
+void     jobs_init(uint32_t worker_count);
+/**
+ * @brief: Finish all queued jobs and join the worker threads.
+ */
+void     jobs_shutdown(void);
+uint32_t jobs_worker_count(void);
+/**
+ * @brief: Thread safe. counter may be NULL. If the queue is full the job runs on the calling thread.
+ *         Jobs must not call memory_alloc, the memory system is main thread only.
+ */
+void     jobs_submit(job_fn_t fn, void *data, job_counter_t *counter);
+/**
+ * @brief: Runs queued jobs on the calling thread until counter reaches zero.
+ */
+void     jobs_wait(job_counter_t *counter);
+bool     jobs_done(job_counter_t *counter);
+#endif
@@ -3,7 +3,29 @@
 
 #include <asset_types.h>
 
-gltf_model_t *model_load_from_gltf(const char * path, const char *asset_id);
+/**
+ * @brief: Parses a .gltf, or a .glb whose buffer is left in the mapped file, into an arena of its own. Thread safe,
+ *         nothing is allocated from the memory system. model_release_gltf frees the model and everything converted
+ *         from it once the buffers are no longer read.
+ */
+gltf_model_t *model_load_from_gltf(const char *path, const char *asset_id);
+void          model_release_gltf(gltf_model_t *gltf_model);
+/**
+ * @brief: Materials of the model, returns their count. textures takes a glTF image to the texture index stored in
+ *         the materials.
+ */
+uint32_t      model_load_materials(gltf_model_t *gltf_model, const uint32_t *textures, material_t *materials);
+/**
+ * @brief: Converts the primitives of the model's mesh into skinned vertices and indices in the model's arena and
+ *         fills the primitive ranges of mesh. joint_table takes a joint of the glTF skin to a joint of the skeleton,
+ *         NULL keeps the skin's joints for model_remap_skinned_joints. Thread safe.
+ */
+void          model_load_skinned_geometry(gltf_model_t *gltf_model, const uint32_t *joint_table, mesh_t *mesh, skinned_geometry_t *geometry);
+/**
+ * @brief: Rewrites the skin joints of geometry converted without a table to skeleton joints, nothing to do when
+ *         joint_table is the identity.
+ */
+void          model_remap_skinned_joints(skinned_geometry_t *geometry, const uint32_t *joint_table, uint32_t joint_count);
 
 #endif
 
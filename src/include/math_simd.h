@@ -0,0 +1,27 @@
+#ifndef MATH_SIMD_H_
+#define MATH_SIMD_H_
+
+//! @brief: picks the widest instruction set the compiler targets. Build with -DMATH_NO_SIMD for the scalar path,
+//          and with -mavx (or -march=native) for the 256 bit matrix kernels.
+#if !defined(MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define MATH_SIMD_SSE 1
+#include <immintrin.h>
+#else
+#define MATH_SIMD_SSE 0
+#endif
+
+#if MATH_SIMD_SSE && defined(__AVX__)
+#define MATH_SIMD_AVX 1
+#else
+#define MATH_SIMD_AVX 0
+#endif
+
+#if MATH_SIMD_AVX
+#define MATH_SIMD_NAME "avx"
+#elif MATH_SIMD_SSE
+#define MATH_SIMD_NAME "sse"
+#else
+#define MATH_SIMD_NAME "scalar"
+#endif
+
+#endif
@@ -42,6 +42,28 @@ typedef struct
     float m[4][4];
 }mat4f_t;
 
+/**
+ * @brief: Affine transform, the last column of a mat4f_t dropped. Rows are the columns of the mat4f_t,
+ *         (linear | translation), so p' = m * (p, 1). 48 bytes, matches a std430 mat3x4 in GLSL where
+ *         vec4(p, 1) * m transforms a point.
+ */
+typedef struct
+{
+    float m[3][4];
+}affine3x4_t;
+
+//! @brief: same layout as vec4f_t and mat4f_t but 16 byte aligned, for arrays that are fed to the SIMD kernels.
+//          The kernels also accept unaligned data, heap and arena blocks are only 8 byte aligned.
+typedef struct
+{
+    _Alignas(16) float x,y,z,w;
+}vec4a_t;
+
+typedef struct
+{
+    _Alignas(16) float m[4][4];
+}mat4a_t;
+
 typedef struct 
 {
     vec2f_t min;
@@ -2,9 +2,16 @@
 #define MATH_H_
 
 #include <math_types.h>
+#include <math_simd.h>
 #include <stdbool.h>
 
+/**
+ * @brief: transform = transform * scale * rotation * translation. The TRS part is built directly, without
+ *         the intermediate matrices, and the multiply is skipped when transform is identity.
+ */
 void    transform_from_TRS(mat4f_t *transform, vec3f_t translation, quat_t rotation, vec3f_t scale);
+//! @brief: scale * rotation * translation written straight into out.
+void    mat4_from_TRS(mat4f_t *out, vec3f_t translation, quat_t rotation, vec3f_t scale);
 
 void    mat4_look_at(vec3f_t from, vec3f_t to, vec3f_t up, mat4f_t *mat);
 void    mat4_orthographic(float bottom, float top, float left, float right, float near, float far, mat4f_t *m);
@@ -13,10 +20,28 @@ mat4f_t mat4_rotate(vec3f_t axis, float theta);
 mat4f_t mat4_rotate_w_quat(quat_t quat);
 mat4f_t mat4_translate(float x, float y, float z);
 mat4f_t mat4_scale(float x, float y, float z);
+//! @brief: out = a * b with SSE or AVX when available, out may alias a or b.
 void    mat4_multiply(const mat4f_t *a, const mat4f_t *b, mat4f_t *out);
+//! @brief: out[i] = a[i] * b[i] for count matrices.
+void    mat4_multiply_n(const mat4f_t *a, const mat4f_t *b, mat4f_t *out, uint32_t count);
 void    mat4_inverse(const mat4f_t *a, mat4f_t *out);
 mat4f_t mat4_identity(void);
 
+affine3x4_t affine_identity(void);
+void    affine_from_mat4(const mat4f_t *in, affine3x4_t *out);
+void    affine_to_mat4(const affine3x4_t *in, mat4f_t *out);
+//! @brief: same as mat4_from_TRS, scale then rotation then translation.
+void    affine_from_TRS(affine3x4_t *out, vec3f_t translation, quat_t rotation, vec3f_t scale);
+//! @brief: a then b, the same order as mat4_multiply(a, b). out may alias a or b.
+void    affine_multiply(const affine3x4_t *a, const affine3x4_t *b, affine3x4_t *out);
+void    affine_multiply_n(const affine3x4_t *a, const affine3x4_t *b, affine3x4_t *out, uint32_t count);
+/**
+ * @brief: Inverse of the 3x3 part and -inverse * translation. Handles scale and shear, for rigid
+ *         transforms use affine_inverse_rigid which is a transpose.
+ */
+void    affine_inverse(const affine3x4_t *in, affine3x4_t *out);
+void    affine_inverse_rigid(const affine3x4_t *in, affine3x4_t *out);
+
 vec4f_t vec4_lerp(vec4f_t a, vec4f_t b, float t);
 vec4f_t vec4_normalize(vec4f_t in);
 
@@ -37,5 +62,13 @@ void quat_to_rot_mat4(quat_t quat, mat4f_t *rot);
 quat_t quat_normalize(quat_t in);
 quat_t quat_lerp(quat_t a, quat_t b, float t);
 quat_t quat_slerp(quat_t a, quat_t b, float t);
+//! @brief: normalized lerp along the shortest arc.
+quat_t quat_nlerp(quat_t a, quat_t b, float t);
+/**
+ * @brief: Batched out[i] = interpolate(a[i], b[i], t[i]), four quaternions per SSE iteration.
+ *         slerp_n uses polynomial acos and sin, within 1e-6 of quat_slerp.
+ */
+void   quat_nlerp_n(const quat_t *a, const quat_t *b, const float *t, quat_t *out, uint32_t count);
+void   quat_slerp_n(const quat_t *a, const quat_t *b, const float *t, quat_t *out, uint32_t count);
 #endif
 
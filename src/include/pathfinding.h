@@ -0,0 +1,131 @@
+#ifndef PATHFINDING_H_
+#define PATHFINDING_H_
+
+#include <math_types.h>
+#include <generator.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLOW_FIELD_UNREACHED UINT16_MAX
+//! @brief side of the tiles the nav grid cuts the floor into, every walk inside one fits in a byte
+#define NAV_CLUSTER_SIZE     8
+#define NAV_FAR              UINT8_MAX
+
+/**
+ * @brief: Breadth first distances toward a target cell, limited to radius steps.
+ *         Cells are invalidated with a generation stamp, so a rebuild only touches the cells it reaches.
+ */
+typedef struct
+{
+    const dungeon_t *dungeon;
+    uint16_t        *distance;
+    uint32_t        *stamp;
+    uint32_t        *queue;
+    uint32_t         queue_cap;
+    uint32_t         generation;
+    int32_t          radius;
+    vec2i_t          target;
+    bool             valid;
+} flow_field_t;
+
+typedef struct
+{
+    uint32_t to;
+    //! @brief floor cell in the from cluster and its neighbour in the to cluster
+    uint32_t cell_from;
+    uint32_t cell_to;
+    //! @brief edge going back the other way
+    uint32_t reverse;
+} nav_edge_t;
+
+/**
+ * @brief: Cluster graph of a dungeon for hierarchical A*. The floor is cut into NAV_CLUSTER_SIZE square tiles and a
+ *         cluster is a connected piece of floor inside one of them. Every floor contact across a tile border is a
+ *         door, so a cluster has at most 4 * NAV_CLUSTER_SIZE doors however large the room or maze it is part of.
+ *         Every cluster stores the walking distance from each of its doors to each of its cells, so the abstract
+ *         search is exact and refining a path is a walk down those distances instead of another search.
+ *         Queries reuse scratch owned by the nav grid, they are not thread safe.
+ */
+typedef struct
+{
+    const dungeon_t *dungeon;
+    //! @brief cluster of every floor cell, UINT32_MAX elsewhere, and the cell's index within it
+    uint32_t        *cluster;
+    uint32_t        *cell_slot;
+    uint32_t        *cluster_size;
+    uint32_t         cluster_count;
+    //! @brief edges of cluster c are edges[edge_offsets[c] .. edge_offsets[c + 1]]
+    uint32_t        *edge_offsets;
+    nav_edge_t      *edges;
+    uint32_t         edge_count;
+
+    //! @brief distance from slot s to door j of cluster c: door_distance[door_offsets[c] + s * degree + j],
+    //!        NAV_FAR when the door can't be reached without leaving the cluster
+    uint64_t        *door_offsets;
+    uint8_t         *door_distance;
+    //! @brief door to door distances of cluster c: door_matrix[matrix_offsets[c] + i * degree + j]
+    uint64_t        *matrix_offsets;
+    uint8_t         *door_matrix;
+
+    //! @brief target field: walking distance from every edge's cell_to to the target
+    uint32_t        *edge_cost;
+    //! @brief walking distance to the target for every slot of the target cluster
+    uint32_t        *target_distance;
+    uint32_t         target_cell;
+    uint32_t         target_cluster;
+    uint32_t         target_generation;
+
+    //scratch, node_cap entries each
+    uint32_t        *g;
+    uint32_t        *f;
+    uint32_t        *parent;
+    uint32_t        *stamp;
+    uint32_t        *heap;
+    uint32_t        *heap_index;
+    uint32_t         node_cap;
+    uint32_t         generation;
+    uint32_t        *edge_path;
+} nav_grid_t;
+
+//! @brief: per entity route cache for nav_next_step, zero initialise
+typedef struct
+{
+    uint32_t cluster;
+    //! @brief door edge to head for, or UINT32_MAX to walk straight to the target
+    uint32_t edge;
+    uint32_t target_generation;
+} nav_agent_t;
+
+bool     flow_field_init(flow_field_t *field, const dungeon_t *dungeon, int32_t radius);
+/**
+ * @brief: Only rebuilds when the target moved to a different cell. Returns true if it rebuilt.
+ */
+bool     flow_field_update(flow_field_t *field, int32_t target_x, int32_t target_y);
+/**
+ * @brief: Step to take from cell x,y to get closer to the target. False outside of the field or on the target.
+ */
+bool     flow_field_direction(const flow_field_t *field, int32_t x, int32_t y, vec2i_t *dir);
+void     flow_field_destroy(flow_field_t *field);
+
+bool     nav_grid_init(nav_grid_t *nav, const dungeon_t *dungeon);
+/**
+ * @brief: Hierarchical A*: a search over the cluster graph, refined by walking down the door distances of each
+ *         cluster on the way. When both cells are in one cluster a search inside it competes with the way through
+ *         other clusters and the shorter path wins. Writes the next max_cells cells after from into path and
+ *         returns how many were written,
+ *         0 if there is no path. Refinement stops once path is full, so long queries stay cheap
+ *         when entities only ask for the next few steps.
+ */
+uint32_t nav_find_path(nav_grid_t *nav, vec2i_t from, vec2i_t to, vec2i_t *path, uint32_t max_cells);
+/**
+ * @brief: Hierarchical flow field toward to: one search over the doors and one inside the target cluster.
+ *         Only rebuilds when the target changed cell. Returns true if it rebuilt.
+ */
+bool     nav_set_target(nav_grid_t *nav, vec2i_t to);
+/**
+ * @brief: Next cell on the shortest path from from to the nav target. Agents pick a door once per cluster
+ *         and target, after that a step is a handful of lookups. False if there is no way to the target.
+ */
+bool     nav_next_step(nav_grid_t *nav, nav_agent_t *agent, vec2i_t from, vec2i_t *next);
+void     nav_grid_destroy(nav_grid_t *nav);
+#endif
@@ -19,15 +19,44 @@ bool renderer_set_viewport(renderer_t *renderer, float w, float h, float minz, f
 bool renderer_set_scissor(renderer_t *renderer, float x, float y, float w, float h);
 
 bool renderer_create_texture(renderer_t *renderer, texture_t *texture, const char *file_path);
+/**
+ * @brief: Texture of width * height decoded RGBA8 pixels, one mip. The pixels are copied before it returns.
+ */
+bool renderer_create_texture_from_pixels(renderer_t *renderer, texture_t *texture, const void *pixels, uint32_t width, uint32_t height);
+/**
+ * @brief: Releases the device memory right away, the frames that used the texture or renderbuffer must have
+ *         finished, see frame_count in renderer_t.
+ */
+void renderer_destroy_texture(renderer_t *renderer, texture_t *texture);
+void renderer_destroy_renderbuffer(renderer_t *renderer, renderbuffer_t *renderbuffer);
+
+/**
+ * @brief: Batches the copies of the textures and device local renderbuffers created until renderer_end_uploads into
+ *         one submission that is not waited for. Fails while the previous batch has not finished.
+ */
+bool renderer_begin_uploads(renderer_t *renderer);
+bool renderer_end_uploads(renderer_t *renderer);
+/**
+ * @brief: True once the last batch has executed and its staging memory is released, only then may it be drawn from.
+ *         wait blocks until then.
+ */
+bool renderer_uploads_finished(renderer_t *renderer, bool wait);
 
 bool renderer_create_renderbuffer(renderer_t *renderer, renderbuffer_t *renderbuffer, renderbuffer_type_e type, uint8_t *data, uint32_t size);
 void renderer_copy_to_renderbuffer(renderer_t *renderer, renderbuffer_t *renderbuffer, void *src, uint32_t size);
+/**
+ * @brief: Persistently mapped memory of the current frame's copy of a host visible renderbuffer, for writing its
+ *         contents in place. Valid once renderer_frame_prepare has waited for the frame, until renderer_frame_submit.
+ */
+void *renderer_map_renderbuffer(renderer_t *renderer, renderbuffer_t *renderbuffer);
 
 bool renderer_create_shader(renderer_t *renderer, renderer_shader_type_e shader_type);
 bool renderer_use_shader(renderer_t *renderer, renderer_shader_type_e shader_type);
 bool renderer_initialize_shader(renderer_t *renderer, renderer_shader_type_e shader_type, shader_resource_list_t *resource_list);
 
 void *renderer_create_render_data(renderer_t *renderer, render_data_type_e type, void *data);
+//! @brief: Frees render data and its descriptor sets right away, like renderer_destroy_renderbuffer
+void  renderer_destroy_render_data(renderer_t *renderer, render_data_type_e type, void *render_data);
 bool renderer_shader_bind_resource(renderer_t *renderer, renderer_shader_type_e shader_type, render_data_type_e type, void *render_data);
 bool renderer_bind_vertex_buffers(renderer_t *renderer, renderbuffer_t *vertex_buffer);
 bool renderer_bind_index_buffers(renderer_t *renderer, renderbuffer_t *index_buffer);
@@ -136,6 +136,8 @@ typedef struct
 {
     void                  *internal_data;//api specific data
     descriptor_set_type_e  descriptor_set;
+    //! @brief device memory of the image and its mips
+    uint32_t               size;
 }texture_t;
 
 typedef struct
@@ -214,13 +216,21 @@ typedef struct renderer_backend_t
     uint32_t (*get_num_frames_in_flight)(struct renderer_backend_t *);
     bool (*create_renderbuffer)(struct renderer_backend_t *, renderbuffer_t *, renderbuffer_type_e, uint8_t *, uint32_t);
     void (*copy_to_renderbuffer)(struct renderer_backend_t *, renderbuffer_t *, void *, uint32_t);
+    void*(*map_renderbuffer)(struct renderer_backend_t *, renderbuffer_t *);
+    bool (*begin_uploads)(struct renderer_backend_t *);
+    bool (*end_uploads)(struct renderer_backend_t *);
+    bool (*uploads_finished)(struct renderer_backend_t *, bool);
     bool (*bind_buffer)(struct renderer_backend_t *, renderbuffer_t*, shader_t*);
     bool (*create_shader)(struct renderer_backend_t *, shader_t *, const char *vert_code, const char *frag_code);
     bool (*use_shader)(struct renderer_backend_t *, shader_t *);
     bool (*shader_bind_resource)(struct renderer_backend_t *, shader_t *, render_data_type_e, void *);
     void*(*create_render_data)(struct renderer_backend_t *, struct bulk_data_renderbuffer_t *, render_data_type_e, void *);
+    void (*destroy_render_data)(struct renderer_backend_t *, render_data_type_e, void *);
     bool (*initialize_shader)(struct renderer_backend_t *, shader_t *,  shader_resource_list_t *);
     bool (*create_texture)(struct renderer_backend_t *, texture_t *, const char *);
+    bool (*create_texture_from_pixels)(struct renderer_backend_t *, texture_t *, const void *, uint32_t, uint32_t);
+    void (*destroy_texture)(struct renderer_backend_t *, texture_t *);
+    void (*destroy_renderbuffer)(struct renderer_backend_t *, renderbuffer_t *);
     bool (*bind_vertex_buffers)(struct renderer_backend_t *, renderbuffer_t *);
     bool (*bind_index_buffers)(struct renderer_backend_t *, renderbuffer_t *);
     bool (*frame_submit)(struct renderer_backend_t *, frame_data_t *);
@@ -248,6 +258,9 @@ typedef struct
     //render target count
     uint32_t current_frame;
     uint32_t max_frames_in_flight;
+    //! @brief frames submitted so far, a resource the last of them used is idle once this reaches
+    //!        its value then + max_frames_in_flight
+    uint64_t frame_count;
 
     struct bulk_data_renderbuffer_t *renderbuffers;
     struct bulk_data_texture_t *textures;
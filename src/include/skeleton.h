@@ -0,0 +1,39 @@
+#ifndef SKELETON_H_
+#define SKELETON_H_
+
+#include <asset_types.h>
+#include <cooked_model.h>
+
+/**
+ * @brief: Node hierarchy, skin and clips of a glTF file. remap takes a glTF node index to a skeleton node index
+ *         and has room for every node of the file.
+ */
+bool     skeleton_create(skeleton_t *skeleton, gltf_model_t *gltf_model, const animation_compression_config_t *compression, uint32_t *remap);
+/**
+ * @brief: Nodes, skin and clips of a cooked model, the clips are copied out of the mapped file.
+ */
+bool     skeleton_create_cooked(skeleton_t *skeleton, const cooked_model_t *cooked);
+void     skeleton_destroy(skeleton_t *skeleton);
+/**
+ * @brief: Skeleton node of every node of another glTF file exported from the same rig, matched by name.
+ *         Nodes the skeleton does not have map to UINT32_MAX. Fails when a node has no name or shares it with
+ *         another node, unless the file has the skeleton's hierarchy and its nodes are bound by index.
+ */
+bool     skeleton_bind_gltf_nodes(const skeleton_t *skeleton, const gltf_model_t *gltf_model, uint32_t *remap);
+//! @brief: skeleton_bind_gltf_nodes for the nodes of a cooked model
+bool     skeleton_bind_cooked_nodes(const skeleton_t *skeleton, const cooked_model_t *cooked, uint32_t *remap);
+/**
+ * @brief: Appends the clips of a glTF file authored for the rig. Channels of nodes the skeleton lacks are dropped.
+ */
+bool     skeleton_add_animations(skeleton_t *skeleton, gltf_model_t *gltf_model, const animation_compression_config_t *compression);
+/**
+ * @brief: Index in the skin of a skeleton node, UINT32_MAX when the node is not a joint.
+ */
+uint32_t skeleton_find_joint(const skeleton_t *skeleton, uint32_t node);
+/**
+ * @brief: joint_table takes a joint of the glTF file's skin to the skeleton joint of the same node, node_remap is
+ *         what skeleton_create or skeleton_bind_gltf_nodes filled for the file. Fails for joints the skeleton lacks.
+ */
+bool     skeleton_build_joint_table(const skeleton_t *skeleton, const gltf_model_t *gltf_model, const uint32_t *node_remap, uint32_t *joint_table);
+
+#endif
@@ -2,10 +2,80 @@
 #define SKINNED_MODEL_H_
 
 #include <asset_types.h>
+#include <cooked_model.h>
 
-bool skinned_model_create(skinned_model_t *skinned_model, const char *file_path, const char *asset_id, renderer_t *renderer, asset_store_t *asset_store);
-void skinned_model_update_animation(skinned_model_t *model, renderer_t *renderer, float dt);
-void skinned_model_draw(skinned_model_t *model, renderer_t *renderer, shader_t *shader);
+struct bulk_data_animated_instance_t;
 
-#endif
+//! @brief: an image of a glTF model, png and jpg files are decoded before the texture is created
+typedef struct
+{
+    const char    *path;
+    asset_key_t    key;
+    bool           decode;
+    bool           decoded;
+    unsigned char *pixels;
+    int            width, height;
+    double         time;
+}skinned_model_image_t;
+
+//! @brief: a glTF model read and converted as far as it can be without the skeleton it is skinned against
+typedef struct
+{
+    gltf_model_t          *gltf_model;
+    //! @brief joints of the glTF skin, skinned_model_create rewrites them to the skeleton's
+    skinned_geometry_t     geometry;
+    mesh_t                 mesh;
+    skinned_model_image_t  images[MAX_TEXTURES_PER_MODEL];
+}skinned_model_source_t;
 
+/**
+ * @brief: Parses the glTF file and converts its vertices, decode_images decodes its png and jpg images as well.
+ *         Thread safe, nothing is taken from the asset store or the memory system. Released with
+ *         skinned_model_release_source.
+ */
+bool skinned_model_read_gltf(skinned_model_source_t *source, const char *file_path, const char *asset_id, bool decode_images);
+void skinned_model_release_source(skinned_model_source_t *source);
+/**
+ * @brief: Mesh and materials of a read glTF file, skinned against skeleton. node_remap takes the file's nodes to
+ *         skeleton nodes, vertex joint indices are rewritten to the skeleton's joints. Textures and buffers another
+ *         model loaded from the same images or vertices are shared through asset_store, images that weren't decoded
+ *         yet are decoded here. False when the model or its buffers can't be created, the references it took are
+ *         left in skinned_model for the caller to release.
+ */
+bool skinned_model_create(skinned_model_t *skinned_model, skinned_model_source_t *source, const skeleton_t *skeleton, uint32_t skeleton_index, const uint32_t *node_remap, asset_store_t *asset_store, renderer_t *renderer);
+/**
+ * @brief: skinned_model_create for a mapped cooked model, node_remap takes the cooked nodes to skeleton nodes.
+ *         The vertices and indices are uploaded from the file without conversion when the skeleton's skin is the
+ *         cooked one.
+ */
+bool skinned_model_create_cooked(skinned_model_t *skinned_model, const cooked_model_t *cooked, const skeleton_t *skeleton, uint32_t skeleton_index, const uint32_t *node_remap, asset_store_t *asset_store, renderer_t *renderer);
+/**
+ * @brief: Bakes the skeleton's clips that are not baked for the model yet at sample_rate, see animation_bake.
+ */
+bool skinned_model_bake_animations(skinned_model_t *skinned_model, const skeleton_t *skeleton, float sample_rate);
+/**
+ * @brief: Frees the baked clips. The GPU buffers are not released yet.
+ */
+void skinned_model_destroy(skinned_model_t *skinned_model);
+/**
+ * @brief: Joint palette storage buffer and render data of an instance set up with animated_instance_init.
+ *         The render data has to exist before the skinned shader is initialised with it. When it fails, what was
+ *         created is left in the instance for skinned_model_destroy_instance.
+ */
+bool skinned_model_create_instance(const skinned_model_t *model, const skeleton_t *skeleton, animated_instance_t *instance, renderer_t *renderer);
+/**
+ * @brief: Retires the instance's palette buffer and render data through asset_store_retire and frees its slot in
+ *         instances. The reference to the model acquired for it is the caller's to release.
+ */
+void skinned_model_destroy_instance(struct bulk_data_animated_instance_t *instances, uint32_t index, asset_store_t *asset_store, renderer_t *renderer);
+/**
+ * @brief: The current frame's copy of the instance's joint palette buffer, mapped. The palette is written in place,
+ *         see animation_system_queue_palette.
+ */
+mat4f_t *skinned_model_map_palette(const animated_instance_t *instance, renderer_t *renderer);
+/**
+ * @brief: Draws the shared mesh with the palette in the instance's buffer for the current frame.
+ */
+void skinned_model_draw(const skinned_model_t *model, const animated_instance_t *instance, renderer_t *renderer, shader_t *shader);
+
+#endif
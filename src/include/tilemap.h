@@ -0,0 +1,62 @@
+#ifndef TILEMAP_H_
+#define TILEMAP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <generator.h>
+#include <utils.h>
+
+#define TILEMAP_MAGIC   0x50414D54 //"TMAP"
+#define TILEMAP_VERSION 1
+
+typedef enum
+{
+    //! @brief section is stored as runs and has to be decoded
+    TILEMAP_FLAG_RLE_TILES   = 0x1,
+    TILEMAP_FLAG_RLE_REGIONS = 0x2
+} tilemap_flags_e;
+
+/**
+ * @brief: On disk layout, little endian:
+ *         header | tiles (width * height uint8_t) | regions (width * height uint32_t)
+ *         Sections start on 8 byte boundaries so the arrays can be used straight from the mapping.
+ *         RLE tiles are (uint8_t run, uint8_t tile) pairs, RLE regions are (uint32_t run, uint32_t region) pairs.
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    int32_t  width;
+    int32_t  height;
+    uint32_t region_count;
+    uint32_t reserved;
+    uint64_t tiles_offset;
+    uint64_t tiles_size;
+    uint64_t regions_offset;
+    uint64_t regions_size;
+} tilemap_header_t;
+
+typedef struct
+{
+    mapped_file_t   file;
+    int32_t         width;
+    int32_t         height;
+    uint32_t        region_count;
+    //! @brief point into the mapping, or into decoded when the file is compressed
+    const uint8_t  *tiles;
+    const uint32_t *regions;
+    void           *decoded;
+} tilemap_t;
+
+/**
+ * @brief: compress only run length encodes a section when that makes it smaller.
+ */
+bool tilemap_write(const dungeon_t *dungeon, const char *path, bool compress);
+/**
+ * @brief: Maps the file and validates the header. Uncompressed maps are used in place,
+ *         so opening a level only pages in what gets touched.
+ */
+bool tilemap_open(tilemap_t *map, const char *path);
+void tilemap_close(tilemap_t *map);
+#endif
@@ -7,8 +7,19 @@
 #define bit_flip(num,bit) ((1ULL << (bit)) ^ (num))
 
 #include <memory_types.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//! @brief read only view of a whole file, pages are loaded on first touch
+typedef struct
+{
+    const uint8_t *data;
+    size_t         size;
+} mapped_file_t;
 
 uint8_t *read_whole_file(const char *file_path, long *size, memory_tag_t tag);
+bool     map_whole_file(const char *file_path, mapped_file_t *file);
+void     unmap_whole_file(mapped_file_t *file);
 
 #endif
 
@@ -20,6 +20,10 @@ uint32_t vulkan_backend_get_number_of_frames_in_flight(struct renderer_backend_t
 
 bool vulkan_backend_create_renderbuffer(struct renderer_backend_t *backend, renderbuffer_t *renderbuffer, renderbuffer_type_e renderbuffer_type, uint8_t *buffer_data, uint32_t size);
 void vulkan_backend_copy_to_renderbuffer(struct renderer_backend_t *backend, renderbuffer_t *renderbuffer, void *src, uint32_t size);
+void *vulkan_backend_map_renderbuffer(struct renderer_backend_t *backend, renderbuffer_t *renderbuffer);
+bool vulkan_backend_begin_uploads(struct renderer_backend_t *backend);
+bool vulkan_backend_end_uploads(struct renderer_backend_t *backend);
+bool vulkan_backend_uploads_finished(struct renderer_backend_t *backend, bool wait);
 
 bool vulkan_backend_bind_vertex_buffers(struct renderer_backend_t *backend, renderbuffer_t *vertex_buffer);
 bool vulkan_backend_bind_index_buffers(struct renderer_backend_t *backend, renderbuffer_t *index_buffer);
@@ -30,8 +34,12 @@ bool vulkan_backend_initialize_shader(renderer_backend_t *backend, shader_t *sha
 bool vulkan_backend_shader_bind_resource(renderer_backend_t *backend, shader_t *shader, render_data_type_e type, void *render_data);
 
 void *vulkan_backend_create_render_data(struct renderer_backend_t *backend, struct bulk_data_renderbuffer_t *renderbuffers, render_data_type_e type, void *data);
+void vulkan_backend_destroy_render_data(struct renderer_backend_t *backend, render_data_type_e type, void *render_data);
 
 bool vulkan_backend_create_texture(struct renderer_backend_t *backend, texture_t *texture, const char *file_path);
+bool vulkan_backend_create_texture_from_pixels(struct renderer_backend_t *backend, texture_t *texture, const void *pixels, uint32_t width, uint32_t height);
+void vulkan_backend_destroy_texture(struct renderer_backend_t *backend, texture_t *texture);
+void vulkan_backend_destroy_renderbuffer(struct renderer_backend_t *backend, renderbuffer_t *renderbuffer);
 
 bool vulkan_backend_push_constants(struct renderer_backend_t *backend, shader_t *shader, const void *data, uint32_t size, uint32_t offset, renderer_shader_stage_e shader_stage);
 bool vulkan_backend_draw_indexed(struct renderer_backend_t *backend, int32_t vertex_offset, uint32_t first_index, uint32_t index_count, uint32_t first_instance, uint32_t instance_count);
@@ -11,5 +11,16 @@ bool get_memory_type(VkPhysicalDeviceMemoryProperties *memProperties,
 
 VkCommandBuffer begin_command_buffer(VkDevice device, VkCommandPool cmd_pool);
 void end_command_buffer(VkCommandBuffer *buffer, VkDevice device, VkCommandPool pool, VkQueue queue);
+
+/**
+ * @brief: Command buffer to record a copy from a staging buffer into. The upload batch's while one is recorded and
+ *         has room for another staging buffer, a one time command buffer otherwise.
+ */
+VkCommandBuffer vulkan_begin_upload(vulkan_context_t *context);
+/**
+ * @brief: Submits and waits for a one time command buffer, a batched one is submitted by renderer_end_uploads.
+ *         staging is destroyed once the copies out of it have executed.
+ */
+void vulkan_end_upload(vulkan_context_t *context, VkCommandBuffer *command_buffer, vulkan_buffer_t *staging);
 #endif
 
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan.h>
 #include <math_types.h>
+#include <stdbool.h>
 
 #define MAX_FRAMES_IN_FLIGHT             2
 #define MAX_TEXTURE_COUNT                128
@@ -94,6 +95,23 @@ typedef struct
     vec2f_t tex_coord;
 }vertex_t;
 
+//! @brief staging buffers one upload batch holds on to, uploads past it are submitted on their own
+#define MAX_BATCHED_UPLOADS              256
+
+/**
+ * @brief: Copies recorded between renderer_begin_uploads and renderer_end_uploads go into one command buffer that
+ *         is submitted once with a fence, the staging buffers are destroyed when the fence has signaled.
+ */
+typedef struct
+{
+    VkCommandBuffer  command_buffer;
+    VkFence          fence;
+    vulkan_buffer_t  staging_buffers[MAX_BATCHED_UPLOADS];
+    uint32_t         staging_buffer_count;
+    bool             recording;
+    bool             in_flight;
+}vulkan_upload_batch_t;
+
 struct bulk_data_vulkan_buffer_t;
 struct bulk_data_vulkan_texture_t;
 
@@ -163,6 +181,8 @@ typedef struct
     uint32_t         image_index; //next swapchain image index
     bool             validation_enabled;
 
+    vulkan_upload_batch_t upload_batch;
+
     struct bulk_data_vulkan_texture_t *textures;
     struct bulk_data_vulkan_buffer_t  *buffers;
 }vulkan_context_t;
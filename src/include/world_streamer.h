@@ -0,0 +1,69 @@
+#ifndef WORLD_STREAMER_H_
+#define WORLD_STREAMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <generator.h>
+#include <containers.h>
+#include <jobs.h>
+
+//! @brief chunk size in tiles, odd so the border is closed and seam doors line up with odd cells
+#define WORLD_CHUNK_SIZE 63
+
+typedef enum
+{
+    CHUNK_STATE_FREE,
+    CHUNK_STATE_GENERATING,
+    CHUNK_STATE_RESIDENT,
+    CHUNK_STATE_FAILED
+} chunk_state_e;
+
+struct world_streamer_t;
+
+typedef struct
+{
+    struct world_streamer_t *world;
+    //! @brief tiles and regions point into the slot memory owned by the streamer
+    dungeon_t                dungeon;
+    void                    *scratch;
+    int32_t                  cx, cy;
+    uint64_t                 last_used;
+    //! @brief chunk_state_e, written by the job thread when generation finishes
+    atomic_uint              state;
+} world_chunk_t;
+
+typedef struct
+{
+    uint64_t seed;
+    uint32_t room_count;
+    //! @brief chunks around the player's chunk to keep resident
+    int32_t  radius;
+    //! @brief bytes for chunk slots, has to fit at least (2 * radius + 1)^2 chunks
+    uint32_t memory_budget;
+} world_config_t;
+
+typedef struct world_streamer_t
+{
+    world_config_t      config;
+    world_chunk_t      *chunks;
+    uint32_t            chunk_capacity;
+    uint8_t            *slot_memory;
+    //! @brief packed chunk coordinate -> slot index
+    index_hash_entry_t *lookup;
+    uint64_t            frame;
+    job_counter_t       jobs;
+} world_streamer_t;
+
+bool             world_streamer_init(world_streamer_t *world, const world_config_t *config);
+/**
+ * @brief: Queues generation for missing chunks around the given tile and evicts the least recently used
+ *         chunks outside of the radius when the budget is full. Never blocks on generation.
+ */
+void             world_streamer_update(world_streamer_t *world, int32_t tile_x, int32_t tile_y);
+//! @brief: NULL if the chunk isn't resident (yet)
+const dungeon_t *world_streamer_get_chunk(world_streamer_t *world, int32_t cx, int32_t cy);
+//! @brief: INVALID_TILE if the chunk isn't resident (yet)
+uint8_t          world_streamer_get_tile(world_streamer_t *world, int32_t x, int32_t y);
+void             world_streamer_shutdown(world_streamer_t *world);
+#endif
@@ -0,0 +1,808 @@
+#include "animation.h"
+
+#include <math_utils.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+float *animation_create_storage(animation_t *animation, uint32_t sampler_count, uint32_t channel_count, size_t key_count)
+{
+    //samplers hold pointers and go first, the 4 byte channels and keys follow without padding
+    size_t sampler_size = sampler_count * sizeof(animation_sampler_t);
+    size_t channel_size = channel_count * sizeof(animation_channel_t);
+    size_t size = sampler_size + channel_size + key_count * sizeof(float);
+
+    uint8_t *data = memory_alloc(size, MEM_TAG_HEAP);
+    if (!data) {
+        LOGE("Unable to allocate %zu bytes for animation", size);
+        return NULL;
+    }
+
+    animation->data          = data;
+    animation->data_size     = size;
+    animation->samplers      = (animation_sampler_t *)data;
+    animation->sampler_count = sampler_count;
+    animation->channels      = (animation_channel_t *)(data + sampler_size);
+    animation->channel_count = channel_count;
+    return (float *)(data + sampler_size + channel_size);
+}
+
+void animation_destroy(animation_t *animation)
+{
+    memory_dealloc(animation->data);
+    animation->data          = NULL;
+    animation->data_size     = 0;
+    animation->samplers      = NULL;
+    animation->sampler_count = 0;
+    animation->channels      = NULL;
+    animation->channel_count = 0;
+}
+
+static vec4f_t animation_decode_quat48(const uint16_t *key)
+{
+    uint64_t bits = ((uint64_t)key[0] << 32) | ((uint64_t)key[1] << 16) | (uint64_t)key[2];
+    uint32_t largest = (uint32_t)(bits >> 45) & 3;
+
+    float q[4];
+    float sum = 0.0f;
+    for (uint32_t i = 0, shift = 30; i < 4; i++) {
+        if (i == largest) continue;
+        float v = (float)((bits >> shift) & 0x7fff) * (1.0f / 32767.0f);
+        q[i] = (v * 2.0f - 1.0f) * ANIMATION_QUAT48_RANGE;
+        sum += q[i] * q[i];
+        shift -= 15;
+    }
+    q[largest] = sqrtf(MAX(1.0f - sum, 0.0f));
+    return (vec4f_t){q[0], q[1], q[2], q[3]};
+}
+
+vec4f_t animation_sampler_get_output(const animation_sampler_t *sampler, uint32_t key)
+{
+    assert(sampler->components <= 4);
+    vec4f_t result = {0};
+
+    switch (sampler->format)
+    {
+        case ANIMATION_KEY_FORMAT_FLOAT:
+        {
+            const float *src = (const float *)sampler->outputs + (size_t)key * sampler->components;
+            memcpy(&result, src, sampler->components * sizeof(float));
+            break;
+        }
+        case ANIMATION_KEY_FORMAT_QUAT48:
+        {
+            result = animation_decode_quat48((const uint16_t *)sampler->outputs + (size_t)key * 3);
+            break;
+        }
+        case ANIMATION_KEY_FORMAT_RANGE16:
+        {
+            const uint16_t *src = (const uint16_t *)sampler->outputs + (size_t)key * sampler->components;
+            const float *min    = &sampler->range_min.x;
+            const float *extent = &sampler->range_extent.x;
+            float *dst          = &result.x;
+            for (uint32_t i = 0; i < sampler->components; i++) {
+                dst[i] = min[i] + extent[i] * ((float)src[i] * (1.0f / 65535.0f));
+            }
+            break;
+        }
+        default:
+            assert(false && "unknown animation key format");
+            break;
+    }
+    return result;
+}
+
+uint32_t animation_sampler_find_key(const animation_sampler_t *sampler, float time, uint32_t *cursor)
+{
+    const float *inputs = sampler->inputs;
+
+    if (sampler->input_count < 2 || time <= inputs[0]) {
+        *cursor = 0;
+        return 0;
+    }
+
+    uint32_t last = sampler->input_count - 1;
+    if (time >= inputs[last]) {
+        *cursor = last;
+        return last;
+    }
+
+    //playback: time moved forward by a tick, the key is at or just after the cursor
+    uint32_t key = *cursor;
+    if (key < last && inputs[key] <= time) {
+        for (uint32_t step = 0; step < ANIMATION_CURSOR_MAX_STEPS; step++) {
+            if (time < inputs[key + 1]) {
+                *cursor = key;
+                return key;
+            }
+            key++;
+        }
+    }
+
+    //seek or loop: inputs[low] <= time < inputs[high]
+    uint32_t low  = 0;
+    uint32_t high = last;
+    while (high - low > 1) {
+        uint32_t mid = low + (high - low) / 2;
+        if (inputs[mid] <= time) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+    *cursor = low;
+    return low;
+}
+
+static uint32_t animation_accessor_components(uint32_t type)
+{
+    switch (type)
+    {
+        case SCALAR: return 1;
+        case VEC2:   return 2;
+        case VEC3:   return 3;
+        case VEC4:   return 4;
+        default:     return 0;
+    }
+}
+
+static const float *animation_accessor_floats(gltf_model_t *gltf_model, uint32_t index)
+{
+    gltf_accessor_t *accessor = &gltf_model->accessors[index];
+    gltf_buffer_view_t *bv    = &gltf_model->buffer_views[accessor->buffer_view];
+    gltf_buffer_t *buffer     = &gltf_model->buffers[bv->buffer];
+    assert(accessor->component_type == FLOAT && "animation accessor is not float");
+    return (const float *)&buffer->data[accessor->byte_offset + bv->byte_offset];
+}
+
+bool animation_create_from_gltf(animation_t *animation, gltf_model_t *gltf_model, uint32_t index, const uint32_t *node_remap)
+{
+    gltf_animation_t *gltf_animation = &gltf_model->animations[index];
+
+    //first input accessor seen and where its times go in the key block, one entry per sampler
+    uint32_t *input_accessors = memory_alloc(gltf_animation->sampler_count * sizeof(uint32_t), MEM_TAG_TEMP);
+    size_t   *input_offsets   = memory_alloc(gltf_animation->sampler_count * sizeof(size_t), MEM_TAG_TEMP);
+    uint32_t  input_count     = 0;
+
+    //size the key block, shared times first then the outputs
+    size_t input_key_count  = 0;
+    size_t output_key_count = 0;
+    for (uint32_t j = 0; j < gltf_animation->sampler_count; j++) {
+        gltf_animation_sampler_t *gltf_sampler = &gltf_animation->samplers[j];
+
+        bool shared = false;
+        for (uint32_t k = 0; k < input_count && !shared; k++) {
+            shared = input_accessors[k] == gltf_sampler->input;
+        }
+        if (!shared) {
+            input_accessors[input_count] = gltf_sampler->input;
+            input_offsets[input_count++] = input_key_count;
+            input_key_count += gltf_model->accessors[gltf_sampler->input].count;
+        }
+
+        gltf_accessor_t *output = &gltf_model->accessors[gltf_sampler->output];
+        output_key_count += (size_t)output->count * animation_accessor_components(output->type);
+    }
+
+    size_t key_count = input_key_count + output_key_count;
+    float *keys = animation_create_storage(animation, gltf_animation->sampler_count, gltf_animation->channel_count, key_count);
+    if (!keys) {
+        return false;
+    }
+
+    animation->start_time = INFINITY;
+    animation->end_time = -INFINITY;
+
+    //sampler keyframe and input time values
+    for (uint32_t k = 0; k < input_count; k++) {
+        gltf_accessor_t *accessor = &gltf_model->accessors[input_accessors[k]];
+        float *dst = &keys[input_offsets[k]];
+        memcpy(dst, animation_accessor_floats(gltf_model, input_accessors[k]), accessor->count * sizeof(float));
+
+        for (uint32_t key = 0; key < accessor->count; key++) {
+            animation->start_time = MIN(animation->start_time, dst[key]);
+            animation->end_time   = MAX(animation->end_time, dst[key]);
+        }
+    }
+    size_t output_offset = input_key_count;
+
+    for (uint32_t j = 0; j < animation->sampler_count; j++) {
+        gltf_animation_sampler_t *gltf_sampler = &gltf_animation->samplers[j];
+        animation_sampler_t *sampler = &animation->samplers[j];
+
+        sampler->interpolation = gltf_sampler->interpolation;
+        sampler->format        = ANIMATION_KEY_FORMAT_FLOAT;
+
+        for (uint32_t k = 0; k < input_count; k++) {
+            if (input_accessors[k] == gltf_sampler->input) {
+                sampler->inputs = &keys[input_offsets[k]];
+                break;
+            }
+        }
+        sampler->input_count = gltf_model->accessors[gltf_sampler->input].count;
+
+        //read sampler keyframe output translate/rotate/scale values
+        gltf_accessor_t *accessor = &gltf_model->accessors[gltf_sampler->output];
+        sampler->components   = animation_accessor_components(accessor->type);
+        sampler->output_count = accessor->count;
+
+        float *dst = &keys[output_offset];
+        size_t float_count = (size_t)accessor->count * sampler->components;
+        memcpy(dst, animation_accessor_floats(gltf_model, gltf_sampler->output), float_count * sizeof(float));
+        sampler->outputs = dst;
+        output_offset += float_count;
+    }
+    assert(output_offset == key_count);
+
+    //channels, the ones for nodes the remap does not know are dropped
+    uint32_t channel_count = 0;
+    for (uint32_t k = 0; k < gltf_animation->channel_count; k++) {
+        gltf_channel_t *gltf_channel = &gltf_animation->channels[k];
+        uint32_t node = node_remap ? node_remap[gltf_channel->node] : gltf_channel->node;
+        if (node == UINT32_MAX) continue;
+
+        animation_channel_t *channel = &animation->channels[channel_count++];
+        channel->path    = gltf_channel->path;
+        channel->sampler = gltf_channel->sampler;
+        channel->node    = node;
+    }
+    animation->channel_count = channel_count;
+    return true;
+}
+
+vec4f_t animation_sampler_evaluate(const animation_sampler_t *sampler, uint32_t path, float time, uint32_t *cursor)
+{
+    uint32_t key  = animation_sampler_find_key(sampler, time, cursor);
+    uint32_t next = key + 1 < sampler->input_count ? key + 1 : key;
+    bool cubic    = sampler->interpolation == CUBIC_SPLINE_INTERPOLATION;
+
+    //cubic spline keys are in tangent, value, out tangent
+    vec4f_t a = animation_sampler_get_output(sampler, cubic ? key * 3 + 1 : key);
+    if (next == key || sampler->interpolation == STEP_INTERPOLATION) return a;
+
+    float dt = sampler->inputs[next] - sampler->inputs[key];
+    float t  = (time - sampler->inputs[key]) / dt;
+    if (t <= 0.0f) return a;
+
+    vec4f_t b = animation_sampler_get_output(sampler, cubic ? next * 3 + 1 : next);
+    vec4f_t result;
+
+    if (cubic) {
+        //hermite, tangents are per second so they scale with the key interval
+        vec4f_t out_tangent = animation_sampler_get_output(sampler, key * 3 + 2);
+        vec4f_t in_tangent  = animation_sampler_get_output(sampler, next * 3);
+
+        float t2  = t * t;
+        float t3  = t2 * t;
+        float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+        float h10 = (t3 - 2.0f * t2 + t) * dt;
+        float h01 = -2.0f * t3 + 3.0f * t2;
+        float h11 = (t3 - t2) * dt;
+
+        result.x = h00 * a.x + h10 * out_tangent.x + h01 * b.x + h11 * in_tangent.x;
+        result.y = h00 * a.y + h10 * out_tangent.y + h01 * b.y + h11 * in_tangent.y;
+        result.z = h00 * a.z + h10 * out_tangent.z + h01 * b.z + h11 * in_tangent.z;
+        result.w = h00 * a.w + h10 * out_tangent.w + h01 * b.w + h11 * in_tangent.w;
+        if (path == ROTATION) {
+            result = vec4_normalize(result);
+        }
+    } else if (path == ROTATION) {
+        quat_t q1 = {.x = a.x, .y = a.y, .z = a.z, .w = a.w};
+        quat_t q2 = {.x = b.x, .y = b.y, .z = b.z, .w = b.w};
+        quat_t q  = quat_normalize(quat_slerp(q1, q2, t));
+        result = (vec4f_t){q.x, q.y, q.z, q.w};
+    } else {
+        result = vec4_lerp(a, b, t);
+    }
+    return result;
+}
+
+void animation_sample(const animation_t *animation, float time, uint32_t *cursors, animation_pose_t *pose)
+{
+    animation_sample_nodes(animation, time, cursors, NULL, pose);
+}
+
+void animation_sample_nodes(const animation_t *animation, float time, uint32_t *cursors, const bool *skip_nodes, animation_pose_t *pose)
+{
+    for (uint32_t i = 0; i < animation->channel_count; i++) {
+        const animation_channel_t *channel = &animation->channels[i];
+        const animation_sampler_t *sampler = &animation->samplers[channel->sampler];
+        uint32_t node = channel->node;
+
+        if (sampler->input_count == 0 || channel->path == WEIGHTS) continue;
+        //the cursor goes stale, the next sample after the node is back finds its key with a binary search
+        if (skip_nodes && skip_nodes[node]) continue;
+
+        vec4f_t value = animation_sampler_evaluate(sampler, channel->path, time, &cursors[i]);
+
+        if (channel->path == TRANSLATION) {
+            pose->translations[node] = (vec3f_t){value.x, value.y, value.z};
+        } else if (channel->path == ROTATION) {
+            pose->rotations[node] = (quat_t){.x = value.x, .y = value.y, .z = value.z, .w = value.w};
+        } else if (channel->path == SCALE) {
+            pose->scales[node] = (vec3f_t){value.x, value.y, value.z};
+        }
+    }
+}
+
+void animation_pose_set_rest(animation_pose_t *pose, const skeleton_t *skeleton)
+{
+    for (uint32_t i = 0; i < skeleton->node_count; i++) {
+        const model_node_t *node = &skeleton->nodes[i];
+        pose->translations[i] = node->translation;
+        pose->rotations[i]    = node->rotation;
+        pose->scales[i]       = node->scale;
+    }
+}
+
+void animation_pose_blend(animation_pose_t *out, 
+                          const animation_pose_t *a, 
+                          const animation_pose_t *b, 
+                          const float *weights, 
+                          uint32_t node_count)
+{
+    //vec3f_t is three packed floats, so translations and scales are lerped as one flat float array each
+    const float *ta = (const float *)a->translations;
+    const float *tb = (const float *)b->translations;
+    const float *sa = (const float *)a->scales;
+    const float *sb = (const float *)b->scales;
+    float *to = (float *)out->translations;
+    float *so = (float *)out->scales;
+
+    for (uint32_t i = 0; i < node_count; i++) {
+        float w = weights[i];
+        for (uint32_t j = 0; j < 3; j++) {
+            uint32_t k = i * 3 + j;
+            to[k] = ta[k] + (tb[k] - ta[k]) * w;
+            so[k] = sa[k] + (sb[k] - sa[k]) * w;
+        }
+    }
+    quat_nlerp_n(a->rotations, b->rotations, weights, out->rotations, node_count);
+}
+
+void animation_pose_add(animation_pose_t *out,
+                        const animation_pose_t *additive,
+                        const animation_pose_t *reference,
+                        const float *weights,
+                        uint32_t node_count)
+{
+    const float *ta = (const float *)additive->translations;
+    const float *tr = (const float *)reference->translations;
+    const float *sa = (const float *)additive->scales;
+    const float *sr = (const float *)reference->scales;
+    float *to = (float *)out->translations;
+    float *so = (float *)out->scales;
+
+    for (uint32_t i = 0; i < node_count; i++) {
+        float w = weights[i];
+        for (uint32_t j = 0; j < 3; j++) {
+            uint32_t k = i * 3 + j;
+            to[k] += (ta[k] - tr[k]) * w;
+            //scales add as ratios, a zero reference scale contributes nothing
+            float ratio = sr[k] != 0.0f ? sa[k] / sr[k] : 1.0f;
+            so[k] *= 1.0f + (ratio - 1.0f) * w;
+        }
+    }
+
+    //delta = conjugate(reference) * additive, weighted against identity in one batch and composed after out
+    quat_t identity[MAX_NODES_PER_MODEL] = {0};
+    quat_t deltas[MAX_NODES_PER_MODEL] = {0};
+    for (uint32_t i = 0; i < node_count; i++) {
+        quat_t r = reference->rotations[i];
+        quat_t q = additive->rotations[i];
+        identity[i] = (quat_t){.w = 1.0f};
+        deltas[i].w = r.w * q.w + r.x * q.x + r.y * q.y + r.z * q.z;
+        deltas[i].x = r.w * q.x - r.x * q.w - r.y * q.z + r.z * q.y;
+        deltas[i].y = r.w * q.y + r.x * q.z - r.y * q.w - r.z * q.x;
+        deltas[i].z = r.w * q.z - r.x * q.y + r.y * q.x - r.z * q.w;
+    }
+    quat_nlerp_n(identity, deltas, weights, deltas, node_count);
+    //the product of unit quaternions stays unit
+    for (uint32_t i = 0; i < node_count; i++) {
+        quat_t r = out->rotations[i];
+        quat_t d = deltas[i];
+        out->rotations[i].w = r.w * d.w - r.x * d.x - r.y * d.y - r.z * d.z;
+        out->rotations[i].x = r.w * d.x + r.x * d.w + r.y * d.z - r.z * d.y;
+        out->rotations[i].y = r.w * d.y - r.x * d.z + r.y * d.w + r.z * d.x;
+        out->rotations[i].z = r.w * d.z + r.x * d.y - r.y * d.x + r.z * d.w;
+    }
+}
+
+void animation_compute_global_matrices(const skeleton_t *skeleton, const animation_pose_t *pose, affine3x4_t *global_matrices)
+{
+    affine3x4_t identity = affine_identity();
+
+    for (uint32_t i = 0; i < skeleton->node_count; i++) {
+        const model_node_t *node = &skeleton->nodes[i];
+        affine3x4_t local;
+
+        affine_from_TRS(&local, pose->translations[i], pose->rotations[i], pose->scales[i]);
+        //gltf nodes carry either a matrix or TRS
+        if (memcmp(&node->local_transform, &identity, sizeof(identity)) != 0) {
+            affine_multiply(&node->local_transform, &local, &local);
+        }
+
+        if (node->parent == UINT32_MAX) {
+            global_matrices[i] = local;
+        } else {
+            assert(node->parent < i);
+            affine_multiply(&local, &global_matrices[node->parent], &global_matrices[i]);
+        }
+    }
+}
+
+void animation_compute_palette(const skeleton_t *skeleton, uint32_t mesh_node, const affine3x4_t *global_matrices, affine3x4_t *palette)
+{
+    const skin_t *skin = &skeleton->skin;
+    uint32_t joint_count = skin->joint_count;
+
+    affine3x4_t inverse_transform;
+    affine_inverse(&global_matrices[mesh_node], &inverse_transform);
+
+    //palette may be a mapped, write combined buffer. It is built in blocks on the stack and written once in order,
+    //never read back
+    affine3x4_t block[ANIMATION_PALETTE_BLOCK];
+    for (uint32_t first = 0; first < joint_count; first += ANIMATION_PALETTE_BLOCK) {
+        uint32_t count = MIN(ANIMATION_PALETTE_BLOCK, joint_count - first);
+        for (uint32_t i = 0; i < count; i++) {
+            block[i] = global_matrices[skin->joints[first + i]];
+        }
+        affine_multiply_n(&skin->inverse_bind_matrices[first], block, block, count);
+        for (uint32_t i = 0; i < count; i++) {
+            affine_multiply(&block[i], &inverse_transform, &block[i]);
+        }
+        memcpy(&palette[first], block, count * sizeof(affine3x4_t));
+    }
+}
+
+void animation_write_palette(const affine3x4_t *joints, uint32_t joint_count, mat4f_t *palette)
+{
+    //the compiled skinning shader still declares a mat4 array, expand until it reads mat3x4
+    mat4f_t block[ANIMATION_PALETTE_BLOCK];
+    for (uint32_t first = 0; first < joint_count; first += ANIMATION_PALETTE_BLOCK) {
+        uint32_t count = MIN(ANIMATION_PALETTE_BLOCK, joint_count - first);
+        for (uint32_t i = 0; i < count; i++) {
+            affine_to_mat4(&joints[first + i], &block[i]);
+        }
+        memcpy(&palette[first], block, count * sizeof(mat4f_t));
+    }
+}
+
+bool animation_bake(animation_baked_clip_t *baked, const skeleton_t *skeleton, uint32_t mesh_node, uint32_t animation, float sample_rate)
+{
+    assert(animation < skeleton->animation_count && sample_rate > 0.0f);
+    const animation_t *clip = &skeleton->animations[animation];
+    uint32_t joint_count = skeleton->skin.joint_count;
+
+    //a frame on both ends, the last one is the end pose the loop wraps from
+    memset(baked, 0, sizeof(*baked));
+    baked->frame_count = (uint32_t)ceilf((clip->end_time - clip->start_time) * sample_rate) + 1;
+    baked->joint_count = joint_count;
+    baked->sample_rate = sample_rate;
+    baked->start_time  = clip->start_time;
+
+    baked->palettes = memory_alloc((size_t)baked->frame_count * (joint_count + 1) * sizeof(affine3x4_t), MEM_TAG_HEAP);
+    if (!baked->palettes) {
+        LOGE("Unable to allocate %u baked frames", baked->frame_count);
+        return false;
+    }
+    baked->mesh_transforms = baked->palettes + (size_t)baked->frame_count * joint_count;
+
+    uint32_t cursors[MAX_ANIMATION_CHANNEL_COUNT] = {0};
+    animation_pose_t pose;
+    affine3x4_t global_matrices[MAX_NODES_PER_MODEL];
+    for (uint32_t i = 0; i < baked->frame_count; i++) {
+        float time = MIN(clip->start_time + (float)i / sample_rate, clip->end_time);
+        animation_pose_set_rest(&pose, skeleton);
+        animation_sample(clip, time, cursors, &pose);
+        animation_compute_global_matrices(skeleton, &pose, global_matrices);
+        animation_compute_palette(skeleton, mesh_node, global_matrices, &baked->palettes[(size_t)i * joint_count]);
+        baked->mesh_transforms[i] = global_matrices[mesh_node];
+    }
+    return true;
+}
+
+void animation_baked_clip_destroy(animation_baked_clip_t *baked)
+{
+    if (baked->palettes) memory_dealloc(baked->palettes);
+    memset(baked, 0, sizeof(*baked));
+}
+
+void animation_baked_sample(const animation_baked_clip_t *baked, float time, bool interpolate, affine3x4_t *palette, affine3x4_t *mesh_transform)
+{
+    float frame = MAX(time - baked->start_time, 0.0f) * baked->sample_rate;
+    uint32_t last = baked->frame_count - 1;
+    uint32_t joint_count = baked->joint_count;
+
+    if (!interpolate) {
+        uint32_t i = MIN((uint32_t)(frame + 0.5f), last);
+        memcpy(palette, &baked->palettes[(size_t)i * joint_count], joint_count * sizeof(affine3x4_t));
+        *mesh_transform = baked->mesh_transforms[i];
+        return;
+    }
+
+    //component wise, the frames are close enough for the blend to stay near rigid
+    uint32_t i0 = MIN((uint32_t)frame, last);
+    uint32_t i1 = MIN(i0 + 1, last);
+    float t = MIN(frame - (float)i0, 1.0f);
+    const float *a = (const float *)&baked->palettes[(size_t)i0 * joint_count];
+    const float *b = (const float *)&baked->palettes[(size_t)i1 * joint_count];
+    float *out = (float *)palette;
+    for (uint32_t i = 0; i < joint_count * 12; i++) {
+        out[i] = a[i] + (b[i] - a[i]) * t;
+    }
+    const float *ma = (const float *)&baked->mesh_transforms[i0];
+    const float *mb = (const float *)&baked->mesh_transforms[i1];
+    float *mo = (float *)mesh_transform;
+    for (uint32_t i = 0; i < 12; i++) {
+        mo[i] = ma[i] + (mb[i] - ma[i]) * t;
+    }
+}
+
+static void animation_playback_start(animation_playback_t *playback, const skeleton_t *skeleton, uint32_t animation)
+{
+    playback->animation = animation;
+    playback->time      = animation == UINT32_MAX ? 0.0f : skeleton->animations[animation].start_time;
+    memset(playback->cursors, 0, sizeof(playback->cursors));
+}
+
+static void animation_playback_advance(animation_playback_t *playback, const skeleton_t *skeleton, float dt)
+{
+    const animation_t *animation = &skeleton->animations[playback->animation];
+    playback->time += dt;
+    //!NOTE: looping, a LOD step may span several loops of a short clip
+    if (playback->time >= animation->end_time) {
+        float length   = animation->end_time - animation->start_time;
+        playback->time = length > 0.0f ? animation->start_time + fmodf(playback->time - animation->start_time, length) :
+                                         animation->start_time;
+    }
+}
+
+//! @brief: the pose of the layer's clips on top of base, cross-faded while a transition is running
+static void animation_layer_sample(animation_layer_t *layer, 
+                                   const skeleton_t *skeleton, 
+                                   const bool *skip_nodes,
+                                   const animation_pose_t *base, 
+                                   animation_pose_t *out)
+{
+    animation_playback_t *current  = &layer->playbacks[layer->current];
+    animation_playback_t *previous = &layer->playbacks[layer->current ^ 1];
+
+    *out = *base;
+    animation_sample_nodes(&skeleton->animations[current->animation], current->time, current->cursors, skip_nodes, out);
+
+    if (previous->animation == UINT32_MAX) return;
+
+    animation_pose_t from = *base;
+    animation_sample_nodes(&skeleton->animations[previous->animation], previous->time, previous->cursors, skip_nodes, &from);
+
+    float fade[MAX_NODES_PER_MODEL];
+    float t = layer->fade_time / layer->fade_duration;
+    for (uint32_t i = 0; i < skeleton->node_count; i++) {
+        fade[i] = t;
+    }
+    animation_pose_blend(out, &from, out, fade, skeleton->node_count);
+}
+
+//! @brief: pose of an additive clip at its first key, the clip's deltas are taken against it
+static void animation_sample_reference(const animation_t *animation, const bool *skip_nodes, const animation_pose_t *base, animation_pose_t *out)
+{
+    uint32_t cursors[MAX_ANIMATION_CHANNEL_COUNT] = {0};
+    *out = *base;
+    animation_sample_nodes(animation, animation->start_time, cursors, skip_nodes, out);
+}
+
+static void animation_layer_apply(animation_layer_t *layer, const skeleton_t *skeleton, const bool *skip_nodes, animation_pose_t *pose)
+{
+    uint32_t node_count = skeleton->node_count;
+    float weights[MAX_NODES_PER_MODEL];
+    for (uint32_t i = 0; i < node_count; i++) {
+        weights[i] = layer->weight * layer->node_weights[i];
+    }
+
+    animation_pose_t sample;
+    if (layer->mode == ANIMATION_BLEND_OVERRIDE) {
+        animation_layer_sample(layer, skeleton, skip_nodes, pose, &sample);
+        animation_pose_blend(pose, pose, &sample, weights, node_count);
+        return;
+    }
+
+    //additive clips are sampled over the rest pose, the current and the fading clip add in proportion to the fade
+    animation_pose_t rest;
+    animation_pose_t reference;
+    animation_pose_set_rest(&rest, skeleton);
+
+    float fade = 1.0f;
+    animation_playback_t *previous = &layer->playbacks[layer->current ^ 1];
+    if (previous->animation != UINT32_MAX) {
+        fade = layer->fade_time / layer->fade_duration;
+        for (uint32_t i = 0; i < node_count; i++) {
+            weights[i] *= 1.0f - fade;
+        }
+        sample = rest;
+        animation_sample_nodes(&skeleton->animations[previous->animation], previous->time, previous->cursors, skip_nodes, &sample);
+        animation_sample_reference(&skeleton->animations[previous->animation], skip_nodes, &rest, &reference);
+        animation_pose_add(pose, &sample, &reference, weights, node_count);
+        for (uint32_t i = 0; i < node_count; i++) {
+            weights[i] = layer->weight * layer->node_weights[i] * fade;
+        }
+    }
+
+    animation_playback_t *current = &layer->playbacks[layer->current];
+    sample = rest;
+    animation_sample_nodes(&skeleton->animations[current->animation], current->time, current->cursors, skip_nodes, &sample);
+    animation_sample_reference(&skeleton->animations[current->animation], skip_nodes, &rest, &reference);
+    animation_pose_add(pose, &sample, &reference, weights, node_count);
+}
+
+void animated_instance_init(animated_instance_t *instance, const skinned_model_t *model, uint32_t model_index, const skeleton_t *skeleton)
+{
+    memset(instance, 0, sizeof(*instance));
+    instance->model    = model_index;
+    instance->skeleton = model->skeleton;
+    instance->state    = UINT32_MAX;
+    instance->pose_version = 1;
+    instance->rest_pose    = true;
+    instance->baked_clip   = UINT32_MAX;
+    instance->ssbo         = UINT32_MAX;
+
+    for (uint32_t i = 0; i < MAX_ANIMATION_STATES; i++) {
+        instance->state_animations[i] = UINT32_MAX;
+    }
+    for (uint32_t i = 0; i < MAX_ANIMATION_LAYERS; i++) {
+        animation_layer_t *layer = &instance->layers[i];
+        layer->playbacks[0].animation = UINT32_MAX;
+        layer->playbacks[1].animation = UINT32_MAX;
+    }
+    //the base layer covers the whole skeleton, the others are off until animated_instance_set_layer
+    animated_instance_set_layer(instance, skeleton, 0, ANIMATION_BLEND_OVERRIDE, 1.0f, UINT32_MAX);
+
+    animation_pose_set_rest(&instance->pose, skeleton);
+    animation_compute_global_matrices(skeleton, &instance->pose, instance->global_matrices);
+}
+
+void animated_instance_set_layer(animated_instance_t *instance, 
+                                 const skeleton_t *skeleton, 
+                                 uint32_t layer_index, 
+                                 animation_blend_mode_e mode, 
+                                 float weight, 
+                                 uint32_t mask_root)
+{
+    assert(layer_index < MAX_ANIMATION_LAYERS);
+    animation_layer_t *layer = &instance->layers[layer_index];
+    layer->mode   = mode;
+    layer->weight = weight;
+
+    //parents come before their children, so a node is in the mask when its parent is
+    for (uint32_t i = 0; i < skeleton->node_count; i++) {
+        uint32_t parent = skeleton->nodes[i].parent;
+        bool inside = mask_root == UINT32_MAX || i == mask_root || (parent != UINT32_MAX && layer->node_weights[parent] > 0.0f);
+        layer->node_weights[i] = inside ? 1.0f : 0.0f;
+    }
+}
+
+void animated_instance_play(animated_instance_t *instance, const skeleton_t *skeleton, uint32_t layer_index, uint32_t animation, float fade_duration)
+{
+    assert(layer_index < MAX_ANIMATION_LAYERS);
+    if (animation >= skeleton->animation_count) {
+        LOGE("No animation with index %u", animation);
+        return;
+    }
+    assert(skeleton->animations[animation].channel_count <= MAX_ANIMATION_CHANNEL_COUNT);
+
+    animation_layer_t *layer = &instance->layers[layer_index];
+    animation_playback_t *current = &layer->playbacks[layer->current];
+    instance->baked_clip = UINT32_MAX;
+
+    //the playing clip becomes the one faded from, an unfinished fade is cut short
+    if (fade_duration > 0.0f && current->animation != UINT32_MAX && current->animation != animation) {
+        layer->current ^= 1;
+        layer->fade_time     = 0.0f;
+        layer->fade_duration = fade_duration;
+    } else {
+        layer->playbacks[layer->current ^ 1].animation = UINT32_MAX;
+    }
+    animation_playback_start(&layer->playbacks[layer->current], skeleton, animation);
+}
+
+void animated_instance_play_baked(animated_instance_t *instance, 
+                                  const skinned_model_t *model, 
+                                  const skeleton_t *skeleton, 
+                                  uint32_t animation, 
+                                  bool interpolate)
+{
+    if (animation >= model->baked_clip_count || !model->baked_clips[animation].palettes) {
+        LOGE("No baked animation with index %u", animation);
+        return;
+    }
+    for (uint32_t i = 1; i < MAX_ANIMATION_LAYERS; i++) {
+        animated_instance_stop(instance, i);
+    }
+    animation_layer_t *layer = &instance->layers[0];
+    layer->playbacks[layer->current ^ 1].animation = UINT32_MAX;
+    animation_playback_start(&layer->playbacks[layer->current], skeleton, animation);
+
+    instance->baked_clip        = animation;
+    instance->baked_interpolate = interpolate;
+    instance->rest_pose         = false;
+    instance->pose_version++;
+}
+
+void animated_instance_stop(animated_instance_t *instance, uint32_t layer_index)
+{
+    assert(layer_index < MAX_ANIMATION_LAYERS);
+    animation_layer_t *layer = &instance->layers[layer_index];
+    layer->playbacks[0].animation = UINT32_MAX;
+    layer->playbacks[1].animation = UINT32_MAX;
+}
+
+void animated_instance_map_state(animated_instance_t *instance, uint32_t state, uint32_t animation, float fade_duration)
+{
+    assert(state < MAX_ANIMATION_STATES);
+    instance->state_animations[state]     = animation;
+    instance->state_fade_durations[state] = fade_duration;
+}
+
+void animated_instance_set_state(animated_instance_t *instance, const skeleton_t *skeleton, uint32_t state)
+{
+    if (state == instance->state) return;
+    instance->state = state;
+
+    if (state < MAX_ANIMATION_STATES && instance->state_animations[state] != UINT32_MAX) {
+        animated_instance_play(instance, skeleton, 0, instance->state_animations[state], instance->state_fade_durations[state]);
+    }
+}
+
+void animated_instance_update(animated_instance_t *instance, const skeleton_t *skeleton, float dt)
+{
+    //a baked clip only moves its time, the palette is looked up when it is written
+    if (instance->baked_clip != UINT32_MAX) {
+        animation_layer_t *layer = &instance->layers[0];
+        animation_playback_advance(&layer->playbacks[layer->current], skeleton, dt);
+        instance->pose_version++;
+        return;
+    }
+
+    const bool *skip_nodes = instance->skip_leaf_nodes ? skeleton->leaf_nodes : NULL;
+
+    bool playing = false;
+    for (uint32_t i = 0; i < MAX_ANIMATION_LAYERS; i++) {
+        const animation_layer_t *layer = &instance->layers[i];
+        playing |= layer->playbacks[layer->current].animation != UINT32_MAX;
+    }
+    if (!playing && instance->rest_pose) return;
+    instance->rest_pose = !playing;
+    instance->pose_version++;
+
+    animation_pose_set_rest(&instance->pose, skeleton);
+
+    for (uint32_t i = 0; i < MAX_ANIMATION_LAYERS; i++) {
+        animation_layer_t *layer = &instance->layers[i];
+        animation_playback_t *current  = &layer->playbacks[layer->current];
+        animation_playback_t *previous = &layer->playbacks[layer->current ^ 1];
+        if (current->animation == UINT32_MAX) continue;
+
+        animation_playback_advance(current, skeleton, dt);
+        if (previous->animation != UINT32_MAX) {
+            layer->fade_time += dt;
+            if (layer->fade_time >= layer->fade_duration) {
+                previous->animation = UINT32_MAX;
+            } else {
+                animation_playback_advance(previous, skeleton, dt);
+            }
+        }
+
+        if (layer->weight > 0.0f) {
+            animation_layer_apply(layer, skeleton, skip_nodes, &instance->pose);
+        }
+    }
+    animation_compute_global_matrices(skeleton, &instance->pose, instance->global_matrices);
+}
+
+const affine3x4_t *animated_instance_get_node_transform(const animated_instance_t *instance, uint32_t node)
+{
+    assert(node < MAX_NODES_PER_MODEL);
+    return &instance->global_matrices[node];
+}
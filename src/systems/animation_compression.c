@@ -0,0 +1,503 @@
+#include "animation_compression.h"
+
+#include <animation.h>
+#include <math_utils.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+//! @brief: the source keys of one sampler while it is refitted
+typedef struct
+{
+    const animation_sampler_t *source;
+    uint32_t     path;
+    float        tolerance;
+
+    const float *times;
+    uint32_t     key_count;
+    //! @brief one value per key, rotations are flipped onto the hemisphere of the previous key
+    vec4f_t     *values;
+    //! @brief per second, only used by cubic spline fits
+    vec4f_t     *in_tangents;
+    vec4f_t     *out_tangents;
+} animation_fit_t;
+
+//! @brief: one sampler of the compressed clip before it is packed into the clip block
+typedef struct
+{
+    uint32_t  interpolation;
+    uint32_t  components;
+    uint32_t  format;
+    vec4f_t   range_min;
+    vec4f_t   range_extent;
+
+    float    *times;
+    uint32_t  key_count;
+    //! @brief key_count values, three per key for cubic splines
+    vec4f_t  *values;
+    uint32_t  value_count;
+
+    //! @brief offsets into the clip block, in floats for times and in the units of the format for outputs
+    size_t    time_offset;
+    size_t    output_offset;
+} animation_track_t;
+
+animation_compression_config_t animation_compression_default_config(void)
+{
+    animation_compression_config_t config = {0};
+    config.enabled               = true;
+    config.quantize              = true;
+    config.allow_cubic           = true;
+    config.rotation_tolerance    = 0.001f;
+    config.translation_tolerance = 0.01f;
+    config.scale_tolerance       = 0.001f;
+    return config;
+}
+
+static float animation_value_error(uint32_t path, vec4f_t a, vec4f_t b)
+{
+    if (path == ROTATION) {
+        a = vec4_normalize(a);
+        b = vec4_normalize(b);
+        if (a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w < 0.0f) {
+            b = (vec4f_t){-b.x, -b.y, -b.z, -b.w};
+        }
+        //angle of the rotation between a and b, atan2 keeps precision near zero where acos does not
+        vec4f_t d = {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+        vec4f_t s = {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+        float dl = sqrtf(d.x * d.x + d.y * d.y + d.z * d.z + d.w * d.w);
+        float sl = sqrtf(s.x * s.x + s.y * s.y + s.z * s.z + s.w * s.w);
+        return 4.0f * atan2f(dl, sl);
+    }
+
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    float dz = a.z - b.z;
+    return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+//! @brief: whether keys a and b alone reproduce the source at every key between them and halfway between keys
+static bool animation_fit_segment(const animation_fit_t *fit, uint32_t interpolation, uint32_t a, uint32_t b)
+{
+    bool cubic = interpolation == CUBIC_SPLINE_INTERPOLATION;
+
+    float times[2] = {fit->times[a], fit->times[b]};
+    vec4f_t values[6];
+    if (cubic) {
+        values[0] = fit->in_tangents[a];
+        values[1] = fit->values[a];
+        values[2] = fit->out_tangents[a];
+        values[3] = fit->in_tangents[b];
+        values[4] = fit->values[b];
+        values[5] = fit->out_tangents[b];
+    } else {
+        values[0] = fit->values[a];
+        values[1] = fit->values[b];
+    }
+
+    animation_sampler_t sampler = {0};
+    sampler.interpolation = interpolation;
+    sampler.components    = 4;
+    sampler.format        = ANIMATION_KEY_FORMAT_FLOAT;
+    sampler.inputs        = times;
+    sampler.input_count   = 2;
+    sampler.outputs       = values;
+    sampler.output_count  = cubic ? 6 : 2;
+
+    uint32_t source_cursor = a;
+    uint32_t fit_cursor    = 0;
+    for (uint32_t i = a; i < b; i++) {
+        float probes[2] = {fit->times[i], 0.5f * (fit->times[i] + fit->times[i + 1])};
+        for (uint32_t j = 0; j < 2; j++) {
+            vec4f_t expected = animation_sampler_evaluate(fit->source, fit->path, probes[j], &source_cursor);
+            vec4f_t actual   = animation_sampler_evaluate(&sampler, fit->path, probes[j], &fit_cursor);
+            if (animation_value_error(fit->path, expected, actual) > fit->tolerance) return false;
+        }
+    }
+    return true;
+}
+
+//! @brief: greedy, every kept key reaches as far forward as the tolerance allows.
+//          within_tolerance is false when even neighbouring keys miss, which only happens when changing interpolation
+static uint32_t animation_fit_keys(const animation_fit_t *fit, uint32_t interpolation, uint32_t *kept, bool *within_tolerance)
+{
+    uint32_t count = 0;
+    kept[count++] = 0;
+    *within_tolerance = true;
+
+    uint32_t a = 0;
+    while (a + 1 < fit->key_count) {
+        uint32_t b = a + 1;
+        if (!animation_fit_segment(fit, interpolation, a, b)) {
+            *within_tolerance = false;
+        }
+        while (b + 1 < fit->key_count && animation_fit_segment(fit, interpolation, a, b + 1)) {
+            b++;
+        }
+        kept[count++] = b;
+        a = b;
+    }
+    return count;
+}
+
+static bool animation_fit_constant(const animation_fit_t *fit)
+{
+    if (fit->key_count < 2) return true;
+    uint32_t last = fit->key_count - 1;
+    return animation_fit_segment(fit, STEP_INTERPOLATION, 0, last) &&
+           animation_value_error(fit->path, fit->values[0], fit->values[last]) <= fit->tolerance;
+}
+
+static uint32_t animation_value_bytes(uint32_t path, uint32_t components, uint32_t interpolation, bool quantize)
+{
+    if (!quantize) return components * sizeof(float);
+    if (path == ROTATION && interpolation != CUBIC_SPLINE_INTERPOLATION) return 3 * sizeof(uint16_t);
+    return components * sizeof(uint16_t);
+}
+
+static size_t animation_track_bytes(uint32_t path, uint32_t components, uint32_t interpolation, bool quantize, uint32_t key_count)
+{
+    uint32_t values_per_key = interpolation == CUBIC_SPLINE_INTERPOLATION ? 3 : 1;
+    return (size_t)key_count * (sizeof(float) + values_per_key * animation_value_bytes(path, components, interpolation, quantize));
+}
+
+//! @brief: keys of the track, the source sampler copied as is when its path is not translation, rotation or scale
+static bool animation_compress_track(const animation_sampler_t *source,
+                                     uint32_t path,
+                                     const animation_compression_config_t *config,
+                                     animation_track_t *track)
+{
+    memset(track, 0, sizeof(*track));
+    track->components = source->components;
+    track->format     = ANIMATION_KEY_FORMAT_FLOAT;
+
+    uint32_t n = source->input_count;
+    bool source_cubic = source->interpolation == CUBIC_SPLINE_INTERPOLATION;
+    bool compressible = n > 0 && (path == TRANSLATION || path == ROTATION || path == SCALE) &&
+                        (source->components == 3 || source->components == 4);
+
+    if (!compressible) {
+        track->interpolation = source->interpolation;
+        track->key_count     = n;
+        track->value_count   = source->output_count;
+        track->times         = memory_alloc(MAX(n, 1) * sizeof(float), MEM_TAG_HEAP);
+        track->values        = memory_alloc(MAX(track->value_count, 1) * sizeof(vec4f_t), MEM_TAG_HEAP);
+        memcpy(track->times, source->inputs, n * sizeof(float));
+        for (uint32_t i = 0; i < track->value_count; i++) {
+            track->values[i] = animation_sampler_get_output(source, i);
+        }
+        return true;
+    }
+
+    animation_fit_t fit = {0};
+    fit.source       = source;
+    fit.path         = path;
+    fit.times        = source->inputs;
+    fit.key_count    = n;
+    fit.tolerance    = path == ROTATION ? config->rotation_tolerance :
+                       path == TRANSLATION ? config->translation_tolerance : config->scale_tolerance;
+    fit.values       = memory_alloc(n * sizeof(vec4f_t), MEM_TAG_HEAP);
+    fit.in_tangents  = memory_alloc(n * sizeof(vec4f_t), MEM_TAG_HEAP);
+    fit.out_tangents = memory_alloc(n * sizeof(vec4f_t), MEM_TAG_HEAP);
+    uint32_t *kept   = memory_alloc(n * sizeof(uint32_t), MEM_TAG_HEAP);
+    uint32_t *cubic_kept = memory_alloc(n * sizeof(uint32_t), MEM_TAG_HEAP);
+
+    for (uint32_t i = 0; i < n; i++) {
+        fit.values[i] = animation_sampler_get_output(source, source_cubic ? i * 3 + 1 : i);
+        if (source_cubic) {
+            fit.in_tangents[i]  = animation_sampler_get_output(source, i * 3);
+            fit.out_tangents[i] = animation_sampler_get_output(source, i * 3 + 2);
+        } else if (path == ROTATION && i > 0) {
+            //the tangents below and component wise hermite need neighbouring keys on one hemisphere
+            vec4f_t p = fit.values[i - 1];
+            vec4f_t q = fit.values[i];
+            if (p.x * q.x + p.y * q.y + p.z * q.z + p.w * q.w < 0.0f) {
+                fit.values[i] = (vec4f_t){-q.x, -q.y, -q.z, -q.w};
+            }
+        }
+    }
+
+    //leave room for rounding the kept keys to 16 bits, the fit and the rounding add up
+    if (config->quantize) {
+        float rounding = 0.0f;
+        if (path == ROTATION) {
+            //half a step on every component of a unit quaternion, the angle is about twice the distance
+            rounding = 2.0f * (2.0f * ANIMATION_QUAT48_RANGE / 32767.0f);
+        } else {
+            float extent = 0.0f;
+            for (uint32_t c = 0; c < 3; c++) {
+                float lo = INFINITY;
+                float hi = -INFINITY;
+                for (uint32_t i = 0; i < n; i++) {
+                    float v = (&fit.values[i].x)[c];
+                    lo = MIN(lo, v);
+                    hi = MAX(hi, v);
+                }
+                extent = MAX(extent, hi - lo);
+            }
+            rounding = 0.5f * sqrtf(3.0f) * extent / 65535.0f;
+        }
+        fit.tolerance = MAX(fit.tolerance - rounding, 0.5f * fit.tolerance);
+    }
+
+    uint32_t interpolation = source->interpolation == STEP_INTERPOLATION ? STEP_INTERPOLATION :
+                             source_cubic ? CUBIC_SPLINE_INTERPOLATION : LINEAR_INTERPOLATION;
+    uint32_t count = 0;
+    bool within_tolerance;
+
+    if (animation_fit_constant(&fit)) {
+        interpolation = LINEAR_INTERPOLATION;
+        kept[count++] = 0;
+    } else {
+        count = animation_fit_keys(&fit, interpolation, kept, &within_tolerance);
+
+        if (interpolation == LINEAR_INTERPOLATION && config->allow_cubic) {
+            //finite difference tangents through the source keys, one sided at the ends
+            for (uint32_t i = 0; i < n; i++) {
+                uint32_t prev = i > 0 ? i - 1 : i;
+                uint32_t next = i + 1 < n ? i + 1 : i;
+                float dt = fit.times[next] - fit.times[prev];
+                float inv_dt = dt > 0.0f ? 1.0f / dt : 0.0f;
+                vec4f_t p = fit.values[prev];
+                vec4f_t q = fit.values[next];
+                vec4f_t tangent = {(q.x - p.x) * inv_dt, (q.y - p.y) * inv_dt, (q.z - p.z) * inv_dt, (q.w - p.w) * inv_dt};
+                fit.in_tangents[i]  = tangent;
+                fit.out_tangents[i] = tangent;
+            }
+
+            uint32_t cubic_count = animation_fit_keys(&fit, CUBIC_SPLINE_INTERPOLATION, cubic_kept, &within_tolerance);
+            size_t linear_bytes = animation_track_bytes(path, source->components, LINEAR_INTERPOLATION, config->quantize, count);
+            size_t cubic_bytes  = animation_track_bytes(path, source->components, CUBIC_SPLINE_INTERPOLATION, config->quantize, cubic_count);
+            if (within_tolerance && cubic_bytes < linear_bytes) {
+                interpolation = CUBIC_SPLINE_INTERPOLATION;
+                count = cubic_count;
+                memcpy(kept, cubic_kept, count * sizeof(uint32_t));
+            }
+        }
+    }
+
+    bool cubic = interpolation == CUBIC_SPLINE_INTERPOLATION;
+    track->interpolation = interpolation;
+    track->key_count     = count;
+    track->value_count   = cubic ? count * 3 : count;
+    track->times         = memory_alloc(count * sizeof(float), MEM_TAG_HEAP);
+    track->values        = memory_alloc(track->value_count * sizeof(vec4f_t), MEM_TAG_HEAP);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t key = kept[i];
+        track->times[i] = fit.times[key];
+        if (cubic) {
+            track->values[i * 3]     = fit.in_tangents[key];
+            track->values[i * 3 + 1] = fit.values[key];
+            track->values[i * 3 + 2] = fit.out_tangents[key];
+        } else {
+            track->values[i] = fit.values[key];
+        }
+    }
+
+    if (config->quantize) {
+        if (path == ROTATION && !cubic) {
+            track->format = ANIMATION_KEY_FORMAT_QUAT48;
+        } else {
+            track->format = ANIMATION_KEY_FORMAT_RANGE16;
+            float *min    = &track->range_min.x;
+            float *extent = &track->range_extent.x;
+            for (uint32_t c = 0; c < track->components; c++) {
+                float lo = INFINITY;
+                float hi = -INFINITY;
+                for (uint32_t i = 0; i < track->value_count; i++) {
+                    float v = (&track->values[i].x)[c];
+                    lo = MIN(lo, v);
+                    hi = MAX(hi, v);
+                }
+                min[c]    = lo;
+                extent[c] = hi - lo;
+            }
+        }
+    }
+
+    memory_dealloc(fit.values);
+    memory_dealloc(fit.in_tangents);
+    memory_dealloc(fit.out_tangents);
+    memory_dealloc(kept);
+    memory_dealloc(cubic_kept);
+    return true;
+}
+
+static void animation_encode_quat48(vec4f_t value, uint16_t *key)
+{
+    value = vec4_normalize(value);
+    float q[4] = {value.x, value.y, value.z, value.w};
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; i++) {
+        if (fabsf(q[i]) > fabsf(q[largest])) largest = i;
+    }
+    //q and -q are the same rotation, a positive largest component needs no sign bit
+    float sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+    uint64_t bits = (uint64_t)largest << 45;
+    for (uint32_t i = 0, shift = 30; i < 4; i++) {
+        if (i == largest) continue;
+        float v = q[i] * sign / ANIMATION_QUAT48_RANGE;
+        v = MAX(-1.0f, MIN(1.0f, v));
+        bits |= (uint64_t)lrintf((v * 0.5f + 0.5f) * 32767.0f) << shift;
+        shift -= 15;
+    }
+    key[0] = (uint16_t)(bits >> 32);
+    key[1] = (uint16_t)(bits >> 16);
+    key[2] = (uint16_t)bits;
+}
+
+static void animation_encode_range16(const animation_track_t *track, vec4f_t value, uint16_t *key)
+{
+    const float *v      = &value.x;
+    const float *min    = &track->range_min.x;
+    const float *extent = &track->range_extent.x;
+    for (uint32_t c = 0; c < track->components; c++) {
+        float t = extent[c] > 0.0f ? (v[c] - min[c]) / extent[c] : 0.0f;
+        t = MAX(0.0f, MIN(1.0f, t));
+        key[c] = (uint16_t)lrintf(t * 65535.0f);
+    }
+}
+
+bool animation_compress(const animation_t *source, const animation_compression_config_t *config, animation_t *result)
+{
+    uint32_t sampler_count = source->sampler_count;
+    animation_track_t *tracks = memory_alloc(MAX(sampler_count, 1) * sizeof(animation_track_t), MEM_TAG_HEAP);
+
+    //a sampler takes the path of the first channel that uses it
+    for (uint32_t i = 0; i < sampler_count; i++) {
+        uint32_t path = WEIGHTS;
+        for (uint32_t j = 0; j < source->channel_count; j++) {
+            if (source->channels[j].sampler == i) {
+                path = source->channels[j].path;
+                break;
+            }
+        }
+        animation_compress_track(&source->samplers[i], path, config, &tracks[i]);
+    }
+
+    //lay out the block: times, shared where the kept keys match, then float outputs, then 16 bit outputs
+    size_t float_count = 0;
+    for (uint32_t i = 0; i < sampler_count; i++) {
+        animation_track_t *track = &tracks[i];
+        track->time_offset = SIZE_MAX;
+        for (uint32_t j = 0; j < i; j++) {
+            if (tracks[j].key_count == track->key_count &&
+                memcmp(tracks[j].times, track->times, track->key_count * sizeof(float)) == 0) {
+                track->time_offset = tracks[j].time_offset;
+                break;
+            }
+        }
+        if (track->time_offset == SIZE_MAX) {
+            track->time_offset = float_count;
+            float_count += track->key_count;
+        }
+    }
+    for (uint32_t i = 0; i < sampler_count; i++) {
+        animation_track_t *track = &tracks[i];
+        if (track->format != ANIMATION_KEY_FORMAT_FLOAT) continue;
+        track->output_offset = float_count;
+        float_count += (size_t)track->value_count * track->components;
+    }
+    size_t half_count = 0;
+    for (uint32_t i = 0; i < sampler_count; i++) {
+        animation_track_t *track = &tracks[i];
+        if (track->format == ANIMATION_KEY_FORMAT_FLOAT) continue;
+        track->output_offset = half_count;
+        half_count += (size_t)track->value_count * (track->format == ANIMATION_KEY_FORMAT_QUAT48 ? 3 : track->components);
+    }
+
+    float *keys = animation_create_storage(result, sampler_count, source->channel_count, float_count + (half_count + 1) / 2);
+    bool created = keys != NULL;
+
+    if (created) {
+        uint16_t *halves = (uint16_t *)(keys + float_count);
+        result->start_time = source->start_time;
+        result->end_time   = source->end_time;
+        memcpy(result->channels, source->channels, source->channel_count * sizeof(animation_channel_t));
+
+        for (uint32_t i = 0; i < sampler_count; i++) {
+            animation_track_t *track     = &tracks[i];
+            animation_sampler_t *sampler = &result->samplers[i];
+
+            sampler->interpolation = track->interpolation;
+            sampler->components    = track->components;
+            sampler->format        = track->format;
+            sampler->range_min     = track->range_min;
+            sampler->range_extent  = track->range_extent;
+            sampler->input_count   = track->key_count;
+            sampler->output_count  = track->value_count;
+            sampler->inputs        = &keys[track->time_offset];
+            memcpy(&keys[track->time_offset], track->times, track->key_count * sizeof(float));
+
+            switch (track->format)
+            {
+                case ANIMATION_KEY_FORMAT_FLOAT:
+                {
+                    float *dst = &keys[track->output_offset];
+                    for (uint32_t k = 0; k < track->value_count; k++) {
+                        memcpy(&dst[k * track->components], &track->values[k], track->components * sizeof(float));
+                    }
+                    sampler->outputs = dst;
+                    break;
+                }
+                case ANIMATION_KEY_FORMAT_QUAT48:
+                {
+                    uint16_t *dst = &halves[track->output_offset];
+                    for (uint32_t k = 0; k < track->value_count; k++) {
+                        animation_encode_quat48(track->values[k], &dst[k * 3]);
+                    }
+                    sampler->outputs = dst;
+                    break;
+                }
+                case ANIMATION_KEY_FORMAT_RANGE16:
+                {
+                    uint16_t *dst = &halves[track->output_offset];
+                    for (uint32_t k = 0; k < track->value_count; k++) {
+                        animation_encode_range16(track, track->values[k], &dst[k * track->components]);
+                    }
+                    sampler->outputs = dst;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < sampler_count; i++) {
+        memory_dealloc(tracks[i].times);
+        memory_dealloc(tracks[i].values);
+    }
+    memory_dealloc(tracks);
+    return created;
+}
+
+void animation_measure_error(const animation_t *reference, const animation_t *clip, animation_error_t *error)
+{
+    memset(error, 0, sizeof(*error));
+    assert(reference->channel_count == clip->channel_count);
+
+    for (uint32_t i = 0; i < reference->channel_count; i++) {
+        const animation_channel_t *channel = &reference->channels[i];
+        const animation_sampler_t *a = &reference->samplers[channel->sampler];
+        const animation_sampler_t *b = &clip->samplers[clip->channels[i].sampler];
+        if (channel->path == WEIGHTS || a->input_count == 0) continue;
+
+        float *max_error = channel->path == ROTATION ? &error->rotation :
+                           channel->path == TRANSLATION ? &error->translation : &error->scale;
+        uint32_t cursor_a = 0;
+        uint32_t cursor_b = 0;
+        for (uint32_t k = 0; k < a->input_count; k++) {
+            float probes[2] = {a->inputs[k], k + 1 < a->input_count ? 0.5f * (a->inputs[k] + a->inputs[k + 1]) : a->inputs[k]};
+            for (uint32_t j = 0; j < 2; j++) {
+                vec4f_t expected = animation_sampler_evaluate(a, channel->path, probes[j], &cursor_a);
+                vec4f_t actual   = animation_sampler_evaluate(b, channel->path, probes[j], &cursor_b);
+                float e = animation_value_error(channel->path, expected, actual);
+                if (e > *max_error) *max_error = e;
+            }
+        }
+    }
+}
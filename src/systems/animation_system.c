@@ -0,0 +1,217 @@
+#include <animation_system.h>
+#include <animation.h>
+#include <memory.h>
+#include <logger.h>
+
+#include <assert.h>
+#include <string.h>
+#include <time.h>
+
+static double animation_system_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+//! @brief: grows a MEM_TAG_HEAP array to hold at least needed elements, keeping the first count of them
+static void *animation_system_grow(void *data, uint32_t *capacity, uint32_t count, uint32_t needed, uint32_t stride)
+{
+    if (needed <= *capacity) return data;
+
+    uint32_t new_capacity = MAX(MAX(*capacity * 2, needed), 16);
+    void *new_data = memory_alloc(new_capacity * stride, MEM_TAG_HEAP);
+    if (data) {
+        memcpy(new_data, data, (size_t)count * stride);
+        memory_dealloc(data);
+    }
+    *capacity = new_capacity;
+    return new_data;
+}
+
+static void animation_system_run_batch(void *data)
+{
+    animation_batch_t *batch = (animation_batch_t *)data;
+    double start = animation_system_now();
+
+    for (uint32_t i = 0; i < batch->count; i++) {
+        animation_task_t *task = &batch->tasks[i];
+        animated_instance_t *instance = task->instance;
+
+        animated_instance_update(instance, task->skeleton, instance->lod_dt + batch->dt);
+        instance->lod_dt = 0.0f;
+    }
+    batch->time = animation_system_now() - start;
+}
+
+static void animation_system_run_palette_batch(void *data)
+{
+    animation_batch_t *batch = (animation_batch_t *)data;
+    double start = animation_system_now();
+
+    affine3x4_t joints[MAX_BONES_PER_SKIN];
+    for (uint32_t i = 0; i < batch->count; i++) {
+        animation_task_t *task = &batch->tasks[i];
+        animated_instance_t *instance = task->instance;
+        uint32_t mesh_node = task->model->mesh_node;
+
+        if (instance->baked_clip != UINT32_MAX) {
+            const animation_playback_t *playback = &instance->layers[0].playbacks[instance->layers[0].current];
+            animation_baked_sample(&task->model->baked_clips[instance->baked_clip], playback->time, instance->baked_interpolate,
+                                   joints, &instance->global_matrices[mesh_node]);
+        } else {
+            animation_compute_palette(task->skeleton, mesh_node, instance->global_matrices, joints);
+        }
+        animation_write_palette(joints, task->skeleton->skin.joint_count, task->palette);
+    }
+    batch->time = animation_system_now() - start;
+}
+
+//! @brief: runs tasks in batches of ANIMATION_BATCH_SIZE on the job system, returns the summed time of the batches
+static double animation_system_run(animation_system_t *system, void (*run)(void *), animation_task_t *tasks, uint32_t task_count, float dt)
+{
+    uint32_t batch_count = (task_count + ANIMATION_BATCH_SIZE - 1) / ANIMATION_BATCH_SIZE;
+    system->batches = animation_system_grow(system->batches, &system->batch_capacity, 0,
+                                            batch_count, sizeof(animation_batch_t));
+
+    for (uint32_t i = 0; i < batch_count; i++) {
+        animation_batch_t *batch = &system->batches[i];
+        batch->tasks = &tasks[i * ANIMATION_BATCH_SIZE];
+        batch->count = MIN(ANIMATION_BATCH_SIZE, task_count - i * ANIMATION_BATCH_SIZE);
+        batch->dt    = dt;
+        batch->time  = 0.0;
+        jobs_submit(run, batch, &system->jobs);
+    }
+    jobs_wait(&system->jobs);
+
+    double time = 0.0;
+    for (uint32_t i = 0; i < batch_count; i++) {
+        time += system->batches[i].time;
+    }
+    system->batch_count = batch_count;
+    return time;
+}
+
+void animation_system_init(animation_system_t *system)
+{
+    memset(system, 0, sizeof(*system));
+    system->lod_distances[0] = 200.0f;
+    system->lod_distances[1] = 300.0f;
+    system->lod_distances[2] = 400.0f;
+    system->lod_skip_leaves  = ANIMATION_LOD_QUARTER;
+}
+
+void animation_system_destroy(animation_system_t *system)
+{
+    //batches point at the tasks
+    jobs_wait(&system->jobs);
+
+    if (system->tasks) memory_dealloc(system->tasks);
+    if (system->skipped) memory_dealloc(system->skipped);
+    if (system->palette_tasks) memory_dealloc(system->palette_tasks);
+    if (system->batches) memory_dealloc(system->batches);
+    memset(system, 0, sizeof(*system));
+}
+
+void animation_system_begin(animation_system_t *system)
+{
+    assert(jobs_done(&system->jobs) && "animation pass still running");
+    system->task_count    = 0;
+    system->skipped_count = 0;
+    memset(system->lod_counts, 0, sizeof(system->lod_counts));
+}
+
+uint32_t animation_system_select_lod(const animation_system_t *system, float distance)
+{
+    uint32_t lod = ANIMATION_LOD_FULL;
+    while (lod < ANIMATION_LOD_COUNT - 1 && distance >= system->lod_distances[lod]) {
+        lod++;
+    }
+    return lod;
+}
+
+void animation_system_set_lod(animation_system_t *system, animated_instance_t *instance, uint32_t lod)
+{
+    assert(lod < ANIMATION_LOD_COUNT);
+    if (lod != instance->lod) {
+        instance->lod       = lod;
+        instance->lod_phase = system->lod_next_phase[lod]++ & ((1u << lod) - 1);
+    }
+    instance->skip_leaf_nodes = lod >= system->lod_skip_leaves;
+}
+
+void animation_system_add(animation_system_t *system, animated_instance_t *instance, const skeleton_t *skeleton)
+{
+    system->lod_counts[instance->lod]++;
+
+    uint32_t interval = 1u << instance->lod;
+    if (((system->tick + instance->lod_phase) & (interval - 1)) != 0) {
+        system->skipped = animation_system_grow(system->skipped, &system->skipped_capacity, system->skipped_count,
+                                                system->skipped_count + 1, sizeof(animated_instance_t *));
+        system->skipped[system->skipped_count++] = instance;
+        return;
+    }
+
+    system->tasks = animation_system_grow(system->tasks, &system->task_capacity, system->task_count,
+                                          system->task_count + 1, sizeof(animation_task_t));
+
+    animation_task_t *task = &system->tasks[system->task_count++];
+    task->instance = instance;
+    task->skeleton = skeleton;
+}
+
+void animation_system_update(animation_system_t *system, float dt)
+{
+    for (uint32_t i = 0; i < system->skipped_count; i++) {
+        system->skipped[i]->lod_dt += dt;
+    }
+
+    double start = animation_system_now();
+    system->batch_time = animation_system_run(system, animation_system_run_batch, system->tasks, system->task_count, dt);
+    system->pass_time  = animation_system_now() - start;
+
+    system->instance_count  = system->task_count + system->skipped_count;
+    system->evaluated_count = system->task_count;
+    system->tick++;
+
+    system->pass_count++;
+    system->total_pass_time  += system->pass_time;
+    system->total_batch_time += system->batch_time;
+}
+
+void animation_system_queue_palette(animation_system_t *system, 
+                                    animated_instance_t *instance, 
+                                    const skeleton_t *skeleton,
+                                    const skinned_model_t *model, 
+                                    mat4f_t *palette, 
+                                    uint32_t frame)
+{
+    assert(frame < MAX_PALETTE_BUFFERS);
+    //the buffer still holds the palette of this pose from the last time the frame was recorded
+    if (instance->palette_versions[frame] == instance->pose_version) {
+        system->palette_skip_count++;
+        return;
+    }
+    instance->palette_versions[frame] = instance->pose_version;
+
+    system->palette_tasks = animation_system_grow(system->palette_tasks, &system->palette_task_capacity, system->palette_task_count,
+                                                  system->palette_task_count + 1, sizeof(animation_task_t));
+
+    animation_task_t *task = &system->palette_tasks[system->palette_task_count++];
+    task->instance  = instance;
+    task->skeleton  = skeleton;
+    task->model     = model;
+    task->palette   = palette;
+}
+
+void animation_system_write_palettes(animation_system_t *system)
+{
+    double start = animation_system_now();
+    animation_system_run(system, animation_system_run_palette_batch, system->palette_tasks, system->palette_task_count, 0.0f);
+    system->palette_time = animation_system_now() - start;
+
+    system->palettes_written   = system->palette_task_count;
+    system->palettes_skipped   = system->palette_skip_count;
+    system->palette_task_count = 0;
+    system->palette_skip_count = 0;
+}
@@ -0,0 +1,823 @@
+#include <pathfinding.h>
+#include <memory.h>
+#include <logger.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define NAV_NONE   UINT32_MAX
+#define NAV_CLOSED (UINT32_MAX - 1)
+
+static const vec2i_t nav_neighbours[4] = {{-1,0}, {0,1}, {0,-1}, {1,0}};
+
+static inline bool nav_walkable(const dungeon_t *dungeon, int32_t x, int32_t y)
+{
+    if (x < 0 || x >= dungeon->width || y < 0 || y >= dungeon->height) return false;
+    return dungeon->tiles[y * dungeon->width + x] == FLOOR;
+}
+
+static inline uint32_t nav_manhattan(const dungeon_t *dungeon, uint32_t a, uint32_t b)
+{
+    int32_t ax = (int32_t)(a % (uint32_t)dungeon->width), ay = (int32_t)(a / (uint32_t)dungeon->width);
+    int32_t bx = (int32_t)(b % (uint32_t)dungeon->width), by = (int32_t)(b / (uint32_t)dungeon->width);
+    return (uint32_t)(abs(ax - bx) + abs(ay - by));
+}
+
+//! @brief: stamps make clearing per query unnecessary, only a wrap around clears them
+static inline uint32_t next_generation(uint32_t *generation, uint32_t *stamp, uint32_t count)
+{
+    if (++(*generation) == 0) {
+        memset(stamp, 0, count * sizeof(uint32_t));
+        *generation = 1;
+    }
+    return *generation;
+}
+
+bool flow_field_init(flow_field_t *field, const dungeon_t *dungeon, int32_t radius)
+{
+    memset(field, 0, sizeof(*field));
+    if (radius <= 0 || radius >= FLOW_FIELD_UNREACHED) {
+        LOGE("Flow field radius %d is out of range", radius);
+        return false;
+    }
+
+    uint32_t cell_count = (uint32_t)dungeon->width * (uint32_t)dungeon->height;
+    uint64_t window     = (uint64_t)(2 * radius + 1) * (uint64_t)(2 * radius + 1);
+
+    field->dungeon   = dungeon;
+    field->radius    = radius;
+    field->queue_cap = (uint32_t)MIN(window, (uint64_t)cell_count);
+    field->distance  = memory_alloc(cell_count * sizeof(uint16_t), MEM_TAG_HEAP);
+    field->stamp     = memory_alloc(cell_count * sizeof(uint32_t), MEM_TAG_HEAP);
+    field->queue     = memory_alloc(field->queue_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    return true;
+}
+
+bool flow_field_update(flow_field_t *field, int32_t target_x, int32_t target_y)
+{
+    if (field->valid && field->target.x == target_x && field->target.y == target_y) return false;
+
+    const dungeon_t *dungeon = field->dungeon;
+    field->target = (vec2i_t){target_x, target_y};
+    field->valid  = nav_walkable(dungeon, target_x, target_y);
+    if (!field->valid) return true;
+
+    uint32_t cell_count = (uint32_t)dungeon->width * (uint32_t)dungeon->height;
+    uint32_t generation = next_generation(&field->generation, field->stamp, cell_count);
+
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t target = (uint32_t)(target_y * dungeon->width + target_x);
+    field->distance[target] = 0;
+    field->stamp[target]    = generation;
+    field->queue[tail++]    = target;
+
+    //the field only covers cells within radius steps, so a rebuild costs the same anywhere on the map
+    while (head < tail) {
+        uint32_t cell = field->queue[head++];
+        uint16_t distance = field->distance[cell];
+        if (distance == field->radius) continue;
+
+        int32_t x = (int32_t)(cell % (uint32_t)dungeon->width);
+        int32_t y = (int32_t)(cell / (uint32_t)dungeon->width);
+        for (uint32_t i = 0; i < 4; i++) {
+            int32_t nx = x + nav_neighbours[i].x;
+            int32_t ny = y + nav_neighbours[i].y;
+            if (!nav_walkable(dungeon, nx, ny)) continue;
+
+            uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+            if (field->stamp[next] == generation) continue;
+
+            assert(tail < field->queue_cap);
+            field->stamp[next]    = generation;
+            field->distance[next] = distance + 1;
+            field->queue[tail++]  = next;
+        }
+    }
+    return true;
+}
+
+bool flow_field_direction(const flow_field_t *field, int32_t x, int32_t y, vec2i_t *dir)
+{
+    const dungeon_t *dungeon = field->dungeon;
+    if (!field->valid || !nav_walkable(dungeon, x, y)) return false;
+
+    uint32_t cell = (uint32_t)(y * dungeon->width + x);
+    if (field->stamp[cell] != field->generation) return false;
+
+    uint16_t best = field->distance[cell];
+    bool found = false;
+    for (uint32_t i = 0; i < 4; i++) {
+        int32_t nx = x + nav_neighbours[i].x;
+        int32_t ny = y + nav_neighbours[i].y;
+        if (!nav_walkable(dungeon, nx, ny)) continue;
+
+        uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+        if (field->stamp[next] == field->generation && field->distance[next] < best) {
+            best  = field->distance[next];
+            *dir  = nav_neighbours[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+void flow_field_destroy(flow_field_t *field)
+{
+    if (field->distance) memory_dealloc(field->distance);
+    if (field->stamp) memory_dealloc(field->stamp);
+    if (field->queue) memory_dealloc(field->queue);
+    memset(field, 0, sizeof(*field));
+}
+
+//! @brief: neighbouring floor cells in different clusters, which only happens across a tile border
+static inline bool nav_contact(const nav_grid_t *nav, uint32_t a, uint32_t b)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    if (dungeon->tiles[a] != FLOOR || dungeon->tiles[b] != FLOOR) return false;
+    return nav->cluster[a] != nav->cluster[b];
+}
+
+//! @brief: counts the doors of every cluster, or adds both edges of every door once the offsets are known
+static void nav_gather_doors(nav_grid_t *nav, uint32_t *cursor)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    for (int32_t y = 0; y < dungeon->height; y++) {
+        for (int32_t x = 0; x < dungeon->width; x++) {
+            uint32_t a = (uint32_t)(y * dungeon->width + x);
+            uint32_t neighbours[2] = {a + 1, a + (uint32_t)dungeon->width};
+            bool inside[2] = {x + 1 < dungeon->width, y + 1 < dungeon->height};
+
+            for (uint32_t i = 0; i < 2; i++) {
+                uint32_t b = neighbours[i];
+                if (!inside[i] || !nav_contact(nav, a, b)) continue;
+
+                uint32_t from = nav->cluster[a];
+                uint32_t to   = nav->cluster[b];
+                if (!cursor) {
+                    nav->edge_offsets[from]++;
+                    nav->edge_offsets[to]++;
+                    continue;
+                }
+                uint32_t forward  = cursor[from]++;
+                uint32_t backward = cursor[to]++;
+                nav->edges[forward]  = (nav_edge_t){to, a, b, backward};
+                nav->edges[backward] = (nav_edge_t){from, b, a, forward};
+            }
+        }
+    }
+}
+
+//! @brief: numbers the connected pieces of floor inside every tile and the cells of each piece
+static uint32_t nav_label_clusters(nav_grid_t *nav)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    uint32_t cell_count = (uint32_t)dungeon->width * (uint32_t)dungeon->height;
+    uint32_t queue[NAV_CLUSTER_SIZE * NAV_CLUSTER_SIZE];
+    uint32_t count = 0;
+
+    memset(nav->cluster, 0xFF, cell_count * sizeof(uint32_t));
+    for (uint32_t start = 0; start < cell_count; start++) {
+        if (dungeon->tiles[start] != FLOOR || nav->cluster[start] != NAV_NONE) continue;
+
+        int32_t tile_x = (int32_t)(start % (uint32_t)dungeon->width) / NAV_CLUSTER_SIZE;
+        int32_t tile_y = (int32_t)(start / (uint32_t)dungeon->width) / NAV_CLUSTER_SIZE;
+        uint32_t head = 0;
+        uint32_t tail = 0;
+        nav->cluster[start]   = count;
+        nav->cell_slot[start] = tail;
+        queue[tail++] = start;
+
+        while (head < tail) {
+            uint32_t cell = queue[head++];
+            int32_t x = (int32_t)(cell % (uint32_t)dungeon->width);
+            int32_t y = (int32_t)(cell / (uint32_t)dungeon->width);
+
+            for (uint32_t i = 0; i < 4; i++) {
+                int32_t nx = x + nav_neighbours[i].x;
+                int32_t ny = y + nav_neighbours[i].y;
+                if (!nav_walkable(dungeon, nx, ny) || nx / NAV_CLUSTER_SIZE != tile_x || ny / NAV_CLUSTER_SIZE != tile_y) continue;
+
+                uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+                if (nav->cluster[next] != NAV_NONE) continue;
+
+                nav->cluster[next]   = count;
+                nav->cell_slot[next] = tail;
+                queue[tail++] = next;
+            }
+        }
+        count++;
+    }
+    return count;
+}
+
+static inline uint32_t nav_cluster_degree(const nav_grid_t *nav, uint32_t cluster)
+{
+    return nav->edge_offsets[cluster + 1] - nav->edge_offsets[cluster];
+}
+
+//! @brief: distances from one cell to all doors of its cluster are next to each other
+static inline const uint8_t *nav_cell_door_distances(const nav_grid_t *nav, uint32_t cluster, uint32_t cell)
+{
+    return &nav->door_distance[nav->door_offsets[cluster] + (uint64_t)nav->cell_slot[cell] * nav_cluster_degree(nav, cluster)];
+}
+
+static inline uint32_t nav_distance(uint8_t distance)
+{
+    return distance == NAV_FAR ? NAV_NONE : distance;
+}
+
+static inline uint32_t nav_door_distance(const nav_grid_t *nav, uint32_t cluster, uint32_t door, uint32_t cell)
+{
+    return nav_distance(nav_cell_door_distances(nav, cluster, cell)[door]);
+}
+
+//! @brief: breadth first search from one door over the floor of its cluster
+static void nav_fill_door_distances(nav_grid_t *nav, uint32_t cluster, uint32_t door)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    uint32_t degree   = nav_cluster_degree(nav, cluster);
+    uint8_t *distance = &nav->door_distance[nav->door_offsets[cluster] + door];
+    uint32_t start    = nav->edges[nav->edge_offsets[cluster] + door].cell_from;
+    uint32_t queue[NAV_CLUSTER_SIZE * NAV_CLUSTER_SIZE];
+
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    distance[(uint64_t)nav->cell_slot[start] * degree] = 0;
+    queue[tail++] = start;
+
+    while (head < tail) {
+        uint32_t cell = queue[head++];
+        uint8_t d = distance[(uint64_t)nav->cell_slot[cell] * degree];
+        int32_t x = (int32_t)(cell % (uint32_t)dungeon->width);
+        int32_t y = (int32_t)(cell / (uint32_t)dungeon->width);
+
+        for (uint32_t i = 0; i < 4; i++) {
+            int32_t nx = x + nav_neighbours[i].x;
+            int32_t ny = y + nav_neighbours[i].y;
+            if (!nav_walkable(dungeon, nx, ny)) continue;
+
+            uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+            if (nav->cluster[next] != cluster || distance[(uint64_t)nav->cell_slot[next] * degree] != NAV_FAR) continue;
+
+            distance[(uint64_t)nav->cell_slot[next] * degree] = d + 1;
+            queue[tail++] = next;
+        }
+    }
+}
+
+bool nav_grid_init(nav_grid_t *nav, const dungeon_t *dungeon)
+{
+    memset(nav, 0, sizeof(*nav));
+    nav->dungeon = dungeon;
+
+    uint32_t cell_count = (uint32_t)dungeon->width * (uint32_t)dungeon->height;
+    nav->cluster        = memory_alloc(cell_count * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->cell_slot      = memory_alloc(cell_count * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->cluster_count  = nav_label_clusters(nav);
+    uint32_t cluster_count = nav->cluster_count;
+
+    nav->cluster_size = memory_alloc(MAX(cluster_count, 1) * sizeof(uint32_t), MEM_TAG_HEAP);
+    memset(nav->cluster_size, 0, MAX(cluster_count, 1) * sizeof(uint32_t));
+    for (uint32_t cell = 0; cell < cell_count; cell++) {
+        if (nav->cluster[cell] != NAV_NONE) nav->cluster_size[nav->cluster[cell]]++;
+    }
+
+    //every floor contact across a tile border is a door, keeping all of them keeps the door search exact
+    nav->edge_offsets = memory_alloc((cluster_count + 1) * sizeof(uint32_t), MEM_TAG_HEAP);
+    memset(nav->edge_offsets, 0, (cluster_count + 1) * sizeof(uint32_t));
+    nav_gather_doors(nav, NULL);
+
+    uint32_t sum = 0;
+    for (uint32_t c = 0; c <= cluster_count; c++) {
+        uint32_t degree = c < cluster_count ? nav->edge_offsets[c] : 0;
+        nav->edge_offsets[c] = sum;
+        sum += degree;
+    }
+    nav->edge_count = sum;
+
+    if (nav->edge_count > 0) {
+        nav->edges = memory_alloc(nav->edge_count * sizeof(nav_edge_t), MEM_TAG_HEAP);
+        uint32_t *cursor = memory_alloc(cluster_count * sizeof(uint32_t), MEM_TAG_HEAP);
+        memcpy(cursor, nav->edge_offsets, cluster_count * sizeof(uint32_t));
+        nav_gather_doors(nav, cursor);
+        memory_dealloc(cursor);
+    }
+
+    //tiles bound the doors and cells of a cluster, so the tables grow with the floor and not with the largest region
+    nav->door_offsets   = memory_alloc(MAX(cluster_count, 1) * sizeof(uint64_t), MEM_TAG_HEAP);
+    nav->matrix_offsets = memory_alloc(MAX(cluster_count, 1) * sizeof(uint64_t), MEM_TAG_HEAP);
+    uint64_t table_size  = 0;
+    uint64_t matrix_size = 0;
+    for (uint32_t c = 0; c < cluster_count; c++) {
+        uint32_t degree = nav_cluster_degree(nav, c);
+        nav->door_offsets[c]   = table_size;
+        nav->matrix_offsets[c] = matrix_size;
+        table_size  += (uint64_t)degree * nav->cluster_size[c];
+        matrix_size += (uint64_t)degree * degree;
+    }
+
+    if (table_size > UINT32_MAX || matrix_size > UINT32_MAX) {
+        LOGE("Door distance tables need %lu bytes", (unsigned long)(table_size + matrix_size));
+        nav_grid_destroy(nav);
+        return false;
+    }
+
+    nav->node_cap    = MAX(cell_count, nav->edge_count + 1);
+    nav->g           = memory_alloc(nav->node_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->f           = memory_alloc(nav->node_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->parent      = memory_alloc(nav->node_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->stamp       = memory_alloc(nav->node_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->heap        = memory_alloc(nav->node_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->heap_index  = memory_alloc(nav->node_cap * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->edge_path   = memory_alloc((nav->edge_count + 1) * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->edge_cost   = memory_alloc((nav->edge_count + 1) * sizeof(uint32_t), MEM_TAG_HEAP);
+    nav->target_cell = NAV_NONE;
+    nav->target_distance = memory_alloc(NAV_CLUSTER_SIZE * NAV_CLUSTER_SIZE * sizeof(uint32_t), MEM_TAG_HEAP);
+
+    if (table_size > 0) {
+        nav->door_distance = memory_alloc((uint32_t)table_size, MEM_TAG_HEAP);
+        memset(nav->door_distance, NAV_FAR, table_size);
+        for (uint32_t c = 0; c < cluster_count; c++) {
+            for (uint32_t door = 0; door < nav_cluster_degree(nav, c); door++) {
+                nav_fill_door_distances(nav, c, door);
+            }
+        }
+    }
+
+    //the door search only needs door to door distances, keep those together so it stays in cache
+    if (matrix_size > 0) {
+        nav->door_matrix = memory_alloc((uint32_t)matrix_size, MEM_TAG_HEAP);
+        for (uint32_t c = 0; c < cluster_count; c++) {
+            uint32_t degree = nav_cluster_degree(nav, c);
+            uint8_t *matrix = &nav->door_matrix[nav->matrix_offsets[c]];
+            for (uint32_t i = 0; i < degree; i++) {
+                for (uint32_t j = 0; j < degree; j++) {
+                    matrix[i * degree + j] = nav_cell_door_distances(nav, c, nav->edges[nav->edge_offsets[c] + j].cell_from)[i];
+                }
+            }
+        }
+    }
+
+    LOGI("Nav grid has %u clusters, %u doors and %lu door distances",
+         cluster_count, nav->edge_count / 2, (unsigned long)table_size);
+    return true;
+}
+
+static void heap_swap(nav_grid_t *nav, uint32_t a, uint32_t b)
+{
+    uint32_t tmp = nav->heap[a];
+    nav->heap[a] = nav->heap[b];
+    nav->heap[b] = tmp;
+    nav->heap_index[nav->heap[a]] = a;
+    nav->heap_index[nav->heap[b]] = b;
+}
+
+static void heap_up(nav_grid_t *nav, uint32_t i)
+{
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (nav->f[nav->heap[parent]] <= nav->f[nav->heap[i]]) break;
+        heap_swap(nav, i, parent);
+        i = parent;
+    }
+}
+
+static void heap_push(nav_grid_t *nav, uint32_t *count, uint32_t node)
+{
+    if (nav->heap_index[node] < NAV_CLOSED) {
+        //already queued, f only ever goes down
+        heap_up(nav, nav->heap_index[node]);
+        return;
+    }
+    nav->heap[*count] = node;
+    nav->heap_index[node] = *count;
+    heap_up(nav, (*count)++);
+}
+
+static uint32_t heap_pop(nav_grid_t *nav, uint32_t *count)
+{
+    uint32_t top = nav->heap[0];
+    (*count)--;
+    if (*count > 0) {
+        heap_swap(nav, 0, *count);
+        uint32_t i = 0;
+        for (;;) {
+            uint32_t l = 2 * i + 1;
+            uint32_t r = l + 1;
+            uint32_t smallest = i;
+            if (l < *count && nav->f[nav->heap[l]] < nav->f[nav->heap[smallest]]) smallest = l;
+            if (r < *count && nav->f[nav->heap[r]] < nav->f[nav->heap[smallest]]) smallest = r;
+            if (smallest == i) break;
+            heap_swap(nav, i, smallest);
+            i = smallest;
+        }
+    }
+    nav->heap_index[top] = NAV_CLOSED;
+    return top;
+}
+
+//! @brief: A* over doors. A node is an edge, standing on its cell_to, and costs come from the door tables,
+//          so the result is the shortest path through the chosen doors. The goal cell is node edge_count.
+//          Returns the number of edges on the way and their walking length, or NAV_NONE if the clusters aren't
+//          connected. Cells of the same cluster get the shortest path that leaves it at least once.
+static uint32_t nav_search_doors(nav_grid_t *nav, uint32_t start_cell, uint32_t goal_cell, uint32_t *length)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    uint32_t start = nav->cluster[start_cell];
+    uint32_t goal  = nav->cluster[goal_cell];
+    uint32_t goal_node  = nav->edge_count;
+    uint32_t generation = next_generation(&nav->generation, nav->stamp, nav->node_cap);
+
+    uint32_t count = 0;
+    //seed with every door out of the start cluster
+    for (uint32_t e = nav->edge_offsets[start]; e < nav->edge_offsets[start + 1]; e++) {
+        uint32_t d = nav_door_distance(nav, start, e - nav->edge_offsets[start], start_cell);
+        if (d == NAV_NONE) continue;
+
+        nav->stamp[e]      = generation;
+        nav->g[e]          = d + 1;
+        nav->f[e]          = d + 1 + nav_manhattan(dungeon, nav->edges[e].cell_to, goal_cell);
+        nav->parent[e]     = NAV_NONE;
+        nav->heap_index[e] = NAV_NONE;
+        heap_push(nav, &count, e);
+    }
+
+    bool found = false;
+    while (count > 0) {
+        uint32_t node = heap_pop(nav, &count);
+        if (node == goal_node) {
+            found = true;
+            break;
+        }
+
+        nav_edge_t *edge = &nav->edges[node];
+        uint32_t cluster = edge->to;
+        //cell_to is the door of the reverse edge, so its table has the distances from where we stand
+        uint32_t entry   = edge->reverse - nav->edge_offsets[cluster];
+        uint32_t degree  = nav->edge_offsets[cluster + 1] - nav->edge_offsets[cluster];
+        const uint8_t *matrix = &nav->door_matrix[nav->matrix_offsets[cluster] + entry * degree];
+
+        for (uint32_t next = nav->edge_offsets[cluster]; next <= nav->edge_offsets[cluster + 1]; next++) {
+            uint32_t g = 0;
+            uint32_t h = 0;
+            uint32_t target = next;
+
+            if (next == nav->edge_offsets[cluster + 1]) {
+                //one past the last door is the goal, if we are in its cluster
+                if (cluster != goal) break;
+                uint32_t d = nav_door_distance(nav, cluster, entry, goal_cell);
+                if (d == NAV_NONE) break;
+                g = nav->g[node] + d;
+                target = goal_node;
+            } else {
+                if (next == edge->reverse) continue;
+                uint32_t d = nav_distance(matrix[next - nav->edge_offsets[cluster]]);
+                if (d == NAV_NONE) continue;
+                g = nav->g[node] + d + 1;
+                h = nav_manhattan(dungeon, nav->edges[next].cell_to, goal_cell);
+            }
+
+            if (nav->stamp[target] == generation) {
+                //walking distances never beat manhattan, so the heuristic is consistent and closed nodes are final
+                if (nav->heap_index[target] == NAV_CLOSED || g >= nav->g[target]) continue;
+            } else {
+                nav->stamp[target]      = generation;
+                nav->heap_index[target] = NAV_NONE;
+            }
+
+            nav->g[target]      = g;
+            nav->f[target]      = g + h;
+            nav->parent[target] = node;
+            heap_push(nav, &count, target);
+        }
+    }
+    if (!found) return NAV_NONE;
+    *length = nav->g[goal_node];
+
+    //walk back to the start, edge_path ends up in reverse order
+    uint32_t edge_count = 0;
+    for (uint32_t node = nav->parent[goal_node]; node != NAV_NONE; node = nav->parent[node]) {
+        nav->edge_path[edge_count++] = node;
+    }
+    return edge_count;
+}
+
+//! @brief: neighbour of cell in the same cluster that is one step closer to the door
+static uint32_t nav_step_to_door(const nav_grid_t *nav, uint32_t cluster, uint32_t door, uint32_t cell)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    uint32_t d = nav_door_distance(nav, cluster, door, cell);
+    int32_t x = (int32_t)(cell % (uint32_t)dungeon->width);
+    int32_t y = (int32_t)(cell / (uint32_t)dungeon->width);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        int32_t nx = x + nav_neighbours[i].x;
+        int32_t ny = y + nav_neighbours[i].y;
+        if (!nav_walkable(dungeon, nx, ny)) continue;
+
+        uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+        if (nav->cluster[next] == cluster && nav_door_distance(nav, cluster, door, next) == d - 1) return next;
+    }
+    assert(false && "door distances are inconsistent");
+    return cell;
+}
+
+static inline vec2i_t nav_cell_to_vec2i(const dungeon_t *dungeon, uint32_t cell)
+{
+    return (vec2i_t){(int32_t)(cell % (uint32_t)dungeon->width), (int32_t)(cell / (uint32_t)dungeon->width)};
+}
+
+//! @brief: A* between two cells of the same cluster that doesn't leave it. Only a path of at most limit steps
+//          counts, it is appended to path after start.
+static bool nav_search_local(nav_grid_t *nav, uint32_t start, uint32_t goal, uint32_t limit, vec2i_t *path, uint32_t *path_count, uint32_t max_cells)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    uint32_t cluster    = nav->cluster[start];
+    uint32_t generation = next_generation(&nav->generation, nav->stamp, nav->node_cap);
+
+    uint32_t count = 0;
+    nav->stamp[start]      = generation;
+    nav->g[start]          = 0;
+    nav->f[start]          = nav_manhattan(dungeon, start, goal);
+    nav->parent[start]     = NAV_NONE;
+    nav->heap_index[start] = NAV_NONE;
+    heap_push(nav, &count, start);
+
+    bool found = false;
+    while (count > 0) {
+        uint32_t cell = heap_pop(nav, &count);
+        if (cell == goal) {
+            found = true;
+            break;
+        }
+
+        int32_t x = (int32_t)(cell % (uint32_t)dungeon->width);
+        int32_t y = (int32_t)(cell / (uint32_t)dungeon->width);
+        for (uint32_t i = 0; i < 4; i++) {
+            int32_t nx = x + nav_neighbours[i].x;
+            int32_t ny = y + nav_neighbours[i].y;
+            if (!nav_walkable(dungeon, nx, ny)) continue;
+
+            uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+            if (nav->cluster[next] != cluster) continue;
+
+            uint32_t g = nav->g[cell] + 1;
+            if (g + nav_manhattan(dungeon, next, goal) > limit) continue;
+            if (nav->stamp[next] == generation) {
+                //manhattan is consistent on a 4 connected grid, closed cells are final
+                if (nav->heap_index[next] == NAV_CLOSED || g >= nav->g[next]) continue;
+            } else {
+                nav->stamp[next]      = generation;
+                nav->heap_index[next] = NAV_NONE;
+            }
+
+            nav->g[next]      = g;
+            nav->f[next]      = g + nav_manhattan(dungeon, next, goal);
+            nav->parent[next] = cell;
+            heap_push(nav, &count, next);
+        }
+    }
+    if (!found) return false;
+
+    //write the segment back to front, dropping the part that doesn't fit
+    uint32_t length = nav->g[goal];
+    uint32_t first  = *path_count;
+    uint32_t cell   = goal;
+    for (uint32_t i = length; i > 0; i--) {
+        uint32_t index = first + i - 1;
+        if (index < max_cells) {
+            path[index] = (vec2i_t){(int32_t)(cell % (uint32_t)dungeon->width), (int32_t)(cell / (uint32_t)dungeon->width)};
+        }
+        cell = nav->parent[cell];
+    }
+    *path_count = MIN(first + length, max_cells);
+    return true;
+}
+
+uint32_t nav_find_path(nav_grid_t *nav, vec2i_t from, vec2i_t to, vec2i_t *path, uint32_t max_cells)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    if (!nav_walkable(dungeon, from.x, from.y) || !nav_walkable(dungeon, to.x, to.y) || max_cells == 0) return 0;
+
+    uint32_t start = (uint32_t)(from.y * dungeon->width + from.x);
+    uint32_t goal  = (uint32_t)(to.y * dungeon->width + to.x);
+    if (start == goal) return 0;
+
+    uint32_t path_count = 0;
+    uint32_t length     = NAV_NONE;
+    uint32_t edge_count = nav_search_doors(nav, start, goal, &length);
+
+    //going around through other clusters can beat staying in a cluster both ends share, keep the shorter one
+    if (nav->cluster[start] == nav->cluster[goal] &&
+        nav_search_local(nav, start, goal, length, path, &path_count, max_cells)) {
+        return path_count;
+    }
+    if (edge_count == NAV_NONE) return 0;
+
+    //walk down the door tables, edge_path is reversed so read it from the back
+    uint32_t current = start;
+    uint32_t cluster = nav->cluster[start];
+    for (uint32_t i = edge_count; i > 0; i--) {
+        uint32_t e = nav->edge_path[i - 1];
+        uint32_t door = e - nav->edge_offsets[cluster];
+
+        while (current != nav->edges[e].cell_from) {
+            if (path_count == max_cells) return path_count;
+            current = nav_step_to_door(nav, cluster, door, current);
+            path[path_count++] = nav_cell_to_vec2i(dungeon, current);
+        }
+
+        if (path_count == max_cells) return path_count;
+        current = nav->edges[e].cell_to;
+        cluster = nav->edges[e].to;
+        path[path_count++] = nav_cell_to_vec2i(dungeon, current);
+    }
+
+    //the last stretch walks from the goal back to the door we came in through
+    uint32_t entry  = nav->edges[nav->edge_path[0]].reverse - nav->edge_offsets[cluster];
+    length          = nav_door_distance(nav, cluster, entry, goal);
+    uint32_t cell   = goal;
+    for (uint32_t i = length; i > 0; i--) {
+        uint32_t index = path_count + i - 1;
+        if (index < max_cells) path[index] = nav_cell_to_vec2i(dungeon, cell);
+        cell = nav_step_to_door(nav, cluster, entry, cell);
+    }
+    return MIN(path_count + length, max_cells);
+}
+
+bool nav_set_target(nav_grid_t *nav, vec2i_t to)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    if (!nav_walkable(dungeon, to.x, to.y)) return false;
+
+    uint32_t goal = (uint32_t)(to.y * dungeon->width + to.x);
+    if (goal == nav->target_cell) return false;
+
+    uint32_t cluster = nav->cluster[goal];
+    nav->target_cell    = goal;
+    nav->target_cluster = cluster;
+    nav->target_generation++;
+
+    //breadth first inside the target cluster, the heap is free between queries so it doubles as the queue
+    memset(nav->target_distance, 0xFF, nav->cluster_size[cluster] * sizeof(uint32_t));
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    nav->target_distance[nav->cell_slot[goal]] = 0;
+    nav->heap[tail++] = goal;
+
+    while (head < tail) {
+        uint32_t cell = nav->heap[head++];
+        uint32_t d = nav->target_distance[nav->cell_slot[cell]];
+        int32_t x = (int32_t)(cell % (uint32_t)dungeon->width);
+        int32_t y = (int32_t)(cell / (uint32_t)dungeon->width);
+
+        for (uint32_t i = 0; i < 4; i++) {
+            int32_t nx = x + nav_neighbours[i].x;
+            int32_t ny = y + nav_neighbours[i].y;
+            if (!nav_walkable(dungeon, nx, ny)) continue;
+
+            uint32_t next = (uint32_t)(ny * dungeon->width + nx);
+            if (nav->cluster[next] != cluster || nav->target_distance[nav->cell_slot[next]] != NAV_NONE) continue;
+
+            nav->target_distance[nav->cell_slot[next]] = d + 1;
+            nav->heap[tail++] = next;
+        }
+    }
+
+    //dijkstra backwards over the doors, starting from the doors into the target cluster
+    memset(nav->edge_cost, 0xFF, nav->edge_count * sizeof(uint32_t));
+    uint32_t generation = next_generation(&nav->generation, nav->stamp, nav->node_cap);
+    uint32_t count = 0;
+
+    for (uint32_t out = nav->edge_offsets[cluster]; out < nav->edge_offsets[cluster + 1]; out++) {
+        uint32_t e = nav->edges[out].reverse;
+        uint32_t d = nav->target_distance[nav->cell_slot[nav->edges[e].cell_to]];
+        if (d == NAV_NONE) continue;
+
+        nav->edge_cost[e]  = d;
+        nav->f[e]          = d;
+        nav->stamp[e]      = generation;
+        nav->heap_index[e] = NAV_NONE;
+        heap_push(nav, &count, e);
+    }
+
+    while (count > 0) {
+        uint32_t e = heap_pop(nav, &count);
+        //cluster we have to be in to take this door
+        uint32_t from   = nav->edges[nav->edges[e].reverse].to;
+        uint32_t degree = nav->edge_offsets[from + 1] - nav->edge_offsets[from];
+        uint32_t door   = e - nav->edge_offsets[from];
+        uint32_t cost   = nav->edge_cost[e] + 1;
+
+        //every edge into from arrives on the door of its reverse. Walking distances are symmetric,
+        //so read the row of this door instead of striding down its column
+        const uint8_t *matrix = &nav->door_matrix[nav->matrix_offsets[from] + door * degree];
+        for (uint32_t out = nav->edge_offsets[from]; out < nav->edge_offsets[from + 1]; out++) {
+            uint32_t in = nav->edges[out].reverse;
+            uint32_t d  = nav_distance(matrix[out - nav->edge_offsets[from]]);
+            if (d == NAV_NONE || nav->edge_cost[in] <= cost + d) continue;
+            if (nav->stamp[in] == generation && nav->heap_index[in] == NAV_CLOSED) continue;
+            if (nav->stamp[in] != generation) {
+                nav->stamp[in]      = generation;
+                nav->heap_index[in] = NAV_NONE;
+            }
+
+            nav->edge_cost[in] = cost + d;
+            nav->f[in]         = cost + d;
+            heap_push(nav, &count, in);
+        }
+    }
+    return true;
+}
+
+//! @brief: door out of the agent's cluster with the shortest walk to the target, NAV_NONE to walk straight there
+static bool nav_pick_route(nav_grid_t *nav, uint32_t cluster, uint32_t cell, uint32_t *route)
+{
+    uint32_t best = NAV_NONE;
+    *route = NAV_NONE;
+
+    if (cluster == nav->target_cluster) {
+        best = nav->target_distance[nav->cell_slot[cell]];
+    }
+
+    const uint8_t *distances = nav_cell_door_distances(nav, cluster, cell);
+    for (uint32_t out = nav->edge_offsets[cluster]; out < nav->edge_offsets[cluster + 1]; out++) {
+        uint32_t d = nav_distance(distances[out - nav->edge_offsets[cluster]]);
+        if (d == NAV_NONE || nav->edge_cost[out] == NAV_NONE) continue;
+
+        uint32_t cost = d + 1 + nav->edge_cost[out];
+        if (cost < best) {
+            best   = cost;
+            *route = out;
+        }
+    }
+    return best != NAV_NONE;
+}
+
+bool nav_next_step(nav_grid_t *nav, nav_agent_t *agent, vec2i_t from, vec2i_t *next)
+{
+    const dungeon_t *dungeon = nav->dungeon;
+    if (nav->target_cell == NAV_NONE || !nav_walkable(dungeon, from.x, from.y)) return false;
+
+    uint32_t cell   = (uint32_t)(from.y * dungeon->width + from.x);
+    uint32_t cluster = nav->cluster[cell];
+    if (cell == nav->target_cell) return false;
+
+    //a suffix of a shortest path is a shortest path, so the door stays right until the cluster or target changes
+    if (agent->cluster != cluster || agent->target_generation != nav->target_generation) {
+        if (!nav_pick_route(nav, cluster, cell, &agent->edge)) return false;
+        agent->cluster           = cluster;
+        agent->target_generation = nav->target_generation;
+    }
+
+    uint32_t step = cell;
+    if (agent->edge == NAV_NONE) {
+        //walk down the target cluster's distances
+        uint32_t d = nav->target_distance[nav->cell_slot[cell]];
+        int32_t x = from.x;
+        int32_t y = from.y;
+        for (uint32_t i = 0; i < 4; i++) {
+            int32_t nx = x + nav_neighbours[i].x;
+            int32_t ny = y + nav_neighbours[i].y;
+            if (!nav_walkable(dungeon, nx, ny)) continue;
+
+            uint32_t n = (uint32_t)(ny * dungeon->width + nx);
+            if (nav->cluster[n] == cluster && nav->target_distance[nav->cell_slot[n]] == d - 1) {
+                step = n;
+                break;
+            }
+        }
+    } else if (cell == nav->edges[agent->edge].cell_from) {
+        step = nav->edges[agent->edge].cell_to;
+    } else {
+        step = nav_step_to_door(nav, cluster, agent->edge - nav->edge_offsets[cluster], cell);
+    }
+
+    *next = nav_cell_to_vec2i(dungeon, step);
+    return step != cell;
+}
+
+void nav_grid_destroy(nav_grid_t *nav)
+{
+    if (nav->edge_offsets) memory_dealloc(nav->edge_offsets);
+    if (nav->edges) memory_dealloc(nav->edges);
+    if (nav->g) memory_dealloc(nav->g);
+    if (nav->f) memory_dealloc(nav->f);
+    if (nav->parent) memory_dealloc(nav->parent);
+    if (nav->stamp) memory_dealloc(nav->stamp);
+    if (nav->heap) memory_dealloc(nav->heap);
+    if (nav->heap_index) memory_dealloc(nav->heap_index);
+    if (nav->cluster) memory_dealloc(nav->cluster);
+    if (nav->cell_slot) memory_dealloc(nav->cell_slot);
+    if (nav->cluster_size) memory_dealloc(nav->cluster_size);
+    if (nav->door_offsets) memory_dealloc(nav->door_offsets);
+    if (nav->door_distance) memory_dealloc(nav->door_distance);
+    if (nav->edge_cost) memory_dealloc(nav->edge_cost);
+    if (nav->target_distance) memory_dealloc(nav->target_distance);
+    if (nav->matrix_offsets) memory_dealloc(nav->matrix_offsets);
+    if (nav->door_matrix) memory_dealloc(nav->door_matrix);
+    if (nav->edge_path) memory_dealloc(nav->edge_path);
+    memset(nav, 0, sizeof(*nav));
+}
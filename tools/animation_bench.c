@@ -0,0 +1,390 @@
+//! @brief: Samples synthetic clips of growing length and reports the cost of a tick with the per channel
+//          key cursor against a scan over every key, plus random seeks which take the binary search path.
+//          Then the cost of blending two full poses and of adding an additive pose onto one, and a full
+//          animation pass with its palette writes over many instances on one thread and on the job system,
+//          with the instances spread evenly over the LOD tiers, with nothing playing and playing a baked clip.
+//          usage: animation_bench [-c channels] [-t ticks] [-i instances]
+#include "core/memory/memory.c"
+#include "core/math/math_utils.c"
+#include "core/jobs/jobs.c"
+#include "systems/animation.c"
+#include "systems/animation_system.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_KEY_RATE  30.0f
+#define BENCH_TICK_RATE 60.0f
+#define BENCH_MAX_KEYS  512
+
+static double bench_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+//! @brief: channel_count channels over channel_count / 3 nodes, every sampler has key_count keys at BENCH_KEY_RATE
+//          and they all share one time array, like a clip exported at a fixed rate
+static void bench_build_clip(animation_t *animation, uint32_t channel_count, uint32_t key_count)
+{
+    //every third channel is a rotation with 4 floats a key, the rest have 3
+    uint32_t rotation_count = channel_count / 3 + (channel_count % 3 > 1 ? 1 : 0);
+    size_t floats_per_key = 1 + 3 * channel_count + rotation_count;
+    float *keys = animation_create_storage(animation, channel_count, channel_count, key_count * floats_per_key);
+    animation->start_time = 0.0f;
+    animation->end_time = (float)(key_count - 1) / BENCH_KEY_RATE;
+
+    float *inputs = keys;
+    for (uint32_t k = 0; k < key_count; k++) {
+        inputs[k] = (float)k / BENCH_KEY_RATE;
+    }
+    float *outputs = inputs + key_count;
+
+    for (uint32_t i = 0; i < channel_count; i++) {
+        animation_channel_t *channel = &animation->channels[i];
+        channel->path    = TRANSLATION + i % 3;
+        channel->node    = i / 3;
+        channel->sampler = i;
+
+        animation_sampler_t *sampler = &animation->samplers[i];
+        sampler->interpolation = LINEAR_INTERPOLATION;
+        sampler->components    = channel->path == ROTATION ? 4 : 3;
+        sampler->inputs        = inputs;
+        sampler->input_count   = key_count;
+        sampler->outputs       = outputs;
+        sampler->output_count  = key_count;
+
+        for (uint32_t k = 0; k < key_count; k++) {
+            float phase = (float)k * 0.37f + (float)i;
+            float *out = &outputs[k * sampler->components];
+            if (channel->path == ROTATION) {
+                out[0] = sinf(phase * 0.5f);
+                out[1] = 0.0f;
+                out[2] = 0.0f;
+                out[3] = cosf(phase * 0.5f);
+            } else {
+                out[0] = sinf(phase);
+                out[1] = cosf(phase);
+                out[2] = phase * 0.01f;
+            }
+        }
+        outputs += key_count * sampler->components;
+    }
+}
+
+//! @brief: the sampling loop before the cursor, every channel walks all of its keys on every tick
+static void bench_sample_scan(animation_t *animation, animation_pose_t *pose, float time)
+{
+    for (uint32_t i = 0; i < animation->channel_count; i++) {
+        animation_channel_t *channel = &animation->channels[i];
+        animation_sampler_t *sampler = &animation->samplers[channel->sampler];
+        uint32_t node = channel->node;
+
+        for (uint32_t j = 0; j < sampler->input_count - 1; j++) {
+            if (time < sampler->inputs[j] || time > sampler->inputs[j + 1]) continue;
+
+            float t = (time - sampler->inputs[j]) / (sampler->inputs[j + 1] - sampler->inputs[j]);
+            vec4f_t a = animation_sampler_get_output(sampler, j);
+            vec4f_t b = animation_sampler_get_output(sampler, j + 1);
+
+            if (channel->path == TRANSLATION) {
+                vec4f_t trans = vec4_lerp(a, b, t);
+                pose->translations[node] = (vec3f_t){trans.x, trans.y, trans.z};
+            } else if (channel->path == ROTATION) {
+                quat_t q1 = {.x = a.x, .y = a.y, .z = a.z, .w = a.w};
+                quat_t q2 = {.x = b.x, .y = b.y, .z = b.z, .w = b.w};
+                pose->rotations[node] = quat_normalize(quat_slerp(q1, q2, t));
+            } else if (channel->path == SCALE) {
+                vec4f_t scale = vec4_lerp(a, b, t);
+                pose->scales[node] = (vec3f_t){scale.x, scale.y, scale.z};
+            }
+        }
+    }
+}
+
+static float bench_pose_error(const animation_pose_t *a, const animation_pose_t *b, uint32_t node_count)
+{
+    float error = 0.0f;
+    for (uint32_t i = 0; i < node_count; i++) {
+        const float *x[3] = {(const float *)&a->translations[i], (const float *)&a->rotations[i], (const float *)&a->scales[i]};
+        const float *y[3] = {(const float *)&b->translations[i], (const float *)&b->rotations[i], (const float *)&b->scales[i]};
+        for (uint32_t j = 0; j < 3; j++) {
+            for (uint32_t k = 0; k < (j == 1 ? 4u : 3u); k++) {
+                float d = fabsf(x[j][k] - y[j][k]);
+                if (d > error) error = d;
+            }
+        }
+    }
+    return error;
+}
+
+static void bench_blend(uint32_t tick_count)
+{
+    animation_pose_t *a = memory_alloc(3 * sizeof(animation_pose_t), MEM_TAG_HEAP);
+    animation_pose_t *b = a + 1;
+    animation_pose_t *out = a + 2;
+    float weights[MAX_NODES_PER_MODEL];
+
+    srand(1);
+    for (uint32_t i = 0; i < MAX_NODES_PER_MODEL; i++) {
+        float phase = (float)rand() / (float)RAND_MAX;
+        a->translations[i] = (vec3f_t){phase, 1.0f, 0.0f};
+        b->translations[i] = (vec3f_t){0.0f, phase, 1.0f};
+        a->rotations[i] = (quat_t){.w = cosf(phase), .x = sinf(phase)};
+        b->rotations[i] = (quat_t){.w = cosf(phase), .y = sinf(phase)};
+        a->scales[i] = (vec3f_t){1.0f, 1.0f, 1.0f};
+        b->scales[i] = (vec3f_t){1.0f, 1.0f + phase, 1.0f};
+        weights[i] = phase;
+    }
+
+    double start = bench_now();
+    for (uint32_t i = 0; i < tick_count; i++) {
+        animation_pose_blend(out, a, b, weights, MAX_NODES_PER_MODEL);
+    }
+    double blend = bench_now() - start;
+
+    //out starts from a every time like a fresh base pose, the copy is part of the timing
+    start = bench_now();
+    for (uint32_t i = 0; i < tick_count; i++) {
+        *out = *a;
+        animation_pose_add(out, b, a, weights, MAX_NODES_PER_MODEL);
+    }
+    double add = bench_now() - start;
+
+    printf("%u nodes: blend %.1f ns/pose, additive %.1f ns/pose\n", MAX_NODES_PER_MODEL,
+           blend * 1e9 / tick_count, add * 1e9 / tick_count);
+}
+
+//! @brief: chain of node_count nodes that are all joints, playing clip on layer 0
+static void bench_build_skeleton(skeleton_t *skeleton, const animation_t *clip, uint32_t node_count)
+{
+    memset(skeleton, 0, sizeof(*skeleton));
+    skeleton->node_count = node_count;
+    for (uint32_t i = 0; i < node_count; i++) {
+        model_node_t *node = &skeleton->nodes[i];
+        node->index  = i;
+        node->parent = i == 0 ? UINT32_MAX : i - 1;
+        node->rotation = (quat_t){.w = 1.0f};
+        node->scale    = (vec3f_t){1.0f, 1.0f, 1.0f};
+        node->local_transform = affine_identity();
+        node->skin = UINT32_MAX;
+        node->mesh = UINT32_MAX;
+
+        skeleton->skin.joints[i] = (uint8_t)i;
+        skeleton->skin.inverse_bind_matrices[i] = affine_identity();
+        skeleton->leaf_nodes[i] = i == node_count - 1;
+    }
+    skeleton->skin.joint_count = node_count;
+    skeleton->animations[0]    = *clip;
+    skeleton->animation_count  = 1;
+}
+
+//! @brief: stand-in for the mapped palette buffers, one per frame in flight
+#define BENCH_FRAMES_IN_FLIGHT 2
+
+//! @brief: time of a tick plus a frame over instance_count instances, worker threads have to be started or not by
+//!         the caller. Adds the instances evaluated and the palettes written to the counters
+static double bench_pass(animation_system_t *system, animated_instance_t *instances, uint32_t instance_count,
+                         const skeleton_t *skeleton, const skinned_model_t *model, mat4f_t *palettes, uint32_t tick_count,
+                         uint64_t *evaluated, uint64_t *written)
+{
+    uint32_t joint_count = skeleton->skin.joint_count;
+    double start = bench_now();
+    for (uint32_t t = 0; t < tick_count; t++) {
+        animation_system_begin(system);
+        for (uint32_t i = 0; i < instance_count; i++) {
+            animation_system_add(system, &instances[i], skeleton);
+        }
+        animation_system_update(system, 1.0f / BENCH_TICK_RATE);
+
+        uint32_t frame = t % BENCH_FRAMES_IN_FLIGHT;
+        for (uint32_t i = 0; i < instance_count; i++) {
+            mat4f_t *palette = &palettes[((size_t)i * BENCH_FRAMES_IN_FLIGHT + frame) * joint_count];
+            animation_system_queue_palette(system, &instances[i], skeleton, model, palette, frame);
+        }
+        animation_system_write_palettes(system);
+
+        *evaluated += system->evaluated_count;
+        *written   += system->palettes_written;
+    }
+    return (bench_now() - start) / tick_count;
+}
+
+static void bench_instances(uint32_t channel_count, uint32_t instance_count, uint32_t tick_count)
+{
+    uint32_t node_count = (channel_count + 2) / 3;
+    animation_t clip = {0};
+    bench_build_clip(&clip, channel_count, 64);
+
+    skeleton_t *skeleton = memory_alloc(sizeof(skeleton_t), MEM_TAG_HEAP);
+    bench_build_skeleton(skeleton, &clip, node_count);
+
+    skinned_model_t model = {0};
+    animated_instance_t *instances = memory_alloc(instance_count * sizeof(animated_instance_t), MEM_TAG_HEAP);
+    mat4f_t *palettes = memory_alloc((size_t)instance_count * BENCH_FRAMES_IN_FLIGHT * node_count * sizeof(mat4f_t), MEM_TAG_HEAP);
+    for (uint32_t i = 0; i < instance_count; i++) {
+        animated_instance_init(&instances[i], &model, i, skeleton);
+        animated_instance_play(&instances[i], skeleton, 0, 0, 0.0f);
+        //spread the instances over the clip
+        animated_instance_update(&instances[i], skeleton, clip.end_time * (float)i / (float)instance_count);
+    }
+
+    animation_system_t system;
+    animation_system_init(&system);
+    uint64_t evaluated = 0;
+    uint64_t written   = 0;
+
+    //no workers yet, jobs_submit runs every batch inline
+    double serial = bench_pass(&system, instances, instance_count, skeleton, &model, palettes, tick_count, &evaluated, &written);
+    jobs_init(0);
+    double parallel = bench_pass(&system, instances, instance_count, skeleton, &model, palettes, tick_count, &evaluated, &written);
+
+    printf("%u instances of %u joints, %u batches: %.1f us/pass on one thread, %.1f us/pass on %u workers + main (%.1fx), "
+           "batches summed %.1f us\n", instance_count, node_count, system.batch_count, serial * 1e6, parallel * 1e6,
+           jobs_worker_count(), serial / parallel, system.total_batch_time / system.pass_count * 1e6);
+
+    for (uint32_t i = 0; i < instance_count; i++) {
+        animation_system_set_lod(&system, &instances[i], i % ANIMATION_LOD_COUNT);
+    }
+    evaluated = 0;
+    written   = 0;
+    double lod = bench_pass(&system, instances, instance_count, skeleton, &model, palettes, tick_count, &evaluated, &written);
+    printf("spread over %u LOD tiers: %.1f us/pass (%.1fx), %.1f instances evaluated and %.1f palettes written per pass\n",
+           ANIMATION_LOD_COUNT, lod * 1e6, parallel / lod, (double)evaluated / tick_count, (double)written / tick_count);
+
+    //nothing playing, the poses stay put and every buffer already holds its palette after the first frames
+    for (uint32_t i = 0; i < instance_count; i++) {
+        animated_instance_stop(&instances[i], 0);
+        animation_system_set_lod(&system, &instances[i], ANIMATION_LOD_FULL);
+    }
+    evaluated = 0;
+    written   = 0;
+    double still = bench_pass(&system, instances, instance_count, skeleton, &model, palettes, tick_count, &evaluated, &written);
+    printf("no clip playing: %.1f us/pass, %.1f palettes written per pass\n", still * 1e6, (double)written / tick_count);
+
+    //crowd: the clip baked at 30 Hz, every instance copies or lerps frames
+    if (!animation_bake(&model.baked_clips[0], skeleton, 0, 0, 30.0f)) {
+        LOGE("Unable to bake the bench clip");
+        return;
+    }
+    model.baked_clip_count = 1;
+    for (int interpolate = 0; interpolate < 2; interpolate++) {
+        for (uint32_t i = 0; i < instance_count; i++) {
+            animated_instance_play_baked(&instances[i], &model, skeleton, 0, interpolate);
+        }
+        evaluated = 0;
+        written   = 0;
+        double baked = bench_pass(&system, instances, instance_count, skeleton, &model, palettes, tick_count, &evaluated, &written);
+        printf("baked at 30 Hz, %s: %.1f us/pass (%.1fx), %.0f ns per instance, %u KB baked\n",
+               interpolate ? "lerped" : "nearest frame", baked * 1e6, parallel / baked, baked * 1e9 / instance_count,
+               (uint32_t)(model.baked_clips[0].frame_count * (node_count + 1) * sizeof(affine3x4_t) / 1024));
+    }
+    animation_baked_clip_destroy(&model.baked_clips[0]);
+
+    jobs_shutdown();
+    animation_system_destroy(&system);
+    animation_destroy(&clip);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t channel_count  = 60;
+    uint32_t tick_count     = 200000;
+    uint32_t instance_count = 256;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+            channel_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            tick_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            instance_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            LOGE("usage: %s [-c channels] [-t ticks] [-i instances]", argv[0]);
+            return 1;
+        }
+    }
+
+    if (channel_count < 3 || tick_count == 0 || channel_count > MAX_ANIMATION_CHANNEL_COUNT) {
+        LOGE("Need 3 to %u channels and one tick", MAX_ANIMATION_CHANNEL_COUNT);
+        return 1;
+    }
+
+    memory_init();
+
+    uint32_t node_count = (channel_count + 2) / 3;
+    animation_pose_t *pose      = memory_alloc(sizeof(animation_pose_t), MEM_TAG_HEAP);
+    animation_pose_t *reference = memory_alloc(sizeof(animation_pose_t), MEM_TAG_HEAP);
+    uint32_t *cursors      = memory_alloc(channel_count * sizeof(uint32_t), MEM_TAG_HEAP);
+    float *seeks = memory_alloc(tick_count * sizeof(float), MEM_TAG_HEAP);
+
+    printf("%u channels, %u ticks at %.0f Hz, keys at %.0f Hz\n", channel_count, tick_count, BENCH_TICK_RATE, BENCH_KEY_RATE);
+    printf("%6s %10s %14s %14s %14s %10s\n", "keys", "clip bytes", "scan ns/tick", "cursor ns/tick", "seek ns/tick", "max error");
+
+    for (uint32_t key_count = 8; key_count <= BENCH_MAX_KEYS; key_count *= 2) {
+        animation_t animation = {0};
+        bench_build_clip(&animation, channel_count, key_count);
+
+        float dt = 1.0f / BENCH_TICK_RATE;
+        srand(key_count);
+        for (uint32_t i = 0; i < tick_count; i++) {
+            seeks[i] = animation.end_time * (float)rand() / (float)RAND_MAX;
+        }
+
+        //scan
+        float time = 0.0f;
+        double start = bench_now();
+        for (uint32_t i = 0; i < tick_count; i++) {
+            time += dt;
+            if (time >= animation.end_time) time -= animation.end_time;
+            bench_sample_scan(&animation, reference, time);
+        }
+        double scan = bench_now() - start;
+
+        //cursor, also checked against the scan tick by tick on a second pass
+        time = 0.0f;
+        start = bench_now();
+        for (uint32_t i = 0; i < tick_count; i++) {
+            time += dt;
+            if (time >= animation.end_time) time -= animation.end_time;
+            animation_sample(&animation, time, cursors, pose);
+        }
+        double cursor = bench_now() - start;
+
+        float error = 0.0f;
+        memset(cursors, 0, channel_count * sizeof(uint32_t));
+        time = 0.0f;
+        for (uint32_t i = 0; i < tick_count && i < 10000; i++) {
+            time += dt;
+            if (time >= animation.end_time) time -= animation.end_time;
+            bench_sample_scan(&animation, reference, time);
+            animation_sample(&animation, time, cursors, pose);
+            float e = bench_pose_error(pose, reference, node_count);
+            if (e > error) error = e;
+        }
+
+        //random seeks
+        start = bench_now();
+        for (uint32_t i = 0; i < tick_count; i++) {
+            animation_sample(&animation, seeks[i], cursors, pose);
+        }
+        double seek = bench_now() - start;
+
+        printf("%6u %10zu %14.1f %14.1f %14.1f %10.2e\n", key_count, animation.data_size,
+               scan * 1e9 / tick_count, cursor * 1e9 / tick_count, seek * 1e9 / tick_count, error);
+
+        animation_destroy(&animation);
+    }
+
+    bench_blend(tick_count);
+    if (instance_count > 0) {
+        bench_instances(channel_count, instance_count, MAX(tick_count / 1000, 1));
+    }
+
+    memory_uninit();
+    return 0;
+}
@@ -0,0 +1,121 @@
+//! @brief: Loads every clip of a glTF file exactly and compressed, then prints key counts, sizes and the max error
+//          of the compressed clip against the raw glTF keys.
+//          usage: animation_report <file.gltf|file.glb> [-r radians] [-t translation] [-s scale] [-float] [-linear]
+#include "core/memory/memory.c"
+#include "core/math/math_utils.c"
+#include "core/string/string.c"
+#include "core/utils/utils.c"
+#include "core/asset_store/json_loader.c"
+#include "systems/animation.c"
+#include "systems/animation_compression.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t report_key_count(const animation_t *animation)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < animation->sampler_count; i++) {
+        count += animation->samplers[i].input_count;
+    }
+    return count;
+}
+
+static uint32_t report_cubic_count(const animation_t *animation)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < animation->sampler_count; i++) {
+        count += animation->samplers[i].interpolation == CUBIC_SPLINE_INTERPOLATION;
+    }
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    animation_compression_config_t config = animation_compression_default_config();
+    const char *path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            config.rotation_tolerance = strtof(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            config.translation_tolerance = strtof(argv[++i], NULL);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            config.scale_tolerance = strtof(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-float") == 0) {
+            config.quantize = false;
+        } else if (strcmp(argv[i], "-linear") == 0) {
+            config.allow_cubic = false;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+
+    if (!path) {
+        LOGE("usage: %s <file.gltf|file.glb> [-r radians] [-t translation] [-s scale] [-float] [-linear]", argv[0]);
+        return 1;
+    }
+
+    memory_init();
+
+    gltf_model_t *gltf_model = model_load_from_gltf(path, path);
+    if (!gltf_model) {
+        LOGE("Unable to load gltf file: %s", path);
+        memory_uninit();
+        return 1;
+    }
+
+    printf("%s: %u clips, tolerance %g rad %g translation %g scale, %s, %s\n", path, gltf_model->animation_count,
+           config.rotation_tolerance, config.translation_tolerance, config.scale_tolerance,
+           config.quantize ? "quantized" : "float", config.allow_cubic ? "cubic fits" : "linear only");
+    printf("%4s %8s %9s %9s %10s %10s %7s %7s %10s %12s %10s\n", "clip", "channels", "raw keys", "keys", "raw bytes",
+           "bytes", "ratio", "cubic", "rot deg", "translation", "scale");
+
+    size_t total_raw = 0;
+    size_t total_compressed = 0;
+    animation_error_t worst = {0};
+
+    for (uint32_t i = 0; i < gltf_model->animation_count; i++) {
+        animation_t raw = {0};
+        animation_t compressed = {0};
+        if (!animation_create_from_gltf(&raw, gltf_model, i, NULL)) {
+            LOGE("Unable to load clip %u", i);
+            continue;
+        }
+        if (!animation_compress(&raw, &config, &compressed)) {
+            LOGE("Unable to compress clip %u", i);
+            animation_destroy(&raw);
+            continue;
+        }
+
+        animation_error_t error;
+        animation_measure_error(&raw, &compressed, &error);
+        worst.rotation    = MAX(worst.rotation, error.rotation);
+        worst.translation = MAX(worst.translation, error.translation);
+        worst.scale       = MAX(worst.scale, error.scale);
+        total_raw        += raw.data_size;
+        total_compressed += compressed.data_size;
+
+        printf("%4u %8u %9u %9u %10zu %10zu %6.1fx %7u %10.4f %12.5f %10.5f\n", i, raw.channel_count,
+               report_key_count(&raw), report_key_count(&compressed), raw.data_size, compressed.data_size,
+               (double)raw.data_size / (double)compressed.data_size, report_cubic_count(&compressed),
+               error.rotation * 180.0 / PI, error.translation, error.scale);
+
+        animation_destroy(&compressed);
+        animation_destroy(&raw);
+    }
+
+    if (total_compressed) {
+        printf("%4s %8s %9s %9s %10zu %10zu %6.1fx %7s %10.4f %12.5f %10.5f\n", "all", "", "", "", total_raw, total_compressed,
+               (double)total_raw / (double)total_compressed, "", worst.rotation * 180.0 / PI, worst.translation, worst.scale);
+    }
+
+    model_release_gltf(gltf_model);
+    memory_uninit();
+    return 0;
+}
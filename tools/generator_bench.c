@@ -0,0 +1,267 @@
+//! @brief: Generates a batch of dungeons on every core and reports throughput, latency and peak memory.
+//          Nothing is written to disk, the maps only live in per worker buffers. -tilemap writes the first map to
+//          path raw and run length encoded and checks that tilemap_open reads back the same tiles and regions.
+//          usage: generator_bench [-n maps] [-s size] [-r rooms] [-seed first_seed] [-score] [-tilemap path]
+#include "core/memory/memory.c"
+#include "core/utils/utils.c"
+#include "core/random/generator.c"
+#include "core/random/tilemap.c"
+#include "core/jobs/jobs.c"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+typedef struct
+{
+    double   seconds;
+    double   floor_ratio;
+    double   connectivity;
+    uint32_t region_count;
+    bool     success;
+} map_result_t;
+
+typedef struct
+{
+    dungeon_config_t config;
+    uint32_t         map_count;
+    bool             score;
+    atomic_uint      next_map;
+    map_result_t    *results;
+} bench_t;
+
+//! @brief: everything a worker touches, allocated up front on the main thread
+typedef struct
+{
+    bench_t  *bench;
+    dungeon_t dungeon;
+    void     *scratch;
+    size_t    scratch_size;
+    uint32_t *stack;
+    uint8_t  *visited;
+} bench_worker_t;
+
+static double bench_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+//! @brief: fraction of floor tiles reachable from the first one
+static double bench_connectivity(bench_worker_t *worker, uint32_t floor_count)
+{
+    dungeon_t *d = &worker->dungeon;
+    uint32_t cell_count = (uint32_t)d->width * (uint32_t)d->height;
+
+    uint32_t start = 0;
+    while (start < cell_count && d->tiles[start] != FLOOR) start++;
+    if (start == cell_count) return 0.0;
+
+    memset(worker->visited, 0, cell_count);
+    uint32_t top = 0;
+    uint32_t reached = 0;
+    worker->stack[top++] = start;
+    worker->visited[start] = 1;
+
+    while (top > 0) {
+        uint32_t cell = worker->stack[--top];
+        int32_t row = (int32_t)(cell / (uint32_t)d->width);
+        int32_t col = (int32_t)(cell % (uint32_t)d->width);
+        reached++;
+
+        for (uint32_t i = 0; i < 4; i++) {
+            int32_t r = row + cardinal[i].y;
+            int32_t c = col + cardinal[i].x;
+            if (r < 0 || r >= d->height || c < 0 || c >= d->width) continue;
+
+            uint32_t next = (uint32_t)(r * d->width + c);
+            if (!worker->visited[next] && d->tiles[next] == FLOOR) {
+                worker->visited[next] = 1;
+                worker->stack[top++] = next;
+            }
+        }
+    }
+    return (double)reached / (double)floor_count;
+}
+
+static void bench_worker(void *data)
+{
+    bench_worker_t *worker = (bench_worker_t *)data;
+    bench_t *bench = worker->bench;
+
+    for (;;) {
+        uint32_t index = atomic_fetch_add(&bench->next_map, 1);
+        if (index >= bench->map_count) break;
+
+        dungeon_config_t config = bench->config;
+        config.seed += index;
+
+        map_result_t *result = &bench->results[index];
+        double start = bench_now();
+        result->success = dungeon_generate(&worker->dungeon, &config, worker->scratch, worker->scratch_size);
+        result->seconds = bench_now() - start;
+        result->region_count = worker->dungeon.region_count;
+
+        if (bench->score && result->success) {
+            uint32_t cell_count = (uint32_t)config.width * (uint32_t)config.height;
+            uint32_t floor_count = 0;
+            for (uint32_t i = 0; i < cell_count; i++) floor_count += worker->dungeon.tiles[i] == FLOOR;
+
+            result->floor_ratio  = (double)floor_count / (double)cell_count;
+            result->connectivity = bench_connectivity(worker, floor_count);
+        }
+    }
+}
+
+//! @brief: writes the map both ways, reads it back through tilemap_open and compares every cell
+static bool bench_tilemap_round_trip(const dungeon_t *dungeon, const char *path)
+{
+    uint64_t cell_count = (uint64_t)dungeon->width * (uint64_t)dungeon->height;
+    for (uint32_t i = 0; i < 2; i++) {
+        bool compress = i == 1;
+        double start = bench_now();
+        if (!tilemap_write(dungeon, path, compress)) return false;
+        double written = bench_now();
+
+        tilemap_t map;
+        if (!tilemap_open(&map, path)) return false;
+        double opened = bench_now();
+
+        bool same = map.width == dungeon->width && map.height == dungeon->height &&
+                    map.region_count == dungeon->region_count &&
+                    memcmp(map.tiles, dungeon->tiles, cell_count) == 0 &&
+                    memcmp(map.regions, dungeon->regions, cell_count * sizeof(uint32_t)) == 0;
+        printf("tilemap      %s, write %.3f ms, open %.3f ms, %.1f KB, %s\n", compress ? "rle" : "raw",
+               (written - start) * 1000.0, (opened - written) * 1000.0, map.file.size / 1024.0,
+               same ? "round trip ok" : "round trip differs");
+        tilemap_close(&map);
+        if (!same) return false;
+    }
+    return true;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[])
+{
+    bench_t bench = {0};
+    bench.map_count         = 1000;
+    bench.config.width      = 127;
+    bench.config.height     = 127;
+    bench.config.room_count = 50;
+    bench.config.seed       = 1;
+    const char *tilemap_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-score") == 0) {
+            bench.score = true;
+        } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            bench.map_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            bench.config.width = bench.config.height = (int32_t)strtol(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            bench.config.room_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-seed") == 0) {
+            bench.config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-tilemap") == 0) {
+            tilemap_path = argv[++i];
+        } else {
+            LOGE("usage: %s [-n maps] [-s size] [-r rooms] [-seed first_seed] [-score] [-tilemap path]", argv[0]);
+            return 1;
+        }
+    }
+
+    if (bench.map_count == 0 || bench.config.width < 13) {
+        LOGE("Need at least one map of at least 13x13 tiles");
+        return 1;
+    }
+
+    memory_init();
+    jobs_init(0);
+
+    //the main thread helps out in jobs_wait, so there is one worker per core
+    uint32_t worker_count = jobs_worker_count() + 1;
+    uint32_t cell_count   = (uint32_t)bench.config.width * (uint32_t)bench.config.height;
+
+    bench.results = memory_alloc(bench.map_count * sizeof(map_result_t), MEM_TAG_HEAP);
+    bench_worker_t *workers = memory_alloc(worker_count * sizeof(bench_worker_t), MEM_TAG_HEAP);
+
+    for (uint32_t i = 0; i < worker_count; i++) {
+        bench_worker_t *worker = &workers[i];
+        worker->bench           = &bench;
+        worker->dungeon.tiles   = memory_alloc(cell_count, MEM_TAG_HEAP);
+        worker->dungeon.regions = memory_alloc(cell_count * sizeof(uint32_t), MEM_TAG_HEAP);
+        worker->scratch_size    = dungeon_scratch_size(bench.config.width, bench.config.height);
+        worker->scratch         = memory_alloc((uint32_t)worker->scratch_size, MEM_TAG_HEAP);
+        if (bench.score) {
+            worker->stack   = memory_alloc(cell_count * sizeof(uint32_t), MEM_TAG_HEAP);
+            worker->visited = memory_alloc(cell_count, MEM_TAG_HEAP);
+        }
+    }
+
+    job_counter_t counter = {0};
+    double start = bench_now();
+    for (uint32_t i = 0; i < worker_count; i++) {
+        jobs_submit(bench_worker, &workers[i], &counter);
+    }
+    jobs_wait(&counter);
+    double elapsed = bench_now() - start;
+
+    double *times = memory_alloc(bench.map_count * sizeof(double), MEM_TAG_HEAP);
+    uint32_t failed = 0;
+    double floor_sum = 0.0, connectivity_min = 1.0;
+    uint64_t region_sum = 0;
+
+    for (uint32_t i = 0; i < bench.map_count; i++) {
+        map_result_t *result = &bench.results[i];
+        times[i] = result->seconds;
+        if (!result->success) {
+            failed++;
+            continue;
+        }
+        region_sum += result->region_count;
+        floor_sum  += result->floor_ratio;
+        if (result->connectivity < connectivity_min) connectivity_min = result->connectivity;
+    }
+    qsort(times, bench.map_count, sizeof(double), compare_double);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    uint32_t succeeded = bench.map_count - failed;
+    printf("maps         %u (%u failed) of %dx%d, %u rooms, %u threads\n",
+           bench.map_count, failed, bench.config.width, bench.config.height, bench.config.room_count, worker_count);
+    printf("throughput   %.1f maps/sec\n", (double)bench.map_count / elapsed);
+    printf("per map      p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           times[bench.map_count / 2] * 1000.0,
+           times[(uint32_t)((bench.map_count - 1) * 0.99)] * 1000.0,
+           times[bench.map_count - 1] * 1000.0);
+    printf("peak memory  %.1f MB\n", (double)usage.ru_maxrss / 1024.0);
+    if (succeeded > 0) {
+        printf("regions      %.1f avg\n", (double)region_sum / succeeded);
+    }
+    if (bench.score && succeeded > 0) {
+        printf("floor ratio  %.3f avg\n", floor_sum / succeeded);
+        printf("connectivity %.3f min\n", connectivity_min);
+    }
+
+    //the workers are done, the first one's buffers take the first map again
+    bool round_trip = true;
+    if (tilemap_path) {
+        dungeon_t *dungeon = &workers[0].dungeon;
+        round_trip = dungeon_generate(dungeon, &bench.config, workers[0].scratch, workers[0].scratch_size) &&
+                     bench_tilemap_round_trip(dungeon, tilemap_path);
+        if (!round_trip) LOGE("Tilemap round trip through %s failed", tilemap_path);
+    }
+
+    jobs_shutdown();
+    memory_uninit();
+    return failed > 0 || !round_trip;
+}
@@ -0,0 +1,149 @@
+//! @brief: Times model_load_from_gltf on a .gltf or .glb and prints the arena memory it took and the process'
+//          peak resident size, run it once per file to compare the two paths. -p packs a .gltf with one buffer
+//          into a .glb first, images stay external so the .glb has to be written next to the .gltf.
+//          usage: gltf_load_report <file.gltf|file.glb> [-n runs] [-p out.glb]
+#include "core/memory/memory.c"
+#include "core/math/math_utils.c"
+#include "core/string/string.c"
+#include "core/utils/utils.c"
+#include "core/asset_store/json_loader.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+static double report_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static bool report_write_chunk(FILE *file, uint32_t type, const void *data, uint32_t size, uint8_t pad)
+{
+    uint32_t padded = (size + 3) & ~3u;
+    glb_chunk_t chunk = {padded, type};
+    bool ok = fwrite(&chunk, sizeof(chunk), 1, file) == 1 && fwrite(data, 1, size, file) == size;
+    for (uint32_t i = size; ok && i < padded; i++) {
+        ok = fputc(pad, file) != EOF;
+    }
+    return ok;
+}
+
+//! @brief: the JSON of gltf_path with the uri of its only buffer dropped, followed by that buffer as the BIN chunk
+static bool report_pack_glb(const char *gltf_path, const char *glb_path)
+{
+    long json_size;
+    uint8_t *json_data = read_whole_file(gltf_path, &json_size, MEM_TAG_TEMP);
+    cJSON *root = json_data ? cJSON_ParseWithLength((const char *)json_data, (size_t)json_size) : NULL;
+    if (!root) {
+        LOGE("Unable to parse %s", gltf_path);
+        return false;
+    }
+
+    cJSON *buffers = cJSON_GetObjectItem(root, "buffers");
+    cJSON *buffer  = cJSON_GetArrayItem(buffers, 0);
+    const char *uri = cJSON_GetStringValue(cJSON_GetObjectItem(buffer, "uri"));
+    if (cJSON_GetArraySize(buffers) != 1 || !uri) {
+        LOGE("%s needs exactly one external buffer to be packed", gltf_path);
+        cJSON_Delete(root);
+        return false;
+    }
+
+    long bin_size;
+    const char *bin_path = string_concatenate(string_get_file_directory(gltf_path, MEM_TAG_TEMP), uri, MEM_TAG_TEMP);
+    uint8_t *bin = read_whole_file(bin_path, &bin_size, MEM_TAG_TEMP);
+    if (!bin) {
+        cJSON_Delete(root);
+        return false;
+    }
+    cJSON_DeleteItemFromObject(buffer, "uri");
+
+    char *json = cJSON_PrintUnformatted(root);
+    uint32_t json_length = (uint32_t)strlen(json);
+    glb_header_t header = {GLB_MAGIC, 2, 0};
+    header.length = sizeof(glb_header_t) + 2 * sizeof(glb_chunk_t) + ((json_length + 3) & ~3u) + (((uint32_t)bin_size + 3) & ~3u);
+
+    FILE *file = fopen(glb_path, "wb");
+    bool ok = file && fwrite(&header, sizeof(header), 1, file) == 1 &&
+              report_write_chunk(file, GLB_CHUNK_JSON, json, json_length, ' ') &&
+              report_write_chunk(file, GLB_CHUNK_BIN, bin, (uint32_t)bin_size, 0);
+    if (file) fclose(file);
+    if (!ok) LOGE("Unable to write %s", glb_path);
+
+    cJSON_free(json);
+    cJSON_Delete(root);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path      = NULL;
+    const char *pack_path = NULL;
+    uint32_t run_count    = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            run_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (i + 1 < argc && strcmp(argv[i], "-p") == 0) {
+            pack_path = argv[++i];
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path || run_count == 0) {
+        LOGE("usage: %s <file.gltf|file.glb> [-n runs] [-p out.glb]", argv[0]);
+        return 1;
+    }
+
+    memory_init();
+
+    if (pack_path) {
+        if (!report_pack_glb(path, pack_path)) {
+            memory_uninit();
+            return 1;
+        }
+        printf("packed %s into %s\n", path, pack_path);
+        memory_uninit();
+        return 0;
+    }
+
+    double best  = 1e30;
+    double total = 0.0;
+    uint32_t arena_bytes = 0;
+    uint64_t buffer_bytes = 0;
+    for (uint32_t i = 0; i < run_count; i++) {
+        memory_begin(MEM_TAG_TEMP);
+        double start = report_now();
+        gltf_model_t *gltf_model = model_load_from_gltf(path, path);
+        double time = report_now() - start;
+        if (!gltf_model) {
+            LOGE("Unable to load %s", path);
+            memory_uninit();
+            return 1;
+        }
+
+        best   = MIN(best, time);
+        total += time;
+        arena_bytes   = (uint32_t)gltf_model->arena.used;
+        buffer_bytes = 0;
+        for (uint32_t j = 0; j < gltf_model->buffer_count; j++) {
+            buffer_bytes += gltf_model->buffers[j].size;
+        }
+        model_release_gltf(gltf_model);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%s: %.3f ms best, %.3f ms mean over %u loads, %.1f KB of buffers, %.1f KB arena memory, "
+           "%ld KB peak resident\n", path, best * 1e3, total / run_count * 1e3, run_count, buffer_bytes / 1024.0,
+           arena_bytes / 1024.0, usage.ru_maxrss);
+
+    memory_uninit();
+    return 0;
+}
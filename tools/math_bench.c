@@ -0,0 +1,275 @@
+//! @brief: Times the SIMD math kernels against the scalar versions they replaced, and the affine kernels
+//          against their mat4 counterparts, and reports the largest difference. usage: math_bench [-r rounds]
+#include "core/math/math_utils.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_COUNT 1024
+
+static mat4a_t bench_a[BENCH_COUNT];
+static mat4a_t bench_b[BENCH_COUNT];
+static mat4a_t bench_out[BENCH_COUNT];
+static mat4a_t bench_reference[BENCH_COUNT];
+
+static affine3x4_t bench_affine_a[BENCH_COUNT];
+static affine3x4_t bench_affine_b[BENCH_COUNT];
+static affine3x4_t bench_affine_out[BENCH_COUNT];
+
+static quat_t  bench_qa[BENCH_COUNT];
+static quat_t  bench_qb[BENCH_COUNT];
+static quat_t  bench_qout[BENCH_COUNT];
+static quat_t  bench_qreference[BENCH_COUNT];
+static float   bench_t[BENCH_COUNT];
+static vec3f_t bench_translation[BENCH_COUNT];
+static vec3f_t bench_scale[BENCH_COUNT];
+
+static double bench_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static float bench_random(void)
+{
+    return (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static quat_t bench_random_quat(void)
+{
+    quat_t q = {bench_random(), bench_random(), bench_random(), bench_random()};
+    return quat_normalize(q);
+}
+
+//! @brief: mat4_multiply before the SIMD kernels
+static void reference_mat4_multiply(const mat4f_t *a, const mat4f_t *b, mat4f_t *out)
+{
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            out->m[i][j] = a->m[i][0] * b->m[0][j] + a->m[i][1] * b->m[1][j] + a->m[i][2] * b->m[2][j] + a->m[i][3] * b->m[3][j];
+        }
+    }
+}
+
+//! @brief: transform_from_TRS before the direct composition, three matrices and three multiplies
+static void reference_transform_from_TRS(mat4f_t *transform, vec3f_t translation, quat_t rotation, vec3f_t scale)
+{
+    mat4f_t scale_mat = mat4_scale(scale.x, scale.y, scale.z);
+    mat4f_t rot_mat = mat4_rotate_w_quat(rotation);
+    mat4f_t trans_mat = mat4_translate(translation.x, translation.y, translation.z);
+
+    mat4f_t scaled = {0};
+    mat4f_t rotated = {0};
+    mat4f_t temp = *transform;
+
+    reference_mat4_multiply(&temp, &scale_mat, &scaled);
+    reference_mat4_multiply(&scaled, &rot_mat, &rotated);
+    reference_mat4_multiply(&rotated, &trans_mat, transform);
+}
+
+static float bench_mat4_error(const mat4a_t *a, const mat4a_t *b)
+{
+    float error = 0.0f;
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        const float *x = &a[i].m[0][0];
+        const float *y = &b[i].m[0][0];
+        for (uint32_t j = 0; j < 16; j++) {
+            float d = fabsf(x[j] - y[j]);
+            if (d > error) error = d;
+        }
+    }
+    return error;
+}
+
+//! @brief: q and -q are the same rotation
+static float bench_quat_error(const quat_t *a, const quat_t *b)
+{
+    float error = 0.0f;
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        float sign = quat_dot(a[i], b[i]) < 0.0f ? -1.0f : 1.0f;
+        float d = fmaxf(fmaxf(fabsf(a[i].w - sign * b[i].w), fabsf(a[i].x - sign * b[i].x)),
+                        fmaxf(fabsf(a[i].y - sign * b[i].y), fabsf(a[i].z - sign * b[i].z)));
+        if (d > error) error = d;
+    }
+    return error;
+}
+
+//! @brief: affine results against full mat4 results
+static float bench_affine_error(const affine3x4_t *a, const mat4a_t *b)
+{
+    float error = 0.0f;
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        mat4f_t m;
+        affine_to_mat4(&a[i], &m);
+        for (uint32_t j = 0; j < 16; j++) {
+            float d = fabsf((&m.m[0][0])[j] - (&b[i].m[0][0])[j]);
+            if (d > error) error = d;
+        }
+    }
+    return error;
+}
+
+static void bench_report(const char *name, double reference, double simd, float error)
+{
+    printf("%-18s %10.2f %10.2f %8.2fx %10.2e\n", name, reference, simd, reference / simd, error);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rounds = 2000;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            rounds = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else {
+            LOGE("usage: %s [-r rounds]", argv[0]);
+            return 1;
+        }
+    }
+    if (rounds == 0) rounds = 1;
+
+    srand(1);
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        float *a = &bench_a[i].m[0][0];
+        float *b = &bench_b[i].m[0][0];
+        for (uint32_t j = 0; j < 16; j++) {
+            a[j] = bench_random();
+            b[j] = bench_random();
+        }
+        bench_qa[i] = bench_random_quat();
+        bench_qb[i] = bench_random_quat();
+        bench_t[i]  = (bench_random() + 1.0f) * 0.5f;
+        bench_translation[i] = (vec3f_t){bench_random(), bench_random(), bench_random()};
+        bench_scale[i]       = (vec3f_t){1.0f + bench_random() * 0.5f, 1.0f + bench_random() * 0.5f, 1.0f + bench_random() * 0.5f};
+    }
+    //every fourth pair nearly parallel, so the lerp fallback lanes get exercised
+    for (uint32_t i = 0; i < BENCH_COUNT; i += 4) {
+        bench_qb[i] = quat_normalize((quat_t){bench_qa[i].w + 0.001f, bench_qa[i].x, bench_qa[i].y, bench_qa[i].z});
+    }
+
+    mat4f_t *a         = (mat4f_t *)bench_a;
+    mat4f_t *b         = (mat4f_t *)bench_b;
+    mat4f_t *out       = (mat4f_t *)bench_out;
+    mat4f_t *reference = (mat4f_t *)bench_reference;
+    double ops = (double)rounds * BENCH_COUNT;
+    double start, scalar_time, simd_time;
+
+    printf("%s kernels, %u rounds of %u\n", MATH_SIMD_NAME, rounds, BENCH_COUNT);
+    printf("%-18s %10s %10s %9s %10s\n", "ns per op", "scalar", "simd", "speedup", "max error");
+
+    //mat4 multiply
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) reference_mat4_multiply(&a[i], &b[i], &reference[i]);
+    }
+    scalar_time = bench_now() - start;
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) mat4_multiply(&a[i], &b[i], &out[i]);
+    }
+    simd_time = bench_now() - start;
+    bench_report("mat4_multiply", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_mat4_error(bench_out, bench_reference));
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        mat4_multiply_n(a, b, out, BENCH_COUNT);
+    }
+    simd_time = bench_now() - start;
+    bench_report("mat4_multiply_n", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_mat4_error(bench_out, bench_reference));
+
+    //TRS composition, identity node matrix as for nodes that carry TRS
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+            reference[i] = mat4_identity();
+            reference_transform_from_TRS(&reference[i], bench_translation[i], bench_qa[i], bench_scale[i]);
+        }
+    }
+    scalar_time = bench_now() - start;
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+            out[i] = mat4_identity();
+            transform_from_TRS(&out[i], bench_translation[i], bench_qa[i], bench_scale[i]);
+        }
+    }
+    simd_time = bench_now() - start;
+    bench_report("transform_from_TRS", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_mat4_error(bench_out, bench_reference));
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+            mat4_from_TRS(&out[i], bench_translation[i], bench_qa[i], bench_scale[i]);
+        }
+    }
+    simd_time = bench_now() - start;
+    bench_report("mat4_from_TRS", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_mat4_error(bench_out, bench_reference));
+
+    //affine against mat4, on TRS transforms so the inverse is well conditioned
+    for (uint32_t i = 0; i < BENCH_COUNT; i++) {
+        mat4_from_TRS(&a[i], bench_translation[i], bench_qa[i], bench_scale[i]);
+        mat4_from_TRS(&b[i], bench_translation[BENCH_COUNT - 1 - i], bench_qb[i], bench_scale[BENCH_COUNT - 1 - i]);
+        affine_from_mat4(&a[i], &bench_affine_a[i]);
+        affine_from_mat4(&b[i], &bench_affine_b[i]);
+    }
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        mat4_multiply_n(a, b, reference, BENCH_COUNT);
+    }
+    scalar_time = bench_now() - start;
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        affine_multiply_n(bench_affine_a, bench_affine_b, bench_affine_out, BENCH_COUNT);
+    }
+    simd_time = bench_now() - start;
+    bench_report("affine_multiply_n", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_affine_error(bench_affine_out, bench_reference));
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) mat4_inverse(&a[i], &reference[i]);
+    }
+    scalar_time = bench_now() - start;
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) affine_inverse(&bench_affine_a[i], &bench_affine_out[i]);
+    }
+    simd_time = bench_now() - start;
+    bench_report("affine_inverse", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_affine_error(bench_affine_out, bench_reference));
+
+    //quaternion blends
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) bench_qreference[i] = quat_nlerp(bench_qa[i], bench_qb[i], bench_t[i]);
+    }
+    scalar_time = bench_now() - start;
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        quat_nlerp_n(bench_qa, bench_qb, bench_t, bench_qout, BENCH_COUNT);
+    }
+    simd_time = bench_now() - start;
+    bench_report("quat_nlerp_n", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_quat_error(bench_qout, bench_qreference));
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < BENCH_COUNT; i++) bench_qreference[i] = quat_slerp(bench_qa[i], bench_qb[i], bench_t[i]);
+    }
+    scalar_time = bench_now() - start;
+
+    start = bench_now();
+    for (uint32_t r = 0; r < rounds; r++) {
+        quat_slerp_n(bench_qa, bench_qb, bench_t, bench_qout, BENCH_COUNT);
+    }
+    simd_time = bench_now() - start;
+    bench_report("quat_slerp_n", scalar_time * 1e9 / ops, simd_time * 1e9 / ops, bench_quat_error(bench_qout, bench_qreference));
+
+    return 0;
+}
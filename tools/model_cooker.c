@@ -0,0 +1,167 @@
+//! @brief: Cooks a skinned glTF model into the .skm the asset store maps at runtime, see cooked_model.h. -c compresses
+//          the clips with the default animation compression. -n loads both files that many times and prints the CPU
+//          side of each load path, everything up to the GPU upload, which reads the vertices and pixels once.
+//          usage: model_cooker <file.gltf|file.glb> <out.skm> [-c] [-n runs]
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+#undef STB_IMAGE_IMPLEMENTATION
+
+#include "core/memory/memory.c"
+#include "core/math/math_utils.c"
+#include "core/string/string.c"
+#include "core/utils/utils.c"
+#include "core/asset_store/json_loader.c"
+#include "systems/animation.c"
+#include "systems/animation_compression.c"
+#include "core/asset_store/skeleton.c"
+#include "core/asset_store/cooked_model.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static double cooker_now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+//! @brief: stands in for the upload, which reads every byte once
+static uint64_t cooker_touch(const void *data, size_t size)
+{
+    const uint64_t *words = (const uint64_t *)data;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size / sizeof(uint64_t); i++) {
+        sum += words[i];
+    }
+    return sum;
+}
+
+static uint64_t cooker_load_gltf(const char *path, const animation_compression_config_t *compression, skeleton_t *skeleton)
+{
+    gltf_model_t *gltf_model = model_load_from_gltf(path, path);
+    if (!gltf_model) return 0;
+
+    uint64_t sum = 0;
+    uint32_t *remap = memory_alloc(MAX(gltf_model->node_count, 1) * sizeof(uint32_t), MEM_TAG_TEMP);
+    uint32_t joint_table[MAX_BONES_PER_SKIN] = {0};
+    if (skeleton_create(skeleton, gltf_model, compression, remap)) {
+        if (skeleton_build_joint_table(skeleton, gltf_model, remap, joint_table)) {
+            uint32_t images[MAX_TEXTURES_PER_MODEL] = {0};
+            material_t materials[MAX_MATERIALS_PER_MODEL];
+            mesh_t mesh;
+            skinned_geometry_t geometry;
+            model_load_materials(gltf_model, images, materials);
+            model_load_skinned_geometry(gltf_model, joint_table, &mesh, &geometry);
+            sum += cooker_touch(geometry.vertices, geometry.vertex_count * sizeof(skinned_vertex_t));
+            sum += cooker_touch(geometry.indices, geometry.index_count * sizeof(uint32_t));
+        }
+        for (uint32_t i = 0; i < gltf_model->image_count; i++) {
+            int w, h, channels;
+            stbi_uc *pixels = gltf_model->image_paths[i] ? stbi_load(gltf_model->image_paths[i], &w, &h, &channels, 4) : NULL;
+            if (pixels) {
+                sum += cooker_touch(pixels, (size_t)w * h * 4);
+                stbi_image_free(pixels);
+            }
+        }
+        skeleton_destroy(skeleton);
+    }
+    model_release_gltf(gltf_model);
+    return sum;
+}
+
+static uint64_t cooker_load_cooked(const char *path, skeleton_t *skeleton)
+{
+    cooked_model_t cooked;
+    if (!cooked_model_open(&cooked, path)) return 0;
+
+    uint64_t sum = 0;
+    if (skeleton_create_cooked(skeleton, &cooked)) {
+        const cooked_model_header_t *header = cooked.header;
+        sum += cooker_touch(cooked.vertices, header->vertex_count * sizeof(skinned_vertex_t));
+        sum += cooker_touch(cooked.indices, header->index_count * sizeof(uint32_t));
+        for (uint32_t i = 0; i < header->image_count; i++) {
+            if (cooked.images[i].format == COOKED_IMAGE_RGBA8) {
+                sum += cooker_touch(cooked_model_image_data(&cooked, i), cooked.images[i].size);
+            }
+        }
+        skeleton_destroy(skeleton);
+    }
+    cooked_model_close(&cooked);
+    return sum;
+}
+
+int main(int argc, char *argv[])
+{
+    animation_compression_config_t compression = {0};
+    const char *path     = NULL;
+    const char *out_path = NULL;
+    uint32_t run_count   = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            compression = animation_compression_default_config();
+        } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            run_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else if (!out_path && argv[i][0] != '-') {
+            out_path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (!path || !out_path) {
+        LOGE("usage: %s <file.gltf|file.glb> <out.skm> [-c] [-n runs]", argv[0]);
+        return 1;
+    }
+
+    memory_init();
+
+    memory_begin(MEM_TAG_TEMP);
+    double start = cooker_now();
+    gltf_model_t *gltf_model = model_load_from_gltf(path, path);
+    bool cooked = gltf_model && cooked_model_write(gltf_model, &compression, out_path);
+    if (gltf_model) model_release_gltf(gltf_model);
+    if (!cooked) {
+        LOGE("Unable to cook %s", path);
+        memory_uninit();
+        return 1;
+    }
+
+    mapped_file_t file;
+    if (map_whole_file(out_path, &file)) {
+        const cooked_model_header_t *header = (const cooked_model_header_t *)file.data;
+        printf("cooked %s into %s in %.1f ms: %.1f KB, %u nodes, %u clips, %u vertices, %u indices, %u images\n",
+               path, out_path, (cooker_now() - start) * 1e3, file.size / 1024.0, header->node_count,
+               header->animation_count, header->vertex_count, header->index_count, header->image_count);
+        unmap_whole_file(&file);
+    }
+
+    skeleton_t *skeleton = memory_alloc(sizeof(skeleton_t), MEM_TAG_HEAP);
+    double best_gltf   = 1e30;
+    double best_cooked = 1e30;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < run_count; i++) {
+        memory_begin(MEM_TAG_TEMP);
+        start = cooker_now();
+        sum += cooker_load_gltf(path, &compression, skeleton);
+        best_gltf = MIN(best_gltf, cooker_now() - start);
+
+        memory_begin(MEM_TAG_TEMP);
+        start = cooker_now();
+        sum += cooker_load_cooked(out_path, skeleton);
+        best_cooked = MIN(best_cooked, cooker_now() - start);
+    }
+    if (run_count > 0) {
+        printf("best of %u loads: %.3f ms from %s, %.3f ms cooked, %.1fx (checksum %llx)\n", run_count,
+               best_gltf * 1e3, path, best_cooked * 1e3, best_gltf / best_cooked, (unsigned long long)sum);
+    }
+    memory_dealloc(skeleton);
+
+    memory_uninit();
+    return 0;
+}